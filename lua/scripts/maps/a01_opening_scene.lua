@@ -48,6 +48,9 @@ function Load(m)
 	Map:AddObjectLayerToOrder(0);
 	Map:AddTileLayerToOrder(2);
 
+	-- This scene always ends with a transition to the underground river, so begin loading that map in the background
+	Map:PreloadMap("lua/scripts/maps/a01_unblock_underground_river.lua");
+
 	CreateSprites();
 	CreateDialogues();
 	CreateEvents();
@@ -62,6 +62,9 @@ function Load(m)
 	Map:AddObjectLayerToOrder(0);
 	Map:AddTileLayerToOrder(2);
 
+	-- This scene always ends with a transition to the capital attack, so begin loading that map in the background
+	Map:PreloadMap("lua/scripts/maps/a01_harrvah_capital_attack.lua");
+
 	CreateSprites();
 	CreateDialogues();
 	CreateEvents();
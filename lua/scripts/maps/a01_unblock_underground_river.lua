@@ -66,6 +66,9 @@ function Load(m)
 	Map:AddObjectLayerToOrder(0);
 	Map:AddTileLayerToOrder(2);
 
+	-- The only exit from this map leads to the return scene, so begin loading that map in the background
+	Map:PreloadMap("lua/scripts/maps/a01_return_scene.lua");
+
 	CreateZones();
 	CreateObjects();
 	CreateSprites();
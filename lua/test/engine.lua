@@ -0,0 +1,147 @@
+------------------------------------------------------------------------------[[
+-- Filename: engine.lua
+--
+-- Description: This file contains benchmarks for the game engine. Each test calls
+-- one of the benchmark functions bound from the hoa_test namespace, which runs
+-- its workload and prints the results to the console before returning.
+------------------------------------------------------------------------------]]
+
+local ns = {}
+setmetatable(ns, {__index = _G})
+engine = ns;
+setfenv(1, ns);
+
+-- Test IDs 20,001 - 21,000 are reserved for engine
+tests = {}
+
+tests[20001] = {
+	name = "Particle Update - Fire";
+	description = "Plays 200 copies of the fire particle effect and reports the average time spent updating them each frame " ..
+		"for several different numbers of update threads.";
+	ExecuteTest = function()
+		hoa_test.BenchmarkParticleUpdate("lua/graphics/particles/fire.lua", 200, 300);
+	end
+}
+
+tests[20002] = {
+	name = "Particle Update - Snow, Rain, Explosion";
+	description = "Runs the particle update benchmark with 100 copies of the snow, rain, and explosion effects in turn. Explosions " ..
+		"are short lived, so their results show the cost of effects that are constantly being created and destroyed.";
+	ExecuteTest = function()
+		hoa_test.BenchmarkParticleUpdate("lua/graphics/particles/snow.lua", 100, 300);
+		hoa_test.BenchmarkParticleUpdate("lua/graphics/particles/rain.lua", 100, 300);
+		hoa_test.BenchmarkParticleUpdate("lua/graphics/particles/explosion.lua", 100, 300);
+	end
+}
+
+tests[20003] = {
+	name = "Path Finding - Shipped Maps";
+	description = "Loads several of the game's maps and reports the average time taken to find a path between the opposite " ..
+		"corners of each one. The party is created first because the map scripts expect it to exist.";
+	ExecuteTest = function()
+		GlobalManager:AddCharacter(1);
+		GlobalManager:AddCharacter(2);
+		GlobalManager:AddCharacter(4);
+		GlobalManager:AddNewRecordGroup("global_records");
+
+		hoa_test.BenchmarkPathFinding("lua/scripts/maps/a01_unblock_underground_river.lua", 100);
+		hoa_test.BenchmarkPathFinding("lua/scripts/maps/a01_harrvah_capital_attack.lua", 100);
+		hoa_test.BenchmarkPathFinding("lua/scripts/maps/a01_sand_dock_departure.lua", 100);
+	end
+}
+
+tests[20004] = {
+	name = "Collision Queries - Harrvah Capital";
+	description = "Loads the largest of the game's maps and reports the time taken to test one million random rectangles of its " ..
+		"collision grid for unwalkable elements, both as whole areas and one element at a time.";
+	ExecuteTest = function()
+		GlobalManager:AddCharacter(1);
+		GlobalManager:AddCharacter(2);
+		GlobalManager:AddCharacter(4);
+		GlobalManager:AddNewRecordGroup("global_records");
+
+		hoa_test.BenchmarkCollisionQueries("lua/scripts/maps/a01_harrvah_capital_attack.lua", 1000000);
+	end
+}
+
+tests[20005] = {
+	name = "Script Cache - Data Files";
+	description = "Opens several of the game's data files repeatedly, first with the script cache disabled and then with it enabled, " ..
+		"and reports the time taken per open along with the cache hit rate and time saved. Tileset definitions have their " ..
+		"environment reused, so cached opens of them do not execute the file either. Only files that the game does not keep " ..
+		"open are used, since a file can not be opened while another script descriptor has it open.";
+	ExecuteTest = function()
+		hoa_test.BenchmarkScriptCache("lua/data/actors/enemies_set_01.lua", 100);
+		hoa_test.BenchmarkScriptCache("lua/data/tilesets/desert_cave.lua", 100);
+		hoa_test.BenchmarkScriptCache("lua/data/maps/harrvah_capital.lua", 10);
+	end
+}
+
+tests[20006] = {
+	name = "Script Compilation - Startup Files";
+	description = "Compares the time taken to load the script files that the game opens when it starts from their source and from " ..
+		"their compiled forms, along with the largest map data file. The compiled files must first be created by running " ..
+		"'make compile-lua'.";
+	ExecuteTest = function()
+		local startup_files = {
+			"lua/global.lua",
+			"lua/data/config/settings.lua",
+			"lua/data/inventory/items.lua",
+			"lua/data/inventory/weapons.lua",
+			"lua/data/inventory/head_armor.lua",
+			"lua/data/inventory/torso_armor.lua",
+			"lua/data/inventory/arm_armor.lua",
+			"lua/data/inventory/leg_armor.lua",
+			"lua/data/inventory/key_items.lua",
+			"lua/data/skills/attack.lua",
+			"lua/data/skills/support.lua",
+			"lua/data/skills/defense.lua",
+			"lua/data/effects/status.lua",
+			"lua/data/actors/map_sprites_stock.lua",
+			"lua/scripts/battles/battle_events.lua"
+		};
+
+		for i, filename in ipairs(startup_files) do
+			hoa_test.BenchmarkScriptCompilation(filename, 20);
+		end
+		hoa_test.BenchmarkScriptCompilation("lua/data/maps/harrvah_capital.lua", 5);
+	end
+}
+
+tests[20007] = {
+	name = "Table Reads - Harrvah Capital Tiles";
+	description = "Reads every tile table of the largest map data file by casting each element through luabind, with " ..
+		"ReadIntVector, and with ReadIntArray, and reports the average time taken by each method to read all of the tables.";
+	ExecuteTest = function()
+		hoa_test.BenchmarkTableReads("lua/data/maps/harrvah_capital.lua", 5);
+	end
+}
+
+tests[20008] = {
+	name = "Object Creation - All Definitions";
+	description = "Constructs every item, weapon, armor, key item, and skill that has a definition, first while their " ..
+		"definitions are loaded and then repeatedly from the loaded definitions, and reports the time taken. The data " ..
+		"currently defines 17 objects (no key items yet) and 14 skills, and an error is reported if a different number is found.";
+	ExecuteTest = function()
+		hoa_test.BenchmarkObjectCreation(1000, 17, 14);
+	end
+}
+
+tests[20009] = {
+	name = "Character Growth - Full Party Level Ups";
+	description = "Awards every character enough experience to gain several levels at once and times the calls to " ..
+		"AcknowledgeGrowth() that process the new levels, as happens at the end of a battle.";
+	ExecuteTest = function()
+		hoa_test.BenchmarkCharacterGrowth(3000, 10);
+	end
+}
+
+tests[20010] = {
+	name = "Map Data Load - Harrvah Capital";
+	description = "Loads the largest map data file from its script and from its compiled map data, and reports the average " ..
+		"time taken by each. The compiled map data must be found under the name of the Lua data file, so running this " ..
+		"test after 'make compile-lua' also checks that maps can use their compiled data when the scripts are compiled.";
+	ExecuteTest = function()
+		hoa_test.BenchmarkMapDataLoad("lua/data/maps/harrvah_capital.lua", 5);
+	end
+}
@@ -117,6 +117,17 @@ customs = {
 -- Engine code tests: Reserve test IDs 20,001 - 30,000
 --------------------------------------------------------------------------------
 
+----- engine: Reserve test IDs 20,001 - 21,000
+table.insert(categories, "engine");
+engine = {
+	name = "Engine Benchmarks";
+	description = "Measures the performance of parts of the game engine. Each benchmark runs to completion before returning to " ..
+		"the test menu, so the screen will appear frozen while it runs. The results are printed to the console.";
+	min_id = 20001;
+	max_id = 21000;
+	file = "lua/test/engine.lua";
+}
+
 
 
 --------------------------------------------------------------------------------
@@ -55,6 +55,16 @@ GameGlobal::~GameGlobal() {
 	IF_PRINT_DEBUG(GLOBAL_DEBUG) << "GameGlobal destructor invoked" << endl;
 
 	ClearAllData();
+
+	// The definitions hold references to script functions, so they are deleted before the scripts are closed
+	_DeleteDefinitions(_item_definitions);
+	_DeleteDefinitions(_weapon_definitions);
+	_DeleteDefinitions(_armor_definitions);
+	_DeleteDefinitions(_shard_definitions);
+	_DeleteDefinitions(_key_item_definitions);
+	_DeleteDefinitions(_skill_definitions);
+	_DeleteDefinitions(_character_definitions);
+
 	_CloseGlobalScripts();
 }
 
@@ -239,8 +249,52 @@ void GameGlobal::_CloseGlobalScripts() {
 		_battle_events_script.CloseTable();
 		_battle_events_script.CloseFile();
 	}
+
+	_next_level_growth_function = ScriptObject();
+	_new_skills_learned_function = ScriptObject();
+	if (_characters_script.IsFileOpen() == true) {
+		_characters_script.CloseTable();
+		_characters_script.CloseFile();
+	}
 } // void GameGlobal::_CloseGlobalScripts()
 
+
+
+void GameGlobal::_OpenCharactersScript() {
+	if (_characters_script.IsFileOpen() == true) {
+		return;
+	}
+
+	if (_characters_script.OpenFile("lua/data/actors/characters.lua") == false) {
+		PRINT_ERROR << "failed to open character data file: lua/data/actors/characters.lua" << endl;
+		return;
+	}
+
+	// The growth functions are called whenever a character gains a level, so they are retrieved only once here
+	_next_level_growth_function = _characters_script.ReadFunctionPointer("DetermineNextLevelGrowth");
+	_new_skills_learned_function = _characters_script.ReadFunctionPointer("DetermineNewSkillsLearned");
+	_characters_script.OpenTable("characters");
+}
+
+
+
+bool GameGlobal::ReloadGlobalScripts() {
+	_CloseGlobalScripts();
+	if (_LoadGlobalScripts() == false) {
+		return false;
+	}
+
+	// Definitions are reloaded in place because every existing object and skill holds a pointer to its definition
+	_ReloadDefinitions(_item_definitions);
+	_ReloadDefinitions(_weapon_definitions);
+	_ReloadDefinitions(_armor_definitions);
+	_ReloadDefinitions(_shard_definitions);
+	_ReloadDefinitions(_key_item_definitions);
+	_ReloadDefinitions(_skill_definitions);
+	_ReloadDefinitions(_character_definitions);
+	return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // GameGlobal class - Character Functions
 ////////////////////////////////////////////////////////////////////////////////
@@ -83,10 +83,10 @@ public:
 
 	/** \brief Closes and reloads all global persistent script files
 	*** \return True if all scripts were loaded successfully
-	*** \note This method is useful when changing the game's language to reload the appropriate text
+	*** \note This method is useful when changing the game's language to reload the appropriate text. Every object
+	*** and skill definition that has been loaded is read again, so existing objects and skills are updated as well.
 	**/
-	bool ReloadGlobalScripts()
-		{ _CloseGlobalScripts(); return _LoadGlobalScripts(); }
+	bool ReloadGlobalScripts();
 
 	//! \name Character Functions
 	//@{
@@ -216,6 +216,38 @@ public:
 		{ if (_inventory.find(id) != _inventory.end()) return true; else return false; }
 	//@}
 
+	/** \name Definition Methods
+	*** \brief Retrieve the shared definition of an object or skill
+	*** \param id The ID of the object or skill
+	*** \return A pointer to the definition, which is never NULL
+	***
+	*** A definition is read from its script the first time that it is requested and is retained until the
+	*** GameGlobal object is destroyed, so every later request for it is only a lookup. If the definition
+	*** could not be read, the definition returned has an ID of zero and the script is not read again.
+	**/
+	//@{
+	const GlobalItemDefinition* GetItemDefinition(uint32 id)
+		{ return _RetrieveDefinition(id, _item_definitions); }
+
+	const GlobalWeaponDefinition* GetWeaponDefinition(uint32 id)
+		{ return _RetrieveDefinition(id, _weapon_definitions); }
+
+	const GlobalArmorDefinition* GetArmorDefinition(uint32 id)
+		{ return _RetrieveDefinition(id, _armor_definitions); }
+
+	const GlobalShardDefinition* GetShardDefinition(uint32 id)
+		{ return _RetrieveDefinition(id, _shard_definitions); }
+
+	const GlobalKeyItemDefinition* GetKeyItemDefinition(uint32 id)
+		{ return _RetrieveDefinition(id, _key_item_definitions); }
+
+	const GlobalSkillDefinition* GetSkillDefinition(uint32 id)
+		{ return _RetrieveDefinition(id, _skill_definitions); }
+
+	const GlobalCharacterDefinition* GetCharacterDefinition(uint32 id)
+		{ return _RetrieveDefinition(id, _character_definitions); }
+	//@}
+
 	//! \name Record Group Methods
 	//@{
 	/** \brief Queries whether or not a record group of a given name exists
@@ -437,6 +469,20 @@ public:
 	hoa_script::ReadScriptDescriptor& GetStatusEffectsScript()
 		{ return _status_effects_script; }
 
+	/** \brief Returns the characters script, opening it if it is not already open
+	*** \note The script remains open and owned by this class once it has been opened, so no other descriptor may open the file
+	**/
+	hoa_script::ReadScriptDescriptor& GetCharactersScript()
+		{ _OpenCharactersScript(); return _characters_script; }
+
+	//! \brief Returns the DetermineNextLevelGrowth function of the characters script, which is invalid if it could not be read
+	const ScriptObject& GetNextLevelGrowthFunction()
+		{ _OpenCharactersScript(); return _next_level_growth_function; }
+
+	//! \brief Returns the DetermineNewSkillsLearned function of the characters script, which is invalid if it could not be read
+	const ScriptObject& GetNewSkillsLearnedFunction()
+		{ _OpenCharactersScript(); return _new_skills_learned_function; }
+
 	hoa_script::ReadScriptDescriptor* GetBattleEventScript()
 		{ return &_battle_events_script; }
 	//@}
@@ -502,6 +548,20 @@ private:
 	std::vector<GlobalKeyItem*>  _inventory_key_items;
 	//@}
 
+	/** \brief Definition containers
+	*** These maps contain every object and skill definition that has been loaded, keyed by ID. Unlike the inventory,
+	*** the definitions are not deleted by ClearAllData() as they do not depend on the game being played.
+	**/
+	//@{
+	std::map<uint32, GlobalItemDefinition*>      _item_definitions;
+	std::map<uint32, GlobalWeaponDefinition*>    _weapon_definitions;
+	std::map<uint32, GlobalArmorDefinition*>     _armor_definitions;
+	std::map<uint32, GlobalShardDefinition*>     _shard_definitions;
+	std::map<uint32, GlobalKeyItemDefinition*>   _key_item_definitions;
+	std::map<uint32, GlobalSkillDefinition*>     _skill_definitions;
+	std::map<uint32, GlobalCharacterDefinition*> _character_definitions;
+	//@}
+
 	//! \name Global data and function script files
 	//@{
 	//! \brief Contains character ID definitions and a number of useful functions
@@ -548,6 +608,15 @@ private:
 
 	//! \brief Contains data and functional definitions for scripted events in key game battles
 	hoa_script::ReadScriptDescriptor _battle_events_script;
+
+	//! \brief Contains the definitions and growth functions of all characters
+	hoa_script::ReadScriptDescriptor _characters_script;
+	//@}
+
+	//! \brief The character growth functions of the characters script, retained so that they may be called without reading the script
+	//@{
+	ScriptObject _next_level_growth_function;
+	ScriptObject _new_skills_learned_function;
 	//@}
 
 	/** \brief The container which stores all of the groups of events that have occured in the game
@@ -557,6 +626,14 @@ private:
 
 	// ----- Private methods
 
+	/** \brief Opens the characters script and retrieves its growth functions if the script is not already open
+	***
+	*** Unlike the other persistent scripts, the characters script is not opened until a character is first constructed.
+	*** The character names are translated when the script is run, and the language of the settings file has not been
+	*** applied yet when the other scripts are loaded.
+	**/
+	void _OpenCharactersScript();
+
 	/** \brief A helper template function that finds and removes an object from the inventory
 	*** \param obj_id The ID of the object to remove from the inventory
 	*** \param inv The vector container of the appropriate inventory type
@@ -572,6 +649,23 @@ private:
 	**/
 	template <class T> T* _RetrieveFromInventory(uint32 obj_id, std::vector<T*>& inv, bool all_counts);
 
+	/** \brief A helper template function that finds a definition, loading it if it has not been requested before
+	*** \param id The ID of the object or skill
+	*** \param definitions The definition container of the appropriate type
+	*** \return A pointer to the definition, which is invalid if it could not be loaded
+	**/
+	template <class T> const T* _RetrieveDefinition(uint32 id, std::map<uint32, T*>& definitions);
+
+	/** \brief A helper template function that reads every definition of a container from its script again
+	*** \param definitions The definition container of the appropriate type
+	**/
+	template <class T> void _ReloadDefinitions(std::map<uint32, T*>& definitions);
+
+	/** \brief A helper template function that deletes every definition of a container
+	*** \param definitions The definition container of the appropriate type
+	**/
+	template <class T> void _DeleteDefinitions(std::map<uint32, T*>& definitions);
+
 	/** \brief A helper function to GameGlobal::SaveGame() that stores the contents of a type of inventory to the saved game file
 	*** \param file A reference to the open and valid file where to write the inventory list
 	*** \param name The name under which this set of inventory data should be categorized (ie "items", "weapons", etc)
@@ -657,6 +751,37 @@ template <class T> T* GameGlobal::_RetrieveFromInventory(uint32 obj_id, std::vec
 
 
 
+template <class T> const T* GameGlobal::_RetrieveDefinition(uint32 id, std::map<uint32, T*>& definitions) {
+	typename std::map<uint32, T*>::iterator i = definitions.find(id);
+	if (i != definitions.end())
+		return i->second;
+
+	// Invalid definitions are retained as well so that a missing definition is only searched for once
+	T* definition = new T();
+	definition->Load(id);
+	definitions.insert(std::make_pair(id, definition));
+	return definition;
+}
+
+
+
+template <class T> void GameGlobal::_ReloadDefinitions(std::map<uint32, T*>& definitions) {
+	for (typename std::map<uint32, T*>::iterator i = definitions.begin(); i != definitions.end(); i++) {
+		i->second->Load(i->first);
+	}
+}
+
+
+
+template <class T> void GameGlobal::_DeleteDefinitions(std::map<uint32, T*>& definitions) {
+	for (typename std::map<uint32, T*>::iterator i = definitions.begin(); i != definitions.end(); i++) {
+		delete i->second;
+	}
+	definitions.clear();
+}
+
+
+
 template <class T> void GameGlobal::_SaveInventory(hoa_script::WriteScriptDescriptor& file, std::string name, std::vector<T*>& inv) {
 	if (file.IsFileOpen() == false) {
 		IF_PRINT_WARNING(GLOBAL_DEBUG) << "failed because the argument file was not open" << std::endl;
@@ -19,6 +19,7 @@
 #include "global_effects.h"
 #include "global_skills.h"
 #include "global_utils.h"
+#include "global.h"
 
 using namespace std;
 
@@ -837,6 +838,141 @@ void GlobalActor::_CalculateEvadeRatings() {
 	}
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// GlobalCharacterDefinition class
+////////////////////////////////////////////////////////////////////////////////
+
+GlobalCharacterDefinition::GlobalCharacterDefinition() :
+	id(0),
+	experience_level(0),
+	experience_points(0),
+	max_hit_points(0),
+	max_skill_points(0),
+	strength(0),
+	vigor(0),
+	fortitude(0),
+	protection(0),
+	stamina(0),
+	resilience(0),
+	agility(0),
+	evade(0.0f),
+	weapon_id(0)
+{}
+
+
+
+void GlobalCharacterDefinition::Load(uint32 character_id) {
+	_Clear();
+	id = character_id;
+
+	ReadScriptDescriptor& char_script = GlobalManager->GetCharactersScript();
+	if (char_script.DoesTableExist(id) == false) {
+		IF_PRINT_WARNING(GLOBAL_DEBUG) << "no valid data for character in definition file: " << id << endl;
+		id = 0;
+		return;
+	}
+
+	// ----- (1): Retrieve their basic character property data
+	char_script.OpenTable(id);
+	name = MakeUnicodeString(char_script.ReadString("name"));
+	filename = char_script.ReadString("filename");
+
+	// ----- (2): Retrieve the initial stats and equipment. If any equipment ids are zero, that indicates nothing is to be equipped.
+	char_script.OpenTable("initial_stats");
+	experience_level = char_script.ReadUInt("experience_level");
+	experience_points = char_script.ReadUInt("experience_points");
+	max_hit_points = char_script.ReadUInt("max_hit_points");
+	max_skill_points = char_script.ReadUInt("max_skill_points");
+	strength = char_script.ReadUInt("strength");
+	vigor = char_script.ReadUInt("vigor");
+	fortitude = char_script.ReadUInt("fortitude");
+	protection = char_script.ReadUInt("protection");
+	stamina = char_script.ReadUInt("stamina");
+	resilience = char_script.ReadUInt("resilience");
+	agility = char_script.ReadUInt("agility");
+	evade = char_script.ReadFloat("evade");
+
+	weapon_id = char_script.ReadUInt("weapon");
+	armor_ids.push_back(char_script.ReadUInt("head_armor"));
+	armor_ids.push_back(char_script.ReadUInt("torso_armor"));
+	armor_ids.push_back(char_script.ReadUInt("arm_armor"));
+	armor_ids.push_back(char_script.ReadUInt("leg_armor"));
+	char_script.CloseTable();
+
+	if (char_script.IsErrorDetected()) {
+		if (GLOBAL_DEBUG) {
+			PRINT_WARNING << "one or more errors occurred while reading initial data - they are listed below" << endl;
+			cerr << char_script.GetErrorMessages() << endl;
+		}
+	}
+
+	// ----- (3): Retrieve the attack points. Their owner is set when a character copies them.
+	char_script.OpenTable("attack_points");
+	for (uint32 i = GLOBAL_POSITION_HEAD; i <= GLOBAL_POSITION_LEGS; i++) {
+		attack_points.push_back(GlobalAttackPoint(NULL));
+		char_script.OpenTable(i);
+		if (attack_points[i].LoadData(char_script) == false) {
+			IF_PRINT_WARNING(GLOBAL_DEBUG) << "failed to succesfully load data for attack point: " << i << endl;
+		}
+		char_script.CloseTable();
+	}
+	char_script.CloseTable();
+
+	if (char_script.IsErrorDetected()) {
+		if (GLOBAL_DEBUG) {
+			PRINT_WARNING << "one or more errors occurred while reading attack point data - they are listed below" << endl;
+			cerr << char_script.GetErrorMessages() << endl;
+		}
+	}
+
+	// ----- (4): Retrieve the skills. The keys indicate the level required to learn the skills and the values are
+	// either a single skill id or a table of skill ids.
+	vector<uint32> skill_levels;
+	char_script.OpenTable("skills");
+	char_script.ReadTableKeys(skill_levels);
+	for (uint32 i = 0; i < skill_levels.size(); i++) {
+		vector<uint32>& level_skills = skills[skill_levels[i]];
+		if (char_script.DoesTableExist(skill_levels[i]) == true)
+			char_script.ReadUIntVector(skill_levels[i], level_skills);
+		else
+			level_skills.push_back(char_script.ReadUInt(skill_levels[i]));
+	}
+	char_script.CloseTable();
+
+	if (char_script.IsErrorDetected()) {
+		if (GLOBAL_DEBUG) {
+			PRINT_WARNING << "one or more errors occurred while reading skill data - they are listed below" << endl;
+			cerr << char_script.GetErrorMessages() << endl;
+		}
+	}
+
+	char_script.CloseTable(); // "characters[id]"
+} // void GlobalCharacterDefinition::Load(uint32 character_id)
+
+
+
+void GlobalCharacterDefinition::_Clear() {
+	id = 0;
+	name.clear();
+	filename.clear();
+	experience_level = 0;
+	experience_points = 0;
+	max_hit_points = 0;
+	max_skill_points = 0;
+	strength = 0;
+	vigor = 0;
+	fortitude = 0;
+	protection = 0;
+	stamina = 0;
+	resilience = 0;
+	agility = 0;
+	evade = 0.0f;
+	weapon_id = 0;
+	armor_ids.clear();
+	attack_points.clear();
+	skills.clear();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // GlobalCharacter class
 ////////////////////////////////////////////////////////////////////////////////
@@ -856,78 +992,47 @@ GlobalCharacter::GlobalCharacter(uint32 id, bool initial) :
 {
 	_id = id;
 
-	// ----- (1): Open the characters script file
-	string filename = "lua/data/actors/characters.lua";
-	ReadScriptDescriptor char_script;
-	if (char_script.OpenFile(filename) == false) {
-		PRINT_ERROR << "failed to open character data file: " << filename << endl;
+	// ----- (1): Retrieve the character's definition, which is only read from the characters script the first time
+	const GlobalCharacterDefinition* definition = GlobalManager->GetCharacterDefinition(_id);
+	if (definition->id == 0) {
+		PRINT_ERROR << "failed to load the definition of character: " << _id << endl;
 		return;
 	}
 
 	// ----- (2): Retrieve their basic character property data
-	char_script.OpenTable("characters");
-	char_script.OpenTable(_id);
-	_name = MakeUnicodeString(char_script.ReadString("name"));
-	_filename = char_script.ReadString("filename");
+	_name = definition->name;
+	_filename = definition->filename;
 
 	// ----- (3): Construct the character from the initial stats if necessary
 	if (initial == true) {
-		char_script.OpenTable("initial_stats");
-		_experience_level = char_script.ReadUInt("experience_level");
-		_experience_points = char_script.ReadUInt("experience_points");
-		_max_hit_points = char_script.ReadUInt("max_hit_points");
+		_experience_level = definition->experience_level;
+		_experience_points = definition->experience_points;
+		_max_hit_points = definition->max_hit_points;
 		_active_max_hit_points = _max_hit_points;
 		_hit_points = _max_hit_points;
-		_max_skill_points = char_script.ReadUInt("max_skill_points");
+		_max_skill_points = definition->max_skill_points;
 		_active_max_skill_points = _max_skill_points;
 		_skill_points = _max_skill_points;
-		_strength = char_script.ReadUInt("strength");
-		_vigor = char_script.ReadUInt("vigor");
-		_fortitude = char_script.ReadUInt("fortitude");
-		_protection = char_script.ReadUInt("protection");
-		_stamina = char_script.ReadUInt("stamina");
-		_resilience = char_script.ReadUInt("resilience");
-		_agility = char_script.ReadUInt("agility");
-		_evade = char_script.ReadFloat("evade");
+		_strength = definition->strength;
+		_vigor = definition->vigor;
+		_fortitude = definition->fortitude;
+		_protection = definition->protection;
+		_stamina = definition->stamina;
+		_resilience = definition->resilience;
+		_agility = definition->agility;
+		_evade = definition->evade;
 
 		// Add the character's initial equipment. If any equipment ids are zero, that indicates nothing is to be equipped.
-		uint32 equipment_id = 0;
-		equipment_id = char_script.ReadUInt("weapon");
-		if (equipment_id != 0)
-			_weapon_equipped = new GlobalWeapon(equipment_id);
+		if (definition->weapon_id != 0)
+			_weapon_equipped = new GlobalWeapon(definition->weapon_id);
 		else
 			_weapon_equipped = NULL;
 
-		equipment_id = char_script.ReadUInt("head_armor");
-		if (equipment_id != 0)
-			_armor_equipped.push_back(new GlobalArmor(equipment_id));
-		else
-			_armor_equipped.push_back(NULL);
-
-		equipment_id = char_script.ReadUInt("torso_armor");
-		if (equipment_id != 0)
-			_armor_equipped.push_back(new GlobalArmor(equipment_id));
-		else
-			_armor_equipped.push_back(NULL);
-
-		equipment_id = char_script.ReadUInt("arm_armor");
-		if (equipment_id != 0)
-			_armor_equipped.push_back(new GlobalArmor(equipment_id));
-		else
-			_armor_equipped.push_back(NULL);
-
-		equipment_id = char_script.ReadUInt("leg_armor");
-		if (equipment_id != 0)
-			_armor_equipped.push_back(new GlobalArmor(equipment_id));
-		else
-			_armor_equipped.push_back(NULL);
-
-		char_script.CloseTable();
-		if (char_script.IsErrorDetected()) {
-			if (GLOBAL_DEBUG) {
-				PRINT_WARNING << "one or more errors occurred while reading initial data - they are listed below" << endl;
-				cerr << char_script.GetErrorMessages() << endl;
-			}
+		for (uint32 i = 0; i < definition->armor_ids.size(); i++) {
+			if (definition->armor_ids[i] != 0)
+				_armor_equipped.push_back(new GlobalArmor(definition->armor_ids[i]));
+			else
+				_armor_equipped.push_back(NULL);
 		}
 	} // if (initial == true)
 	else {
@@ -936,62 +1041,34 @@ GlobalCharacter::GlobalCharacter(uint32 id, bool initial) :
 	}
 
 	// ----- (4): Setup the character's attack points
-	char_script.OpenTable("attack_points");
-	for (uint32 i = GLOBAL_POSITION_HEAD; i <= GLOBAL_POSITION_LEGS; i++) {
-		_attack_points.push_back(new GlobalAttackPoint(this));
-		char_script.OpenTable(i);
-		if (_attack_points[i]->LoadData(char_script) == false) {
-			IF_PRINT_WARNING(GLOBAL_DEBUG) << "failed to succesfully load data for attack point: " << i << endl;
-		}
-		char_script.CloseTable();
-	}
-	char_script.CloseTable();
-
-	if (char_script.IsErrorDetected()) {
-		if (GLOBAL_DEBUG) {
-			PRINT_WARNING << "one or more errors occurred while reading attack point data - they are listed below" << endl;
-			cerr << char_script.GetErrorMessages() << endl;
-		}
+	for (uint32 i = 0; i < definition->attack_points.size(); i++) {
+		_attack_points.push_back(new GlobalAttackPoint(definition->attack_points[i]));
+		_attack_points[i]->SetActorOwner(this);
 	}
 
 	// ----- (5): Construct the character's initial skill set if necessary
 	if (initial) {
-		// The skills table contains key/value pairs. The key indicate the level required to learn the skill and the value is the skill's id
-		vector<uint32> skill_levels;
-		char_script.OpenTable("skills");
-		char_script.ReadTableKeys(skill_levels);
-
-		// We want to add the skills beginning with the first learned to the last. ReadTableKeys does not guarantee returing the keys in a sorted order,
-		// so sort the skills by level before checking each one.
-		sort(skill_levels.begin(), skill_levels.end());
-
-		// Only add the skills for which the experience level requirements are met
-		for (uint32 i = 0; i < skill_levels.size(); i++) {
-			if (skill_levels[i] <= _experience_level) {
-				AddSkill(char_script.ReadUInt(skill_levels[i]));
-			}
-			// Because skill_levels is sorted, all remaining skills will not have their level requirements met
-			else {
+		// The skills are sorted by level, so they are added beginning with the first learned. Only the skills for which the
+		// experience level requirements are met are added.
+		for (map<uint32, vector<uint32> >::const_iterator i = definition->skills.begin(); i != definition->skills.end(); i++) {
+			// Because the skills are sorted, all remaining skills will not have their level requirements met
+			if (i->first > _experience_level)
 				break;
-			}
-		}
 
-		char_script.CloseTable();
-		if (char_script.IsErrorDetected()) {
-			if (GLOBAL_DEBUG) {
-				PRINT_WARNING << "one or more errors occurred while reading skill data - they are listed below" << endl;
-				cerr << char_script.GetErrorMessages() << endl;
+			for (uint32 j = 0; j < i->second.size(); j++) {
+				AddSkill(i->second[j]);
 			}
 		}
 	} // if (initial)
 
-	char_script.CloseTable(); // "characters[id]"
-	char_script.CloseTable(); // "characters"
-
 	// ----- (6): Determine the character's initial growth if necessary
 	if (initial) {
+		const ScriptObject& growth_function = GlobalManager->GetNextLevelGrowthFunction();
 		try {
-			ScriptCallFunction<void>(char_script.GetLuaState(), "DetermineNextLevelGrowth", this);
+			if (growth_function.is_valid() == true)
+				ScriptCallFunction<void>(growth_function, this);
+			else
+				IF_PRINT_WARNING(GLOBAL_DEBUG) << "the character growth functions were not loaded" << endl;
 			_ConstructPeriodicGrowth();
 		}
 		catch (luabind::error e) {
@@ -1002,15 +1079,7 @@ GlobalCharacter::GlobalCharacter(uint32 id, bool initial) :
 		}
 	}
 
-	// ----- (7): Close the script file and calculate all rating totals
-	if (char_script.IsErrorDetected()) {
-		if (GLOBAL_DEBUG) {
-			PRINT_WARNING << "one or more errors occurred while reading final data - they are listed below" << endl;
-			cerr << char_script.GetErrorMessages() << endl;
-		}
-	}
-	char_script.CloseFile();
-
+	// ----- (7): Calculate all rating totals
 	_CalculateAttackRatings();
 	_CalculateDefenseRatings();
 	_CalculateEvadeRatings();
@@ -1220,17 +1289,18 @@ bool GlobalCharacter::AcknowledgeGrowth() {
 	// A new experience level has been gained. Retrieve the growth data for the new experience level
 	_experience_level += 1;
 
-	// Retrieve the growth data for the new experience level and check for any additional growth
+	// Retrieve the growth data for the new experience level and check for any additional growth. The growth functions
+	// are retained by the GameGlobal class, so the characters script does not need to be opened.
 	bool additional_growth_detected = false;
-	string filename = "lua/data/actors/characters.lua";
-	ReadScriptDescriptor character_script;
-	if (character_script.OpenFile(filename) == false) {
-		IF_PRINT_WARNING(GLOBAL_DEBUG) << "failed to open character data file: " << filename << endl;
+	const ScriptObject& growth_function = GlobalManager->GetNextLevelGrowthFunction();
+	const ScriptObject& skills_function = GlobalManager->GetNewSkillsLearnedFunction();
+	if (growth_function.is_valid() == false || skills_function.is_valid() == false) {
+		IF_PRINT_WARNING(GLOBAL_DEBUG) << "the character growth functions were not loaded" << endl;
 		return false;
 	}
 
 	try {
-		ScriptCallFunction<void>(character_script.GetLuaState(), "DetermineNextLevelGrowth", this);
+		ScriptCallFunction<void>(growth_function, this);
 		_ConstructPeriodicGrowth();
 		additional_growth_detected = _CheckForGrowth();
 	} catch(luabind::error& e) {
@@ -1242,14 +1312,13 @@ bool GlobalCharacter::AcknowledgeGrowth() {
 	// Reset the skills learned container and add any skills learned at this level
 	_new_skills_learned.clear();
 	try {
-		ScriptCallFunction<void>(character_script.GetLuaState(), "DetermineNewSkillsLearned", this);
+		ScriptCallFunction<void>(skills_function, this);
 	} catch(luabind::error& e) {
 		ScriptManager->HandleLuaError(e);
 	} catch(luabind::cast_failed& e) {
 		ScriptManager->HandleCastError(e);
 	}
 
-	character_script.CloseFile();
 	return additional_growth_detected;
 } // bool GlobalCharacter::AcknowledgeGrowth()
 
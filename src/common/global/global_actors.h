@@ -664,6 +664,74 @@ protected:
 }; // class GlobalActor
 
 
+/** ****************************************************************************
+*** \brief The static data of a playable character as defined in the characters script
+***
+*** A character's name, initial state, attack points, and skill progression never
+*** change, so they are read from lua/data/actors/characters.lua once, the first
+*** time that the character is constructed, and are retained by the GameGlobal
+*** class until the game exits. A definition with an ID of zero is the definition
+*** of a character that could not be loaded.
+*** ***************************************************************************/
+class GlobalCharacterDefinition {
+public:
+	GlobalCharacterDefinition();
+
+	/** \brief Reads the definition from the character's table in the characters script
+	*** \param character_id The ID of the character to load
+	***
+	*** All existing data of the definition is replaced. If the character has no table in the script, the ID of the
+	*** definition will be set to zero.
+	**/
+	void Load(uint32 character_id);
+
+	//! \brief The ID of the character, or zero if the character is invalid
+	uint32 id;
+
+	//! \brief The name of the character as it will be displayed on the screen
+	hoa_utils::ustring name;
+
+	//! \brief The base name of the character's image files
+	std::string filename;
+
+	//! \name Initial Stats
+	//@{
+	uint32 experience_level;
+	uint32 experience_points;
+	uint32 max_hit_points;
+	uint32 max_skill_points;
+	uint32 strength;
+	uint32 vigor;
+	uint32 fortitude;
+	uint32 protection;
+	uint32 stamina;
+	uint32 resilience;
+	uint32 agility;
+	float evade;
+	//@}
+
+	//! \brief The ID of the initial weapon, or zero if the character starts without a weapon
+	uint32 weapon_id;
+
+	//! \brief The IDs of the initial head, torso, arm, and leg armor, where zero indicates that nothing is equipped
+	std::vector<uint32> armor_ids;
+
+	/** \brief The character's four attack points, in the order of the GLOBAL_POSITION constants
+	*** These attack points have no owner. Characters own copies of them.
+	**/
+	std::vector<GlobalAttackPoint> attack_points;
+
+	/** \brief The IDs of the skills that the character learns, keyed by the experience level at which they are learned
+	*** The skills of every level up to and including the initial experience level are known by a newly constructed character.
+	**/
+	std::map<uint32, std::vector<uint32> > skills;
+
+private:
+	//! \brief Removes all data from the definition
+	void _Clear();
+}; // class GlobalCharacterDefinition
+
+
 /** ****************************************************************************
 *** \brief Represents a playable game character
 ***
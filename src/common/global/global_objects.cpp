@@ -31,129 +31,270 @@ using namespace hoa_global::private_global;
 namespace hoa_global {
 
 ////////////////////////////////////////////////////////////////////////////////
-// GlobalObject class
+// GlobalObjectDefinition class
 ////////////////////////////////////////////////////////////////////////////////
 
-void GlobalObject::_LoadObjectData(hoa_script::ReadScriptDescriptor& script) {
-	_name = MakeUnicodeString(script.ReadString("name"));
-	_description = MakeUnicodeString(script.ReadString("description"));
-	_price = script.ReadUInt("standard_price");
+void GlobalObjectDefinition::_Clear() {
+	id = 0;
+	name.clear();
+	description.clear();
+	lore.clear();
+	price = 0;
+	icon_image.Clear();
+}
+
+
+
+void GlobalObjectDefinition::_LoadObjectData(hoa_script::ReadScriptDescriptor& script) {
+	name = MakeUnicodeString(script.ReadString("name"));
+	description = MakeUnicodeString(script.ReadString("description"));
+	price = script.ReadUInt("standard_price");
 	string icon_file = script.ReadString("icon");
-	if (_icon_image.Load(icon_file) == false) {
-		IF_PRINT_WARNING(GLOBAL_DEBUG) << "failed to load icon image for item: " << _id << endl;
-		_InvalidateObject();
+	if (icon_image.Load(icon_file) == false) {
+		IF_PRINT_WARNING(GLOBAL_DEBUG) << "failed to load icon image for item: " << id << endl;
+		id = 0;
+	}
+}
+
+
+
+void GlobalObjectDefinition::_FinishLoading(hoa_script::ReadScriptDescriptor& script, const string& object_type) {
+	script.CloseTable();
+	if (script.IsErrorDetected()) {
+		if (GLOBAL_DEBUG) {
+			PRINT_WARNING << "one or more errors occurred while reading " << object_type << " data - they are listed below" << endl;
+			cerr << script.GetErrorMessages() << endl;
+		}
+		id = 0;
 	}
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// GlobalItem class
+// GlobalItemDefinition class
 ////////////////////////////////////////////////////////////////////////////////
 
-GlobalItem::GlobalItem(uint32 id, uint32 count) :
-	GlobalObject(id, count),
-	_target_type(GLOBAL_TARGET_INVALID),
-	_battle_use_function(NULL),
-	_field_use_function(NULL)
-{
-	if ((_id == 0) || (_id > MAX_ITEM_ID)) {
-		IF_PRINT_WARNING(GLOBAL_DEBUG) << "invalid id in constructor: " << _id << endl;
-		_InvalidateObject();
+GlobalItemDefinition::~GlobalItemDefinition() {
+	_Clear();
+}
+
+
+
+void GlobalItemDefinition::Load(uint32 object_id) {
+	_Clear();
+	id = object_id;
+
+	if ((id == 0) || (id > MAX_ITEM_ID)) {
+		IF_PRINT_WARNING(GLOBAL_DEBUG) << "invalid item id: " << id << endl;
+		id = 0;
 		return;
 	}
 
 	ReadScriptDescriptor& script_file = GlobalManager->GetItemsScript();
-	if (script_file.DoesTableExist(_id) == false) {
-		IF_PRINT_WARNING(GLOBAL_DEBUG) << "no valid data for item in definition file: " << _id << endl;
-		_InvalidateObject();
+	if (script_file.DoesTableExist(id) == false) {
+		IF_PRINT_WARNING(GLOBAL_DEBUG) << "no valid data for item in definition file: " << id << endl;
+		id = 0;
 		return;
 	}
 
 	// Load the item data from the script
-	script_file.OpenTable(_id);
+	script_file.OpenTable(id);
 	_LoadObjectData(script_file);
 
-	_target_type = static_cast<GLOBAL_TARGET>(script_file.ReadInt("target_type"));
+	target_type = static_cast<GLOBAL_TARGET>(script_file.ReadInt("target_type"));
 	if (script_file.DoesFunctionExist("BattleUse") == true) {
-		_battle_use_function = new ScriptObject();
-		*_battle_use_function = script_file.ReadFunctionPointer("BattleUse");
+		battle_use_function = new ScriptObject();
+		*battle_use_function = script_file.ReadFunctionPointer("BattleUse");
 	}
 	if (script_file.DoesFunctionExist("FieldUse") == true) {
-		_field_use_function = new ScriptObject();
-		*_field_use_function = script_file.ReadFunctionPointer("FieldUse");
+		field_use_function = new ScriptObject();
+		*field_use_function = script_file.ReadFunctionPointer("FieldUse");
 	}
 
+	_FinishLoading(script_file, "item");
+} // void GlobalItemDefinition::Load(uint32 object_id)
 
-	script_file.CloseTable();
-	if (script_file.IsErrorDetected()) {
-		if (GLOBAL_DEBUG) {
-			PRINT_WARNING << "one or more errors occurred while reading item data - they are listed below" << endl;
-			cerr << script_file.GetErrorMessages() << endl;
-		}
-		_InvalidateObject();
-	}
-} // void GlobalItem::GlobalItem(uint32 id, uint32 count = 1)
 
 
+void GlobalItemDefinition::_Clear() {
+	GlobalObjectDefinition::_Clear();
+	target_type = GLOBAL_TARGET_INVALID;
 
-GlobalItem::~GlobalItem() {
-	if (_battle_use_function != NULL) {
-		delete _battle_use_function;
-		_battle_use_function = NULL;
+	if (battle_use_function != NULL) {
+		delete battle_use_function;
+		battle_use_function = NULL;
 	}
-	if (_field_use_function != NULL) {
-		delete _field_use_function;
-		_field_use_function = NULL;
+
+	if (field_use_function != NULL) {
+		delete field_use_function;
+		field_use_function = NULL;
 	}
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// GlobalWeaponDefinition class
+////////////////////////////////////////////////////////////////////////////////
 
+void GlobalWeaponDefinition::Load(uint32 object_id) {
+	_Clear();
+	id = object_id;
+	if ((id <= MAX_ITEM_ID) || (id > MAX_WEAPON_ID)) {
+		IF_PRINT_WARNING(GLOBAL_DEBUG) << "invalid weapon id: " << id << endl;
+		id = 0;
+		return;
+	}
 
-GlobalItem::GlobalItem(const GlobalItem& copy) :
-	GlobalObject(copy)
-{
-	_target_type = copy._target_type;
+	ReadScriptDescriptor& script_file = GlobalManager->GetWeaponsScript();
+	if (script_file.DoesTableExist(id) == false) {
+		IF_PRINT_WARNING(GLOBAL_DEBUG) << "no valid data for weapon in definition file: " << id << endl;
+		id = 0;
+		return;
+	}
 
-	// Make copies of valid ScriptObject function pointers
-	if (copy._battle_use_function == NULL)
-		_battle_use_function = NULL;
-	else
-		_battle_use_function = new ScriptObject(*copy._battle_use_function);
+	// Load the weapon data from the script
+	script_file.OpenTable(id);
+	_LoadObjectData(script_file);
 
-	if (copy._field_use_function == NULL)
-		_field_use_function = NULL;
-	else
-		_field_use_function = new ScriptObject(*copy._field_use_function);
+	physical_attack = script_file.ReadUInt("physical_attack");
+	ethereal_attack = script_file.ReadUInt("ethereal_attack");
+	usable_by = script_file.ReadUInt("usable_by");
+
+	_FinishLoading(script_file, "weapon");
+} // void GlobalWeaponDefinition::Load(uint32 object_id)
+
+
+
+void GlobalWeaponDefinition::_Clear() {
+	GlobalObjectDefinition::_Clear();
+	physical_attack = 0;
+	ethereal_attack = 0;
+	usable_by = 0;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// GlobalArmorDefinition class
+////////////////////////////////////////////////////////////////////////////////
 
+void GlobalArmorDefinition::Load(uint32 object_id) {
+	_Clear();
+	id = object_id;
 
-GlobalItem& GlobalItem::operator=(const GlobalItem& copy) {
-	if (this == &copy) // Handle self-assignment case
-		return *this;
+	// Figure out the appropriate script reference to grab based on the id value
+	ReadScriptDescriptor* script_file;
+	if ((id > MAX_WEAPON_ID) && (id <= MAX_HEAD_ARMOR_ID)) {
+		script_file = &(GlobalManager->GetHeadArmorScript());
+	}
+	else if ((id > MAX_HEAD_ARMOR_ID) && (id <= MAX_TORSO_ARMOR_ID)) {
+		script_file = &(GlobalManager->GetTorsoArmorScript());
+	}
+	else if ((id > MAX_TORSO_ARMOR_ID) && (id <= MAX_ARM_ARMOR_ID)) {
+		script_file = &(GlobalManager->GetArmArmorScript());
+	}
+	else if ((id > MAX_ARM_ARMOR_ID) && (id <= MAX_LEG_ARMOR_ID)) {
+		script_file = &(GlobalManager->GetLegArmorScript());
+	}
+	else {
+		IF_PRINT_WARNING(GLOBAL_DEBUG) << "invalid armor id: " << id << endl;
+		id = 0;
+		return;
+	}
 
-	GlobalObject::operator=(copy);
-	_target_type = copy._target_type;
+	if (script_file->DoesTableExist(id) == false) {
+		IF_PRINT_WARNING(GLOBAL_DEBUG) << "no valid data for armor in definition file: " << id << endl;
+		id = 0;
+		return;
+	}
+
+	// Load the armor data from the script
+	script_file->OpenTable(id);
+	_LoadObjectData(*script_file);
+
+	physical_defense = script_file->ReadUInt("physical_defense");
+	ethereal_defense = script_file->ReadUInt("ethereal_defense");
+	usable_by = script_file->ReadUInt("usable_by");
+
+	_FinishLoading(*script_file, "armor");
+} // void GlobalArmorDefinition::Load(uint32 object_id)
 
-	// Make copies of valid ScriptObject function pointers
-	if (copy._battle_use_function == NULL)
-		_battle_use_function = NULL;
-	else
-		_battle_use_function = new ScriptObject(*copy._battle_use_function);
 
-	if (copy._field_use_function == NULL)
-		_field_use_function = NULL;
-	else
-		_field_use_function = new ScriptObject(*copy._field_use_function);
 
-	return *this;
+void GlobalArmorDefinition::_Clear() {
+	GlobalObjectDefinition::_Clear();
+	physical_defense = 0;
+	ethereal_defense = 0;
+	usable_by = 0;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// GlobalShardDefinition class
+////////////////////////////////////////////////////////////////////////////////
+
+void GlobalShardDefinition::Load(uint32 object_id) {
+	_Clear();
+	id = object_id;
+	if ((id <= MAX_LEG_ARMOR_ID) || (id > MAX_SHARD_ID)) {
+		IF_PRINT_WARNING(GLOBAL_DEBUG) << "invalid shard id: " << id << endl;
+		id = 0;
+		return;
+	}
+
+	// TODO: replace the code below when shards scripts are available
+	IF_PRINT_WARNING(GLOBAL_DEBUG) << "shards do not have a definition file yet: " << id << endl;
+	id = 0;
+// 	ReadScriptDescriptor& script_file = GlobalManager->GetShardsScript();
+// 	if (script_file.DoesTableExist(id) == false) {
+// 		IF_PRINT_WARNING(GLOBAL_DEBUG) << "no valid data for shard in definition file: " << id << endl;
+// 		id = 0;
+// 		return;
+// 	}
+//
+// 	// Load the shard data from the script
+// 	script_file.OpenTable(id);
+// 	_LoadObjectData(script_file);
+//
+// 	_FinishLoading(script_file, "shard");
+} // void GlobalShardDefinition::Load(uint32 object_id)
+
+////////////////////////////////////////////////////////////////////////////////
+// GlobalKeyItemDefinition class
+////////////////////////////////////////////////////////////////////////////////
+
+void GlobalKeyItemDefinition::Load(uint32 object_id) {
+	_Clear();
+	id = object_id;
+	if ((id <= MAX_SHARD_ID) || (id > MAX_KEY_ITEM_ID)) {
+		IF_PRINT_WARNING(GLOBAL_DEBUG) << "invalid key item id: " << id << endl;
+		id = 0;
+		return;
+	}
+
+	ReadScriptDescriptor& script_file = GlobalManager->GetKeyItemsScript();
+	if (script_file.DoesTableExist(id) == false) {
+		IF_PRINT_WARNING(GLOBAL_DEBUG) << "no valid data for key item in definition file: " << id << endl;
+		id = 0;
+		return;
+	}
+
+	// Load the key item data from the script
+	script_file.OpenTable(id);
+	_LoadObjectData(script_file);
+
+	_FinishLoading(script_file, "key item");
+} // void GlobalKeyItemDefinition::Load(uint32 object_id)
+
+////////////////////////////////////////////////////////////////////////////////
+// GlobalItem class
+////////////////////////////////////////////////////////////////////////////////
+
+GlobalItem::GlobalItem(uint32 id, uint32 count) :
+	GlobalObject(GlobalManager->GetItemDefinition(id), count)
+{}
+
 ////////////////////////////////////////////////////////////////////////////////
 // GlobalWeapon class
 ////////////////////////////////////////////////////////////////////////////////
 
 GlobalWeapon::GlobalWeapon(uint32 id, uint32 count) :
-	GlobalObject(id, count)
+	GlobalObject(GlobalManager->GetWeaponDefinition(id), count)
 {
 	// Initialize all elemental effects as neutral
 	_elemental_effects.insert(pair<GLOBAL_ELEMENTAL, GLOBAL_INTENSITY>(GLOBAL_ELEMENTAL_FIRE, GLOBAL_INTENSITY_NEUTRAL));
@@ -164,44 +305,14 @@ GlobalWeapon::GlobalWeapon(uint32 id, uint32 count) :
 	_elemental_effects.insert(pair<GLOBAL_ELEMENTAL, GLOBAL_INTENSITY>(GLOBAL_ELEMENTAL_PIERCING, GLOBAL_INTENSITY_NEUTRAL));
 	_elemental_effects.insert(pair<GLOBAL_ELEMENTAL, GLOBAL_INTENSITY>(GLOBAL_ELEMENTAL_CRUSHING, GLOBAL_INTENSITY_NEUTRAL));
 	_elemental_effects.insert(pair<GLOBAL_ELEMENTAL, GLOBAL_INTENSITY>(GLOBAL_ELEMENTAL_MAULING, GLOBAL_INTENSITY_NEUTRAL));
-
-	if ((_id <= MAX_ITEM_ID) || (_id > MAX_WEAPON_ID)) {
-		IF_PRINT_WARNING(GLOBAL_DEBUG) << "invalid id in constructor: " << _id << endl;
-		_InvalidateObject();
-		return;
-	}
-
-	ReadScriptDescriptor& script_file = GlobalManager->GetWeaponsScript();
-	if (script_file.DoesTableExist(_id) == false) {
-		IF_PRINT_WARNING(GLOBAL_DEBUG) << "no valid data for weapon in definition file: " << _id << endl;
-		_InvalidateObject();
-		return;
-	}
-
-	// Load the weapon data from the script
-	script_file.OpenTable(_id);
-	_LoadObjectData(script_file);
-
-	_physical_attack = script_file.ReadUInt("physical_attack");
-	_ethereal_attack = script_file.ReadUInt("ethereal_attack");
-	_usable_by = script_file.ReadUInt("usable_by");
-
-	script_file.CloseTable();
-	if (script_file.IsErrorDetected()) {
-		if (GLOBAL_DEBUG) {
-			PRINT_WARNING << "one or more errors occurred while reading weapon data - they are listed below" << endl;
-			cerr << script_file.GetErrorMessages() << endl;
-		}
-		_InvalidateObject();
-	}
-} // void GlobalWeapon::GlobalWeapon(uint32 id, uint32 count = 1)
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 // GlobalArmor class
 ////////////////////////////////////////////////////////////////////////////////
 
 GlobalArmor::GlobalArmor(uint32 id, uint32 count) :
-	GlobalObject(id, count)
+	GlobalObject(GlobalManager->GetArmorDefinition(id), count)
 {
 	// Initialize all elemental effects as neutral
 	_elemental_effects.insert(pair<GLOBAL_ELEMENTAL, GLOBAL_INTENSITY>(GLOBAL_ELEMENTAL_FIRE, GLOBAL_INTENSITY_NEUTRAL));
@@ -212,68 +323,19 @@ GlobalArmor::GlobalArmor(uint32 id, uint32 count) :
 	_elemental_effects.insert(pair<GLOBAL_ELEMENTAL, GLOBAL_INTENSITY>(GLOBAL_ELEMENTAL_PIERCING, GLOBAL_INTENSITY_NEUTRAL));
 	_elemental_effects.insert(pair<GLOBAL_ELEMENTAL, GLOBAL_INTENSITY>(GLOBAL_ELEMENTAL_CRUSHING, GLOBAL_INTENSITY_NEUTRAL));
 	_elemental_effects.insert(pair<GLOBAL_ELEMENTAL, GLOBAL_INTENSITY>(GLOBAL_ELEMENTAL_MAULING, GLOBAL_INTENSITY_NEUTRAL));
-
-	if ((_id <= MAX_WEAPON_ID) || (_id > MAX_LEG_ARMOR_ID)) {
-		IF_PRINT_WARNING(GLOBAL_DEBUG) << "invalid id in constructor: " << _id << endl;
-		_InvalidateObject();
-		return;
-	}
-
-	// Figure out the appropriate script reference to grab based on the id value
-	ReadScriptDescriptor* script_file;
-	switch (GetObjectType()) {
-		case GLOBAL_OBJECT_HEAD_ARMOR:
-			script_file = &(GlobalManager->GetHeadArmorScript());
-			break;
-		case GLOBAL_OBJECT_TORSO_ARMOR:
-			script_file = &(GlobalManager->GetTorsoArmorScript());
-			break;
-		case GLOBAL_OBJECT_ARM_ARMOR:
-			script_file = &(GlobalManager->GetArmArmorScript());
-			break;
-		case GLOBAL_OBJECT_LEG_ARMOR:
-			script_file = &(GlobalManager->GetLegArmorScript());
-			break;
-		default:
-			IF_PRINT_WARNING(GLOBAL_DEBUG) << "could not determine armor type: " << _id << endl;
-			_InvalidateObject();
-			return;
-	}
-
-	if (script_file->DoesTableExist(_id) == false) {
-		IF_PRINT_WARNING(GLOBAL_DEBUG) << "no valid data for armor in definition file: " << _id << endl;
-		_InvalidateObject();
-		return;
-	}
-
-	// Load the armor data from the script
-	script_file->OpenTable(_id);
-	_LoadObjectData(*script_file);
-
-	_physical_defense = script_file->ReadUInt("physical_defense");
-	_ethereal_defense = script_file->ReadUInt("ethereal_defense");
-	_usable_by = script_file->ReadUInt("usable_by");
-
-	script_file->CloseTable();
-	if (script_file->IsErrorDetected()) {
-		if (GLOBAL_DEBUG) {
-			PRINT_WARNING << "one or more errors occurred while reading armor data - they are listed below" << endl;
-			cerr << script_file->GetErrorMessages() << endl;
-		}
-		_InvalidateObject();
-	}
-} // void GlobalArmor::GlobalArmor(uint32 id, uint32 count = 1)
+}
 
 
 
 GLOBAL_OBJECT GlobalArmor::GetObjectType() const {
-	if ((_id > MAX_WEAPON_ID) && (_id <= MAX_HEAD_ARMOR_ID))
+	uint32 id = GetID();
+	if ((id > MAX_WEAPON_ID) && (id <= MAX_HEAD_ARMOR_ID))
 		return GLOBAL_OBJECT_HEAD_ARMOR;
-	else if ((_id > MAX_HEAD_ARMOR_ID) && (_id <= MAX_TORSO_ARMOR_ID))
+	else if ((id > MAX_HEAD_ARMOR_ID) && (id <= MAX_TORSO_ARMOR_ID))
 		return GLOBAL_OBJECT_TORSO_ARMOR;
-	else if ((_id > MAX_TORSO_ARMOR_ID) && (_id <= MAX_ARM_ARMOR_ID))
+	else if ((id > MAX_TORSO_ARMOR_ID) && (id <= MAX_ARM_ARMOR_ID))
 		return GLOBAL_OBJECT_ARM_ARMOR;
-	else if ((_id > MAX_ARM_ARMOR_ID) && (_id <= MAX_LEG_ARMOR_ID))
+	else if ((id > MAX_ARM_ARMOR_ID) && (id <= MAX_LEG_ARMOR_ID))
 		return GLOBAL_OBJECT_LEG_ARMOR;
 	else
 		return GLOBAL_OBJECT_INVALID;
@@ -284,68 +346,15 @@ GLOBAL_OBJECT GlobalArmor::GetObjectType() const {
 ////////////////////////////////////////////////////////////////////////////////
 
 GlobalShard::GlobalShard(uint32 id, uint32 count) :
-	GlobalObject(id, count)
-{
-	if ((_id <= MAX_LEG_ARMOR_ID) || (_id > MAX_SHARD_ID)) {
-		IF_PRINT_WARNING(GLOBAL_DEBUG) << "invalid id in constructor: " << _id << endl;
-		_InvalidateObject();
-		return;
-	}
-
-	// TODO: uncomment the code below when shards scripts are available
-// 	ReadScriptDescriptor& script_file = GlobalManager->GetShardsScript();
-// 	if (script_file.DoesTableExist(_id) == false) {
-// 		IF_PRINT_WARNING(GLOBAL_DEBUG) << "no valid data for shard in definition file: " << _id << endl;
-// 		_InvalidateObject();
-// 		return;
-// 	}
-//
-// 	// Load the shard data from the script
-// 	script_file.OpenTable(_id);
-// 	_LoadObjectData(script_file);
-//
-// 	script_file.CloseTable();
-// 	if (script_file.IsErrorDetected()) {
-// 		if (GLOBAL_DEBUG) {
-// 			PRINT_WARNING << "one or more errors occurred while reading shard data - they are listed below" << endl;
-// 			cerr << script_file.GetErrorMessages() << endl;
-// 		}
-// 		_InvalidateObject();
-// 	}
-} // void GlobalShard::GlobalShard(uint32 id, uint32 count = 1)
+	GlobalObject(GlobalManager->GetShardDefinition(id), count)
+{}
 
 ////////////////////////////////////////////////////////////////////////////////
 // GlobalKeyItem class
 ////////////////////////////////////////////////////////////////////////////////
 
 GlobalKeyItem::GlobalKeyItem(uint32 id, uint32 count) :
-	GlobalObject(id, count)
-{
-	if ((_id <= MAX_SHARD_ID) || (_id > MAX_KEY_ITEM_ID)) {
-		IF_PRINT_WARNING(GLOBAL_DEBUG) << "invalid id in constructor: " << _id << endl;
-		_InvalidateObject();
-		return;
-	}
-
-	ReadScriptDescriptor& script_file = GlobalManager->GetKeyItemsScript();
-	if (script_file.DoesTableExist(_id) == false) {
-		IF_PRINT_WARNING(GLOBAL_DEBUG) << "no valid data for key item in definition file: " << _id << endl;
-		_InvalidateObject();
-		return;
-	}
-
-	// Load the key item data from the script
-	script_file.OpenTable(_id);
-	_LoadObjectData(script_file);
-
-	script_file.CloseTable();
-	if (script_file.IsErrorDetected()) {
-		if (GLOBAL_DEBUG) {
-			PRINT_WARNING << "one or more errors occurred while reading key item data - they are listed below" << endl;
-			cerr << script_file.GetErrorMessages() << endl;
-		}
-		_InvalidateObject();
-	}
-} // void GlobalKeyItem::GlobalKeyItem(uint32 id, uint32 count = 1)
+	GlobalObject(GlobalManager->GetKeyItemDefinition(id), count)
+{}
 
 } // namespace hoa_global
@@ -29,6 +29,166 @@
 
 namespace hoa_global {
 
+/** ****************************************************************************
+*** \brief The properties shared by every instance of a game object with the same ID
+***
+*** Object definitions are read from the Lua definition table of the object the first
+*** time that they are requested from the GameGlobal class, which retains them until
+*** the game exits. Every GlobalObject constructed with the same ID points to the same
+*** definition, so constructing objects does not access any script. The definitions
+*** are only modified when they are loaded, and everything else may only view them
+*** through a const pointer.
+***
+*** A definition with an ID of zero is the definition of an invalid object. When an
+*** object could not be loaded, the definition that is retained for its ID is invalid
+*** so that the failure does not cause the script to be read again.
+*** ***************************************************************************/
+class GlobalObjectDefinition {
+public:
+	GlobalObjectDefinition() :
+		id(0), price(0) {}
+
+	virtual ~GlobalObjectDefinition()
+		{}
+
+	/** \brief Reads the definition from the object's table in its definition script
+	*** \param object_id The ID of the object to load
+	***
+	*** All existing data of the definition is replaced. If the object data could not be read, the ID of
+	*** the definition will be set to zero.
+	**/
+	virtual void Load(uint32 object_id) = 0;
+
+	//! \brief The ID of the object, or zero if the object is invalid
+	uint32 id;
+
+	//! \brief The name of the object as it would be displayed on a screen
+	hoa_utils::ustring name;
+
+	//! \brief A short description of the item to display on the screen
+	hoa_utils::ustring description;
+
+	//! \brief A detailed description of the object's history, culture, and how it fits into the game world
+	hoa_utils::ustring lore;
+
+	//! \brief The base price of the object for purchase/sale in the game
+	uint32 price;
+
+	//! \brief A loaded icon image of the object at its original size of 60x60 pixels
+	hoa_video::StillImage icon_image;
+
+protected:
+	//! \brief Removes the data common to all objects from the definition
+	void _Clear();
+
+	/** \brief Reads the data common to all objects from an open script file
+	*** \param script A reference to a script file with the table of the object opened
+	**/
+	void _LoadObjectData(hoa_script::ReadScriptDescriptor& script);
+
+	/** \brief Closes the table of the object and invalidates the definition if any errors occurred while reading it
+	*** \param script A reference to the script file that the definition was read from
+	*** \param object_type The type of object being loaded, used in the warning message
+	**/
+	void _FinishLoading(hoa_script::ReadScriptDescriptor& script, const std::string& object_type);
+}; // class GlobalObjectDefinition
+
+
+//! \brief The shared properties of an item
+class GlobalItemDefinition : public GlobalObjectDefinition {
+public:
+	GlobalItemDefinition() :
+		target_type(GLOBAL_TARGET_INVALID), battle_use_function(NULL), field_use_function(NULL) {}
+
+	~GlobalItemDefinition();
+
+	void Load(uint32 object_id);
+
+	//! \brief The type of target for the item
+	GLOBAL_TARGET target_type;
+
+	//! \brief A pointer to the script function that performs the item's effect while in battle, or NULL if it is not usable in battle
+	ScriptObject* battle_use_function;
+
+	//! \brief A pointer to the script function that performs the item's effect while in a menu, or NULL if it is not usable in the field
+	ScriptObject* field_use_function;
+
+private:
+	GlobalItemDefinition(const GlobalItemDefinition& copy);
+	GlobalItemDefinition& operator=(const GlobalItemDefinition& copy);
+
+	//! \brief Removes all data from the definition
+	void _Clear();
+}; // class GlobalItemDefinition : public GlobalObjectDefinition
+
+
+//! \brief The shared properties of a weapon
+class GlobalWeaponDefinition : public GlobalObjectDefinition {
+public:
+	GlobalWeaponDefinition() :
+		physical_attack(0), ethereal_attack(0), usable_by(0) {}
+
+	void Load(uint32 object_id);
+
+	//! \brief The amount of physical damage that the weapon causes
+	uint32 physical_attack;
+
+	//! \brief The amount of ethereal damage that the weapon causes
+	uint32 ethereal_attack;
+
+	/** \brief A bit-mask that determines which characters can use or equip the object
+	*** See the game character ID constants in global_actors.h for more information
+	**/
+	uint32 usable_by;
+
+private:
+	//! \brief Removes all data from the definition
+	void _Clear();
+}; // class GlobalWeaponDefinition : public GlobalObjectDefinition
+
+
+//! \brief The shared properties of a piece of armor of any type
+class GlobalArmorDefinition : public GlobalObjectDefinition {
+public:
+	GlobalArmorDefinition() :
+		physical_defense(0), ethereal_defense(0), usable_by(0) {}
+
+	//! \note The definition script to read from is determined by the range that the ID falls in
+	void Load(uint32 object_id);
+
+	//! \brief The amount of physical defense that the armor provides
+	uint32 physical_defense;
+
+	//! \brief The amount of ethereal defense that the armor provides
+	uint32 ethereal_defense;
+
+	/** \brief A bit-mask that determines which characters can use or equip the object
+	*** See the game character ID constants in global_actors.h for more information
+	**/
+	uint32 usable_by;
+
+private:
+	//! \brief Removes all data from the definition
+	void _Clear();
+}; // class GlobalArmorDefinition : public GlobalObjectDefinition
+
+
+/** \brief The shared properties of a shard
+*** \todo Shards do not have a definition script yet, so every shard definition is currently invalid
+**/
+class GlobalShardDefinition : public GlobalObjectDefinition {
+public:
+	void Load(uint32 object_id);
+}; // class GlobalShardDefinition : public GlobalObjectDefinition
+
+
+//! \brief The shared properties of a key item, which has no data beyond the common object data
+class GlobalKeyItemDefinition : public GlobalObjectDefinition {
+public:
+	void Load(uint32 object_id);
+}; // class GlobalKeyItemDefinition : public GlobalObjectDefinition
+
+
 /** ****************************************************************************
 *** \brief An abstract base class for representing a game object
 ***
@@ -40,32 +200,38 @@ namespace hoa_global {
 *** class object rather than having to create and managed 50 class objects, one for
 *** each potion. The _count member achieves this convenient function.
 ***
-*** A GlobalObject with an ID value of zero is considered invalid. Most of the
-*** protected members of this class can only be set by the constructors or methods
-*** of deriving classes.
+*** The properties of an object that never change, such as its name and price, are
+*** held by a definition object that is shared with every other object of the same
+*** ID. The object itself only holds its count and the properties that can change
+*** over the course of the game.
+***
+*** The ID of an object is the ID of its definition, so an object becomes invalid
+*** whenever its definition is invalid. A GlobalObject with an ID value of zero is
+*** considered invalid. Most of the protected members of this class can only be set
+*** by the constructors or methods of deriving classes.
 ***
 *** \note The price of an object is not actually the price it is bought or sold
 *** at in the game. It is a "base price" from which all levels of buy and sell
 *** prices are derived from.
 ***
 *** \todo The "lore" for an object is a feature that we have discussed but not
-*** yet decided if we wish to implement. Placeholders exist in this class for now,
-*** but if lore is not to be implemented as a game feature they should be removed.
+*** yet decided if we wish to implement. Placeholders exist in the definition class
+*** for now, but if lore is not to be implemented as a game feature they should be removed.
 *** ***************************************************************************/
 class GlobalObject {
 public:
-	GlobalObject() :
-		_id(0), _count(0), _price(0) {}
-
-	GlobalObject(uint32 id, uint32 count = 1) :
-		_id(id), _count(count), _price(0) {}
+	/** \param definition A pointer to the shared definition of the object, which must not be NULL
+	*** \param count The number of objects to initialize this class object as representing
+	**/
+	GlobalObject(const GlobalObjectDefinition* definition, uint32 count) :
+		_count(count), _definition(definition) {}
 
 	virtual ~GlobalObject()
 		{}
 
 	//! \brief Returns true if the object is properly initialized and ready to be used
 	bool IsValid() const
-		{ return (_id != 0); }
+		{ return (_definition->id != 0); }
 
 	/** \brief Purely virtual function used to distinguish between object types
 	*** \return A value that represents the type of object
@@ -89,16 +255,16 @@ public:
 	//! \name Class Member Access Functions
 	//@{
 	uint32 GetID() const
-		{ return _id; }
+		{ return _definition->id; }
 
 	const hoa_utils::ustring& GetName() const
-		{ return _name; }
+		{ return _definition->name; }
 
 	const hoa_utils::ustring& GetDescription() const
-		{ return _description; }
+		{ return _definition->description; }
 
 	const hoa_utils::ustring& GetLore() const
-		{ return _lore; }
+		{ return _definition->lore; }
 
 	void SetCount(uint32 count)
 		{ _count = count; }
@@ -107,49 +273,21 @@ public:
 		{ return _count; }
 
 	uint32 GetPrice() const
-		{ return _price; }
+		{ return _definition->price; }
 
 	const hoa_video::StillImage& GetIconImage() const
-		{ return _icon_image; }
+		{ return _definition->icon_image; }
+
+	const GlobalObjectDefinition* GetDefinition() const
+		{ return _definition; }
 	//@}
 
 protected:
-	/** \brief An identification number for each unique item
-	*** \note An ID number of zero indicates an invalid object
-	**/
-	uint32 _id;
-
-	//! \brief The name of the object as it would be displayed on a screen
-	hoa_utils::ustring _name;
-
-	//! \brief A short description of the item to display on the screen
-	hoa_utils::ustring _description;
-
-	//! \brief A detailed description of the object's history, culture, and how it fits into the game world
-	hoa_utils::ustring _lore;
-
 	//! \brief Retains how many occurences of the object are represented by this class object instance
 	uint32 _count;
 
-	//! \brief The base price of the object for purchase/sale in the game
-	uint32 _price;
-
-	//! \brief A loaded icon image of the object at its original size of 60x60 pixels
-	hoa_video::StillImage _icon_image;
-
-	//! \brief Causes the object to become invalid due to a loading error or other significant issue
-	void _InvalidateObject()
-		{ _id = 0; }
-
-	/** \brief Reads object data from an open script file
-	*** \param script A reference to a script file that has been opened and prepared
-	***
-	*** This method does not do any of its own error case checking. Only dervied classes may call this
-	*** protected function and they are expected to have the script file successfully opened and the correct
-	*** table context prepared. This function will do nothing more but read the expected key/values of
-	*** the open table in the script file and return.
-	**/
-	void _LoadObjectData(hoa_script::ReadScriptDescriptor& script);
+	//! \brief A pointer to the shared definition of the object, owned by the GameGlobal class
+	const GlobalObjectDefinition* _definition;
 }; // class GlobalObject
 
 
@@ -169,50 +307,41 @@ public:
 	**/
 	GlobalItem(uint32 id, uint32 count = 1);
 
-	~GlobalItem();
-
-	GlobalItem(const GlobalItem& copy);
-
-	GlobalItem& operator=(const GlobalItem& copy);
+	~GlobalItem()
+		{}
 
 	GLOBAL_OBJECT GetObjectType() const
 		{ return GLOBAL_OBJECT_ITEM; }
 
 	//! \brief Returns true if the item can be used in battle
 	bool IsUsableInBattle()
-		{ return (_battle_use_function != NULL); }
+		{ return (_GetDefinition()->battle_use_function != NULL); }
 
 	//! \brief Returns true if the item can be used in the field
 	bool IsUsableInField()
-		{ return (_field_use_function != NULL); }
+		{ return (_GetDefinition()->field_use_function != NULL); }
 
 	//! \name Class Member Access Functions
 	//@{
 	GLOBAL_TARGET GetTargetType() const
-		{ return _target_type; }
+		{ return _GetDefinition()->target_type; }
 
 	/** \brief Returns a pointer to the ScriptObject of the battle use function
 	*** \note This function will return NULL if the skill is not usable in battle
 	**/
 	const ScriptObject* GetBattleUseFunction() const
-		{ return _battle_use_function; }
+		{ return _GetDefinition()->battle_use_function; }
 
 	/** \brief Returns a pointer to the ScriptObject of the field use function
 	*** \note This function will return NULL if the skill is not usable in the field
 	**/
 	const ScriptObject* GetFieldUseFunction() const
-		{ return _field_use_function; }
+		{ return _GetDefinition()->field_use_function; }
 	//@}
 
 private:
-	//! \brief The type of target for the item
-	GLOBAL_TARGET _target_type;
-
-	//! \brief A pointer to the script function that performs the item's effect while in battle
-	ScriptObject* _battle_use_function;
-
-	//! \brief A pointer to the script function that performs the item's effect while in a menu
-	ScriptObject* _field_use_function;
+	const GlobalItemDefinition* _GetDefinition() const
+		{ return static_cast<const GlobalItemDefinition*>(_definition); }
 }; // class GlobalItem : public GlobalObject
 
 
@@ -245,13 +374,13 @@ public:
 	//! \name Class Member Access Functions
 	//@{
 	uint32 GetPhysicalAttack() const
-		{ return _physical_attack; }
+		{ return _GetDefinition()->physical_attack; }
 
 	uint32 GetEtherealAttack() const
-		{ return _ethereal_attack; }
+		{ return _GetDefinition()->ethereal_attack; }
 
 	uint32 GetUsableBy() const
-		{ return _usable_by; }
+		{ return _GetDefinition()->usable_by; }
 
 	const std::vector<GlobalShard*>& GetSockets() const
 		{ return _sockets; }
@@ -261,17 +390,6 @@ public:
 	//@}
 
 private:
-	//! \brief The amount of physical damage that the weapon causes
-	uint32 _physical_attack;
-
-	//! \brief The amount of ethereal damage that the weapon causes
-	uint32 _ethereal_attack;
-
-	/** \brief A bit-mask that determines which characters can use or equip the object
-	*** See the game character ID constants in global_actors.h for more information
-	**/
-	uint32 _usable_by;
-
 	/** \brief Sockets which may be used to place shards on the weapon
 	*** Weapons may have no sockets, so it is not uncommon for the size of this vector to be zero.
 	*** When a socket is available but empty (has no attached shard), the pointer at that index
@@ -286,6 +404,9 @@ private:
 
 	// TODO: Add status effects to weapons
 	// std::map<GLOBAL_STATUS, GLOBAL_INTENSITY> _status_effects;
+
+	const GlobalWeaponDefinition* _GetDefinition() const
+		{ return static_cast<const GlobalWeaponDefinition*>(_definition); }
 }; // class GlobalWeapon : public GlobalObject
 
 
@@ -316,13 +437,13 @@ public:
 	GLOBAL_OBJECT GetObjectType() const;
 
 	uint32 GetPhysicalDefense() const
-		{ return _physical_defense; }
+		{ return _GetDefinition()->physical_defense; }
 
 	uint32 GetEtherealDefense() const
-		{ return _ethereal_defense; }
+		{ return _GetDefinition()->ethereal_defense; }
 
 	uint32 GetUsableBy() const
-		{ return _usable_by; }
+		{ return _GetDefinition()->usable_by; }
 
 	const std::vector<GlobalShard*>& GetSockets() const
 		{ return _sockets; }
@@ -331,17 +452,6 @@ public:
 		{ return _elemental_effects; }
 
 private:
-	//! \brief The amount of physical defense that the armor provides
-	uint32 _physical_defense;
-
-	//! \brief The amount of ethereal defense that the armor provides
-	uint32 _ethereal_defense;
-
-	/** \brief A bit-mask that determines which characters can use or equip the object
-	*** See the game character ID constants in global_actors.h for more information
-	**/
-	uint32 _usable_by;
-
 	/** \brief Sockets which may be used to place shards on the armor
 	*** Armor may have no sockets, so it is not uncommon for the size of this vector to be zero.
 	*** When a socket is available but empty (has no attached shard), the pointer at that index
@@ -356,6 +466,9 @@ private:
 
 	// TODO: Add status effects to weapons
 	// std::map<GLOBAL_STATUS, GLOBAL_INTENSITY> _status_effects;
+
+	const GlobalArmorDefinition* _GetDefinition() const
+		{ return static_cast<const GlobalArmorDefinition*>(_definition); }
 }; // class GlobalArmor : public GlobalObject
 
 
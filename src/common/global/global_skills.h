@@ -29,6 +29,83 @@
 
 namespace hoa_global {
 
+/** ****************************************************************************
+*** \brief The properties of a skill, shared by every GlobalSkill with the same ID
+***
+*** Like the object definitions, skill definitions are read from the skill scripts
+*** the first time that they are requested from the GameGlobal class, which retains
+*** them until the game exits. A definition with an ID of zero is the definition of
+*** a skill that could not be loaded.
+*** ***************************************************************************/
+class GlobalSkillDefinition {
+public:
+	GlobalSkillDefinition();
+
+	~GlobalSkillDefinition();
+
+	/** \brief Reads the definition from the skill's table in the script for its type of skill
+	*** \param skill_id The ID of the skill to load
+	***
+	*** All existing data of the definition is replaced. If the skill data could not be read, the ID of
+	*** the definition will be set to zero.
+	**/
+	void Load(uint32 skill_id);
+
+	//! \brief The unique identifier number of the skill, or zero if the skill is invalid
+	uint32 id;
+
+	//! \brief The name of the skill as it will be displayed on the screen.
+	hoa_utils::ustring name;
+
+	/** \brief A short description of what the skill does when executed
+	*** \note Not all defined skills have a description. For example, skills used only by enemies are
+	*** typically missing a description
+	**/
+	hoa_utils::ustring description;
+
+	//! \brief The type identifier for the skill
+	GLOBAL_SKILL type;
+
+	/** \brief The amount of skill points (SP) that the skill requires to be used
+	*** Zero is a valid value for this member and means that no skill points are required to use the
+	*** skill. Skills with this property are known as "innate skills".
+	**/
+	uint32 sp_required;
+
+	/** \brief The amount of time (in milliseconds) that must expire before a skill can be used after it is selected
+	*** When a character or enemy has selected to use the skill in a battle, this value instructs how
+	*** much time must pass before the skill may be executed. It is acceptable for this member to be zero.
+	**/
+	uint32 warmup_time;
+
+	/** \brief The type of target for the skill
+	*** Target types include attack points, actors, and parties. This enum type is defined in global_actors.h
+	**/
+	GLOBAL_TARGET target_type;
+
+	/** \brief The identifier name of the sprite animation to play when it executes the function
+	***
+	*** \note This identifier is only valid for characters who are executing the skill, as enemies are not animated
+	*** in a battle. If an enemy executes the skill, this information will be ignored. It is fine to leave the action
+	*** name undefined ("") for skills which no character is able to execute (skills specific to enemies).
+	**/
+	std::string action_name;
+
+	//! \brief A pointer to the skill's execution function for battles, or NULL if it is not executable in battle
+	ScriptObject* battle_execute_function;
+
+	//! \brief A pointer to the skill's execution function for menus, or NULL if it is not executable in menus
+	ScriptObject* field_execute_function;
+
+private:
+	GlobalSkillDefinition(const GlobalSkillDefinition& copy);
+	GlobalSkillDefinition& operator=(const GlobalSkillDefinition& copy);
+
+	//! \brief Removes all data from the definition
+	void _Clear();
+}; // class GlobalSkillDefinition
+
+
 /** ****************************************************************************
 *** \brief Represents skills that are used in the game by both characters and enemies
 ***
@@ -49,118 +126,76 @@ namespace hoa_global {
 *** Because skills are scripted and can achieve almost any possible effect, this class
 *** only retains the common properties that all skills share. For example, the skill's
 *** name, type of target, and the amount of time it takes an actor to "warmup" to use
-*** the skill.
+*** the skill. None of these properties change during the game, so they are held by a
+*** definition that is shared by every GlobalSkill object of the same ID.
 *** ***************************************************************************/
 class GlobalSkill {
 public:
 	//! \param id The identification number of the skill to construct
 	GlobalSkill(uint32 id);
 
-	~GlobalSkill();
-
-	GlobalSkill(const GlobalSkill& copy);
-
-	GlobalSkill& operator=(const GlobalSkill& copy);
+	~GlobalSkill()
+		{}
 
 	//! \brief Returns true if the skill is properly initialized and ready to be used
 	bool IsValid() const
-		{ return (_id != 0); }
+		{ return (_definition->id != 0); }
 
 	//! \brief Returns true if the skill can be executed in battles
 	bool IsExecutableInBattle() const
-		{ return (_battle_execute_function != NULL); }
+		{ return (_definition->battle_execute_function != NULL); }
 
 	//! \brief Returns true if the skill can be executed in menus
 	bool IsExecutableInField() const
-		{ return (_field_execute_function != NULL); }
+		{ return (_definition->field_execute_function != NULL); }
 
 	/** \name Class member access functions
 	*** \note No set functions are defined because the class members should only be intialized within Lua
 	**/
 	//@{
 	hoa_utils::ustring GetName() const
-		{ return _name; }
+		{ return _definition->name; }
 
 	hoa_utils::ustring GetDescription() const
-		{ return _description; }
+		{ return _definition->description; }
 
 	uint32 GetID() const
-		{ return _id; }
+		{ return _definition->id; }
 
 	GLOBAL_SKILL GetType() const
-		{ return _type; }
+		{ return _definition->type; }
 
 	uint32 GetSPRequired() const
-		{ return _sp_required; }
+		{ return _definition->sp_required; }
 
 	uint32 GetWarmupTime() const
-		{ return _warmup_time; }
+		{ return _definition->warmup_time; }
 
 	GLOBAL_TARGET GetTargetType() const
-		{ return _target_type; }
+		{ return _definition->target_type; }
 
 	const std::string& GetActionName() const
-		{ return _action_name; }
+		{ return _definition->action_name; }
 
 	/** \brief Returns a pointer to the ScriptObject of the battle execution function
 	*** \note This function will return NULL if the skill is not executable in battle
 	**/
 	const ScriptObject* GetBattleExecuteFunction() const
-		{ return _battle_execute_function; }
+		{ return _definition->battle_execute_function; }
 
 	/** \brief Returns a pointer to the ScriptObject of the menu execution function
 	*** \note This function will return NULL if the skill is not executable in menus
 	**/
 	const ScriptObject* GetFieldExecuteFunction() const
-		{ return _field_execute_function; }
+		{ return _definition->field_execute_function; }
+
+	const GlobalSkillDefinition* GetDefinition() const
+		{ return _definition; }
 	//@}
 
 private:
-	//! \brief The unique identifier number of the skill.
-	uint32 _id;
-
-	//! \brief The name of the skill as it will be displayed on the screen.
-	hoa_utils::ustring _name;
-
-	/** \brief A short description of what the skill does when executed
-	*** \note Not all defined skills have a description. For example, skills used only by enemies are
-	*** typically missing a description
-	**/
-	hoa_utils::ustring _description;
-
-	//! \brief The type identifier for the skill
-	GLOBAL_SKILL _type;
-
-	/** \brief The amount of skill points (SP) that the skill requires to be used
-	*** Zero is a valid value for this member and means that no skill points are required to use the
-	*** skill. Skills with this property are known as "innate skills".
-	**/
-	uint32 _sp_required;
-
-	/** \brief The amount of time (in milliseconds) that must expire before a skill can be used after it is selected
-	*** When a character or enemy has selected to use the skill in a battle, this value instructs how
-	*** much time must pass before the skill may be executed. It is acceptable for this member to be zero.
-	**/
-	uint32 _warmup_time;
-
-	/** \brief The type of target for the skill
-	*** Target types include attack points, actors, and parties. This enum type is defined in global_actors.h
-	**/
-	GLOBAL_TARGET _target_type;
-
-	/** \brief The identifier name of the sprite animation to play when it executes the function
-	***
-	*** \note This identifier is only valid for characters who are executing the skill, as enemies are not animated
-	*** in a battle. If an enemy executes the skill, this information will be ignored. It is fine to leave the action
-	*** name undefined ("") for skills which no character is able to execute (skills specific to enemies).
-	**/
-	std::string _action_name;
-
-	//! \brief A pointer to the skill's execution function for battles
-	ScriptObject* _battle_execute_function;
-
-	//! \brief A pointer to the skill's execution function for menus
-	ScriptObject* _field_execute_function;
+	//! \brief A pointer to the shared definition of the skill, owned by the GameGlobal class
+	const GlobalSkillDefinition* _definition;
 }; // class GlobalSkill
 
 } // namespace hoa_global
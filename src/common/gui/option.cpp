@@ -41,7 +41,8 @@ Option::~Option() {
 Option::Option(const Option& copy) :
 	disabled(copy.disabled),
 	elements(copy.elements),
-	text(copy.text)
+	text(copy.text),
+	text_widths(copy.text_widths)
 {
 	for (uint32 i = 0; i < copy.images.size(); ++i) {
 		images.push_back(new StillImage(*(copy.images[i])));
@@ -59,6 +60,7 @@ Option& Option::operator=(const Option& copy) {
 	disabled = copy.disabled;
 	elements = copy.elements;
 	text = copy.text;
+	text_widths = copy.text_widths;
 	for (uint32 i = 0; i < copy.images.size(); ++i) {
 		images.push_back(new StillImage(*(copy.images[i])));
 	}
@@ -72,6 +74,7 @@ void Option::Clear() {
 	disabled = false;
 	elements.clear();
 	text.clear();
+	text_widths.clear();
 	for (uint32 i = 0; i < images.size(); ++i) {
 		if (images[i] != NULL) {
 			delete images[i];
@@ -386,7 +389,7 @@ void OptionBox::AddOptionElementText(uint32 option_index, const ustring& text) {
 
 	new_element.type = VIDEO_OPTION_ELEMENT_TEXT;
 	new_element.value = static_cast<int32>(this_option.text.size());
-	this_option.text.push_back(text);
+	_AddOptionText(this_option, text);
 	this_option.elements.push_back(new_element);
 }
 
@@ -754,7 +757,17 @@ void OptionBox::SetTextStyle(const TextStyle& style) {
 		return;
 	}
 
+	// The widths of all text must be recalculated if the font has changed
+	bool font_changed = (_text_style.font != style.font);
 	_text_style = style;
+	if (font_changed == true) {
+		for (uint32 i = 0; i < _options.size(); ++i) {
+			Option& op = _options[i];
+			for (uint32 j = 0; j < op.text.size(); ++j) {
+				op.text_widths[j] = TextManager->CalculateTextWidth(_text_style.font, op.text[j]);
+			}
+		}
+	}
 	_initialized = IsInitialized(_initialization_errors);
 }
 
@@ -867,11 +880,11 @@ bool OptionBox::_ConstructOption(const ustring& format_string, Option& op) {
 			size_t tag_begin = tmp.find(OPEN_TAG);
 
 			if (tag_begin == ustring::npos) { // There are no more tags remaining, so extract the entire string
-				op.text.push_back(tmp);
+				_AddOptionText(op, tmp);
 				tmp.clear();
 			}
 			else { // Another tag remains to be processed, so extract the text substring
-				op.text.push_back(tmp.substr(0, tag_begin));
+				_AddOptionText(op, tmp.substr(0, tag_begin));
 				tmp = tmp.substr(tag_begin, tmp.length() - tag_begin);
 			}
 		}
@@ -884,6 +897,13 @@ bool OptionBox::_ConstructOption(const ustring& format_string, Option& op) {
 
 
 
+void OptionBox::_AddOptionText(Option& op, const ustring& text) {
+	op.text.push_back(text);
+	op.text_widths.push_back(TextManager->CalculateTextWidth(_text_style.font, text));
+}
+
+
+
 bool OptionBox::_ChangeSelection(int32 offset, bool horizontal) {
 	// Do nothing if the movement is horizontal and there is only one column with no horizontal wrap shifting
 	if ((horizontal == true) && (_number_cell_columns == 1) &&( _horizontal_wrap_mode != VIDEO_WRAP_MODE_SHIFTED))
@@ -1178,7 +1198,7 @@ void OptionBox::_DrawOption(const Option& op, const OptionCellBounds &bounds, fl
 
 				if (text_index >= 0 && text_index < static_cast<int32>(op.text.size())) {
 					const ustring& text = op.text[text_index];
-					float width = static_cast<float>(VideoManager->Text()->CalculateTextWidth(_text_style.font, text));
+					float width = static_cast<float>(op.text_widths[text_index]);
 					float edge = x - bounds.x_left; // edge value for VIDEO_X_LEFT
 
 					if (xalign == VIDEO_X_CENTER)
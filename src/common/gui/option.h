@@ -220,6 +220,11 @@ public:
 	//! \brief Contains all pieces of text for this option
 	std::vector<hoa_utils::ustring> text;
 
+	/** \brief The width of each piece of text, in the font of the option box which holds this option
+	*** These are calculated when the text is added and whenever the font changes, so that the text does not need to be measured when drawn
+	**/
+	std::vector<int32> text_widths;
+
 	//! \brief Contains all images used for this option
 	std::vector<hoa_video::StillImage*> images;
 }; // class Option
@@ -607,6 +612,12 @@ private:
 	**/
 	bool _ConstructOption(const hoa_utils::ustring &format_string, private_gui::Option &option);
 
+	/** \brief Adds a piece of text to an option and records its width in the current font
+	*** \param op The option to add the text to
+	*** \param text The text to add
+	**/
+	void _AddOptionText(private_gui::Option& op, const hoa_utils::ustring& text);
+
 	/** \brief Changes the selected option by making a movement relative to the current selection
 	*** \param offset The amount to move in specified direction (ie 1 row up, 1 column right, etc.)
 	*** \param horizontal true if moving horizontally, false if moving vertically
@@ -64,6 +64,7 @@ void TextBox::ClearText() {
 	_finished = true;
 	_num_chars = 0;
 	_text.clear();
+	_char_offsets.clear();
 	_text_save.clear();
 }
 
@@ -300,6 +301,7 @@ void TextBox::_ReformatText() {
 	ustring temp_str = _text_save;
 	const size_t temp_length = temp_str.length();
 	_text.clear();
+	_char_offsets.clear();
 	_num_chars = 0;
 
 	// If font not set, return (leave _text vector empty)
@@ -318,7 +320,7 @@ void TextBox::_ReformatText() {
 		}
 		// Otherwise, add the new line segment and proceed to find the next
 		else {
-			_AddLine(temp_str.substr(start_pos, temp_length - newline_pos));
+			_AddLine(temp_str.substr(start_pos, newline_pos - start_pos));
 			start_pos = newline_pos + 1;
 		}
 	}
@@ -367,67 +369,66 @@ int32 TextBox::CalculateTextHeight() {
 
 
 void TextBox::_AddLine(const ustring& line) {
-	// perform word wrapping in a loop until all the text is added
+	const int32 line_length = static_cast<int32>(line.length());
 
-	ustring temp_line = line;
-
-	while (temp_line.empty() == false) {
-		int32 text_width = TextManager->CalculateTextWidth(_text_style.font, line);
+	// An empty line is kept so that blank lines in the text are preserved
+	if (line_length == 0) {
+		_text.push_back(line);
+		_char_offsets.push_back(vector<int32>(1, 0));
+		return;
+	}
 
-		// If the text can fit in the text box, add the whole line and return
-		if (text_width < _width) {
-			_text.push_back(temp_line);
-			_num_chars += static_cast<int32>(temp_line.size());
-			return;
-		}
+	// Measure each character only once: offsets[i] holds the width of the first i characters of the line
+	vector<int32> offsets(line_length + 1, 0);
+	for (int32 i = 0; i < line_length; ++i) {
+		offsets[i + 1] = offsets[i] + TextManager->CalculateCharacterAdvance(_font_properties, line[i]);
+	}
 
-		// Otherwise, find the maximum number of words which can fit and make that substring a line
-		// Word boundaries are found by calling the _IsCharacterBreakable() method
-		ustring wrapped_line;
-		int32 num_wrapped_chars = 0;
-		int32 last_breakable_index = -1;
-		int32 line_length = static_cast<int32>(temp_line.length());
+	// Perform word wrapping in a loop until all the text is added. Each pass adds the characters in [line_start, line_end).
+	int32 line_start = 0;
+	while (line_start < line_length) {
+		int32 line_end = line_length;
 
-		while (num_wrapped_chars < line_length) {
-			wrapped_line += temp_line[num_wrapped_chars];
+		// If the remaining text does not fit in the text box, find the maximum number of words which can fit
+		// Word boundaries are found by calling the _IsBreakableChar() method
+		if (offsets[line_length] - offsets[line_start] >= _width) {
+			int32 last_breakable_index = -1;
+			bool exceeded_width = false;
 
-			if (_IsBreakableChar(temp_line[num_wrapped_chars])) {
-				int32 text_width = TextManager->CalculateTextWidth(_text_style.font, wrapped_line);
+			for (int32 i = line_start; i < line_length; ++i) {
+				if (_IsBreakableChar(line[i]) == false)
+					continue;
 
-				if (text_width < _width) {
+				if (offsets[i + 1] - offsets[line_start] < _width) {
 					// We haven't gone past the breaking point: mark this as a possible breaking point
-					last_breakable_index = num_wrapped_chars;
+					last_breakable_index = i;
 				}
 				else {
 					// We exceeded the maximum width, so go back to the previous breaking point.
-					// If there was no previous breaking point (== -1), then just break it off at
-					// the current character position.
-					if (last_breakable_index != -1)
-						num_wrapped_chars = last_breakable_index;
+					// If there was no previous breaking point, then just break it off at the current character position.
+					line_end = (last_breakable_index != -1) ? last_breakable_index : i;
+					exceeded_width = true;
 					break;
 				}
-			} // (_IsBreakableChar(temp_line[num_wrapped_chars]))
-			++num_wrapped_chars;
-		} // while (num_wrapped_chars < line_length)
-
-		// Figure out the number of characters in the wrapped line and construct the wrapped line
-		text_width = TextManager->CalculateTextWidth(_text_style.font, wrapped_line);
-		if (text_width >= _width && last_breakable_index != -1) {
-			num_wrapped_chars = last_breakable_index;
+			}
+
+			// The last word is too long to fit, so break the line before it
+			if (exceeded_width == false && last_breakable_index != -1)
+				line_end = last_breakable_index;
+		}
+
+		// Add the new wrapped line to the text along with the position of each of its characters
+		_text.push_back(line.substr(line_start, line_end - line_start));
+		_char_offsets.push_back(vector<int32>(offsets.begin() + line_start, offsets.begin() + line_end + 1));
+		vector<int32>& line_offsets = _char_offsets.back();
+		for (uint32 i = 0; i < line_offsets.size(); ++i) {
+			line_offsets[i] -= offsets[line_start];
 		}
-		wrapped_line = temp_line.substr(0, num_wrapped_chars);
-
-		// Add the new wrapped line to the text.
-		_text.push_back(wrapped_line);
-		_num_chars += static_cast<int32>(wrapped_line.size());
-
-		// If there is no more text remaining, we are finished.
-		if (num_wrapped_chars == line_length)
-			return;
-		// Otherwise, we need to grab the rest of the text that remains to be added and loop again
-		else
-			temp_line = temp_line.substr(num_wrapped_chars + 1, line_length - num_wrapped_chars);
-	} // while (temp_line.empty() == false)
+		_num_chars += line_end - line_start;
+
+		// The breakable character that the line was wrapped at is not carried over to the start of the next line
+		line_start = line_end + 1;
+	} // while (line_start < line_length)
 } // void TextBox::_AddLine(const ustring& line)
 
 
@@ -459,7 +460,8 @@ void TextBox::_DrawTextLines(float text_x, float text_y, ScreenRect scissor_rect
 	// Iterate through the loop for every line of text and draw it
 	for (int32 line = 0; line < static_cast<int32>(_text.size()); ++line) {
 		// (1): Calculate the x draw offset for this line and move to that position
-		float line_width = static_cast<float>(TextManager->CalculateTextWidth(_text_style.font, _text[line]));
+		const vector<int32>& offsets = _char_offsets[line];
+		float line_width = static_cast<float>(offsets.back());
 		int32 x_align = VideoManager->_ConvertXAlign(_text_xalign);
 		float x_offset = text_x + ((x_align + 1) * line_width) * 0.5f * VideoManager->_current_context.coordinate_system.GetHorizontalDirection();
 
@@ -468,7 +470,11 @@ void TextBox::_DrawTextLines(float text_x, float text_y, ScreenRect scissor_rect
 		int32 line_size = static_cast<int32>(_text[line].size());
 
 		// (2): Draw the text depending on the display mode and whether or not the gradual display is finished
-		if (_finished || _mode == VIDEO_TEXT_INSTANT) {
+		if (line_size == 0) {
+			// Blank lines have nothing to draw
+		}
+
+		else if (_finished || _mode == VIDEO_TEXT_INSTANT) {
 			TextManager->Draw(_text[line], _text_style);
 		}
 
@@ -518,7 +524,7 @@ void TextBox::_DrawTextLines(float text_x, float text_y, ScreenRect scissor_rect
 					Color old_color = _text_style.color;
 					_text_style.color[3] *= cur_percent;
 
-					VideoManager->MoveRelative(static_cast<float>(TextManager->CalculateTextWidth(_text_style.font, substring)), 0.0f);
+					VideoManager->MoveRelative(static_cast<float>(offsets[num_completed_chars]), 0.0f);
 					TextManager->Draw(_text[line].substr(num_completed_chars, 1), _text_style);
 					_text_style.color = old_color;
 				}
@@ -572,7 +578,7 @@ void TextBox::_DrawTextLines(float text_x, float text_y, ScreenRect scissor_rect
 				// Create a rectangle for the current character, in window coordinates
 				int32 char_x, char_y, char_w, char_h;
 				char_x = static_cast<int32>(x_offset + VideoManager->_current_context.coordinate_system.GetHorizontalDirection()
-					* TextManager->CalculateTextWidth(_text_style.font, substring));
+					* offsets[num_completed_chars]);
 				char_y = static_cast<int32>(text_y - VideoManager->_current_context.coordinate_system.GetVerticalDirection()
 					* (_font_properties->height + _font_properties->descent));
 
@@ -582,13 +588,13 @@ void TextBox::_DrawTextLines(float text_x, float text_y, ScreenRect scissor_rect
 				if (VideoManager->_current_context.coordinate_system.GetVerticalDirection() < 0.0f)
 					char_x = static_cast<int32>(VideoManager->_current_context.coordinate_system.GetLeft()) - char_x;
 
-				char_w = TextManager->CalculateTextWidth(_text_style.font, cur_char_string);
+				char_w = offsets[num_completed_chars + 1] - offsets[num_completed_chars];
 				char_h = _font_properties->height;
 
 				// Multiply the width by percentage done to determine the scissoring dimensions
 				char_w = static_cast<int32>(cur_percent * char_w);
 				VideoManager->MoveRelative(VideoManager->_current_context.coordinate_system.GetHorizontalDirection()
-					* TextManager->CalculateTextWidth(_text_style.font, substring), 0.0f);
+					* offsets[num_completed_chars], 0.0f);
 
 				// Construct the scissor rectangle using the character dimensions and draw the revealing character
 				VideoManager->PushState();
@@ -233,6 +233,12 @@ private:
 	//! \brief An array of wide strings, one for each line of text.
 	std::vector<hoa_utils::ustring> _text;
 
+	/** \brief The horizontal position of every character in each line of text, relative to the start of the line
+	*** Each line has one more entry than it has characters, the last of which is the width of the entire line.
+	*** These are calculated whenever the text is reformatted, so that drawing the text never needs to measure it.
+	**/
+	std::vector<std::vector<int32> > _char_offsets;
+
 	//! \brief The unedited text for reformatting
 	hoa_utils::ustring _text_save;
 
@@ -247,7 +253,8 @@ private:
 	/** \brief Adds a new line of text to the _text vector.
 	*** \param line The unicode text string to add as a new line
 	*** If the line is too long to fit in the width of the textbox, it will automatically
-	*** be split into multiple lines through word wrapping.
+	*** be split into multiple lines through word wrapping. Each character of the line is
+	*** only measured once, so the time taken grows linearly with the length of the line.
 	**/
 	void _AddLine(const hoa_utils::ustring &line);
 
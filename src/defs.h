@@ -82,6 +82,9 @@ namespace hoa_video {
 	class AnimatedImage;
 	class CompositeImage;
 
+	class StaticSpriteBatch;
+	class ImageLoadBatch;
+
 	class TextureController;
 
 	class TextSupervisor;
@@ -103,9 +106,15 @@ namespace hoa_video {
 		class FixedTexSheet;
 		class VariableTexSheet;
 		class FixedTexNode;
-		class VariableTexNode;
+		class VariableTexRect;
+		class AtlasTexSheet;
+		class GlyphTexSheet;
+		class AtlasCache;
+		class AtlasCacheEntry;
 
 		class ImageMemory;
+		class ImageDecodeJob;
+		class ImageDecoder;
 
 		class BaseTexture;
 		class ImageTexture;
@@ -117,13 +126,23 @@ namespace hoa_video {
 		class ParticleManager;
 		class ParticleSystem;
 		class ParticleSystemDef;
-		class Particle;
+		class ParticleUpdateJob;
+		class ParticleUpdatePool;
+		class ParticleArray;
 		class ParticleVertex;
 		class ParticleTexCoord;
+		class ParticleTexCoordArray;
+		class ParticleRandom;
 		class ParticleKeyframe;
 
+		class ScreenCapture;
+		class ScreenCaptureJob;
 		class ScreenFader;
 		class ShakeForce;
+
+		class BatchVertex;
+		class SpriteBatch;
+		class StaticSpriteRun;
 	}
 }
 
@@ -290,14 +309,16 @@ namespace hoa_map {
 	class MapMode;
 
 	namespace private_map {
+		class MapData;
+		class MapPreload;
 		class TileSupervisor;
-		class MapTile;
 
 		class MapRectangle;
 		class MapFrame;
 		class PathNode;
 
 		class ObjectSupervisor;
+		class ObjectGrid;
 		class MapObject;
 		class PhysicalObject;
 		class TreasureObject;
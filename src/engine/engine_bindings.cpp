@@ -338,6 +338,10 @@ void BindEngineCode() {
 			.def("DrawOverlays", &VideoEngine::DrawOverlays)
 			.def("AddParticleEffect", &VideoEngine::AddParticleEffect)
 			.def("StopAllParticleEffects", &VideoEngine::StopAllParticleEffects)
+			.def("StartCaptureSequence", &VideoEngine::StartCaptureSequence)
+			.def("StopCaptureSequence", &VideoEngine::StopCaptureSequence)
+			.def("IsCapturingSequence", &VideoEngine::IsCapturingSequence)
+			.def("FinishScreenCaptures", &VideoEngine::FinishScreenCaptures)
 
 			// Namespace constants
 			.enum_("constants") [
@@ -336,7 +336,9 @@ void InputEngine::_KeyEventHandler(SDL_KeyboardEvent& key_event) {
 						break;
 					i++;
 				}
+				// The file is written in the background, so the next screenshot must not rely on it existing yet
 				VideoManager->MakeScreenshot(path);
+				i++;
 				return;
 			}
 			else if (key_event.keysym.sym == SDLK_t) {
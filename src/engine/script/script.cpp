@@ -17,6 +17,9 @@
 
 #include <iostream>
 #include <stdarg.h>
+#include <sys/stat.h>
+
+#include <SDL2/SDL_timer.h>
 
 #include "script.h"
 
@@ -33,11 +36,39 @@ namespace hoa_script {
 ScriptEngine* ScriptManager = NULL;
 bool SCRIPT_DEBUG = false;
 
+namespace private_script {
+
+//! \brief Returns the amount of memory in use by a Lua state, in bytes
+uint32 GetLuaMemoryUsage(lua_State* state) {
+	return static_cast<uint32>(lua_gc(state, LUA_GCCOUNT, 0)) * 1024 + static_cast<uint32>(lua_gc(state, LUA_GCCOUNTB, 0));
+}
+
+/** \brief Returns the low 32 bits of the high resolution performance counter
+*** Only the difference between two values is meaningful, which remains correct across a wrap of the counter for any
+*** interval shorter than 2^32 counts (several seconds at the highest counter frequencies).
+**/
+uint32 GetPerformanceCount() {
+	return static_cast<uint32>(SDL_GetPerformanceCounter());
+}
+
+//! \brief Returns the number of milliseconds that have passed since a value returned by GetPerformanceCount()
+float GetElapsedMilliseconds(uint32 start) {
+	return static_cast<float>(GetPerformanceCount() - start) * 1000.0f / static_cast<float>(SDL_GetPerformanceFrequency());
+}
+
+} // namespace private_script
+
 //-----------------------------------------------------------------------------
 // ScriptEngine Class Functions
 //-----------------------------------------------------------------------------
 
-ScriptEngine::ScriptEngine() {
+ScriptEngine::ScriptEngine() :
+	_script_cache_memory(0),
+	_script_cache_size(DEFAULT_SCRIPT_CACHE_SIZE),
+	_script_cache_hits(0),
+	_script_cache_misses(0),
+	_script_cache_time_saved(0.0f)
+{
 	IF_PRINT_DEBUG(SCRIPT_DEBUG) << "ScriptEngine constructor invoked." << endl;
 
 	// Initialize Lua and LuaBind
@@ -51,7 +82,11 @@ ScriptEngine::ScriptEngine() {
 ScriptEngine::~ScriptEngine() {
 	IF_PRINT_DEBUG(SCRIPT_DEBUG) << "ScriptEngine destructor invoked." << endl;
 
+	if (SCRIPT_DEBUG == true)
+		PrintScriptCacheStatistics();
+
 	_open_files.clear();
+	ClearScriptCache();
 	lua_close(_global_state);
 	_global_state = NULL;
 }
@@ -122,16 +157,54 @@ void ScriptEngine::HandleCastError(luabind::cast_failed& err) {
 
 
 
+void ScriptEngine::InvalidateCachedScript(const string& filename) {
+	map<string, CachedScript>::iterator script = _script_cache.find(filename);
+	if (script != _script_cache.end())
+		_RemoveCachedScript(script);
+}
+
+
+
+void ScriptEngine::ClearScriptCache() {
+	while (_script_cache.empty() == false) {
+		_RemoveCachedScript(_script_cache.begin());
+	}
+}
+
+
+
+void ScriptEngine::EnableEnvironmentReuse(const string& directory) {
+	for (uint32 i = 0; i < _reused_environment_directories.size(); i++) {
+		if (_reused_environment_directories[i] == directory)
+			return;
+	}
+
+	_reused_environment_directories.push_back(directory);
+}
+
+
+
+void ScriptEngine::SetScriptCacheSize(uint32 size) {
+	_script_cache_size = size;
+	_TrimScriptCache();
+}
+
+
+
+void ScriptEngine::PrintScriptCacheStatistics() const {
+	uint32 total_opens = _script_cache_hits + _script_cache_misses;
+	float hit_rate = (total_opens == 0) ? 0.0f : 100.0f * static_cast<float>(_script_cache_hits) / static_cast<float>(total_opens);
+
+	cout << "Script cache: " << _script_cache.size() << " files, " << _script_cache_memory / 1024 << " KB of "
+		<< _script_cache_size / 1024 << " KB, " << _script_cache_hits << " hits, " << _script_cache_misses << " misses ("
+		<< hit_rate << "% hit rate), " << _script_cache_time_saved << " ms saved" << endl;
+}
+
+
+
 void ScriptEngine::_AddOpenFile(ScriptDescriptor* sd) {
 	// NOTE: This function assumes that the file is not already open
-
 	_open_files.insert(make_pair(sd->_filename, sd));
-	// Add the lua_State to the list of opened lua states if it is not already present
-	if (sd->GetAccessMode() == SCRIPT_READ || sd->GetAccessMode() == SCRIPT_MODIFY) {
-		ReadScriptDescriptor* rsd = dynamic_cast<ReadScriptDescriptor*>(sd);
-		if (_open_threads.find(rsd->GetFilename()) == _open_threads.end())
-			_open_threads[rsd->GetFilename()] = rsd->_lstack;
-	}
 }
 
 
@@ -143,13 +216,123 @@ void ScriptEngine::_RemoveOpenFile(ScriptDescriptor* sd) {
 
 
 
-lua_State *ScriptEngine::_CheckForPreviousLuaState(const std::string &filename) {
-	return NULL; // TEMP, see todo notes in script.h
+bool ScriptEngine::_ExecuteFile(lua_State* thread, const string& filename, bool reuse_environment) {
+	// ---------- (1) Discard the cached copy of the file if the file has changed since it was compiled
+	struct stat file_info;
+	bool file_found = (stat(filename.c_str(), &file_info) == 0);
+	uint32 file_size = file_found ? static_cast<uint32>(file_info.st_size) : 0;
+	uint32 modify_time = file_found ? static_cast<uint32>(file_info.st_mtime) : 0;
+
+	map<string, CachedScript>::iterator script = _script_cache.find(filename);
+	if (script != _script_cache.end() && (script->second.file_size != file_size || script->second.modify_time != modify_time)) {
+		_RemoveCachedScript(script);
+		script = _script_cache.end();
+	}
+
+	if (reuse_environment == true) {
+		reuse_environment = false;
+		for (uint32 i = 0; i < _reused_environment_directories.size(); i++) {
+			if (filename.compare(0, _reused_environment_directories[i].size(), _reused_environment_directories[i]) == 0) {
+				reuse_environment = true;
+				break;
+			}
+		}
+	}
+
+	// The tablespace name is determined the same way that ReadScriptDescriptor::OpenTablespace() does
+	string::size_type name_start = filename.find_last_of("/") + 1;
+	string tablespace = filename.substr(name_start, filename.find(".", name_start) - name_start);
+
+	// ---------- (2) Push the compiled chunk of the file onto the thread's stack, compiling it if it is not cached
+	if (script != _script_cache.end()) {
+		_script_cache_hits++;
+		_script_cache_time_saved += script->second.load_time;
+		_script_cache_usage.splice(_script_cache_usage.begin(), _script_cache_usage, script->second.usage_position);
+
+		// Restoring a kept environment requires no execution at all
+		if (reuse_environment == true && script->second.tablespace_reference != LUA_NOREF) {
+			_script_cache_time_saved += script->second.execute_time;
+			lua_rawgeti(thread, LUA_REGISTRYINDEX, script->second.tablespace_reference);
+			lua_setglobal(thread, tablespace.c_str());
+			return true;
+		}
+
+		lua_rawgeti(thread, LUA_REGISTRYINDEX, script->second.chunk_reference);
+	}
+	else {
+		_script_cache_misses++;
+
+		uint32 start_memory = GetLuaMemoryUsage(thread);
+		uint32 start_time = GetPerformanceCount();
+		if (luaL_loadfile(thread, filename.c_str()) != 0) {
+			return false;
+		}
+
+		// Files that could not be found by stat() can not be checked for changes, so they are never cached
+		if (file_found == true && _script_cache_size > 0) {
+			CachedScript& new_script = _script_cache[filename];
+			new_script.file_size = file_size;
+			new_script.modify_time = modify_time;
+			new_script.load_time = GetElapsedMilliseconds(start_time);
+			// Garbage collection may run while the file is compiling, so the size of the file is used when no growth was measured
+			uint32 end_memory = GetLuaMemoryUsage(thread);
+			new_script.chunk_memory = (end_memory > start_memory) ? end_memory - start_memory : file_size;
+
+			lua_pushvalue(thread, STACK_TOP);
+			new_script.chunk_reference = luaL_ref(thread, LUA_REGISTRYINDEX);
+
+			_script_cache_usage.push_front(filename);
+			new_script.usage_position = _script_cache_usage.begin();
+			_script_cache_memory += new_script.chunk_memory;
+			script = _script_cache.find(filename);
+		}
+	}
+
+	// ---------- (3) Execute the chunk, keeping the resulting tablespace if the file's environment is to be reused
+	// Files may change the environment of their own chunk with setfenv(), so it is restored to the global table first
+	lua_pushvalue(thread, LUA_GLOBALSINDEX);
+	lua_setfenv(thread, STACK_TOP - 1);
 
-	if (_open_threads.find(filename) != _open_threads.end())
-		return _open_threads[filename];
-	else
-		return NULL;
+	uint32 start_memory = GetLuaMemoryUsage(thread);
+	uint32 start_time = GetPerformanceCount();
+	if (lua_pcall(thread, 0, 0, 0) != 0) {
+		return false;
+	}
+
+	if (script != _script_cache.end() && reuse_environment == true && script->second.tablespace_reference == LUA_NOREF) {
+		lua_getglobal(thread, tablespace.c_str());
+		if (lua_istable(thread, STACK_TOP)) {
+			script->second.execute_time = GetElapsedMilliseconds(start_time);
+			uint32 end_memory = GetLuaMemoryUsage(thread);
+			script->second.environment_memory = (end_memory > start_memory) ? end_memory - start_memory : 0;
+			script->second.tablespace_reference = luaL_ref(thread, LUA_REGISTRYINDEX);
+			_script_cache_memory += script->second.environment_memory;
+		}
+		else {
+			lua_pop(thread, 1);
+		}
+	}
+
+	_TrimScriptCache();
+	return true;
+} // bool ScriptEngine::_ExecuteFile(lua_State* thread, const string& filename, bool reuse_environment)
+
+
+
+void ScriptEngine::_RemoveCachedScript(map<string, CachedScript>::iterator script) {
+	luaL_unref(_global_state, LUA_REGISTRYINDEX, script->second.chunk_reference);
+	luaL_unref(_global_state, LUA_REGISTRYINDEX, script->second.tablespace_reference);
+	_script_cache_memory -= script->second.chunk_memory + script->second.environment_memory;
+	_script_cache_usage.erase(script->second.usage_position);
+	_script_cache.erase(script);
+}
+
+
+
+void ScriptEngine::_TrimScriptCache() {
+	while (_script_cache_memory > _script_cache_size && _script_cache_usage.empty() == false) {
+		_RemoveCachedScript(_script_cache.find(_script_cache_usage.back()));
+	}
 }
 
 
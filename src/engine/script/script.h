@@ -83,6 +83,42 @@ const int32 STACK_TOP = -1;
 //! \brief Used to represent the end of a Lua table that is being iterated
 const luabind::iterator TABLE_END;
 
+//! \brief The default limit on the amount of memory held by the script cache, in bytes
+const uint32 DEFAULT_SCRIPT_CACHE_SIZE = 16 * 1024 * 1024;
+
+/** ****************************************************************************
+*** \brief A script file that has been compiled and is held in the script cache
+***
+*** The compiled chunk of the file is kept in the Lua registry so that it may be
+*** executed again without parsing the file. When environment reuse is enabled
+*** for the file, the table that the file's tablespace held after it was last
+*** executed is also kept, so that the file does not need to be executed again.
+*** ***************************************************************************/
+class CachedScript {
+public:
+	CachedScript() :
+		file_size(0), modify_time(0), chunk_reference(LUA_NOREF), tablespace_reference(LUA_NOREF),
+		chunk_memory(0), environment_memory(0), load_time(0.0f), execute_time(0.0f) {}
+
+	//! \brief The size and modification time of the file when it was compiled
+	uint32 file_size, modify_time;
+
+	//! \brief A reference in the Lua registry to the compiled chunk of the file
+	int32 chunk_reference;
+
+	//! \brief A reference in the Lua registry to the file's tablespace table, or LUA_NOREF if its environment is not kept
+	int32 tablespace_reference;
+
+	//! \brief The approximate amount of memory held by the compiled chunk and the kept tablespace, in bytes
+	uint32 chunk_memory, environment_memory;
+
+	//! \brief The time taken to compile the file and to execute it, in milliseconds
+	float load_time, execute_time;
+
+	//! \brief The position of the file in the script engine's list of the most recently used files
+	std::list<std::string>::iterator usage_position;
+}; // class CachedScript
+
 } // namespace private_script
 
 /** ****************************************************************************
@@ -90,9 +126,14 @@ const luabind::iterator TABLE_END;
 ***
 *** This class is an abstract class for representing a Lua script file. Files
 *** with a .lua extension are human-readable, uncompiled Lua text files and
-*** files with a .hoa extension are compiled script files.
+*** files with a .hoa extension are compiled script files. The compiled form of
+*** a file is named after its source file with .hoa appended (for example,
+*** "items.lua.hoa"), and is produced for every shipped script by the
+*** compile-lua build target.
 ***
-*** \note Compiled Lua files exhibit faster performance than uncompile files.
+*** \note Compiled Lua files exhibit faster performance than uncompile files. When
+*** reading a file, the compiled form is opened in its place unless the source file
+*** was modified after it was compiled or script debugging is enabled.
 *** ***************************************************************************/
 class ScriptDescriptor {
 	friend class ScriptEngine;
@@ -247,20 +288,86 @@ public:
 	**/
 	void HandleCastError(luabind::cast_failed& err);
 
+	/** \name Script Cache Methods
+	*** \brief Control the cache of compiled script files
+	***
+	*** Every file opened for reading or modification is compiled once and kept in the cache, so that
+	*** opening it again only needs to execute the compiled chunk. A cached file is recompiled whenever
+	*** its size or modification time changes. When the memory held by the cache exceeds its limit, the
+	*** least recently opened files are removed first.
+	***
+	*** Files may also have their environment reused, where the tablespace table produced by executing
+	*** the file is kept and restored when the file is opened again instead of executing it. This is
+	*** only correct for files that keep all of their data inside their tablespace table, whose execution
+	*** does not depend on any other state, and whose tables are never modified once they are loaded.
+	**/
+	//@{
+	/** \brief Removes a file from the cache so that it is parsed and executed the next time that it is opened
+	*** \param filename The name of the file, including its extension
+	**/
+	void InvalidateCachedScript(const std::string& filename);
+
+	//! \brief Removes every file from the cache
+	void ClearScriptCache();
+
+	/** \brief Enables environment reuse for all files in a directory
+	*** \param directory The path of the directory, such as "lua/data/tilesets/". Files in its subdirectories are included.
+	**/
+	void EnableEnvironmentReuse(const std::string& directory);
+
+	/** \brief Sets the limit on the amount of memory held by the cache, removing files as needed to meet it
+	*** \param size The limit in bytes. A limit of zero disables the cache.
+	**/
+	void SetScriptCacheSize(uint32 size);
+
+	//! \brief Prints the cache statistics to standard output
+	void PrintScriptCacheStatistics() const;
+
+	//! \brief Resets the cache hit and miss counters and the time saved to zero
+	void ResetScriptCacheStatistics()
+		{ _script_cache_hits = 0; _script_cache_misses = 0; _script_cache_time_saved = 0.0f; }
+
+	uint32 GetScriptCacheSize() const
+		{ return _script_cache_size; }
+
+	uint32 GetScriptCacheHits() const
+		{ return _script_cache_hits; }
+
+	uint32 GetScriptCacheMisses() const
+		{ return _script_cache_misses; }
+
+	//! \brief Returns the total time that opening cached files avoided spending on parsing and execution, in milliseconds
+	float GetScriptCacheTimeSaved() const
+		{ return _script_cache_time_saved; }
+
+	//! \brief Returns the approximate amount of memory held by the cache, in bytes
+	uint32 GetScriptCacheMemory() const
+		{ return _script_cache_memory; }
+	//@}
+
 private:
 	ScriptEngine();
 
 	//! \brief Maintains a list of all script files that are currently open
 	std::map<std::string, ScriptDescriptor*> _open_files;
 
-	// TODO: not re-opening Lua files introduces serious problems (invalid data being read) and conflicts when
-	// two files share the same variable name are opened in succession. I believe this "feature" should be
-	// removed, but I'm leaving it here for now until we understand the situation completely.
-	/** \brief Maintains a cache of opened lua threads
-	*** This is done so that a file that has already been loaded into the lua state will not be loaded again.
-	*** Instead the lua_thread will be returned.
-	**/
-	std::map<std::string, lua_State*> _open_threads;
+	//! \brief The compiled script files held by the cache, indexed by filename
+	std::map<std::string, private_script::CachedScript> _script_cache;
+
+	//! \brief The names of the cached files ordered from most to least recently opened
+	std::list<std::string> _script_cache_usage;
+
+	//! \brief The approximate amount of memory held by the cache, and the limit on that amount, in bytes
+	uint32 _script_cache_memory, _script_cache_size;
+
+	//! \brief The directories whose files have their environment reused
+	std::vector<std::string> _reused_environment_directories;
+
+	//! \brief The number of times that a file was opened and was or was not found in the cache
+	uint32 _script_cache_hits, _script_cache_misses;
+
+	//! \brief The total time that opening cached files avoided spending on parsing and execution, in milliseconds
+	float _script_cache_time_saved;
 
 	//! \brief The lua state shared globally by all files
 	lua_State* _global_state;
@@ -271,14 +378,19 @@ private:
 	//! \brief Removes an open file from the list of open files
 	void _RemoveOpenFile(ScriptDescriptor* sd);
 
-	// TODO: related to the to-do note above. I don't think this function should be used. For now it
-	// always returns NULL.
-	/** \brief Checks for the existence of a previously opened lua state from that filename.
-	*** This should class because the filename contains the full path
-	***
-	*** \return A pointer to the lua_State for the file, or NULL if the file has never been opened.
+	/** \brief Executes a script file on a Lua thread, using the cache to avoid parsing it where possible
+	*** \param thread The thread to execute the file on
+	*** \param filename The name of the file, including its extension
+	*** \param reuse_environment If true, the file's environment is reused if it is enabled for the file's directory
+	*** \return False if the file could not be loaded or executed, in which case the error message is left on top of the thread's stack
 	**/
-	lua_State* _CheckForPreviousLuaState(const std::string &filename);
+	bool _ExecuteFile(lua_State* thread, const std::string& filename, bool reuse_environment);
+
+	//! \brief Removes a file from the cache and releases its references in the Lua registry
+	void _RemoveCachedScript(std::map<std::string, private_script::CachedScript>::iterator script);
+
+	//! \brief Removes the least recently opened files from the cache until its memory limit is met
+	void _TrimScriptCache();
 }; // class ScriptEngine : public hoa_utils::Singleton<ScriptEngine>
 
 } // namespace hoa_script
@@ -53,20 +53,16 @@ bool ModifyScriptDescriptor::OpenFile(const std::string& file_name) {
 		return false;
 	}
 
-	// Check if this file was opened previously.
-	if ((this->_lstack = ScriptManager->_CheckForPreviousLuaState(file_name)) == NULL)
-	{
-		// Increases the global stack size by 1 element. That is needed because the new thread will be pushed in the
-		// stack and we have to be sure there is enough space there.
-		lua_checkstack(ScriptManager->GetGlobalState(),1);
-		_lstack = lua_newthread(ScriptManager->GetGlobalState());
-
-		// Attempt to load and execute the Lua file.
-		if (luaL_loadfile(_lstack, file_name.c_str()) != 0 || lua_pcall(_lstack, 0, 0, 0)) {
-			cerr << "SCRIPT ERROR: ModifyScriptDescriptor::OpenFile() could not open the file " << file_name << endl;
-			_access_mode = SCRIPT_CLOSED;
-			return false;
-		}
+	// Increases the global stack size by 1 element. That is needed because the new thread will be pushed in the
+	// stack and we have to be sure there is enough space there.
+	lua_checkstack(ScriptManager->GetGlobalState(),1);
+	_lstack = lua_newthread(ScriptManager->GetGlobalState());
+
+	// Attempt to load and execute the Lua file. The environment is never reused because modifications are made to it.
+	if (ScriptManager->_ExecuteFile(_lstack, file_name, false) == false) {
+		cerr << "SCRIPT ERROR: ModifyScriptDescriptor::OpenFile() could not open the file " << file_name << endl;
+		_access_mode = SCRIPT_CLOSED;
+		return false;
 	}
 
 	// Write out some global stuff
@@ -145,6 +141,8 @@ void ModifyScriptDescriptor::CommitChanges(bool leave_closed) {
 		_error_messages << "* ModifyScriptDescriptor::CommitChanges() failed because after writing the temporary file "
 			<< temp_filename << ", it could not be moved to overwrite the original filename " << _filename << endl;
 	}
+	// The file may be rewritten within the same second, which would not change its modification time
+	ScriptManager->InvalidateCachedScript(_filename);
 
 	if (leave_closed == false)
 		OpenFile();
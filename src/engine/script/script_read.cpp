@@ -14,6 +14,8 @@
 *** \brief   Source file for the ReadScriptDescriptor class.
 *** ***************************************************************************/
 
+#include <sys/stat.h>
+
 #include "utils.h"
 
 #include "script.h"
@@ -55,9 +57,13 @@ bool ReadScriptDescriptor::OpenFile(const string& filename, bool force_reload) {
 	if (DoesFileExist(file_name + ".lua")) {
 		file_name = filename + ".lua";
 	}
-	if (DoesFileExist(file_name + ".hoa")) {
-		if (!(DoesFileExist(file_name + ".lua") && SCRIPT_DEBUG))
-			file_name = filename + ".hoa";
+	// Use the compiled form of the file unless the source has been modified since the file was compiled. The descriptor
+	// keeps the name of the source file either way, so that callers see the same filename whether or not it was compiled.
+	string loaded_filename = file_name;
+	struct stat source_info, compiled_info;
+	if (stat((file_name + ".hoa").c_str(), &compiled_info) == 0) {
+		if (stat(file_name.c_str(), &source_info) != 0 || (SCRIPT_DEBUG == false && compiled_info.st_mtime >= source_info.st_mtime))
+			loaded_filename = file_name + ".hoa";
 	}
 
 	if (ScriptManager->IsFileOpen(file_name) == true) {
@@ -65,23 +71,21 @@ bool ReadScriptDescriptor::OpenFile(const string& filename, bool force_reload) {
 		return false;
 	}
 
-	// Check if this file was opened previously.
-	if ((force_reload == true) || (_lstack = ScriptManager->_CheckForPreviousLuaState(file_name)) == NULL) {
-		// Increases the global stack size by 1 element. That is needed because the new thread will be pushed in the
-		// stack and we have to be sure there is enough space there.
-		lua_checkstack(ScriptManager->GetGlobalState(), 1);
-		_lstack = lua_newthread(ScriptManager->GetGlobalState());
+	// Increases the global stack size by 1 element. That is needed because the new thread will be pushed in the
+	// stack and we have to be sure there is enough space there.
+	lua_checkstack(ScriptManager->GetGlobalState(), 1);
+	_lstack = lua_newthread(ScriptManager->GetGlobalState());
 
-		// Attempt to load and execute the Lua file
-		if (luaL_loadfile(_lstack, file_name.c_str()) != 0 || lua_pcall(_lstack, 0, 0, 0)) {
-			PRINT_ERROR << "could not open script file: " << file_name << ", error message:" << endl;
-			cerr << lua_tostring(_lstack, private_script::STACK_TOP) << endl;
-			_access_mode = SCRIPT_CLOSED;
-			return false;
-		}
+	// Attempt to load and execute the Lua file. The script engine only needs to parse the file if it is not in the cache.
+	if (ScriptManager->_ExecuteFile(_lstack, loaded_filename, !force_reload) == false) {
+		PRINT_ERROR << "could not open script file: " << loaded_filename << ", error message:" << endl;
+		cerr << lua_tostring(_lstack, private_script::STACK_TOP) << endl;
+		_access_mode = SCRIPT_CLOSED;
+		return false;
 	}
 
 	_filename = file_name;
+	_loaded_filename = loaded_filename;
 	_access_mode = SCRIPT_READ;
 	ScriptManager->_AddOpenFile(this);
 	return true;
@@ -386,6 +390,56 @@ void ReadScriptDescriptor::CloseAllTables() {
 
 
 
+bool ReadScriptDescriptor::_OpenNumberTable(const string& key) {
+	int32 top = lua_gettop(_lstack);
+	uint32 num_open_tables = _open_tables.size();
+
+	OpenTable(key);
+	if (_open_tables.size() == num_open_tables) {
+		// A failed open may leave the value that was retrieved on the stack
+		lua_settop(_lstack, top);
+		return false;
+	}
+	return true;
+}
+
+
+
+bool ReadScriptDescriptor::_OpenNumberTable(int32 key) {
+	if (_open_tables.size() == 0) {
+		IF_PRINT_WARNING(SCRIPT_DEBUG) << "failed because no tables were open when trying to access the table variable: " << key << endl;
+		return false;
+	}
+
+	int32 top = lua_gettop(_lstack);
+	uint32 num_open_tables = _open_tables.size();
+
+	OpenTable(key);
+	if (_open_tables.size() == num_open_tables) {
+		lua_settop(_lstack, top);
+		return false;
+	}
+	return true;
+}
+
+
+
+bool ReadScriptDescriptor::_IsListTable(uint32 size) {
+	if (size == 0)
+		lua_pushnil(_lstack);
+	else
+		lua_pushinteger(_lstack, size);
+
+	// lua_next() pops the key and pushes nothing when there are no more keys
+	if (lua_next(_lstack, STACK_TOP - 1) == 0)
+		return true;
+
+	lua_pop(_lstack, 2);
+	return false;
+}
+
+
+
 uint32 ReadScriptDescriptor::GetTableSize(const string& table_name) {
 	uint32 size = 0;
 
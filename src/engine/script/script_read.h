@@ -76,6 +76,9 @@ public:
 	/** \name File Access Functions
 	*** \note These are derived from ScriptDescriptor, refer to the comments for these
 	*** methods in the header file for that class.
+	***
+	*** \note When force_reload is true, the file is always executed even if the script engine
+	*** would otherwise restore its environment from the script cache.
 	**/
 	//@{
 	virtual bool OpenFile(const std::string& file_name);
@@ -213,6 +216,10 @@ public:
 	***
 	*** \note The integer keys are only valid for tables that are elements of a parent table.
 	*** They can not be used to access tables in the global space.
+	***
+	*** \note The integer, unsigned integer, and float functions read list tables straight off of
+	*** the Lua stack instead of casting each element through luabind. Elements that are not numbers
+	*** are skipped with a single warning for the whole table.
 	**/
 	//@{
 	void ReadBoolVector(const std::string& key, std::vector<bool>& vect)
@@ -222,22 +229,22 @@ public:
 		{ _ReadDataVector<bool>(key, vect); }
 
 	void ReadIntVector(const std::string& key, std::vector<int32>& vect)
-		{ _ReadDataVector<int32>(key, vect); }
+		{ _ReadNumberVector<int32>(key, vect); }
 
 	void ReadIntVector(int32 key, std::vector<int32>& vect)
-		{ _ReadDataVector<int32>(key, vect); }
+		{ _ReadNumberVector<int32>(key, vect); }
 
 	void ReadUIntVector(const std::string& key, std::vector<uint32>& vect)
-		{ _ReadDataVector<uint32>(key, vect); }
+		{ _ReadNumberVector<uint32>(key, vect); }
 
 	void ReadUIntVector(int32 key, std::vector<uint32>& vect)
-		{ _ReadDataVector<uint32>(key, vect); }
+		{ _ReadNumberVector<uint32>(key, vect); }
 
 	void ReadFloatVector(const std::string& key, std::vector<float>& vect)
-		{ _ReadDataVector<float>(key, vect); }
+		{ _ReadNumberVector<float>(key, vect); }
 
 	void ReadFloatVector(int32 key, std::vector<float>& vect)
-		{ _ReadDataVector<float>(key, vect); }
+		{ _ReadNumberVector<float>(key, vect); }
 
 	void ReadStringVector(const std::string& key, std::vector<std::string>& vect)
 		{ _ReadDataVector<std::string>(key, vect); }
@@ -252,6 +259,40 @@ public:
 		{ _ReadDataVector<hoa_utils::ustring>(key, vect); }
 	//@}
 
+	/** \name Numeric Array Read Functions
+	*** \brief These functions fill preallocated storage with the numbers of a list table read from the Lua file.
+	*** \param key The name of the table to read.
+	*** \param storage A pointer to the storage to fill, which must hold at least size elements.
+	*** \param size The number of elements that the table is expected to contain.
+	*** \return True if the table was a list of exactly size numbers and all of them were written.
+	***
+	*** These are the fastest way to read large tables of numbers, such as the tile layers of a map. Rather
+	*** than reporting a problem with every element, a single error message describing the entire table is
+	*** added to the descriptor's error messages when the table is missing, has the wrong number of elements,
+	*** or contains anything other than numbers. The contents of the storage are undefined after a failure.
+	***
+	*** \note The integer keys are only valid for tables that are elements of a parent table.
+	**/
+	//@{
+	bool ReadIntArray(const std::string& key, int32* storage, uint32 size)
+		{ return _ReadNumberArray<int32>(key, storage, size); }
+
+	bool ReadIntArray(int32 key, int32* storage, uint32 size)
+		{ return _ReadNumberArray<int32>(key, storage, size); }
+
+	bool ReadUIntArray(const std::string& key, uint32* storage, uint32 size)
+		{ return _ReadNumberArray<uint32>(key, storage, size); }
+
+	bool ReadUIntArray(int32 key, uint32* storage, uint32 size)
+		{ return _ReadNumberArray<uint32>(key, storage, size); }
+
+	bool ReadFloatArray(const std::string& key, float* storage, uint32 size)
+		{ return _ReadNumberArray<float>(key, storage, size); }
+
+	bool ReadFloatArray(int32 key, float* storage, uint32 size)
+		{ return _ReadNumberArray<float>(key, storage, size); }
+	//@}
+
 	/** \name Function Pointer Read Functions
 	*** \param key The name of the function if it is contained in the global space, or the key
 	*** if the function is embedded in a table.
@@ -391,6 +432,13 @@ public:
 	lua_State* GetLuaState()
 		{ return _lstack; }
 
+	/** \brief Returns the name of the file that was executed when the file was last opened
+	*** This is the compiled form of the file (the filename with ".hoa" appended) when that was used, and is otherwise
+	*** the same as GetFilename(). GetFilename() always returns the name of the source file, even when it was not read.
+	**/
+	const std::string& GetLoadedFilename() const
+		{ return _loaded_filename; }
+
 	/** \brief Prints out the contents of the Lua stack mechanism to standard output
 	*** The elements are printed from stack top to stack bottom.
 	**/
@@ -406,6 +454,9 @@ protected:
 	//! \brief The Lua stack, which handles all data sharing between C++ and Lua.
 	lua_State *_lstack;
 
+	//! \brief The name of the file that was actually executed, which may be the compiled form of _filename
+	std::string _loaded_filename;
+
 	/** \name Data Existence Check Functions
 	*** \brief These functions are called by the public DoesTYPEExist functions of this class.
 	*** \param key The name or numeric id of the Lua data to check.
@@ -450,6 +501,42 @@ protected:
 	template <class T> void _ReadDataVectorHelper(std::vector<T>& vect);
 	//@}
 
+	/** \name Numeric Read Templates
+	*** \brief These template functions are called by the public numeric vector and array read functions.
+	*** \param key The name or numeric identifier of the table to read.
+	***
+	*** List tables are read with raw Lua stack operations. The vector function falls back on _ReadDataVectorHelper()
+	*** for any other table, while the array function fails.
+	*** \note Integer keys are only valid for tables stored in a table, not for global tables.
+	**/
+	//@{
+	template <class T, class K> void _ReadNumberVector(K key, std::vector<T>& vect);
+	template <class T, class K> bool _ReadNumberArray(K key, T* storage, uint32 size);
+
+	/** \brief Copies the numbers of the list table at the top of the stack into storage
+	*** \param storage A pointer to the storage to fill, which must hold at least size elements
+	*** \param size The number of elements to read, as returned by lua_objlen()
+	*** \return The number of elements written. Elements that are not numbers are skipped.
+	**/
+	template <class T> uint32 _ReadNumberSequence(T* storage, uint32 size);
+	//@}
+
+	/** \brief Opens a table for one of the numeric read functions, restoring the stack if the table could not be opened
+	*** \return True if the table was opened
+	**/
+	bool _OpenNumberTable(const std::string& key);
+	bool _OpenNumberTable(int32 key);
+
+	/** \brief Determines whether the table at the top of the stack has any keys other than 1 through size
+	*** \param size The length of the table, as returned by lua_objlen()
+	*** \return True if the table only holds the elements 1 through size
+	***
+	*** Lua traverses the array part of a table before its hash part, so only the keys that follow the last element
+	*** of the list need to be checked. This misses other keys only in tables whose list elements were all stored
+	*** in the hash part, which table constructors never produce.
+	**/
+	bool _IsListTable(uint32 size);
+
 	/** \name Table Key Template
 	*** \brief This template function fills a vector with all of the keys contained by the table
 	*** \param vect A reference to the vector where the keys should be stored
@@ -579,6 +666,74 @@ template <class T> void ReadScriptDescriptor::_ReadDataVectorHelper(std::vector<
 
 
 
+template <class T, class K> void ReadScriptDescriptor::_ReadNumberVector(K key, std::vector<T>& vect) {
+	if (_OpenNumberTable(key) == false)
+		return;
+
+	uint32 size = static_cast<uint32>(lua_objlen(_lstack, private_script::STACK_TOP));
+	if (_IsListTable(size) == false) {
+		_ReadDataVectorHelper(vect);
+		CloseTable();
+		return;
+	}
+
+	uint32 start = vect.size();
+	vect.resize(start + size);
+	uint32 count = (size == 0) ? 0 : _ReadNumberSequence(&vect[start], size);
+	vect.resize(start + count);
+	if (count != size) {
+		IF_PRINT_WARNING(SCRIPT_DEBUG) << (size - count) << " of the " << size << " elements of the table " << key
+			<< " were not numbers and were skipped" << std::endl;
+	}
+
+	CloseTable();
+} // template <class T, class K> void ReadScriptDescriptor::_ReadNumberVector(K key, std::vector<T>& vect)
+
+
+
+template <class T, class K> bool ReadScriptDescriptor::_ReadNumberArray(K key, T* storage, uint32 size) {
+	if (_OpenNumberTable(key) == false) {
+		_error_messages << "* ReadScriptDescriptor::_ReadNumberArray() failed because the table " << key << " could not be opened" << std::endl;
+		return false;
+	}
+
+	uint32 length = static_cast<uint32>(lua_objlen(_lstack, private_script::STACK_TOP));
+	if (length != size || _IsListTable(length) == false) {
+		_error_messages << "* ReadScriptDescriptor::_ReadNumberArray() failed because the table " << key << " was not a list of "
+			<< size << " elements" << std::endl;
+		CloseTable();
+		return false;
+	}
+
+	uint32 count = (size == 0) ? 0 : _ReadNumberSequence(storage, size);
+	CloseTable();
+	if (count != size) {
+		_error_messages << "* ReadScriptDescriptor::_ReadNumberArray() failed because " << (size - count) << " of the " << size
+			<< " elements of the table " << key << " were not numbers" << std::endl;
+		return false;
+	}
+
+	return true;
+} // template <class T, class K> bool ReadScriptDescriptor::_ReadNumberArray(K key, T* storage, uint32 size)
+
+
+
+template <class T> uint32 ReadScriptDescriptor::_ReadNumberSequence(T* storage, uint32 size) {
+	uint32 count = 0;
+	for (uint32 i = 1; i <= size; i++) {
+		lua_rawgeti(_lstack, private_script::STACK_TOP, i);
+		// The type is checked instead of using lua_isnumber(), which would also accept numeric strings as luabind does not
+		if (lua_type(_lstack, private_script::STACK_TOP) == LUA_TNUMBER) {
+			storage[count] = static_cast<T>(lua_tonumber(_lstack, private_script::STACK_TOP));
+			count++;
+		}
+		lua_pop(_lstack, 1);
+	}
+	return count;
+} // template <class T> uint32 ReadScriptDescriptor::_ReadNumberSequence(T* storage, uint32 size)
+
+
+
 template <class T> void ReadScriptDescriptor::_ReadTableKeys(std::vector<T>& keys) {
 	keys.clear();
 
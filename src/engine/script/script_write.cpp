@@ -112,6 +112,8 @@ void WriteScriptDescriptor::CloseFile() {
 	_open_tables.clear();
 	_access_mode = SCRIPT_CLOSED;
 	ScriptManager->_RemoveOpenFile(this);
+	// Any compiled copy of the file that was overwritten is out of date
+	ScriptManager->InvalidateCachedScript(_filename);
 }
 
 
@@ -0,0 +1,395 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2015 by The Allacrost Project
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    atlas_cache.cpp
+*** \author  Tyler Olsen, roots@allacrost.org
+*** \brief   Source file for the on-disk texture atlas cache
+*** ***************************************************************************/
+
+#include <cstdio>
+#include <sys/stat.h>
+
+#include "atlas_cache.h"
+#include "video.h"
+
+using namespace std;
+using namespace hoa_utils;
+
+namespace hoa_video {
+
+namespace private_video {
+
+//! \brief The string which begins every atlas cache file
+static const char ATLAS_CACHE_MAGIC[8] = { 'H', 'O', 'A', 'A', 'T', 'L', 'A', 'S' };
+
+//! \brief Reads a single value from a mapped cache file, advancing the offset. Returns false if the read would pass the end of the file.
+static bool ReadCacheValue(const uint8* data, uint32 size, uint32& offset, uint32& value) {
+	if (offset + sizeof(uint32) > size)
+		return false;
+
+	memcpy(&value, data + offset, sizeof(uint32));
+	offset += sizeof(uint32);
+	return true;
+}
+
+//! \brief Reads a length-prefixed string from a mapped cache file, advancing the offset
+static bool ReadCacheString(const uint8* data, uint32 size, uint32& offset, string& value) {
+	uint32 length;
+	if (ReadCacheValue(data, size, offset, length) == false || length > size - offset)
+		return false;
+
+	value.assign(reinterpret_cast<const char*>(data + offset), length);
+	offset += length;
+	return true;
+}
+
+//! \brief Writes a single value to a cache file
+static bool WriteCacheValue(FILE* file, uint32 value) {
+	return fwrite(&value, sizeof(uint32), 1, file) == 1;
+}
+
+//! \brief Writes a length-prefixed string to a cache file
+static bool WriteCacheString(FILE* file, const string& value) {
+	if (WriteCacheValue(file, value.length()) == false)
+		return false;
+	return value.empty() || fwrite(value.data(), value.length(), 1, file) == 1;
+}
+
+
+
+bool AtlasCache::IsCached(const string& filename) {
+	if (_enabled == false)
+		return false;
+
+	uint8* data = NULL;
+	uint32 size = 0;
+	if (_MapFile(_GetCacheFilename(filename), data, size) == false)
+		return false;
+
+	uint32 page_width, page_height, page_count, page_offset;
+	bool valid = _ReadHeader(filename, data, size, page_width, page_height, page_count, page_offset, NULL);
+	_UnmapFile(data, size);
+	return valid;
+}
+
+
+
+bool AtlasCache::LoadMultiImage(const string& filename, const vector<string>& tags, bool is_static, vector<ImageTexture*>& textures) {
+	if (_enabled == false)
+		return false;
+
+	uint8* data = NULL;
+	uint32 size = 0;
+	if (_MapFile(_GetCacheFilename(filename), data, size) == false)
+		return false;
+
+	uint32 page_width, page_height, page_count, page_offset;
+	map<string, AtlasCacheEntry> entries;
+	if (_ReadHeader(filename, data, size, page_width, page_height, page_count, page_offset, &entries) == false) {
+		IF_PRINT_DEBUG(VIDEO_DEBUG) << "ignoring invalid or out of date atlas cache for image: " << filename << endl;
+		_UnmapFile(data, size);
+		return false;
+	}
+
+	// Every requested element must be in the index, otherwise the image was split differently when the cache was written
+	vector<const AtlasCacheEntry*> found_entries;
+	for (uint32 i = 0; i < tags.size(); i++) {
+		map<string, AtlasCacheEntry>::const_iterator entry = entries.find(tags[i]);
+		if (entry == entries.end() || entry->second.page >= page_count) {
+			IF_PRINT_DEBUG(VIDEO_DEBUG) << "atlas cache for image: " << filename << " did not contain element: " << tags[i] << endl;
+			_UnmapFile(data, size);
+			return false;
+		}
+		found_entries.push_back(&(entry->second));
+	}
+
+	// Upload every page that holds at least one of the requested elements, straight from the mapped file
+	vector<AtlasTexSheet*> sheets(page_count, static_cast<AtlasTexSheet*>(NULL));
+	bool success = true;
+	for (uint32 i = 0; i < found_entries.size() && success == true; i++) {
+		uint32 page = found_entries[i]->page;
+		if (sheets[page] != NULL)
+			continue;
+
+		sheets[page] = TextureManager->_CreateAtlasTexSheet(page_width, page_height, is_static);
+		if (sheets[page] == NULL) {
+			success = false;
+			break;
+		}
+
+		ImageMemory page_data;
+		page_data.width = page_width;
+		page_data.height = page_height;
+		page_data.rgb_format = false;
+		page_data.pixels = data + page_offset + page * page_width * page_height * 4;
+		success = sheets[page]->CopyRect(0, 0, page_data);
+		// The pixels belong to the mapped file and must not be freed by the ImageMemory destructor
+		page_data.pixels = NULL;
+	}
+
+	_UnmapFile(data, size);
+
+	// Create a texture for each element at the location recorded in the index
+	textures.clear();
+	for (uint32 i = 0; i < found_entries.size() && success == true; i++) {
+		const AtlasCacheEntry* entry = found_entries[i];
+		ImageTexture* img = new ImageTexture(filename, tags[i], entry->width, entry->height);
+		if (sheets[entry->page]->PlaceTexture(img, entry->x, entry->y) == false) {
+			delete img;
+			success = false;
+			break;
+		}
+		textures.push_back(img);
+	}
+
+	if (success == false) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to load the atlas cache for image: " << filename << endl;
+		for (uint32 i = 0; i < textures.size(); i++) {
+			textures[i]->texture_sheet->RemoveTexture(textures[i]);
+			delete textures[i];
+		}
+		textures.clear();
+
+		for (uint32 i = 0; i < sheets.size(); i++) {
+			if (sheets[i] != NULL)
+				TextureManager->_RemoveSheet(sheets[i]);
+		}
+		return false;
+	}
+
+	return true;
+} // bool AtlasCache::LoadMultiImage(...)
+
+
+
+bool AtlasCache::SaveMultiImage(const string& filename, const vector<string>& tags, const ImageMemory& multi_image,
+	const uint32 grid_rows, const uint32 grid_cols)
+{
+	if (_enabled == false)
+		return false;
+
+	// Both RGB and RGBA source data are accepted. Pages are always stored in RGBA format.
+	if (multi_image.pixels == NULL || multi_image.width <= 0 || multi_image.height <= 0 || grid_rows == 0 || grid_cols == 0 ||
+		tags.size() != grid_rows * grid_cols)
+	{
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "invalid multi image data for image: " << filename << endl;
+		return false;
+	}
+
+	// The source image becomes a single page, padded out to power of two dimensions
+	uint32 page_width = RoundUpPow2(multi_image.width);
+	uint32 page_height = RoundUpPow2(multi_image.height);
+	if (static_cast<uint32>(multi_image.width * multi_image.height) < ATLAS_CACHE_MIN_AREA)
+		return false;
+	if (page_width > static_cast<uint32>(TextureManager->GetMaxTextureSize()) ||
+		page_height > static_cast<uint32>(TextureManager->GetMaxTextureSize()))
+	{
+		return false;
+	}
+
+	uint32 source_size, source_time;
+	if (_GetSourceInfo(filename, source_size, source_time) == false)
+		return false;
+
+	string cache_filename = _GetCacheFilename(filename);
+	if (cache_filename.empty() == true)
+		return false;
+
+	// Write to a temporary file first so that an interrupted write never leaves behind a partial cache file
+	string temp_filename = cache_filename + ".tmp";
+	FILE* file = fopen(temp_filename.c_str(), "wb");
+	if (file == NULL) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to open atlas cache file for writing: " << temp_filename << endl;
+		return false;
+	}
+
+	int32 element_width = multi_image.width / grid_cols;
+	int32 element_height = multi_image.height / grid_rows;
+
+	// The size of the header and index must be known to record the offset of the pages
+	uint32 page_offset = sizeof(ATLAS_CACHE_MAGIC) + 9 * sizeof(uint32) + filename.length();
+	for (uint32 i = 0; i < tags.size(); i++) {
+		page_offset += 6 * sizeof(uint32) + tags[i].length();
+	}
+	// Align the pages so that each row of pixels begins on a four byte boundary when the file is mapped
+	uint32 padding = (4 - (page_offset % 4)) % 4;
+	page_offset += padding;
+
+	bool success = fwrite(ATLAS_CACHE_MAGIC, sizeof(ATLAS_CACHE_MAGIC), 1, file) == 1;
+	success = success && WriteCacheValue(file, ATLAS_CACHE_VERSION);
+	success = success && WriteCacheString(file, filename);
+	success = success && WriteCacheValue(file, source_size);
+	success = success && WriteCacheValue(file, source_time);
+	success = success && WriteCacheValue(file, page_width);
+	success = success && WriteCacheValue(file, page_height);
+	success = success && WriteCacheValue(file, 1);
+	success = success && WriteCacheValue(file, tags.size());
+	success = success && WriteCacheValue(file, page_offset);
+
+	// Elements are in row-major order, matching the order of the tags created by ImageDescriptor::_LoadMultiImage()
+	for (uint32 row = 0; row < grid_rows && success == true; row++) {
+		for (uint32 col = 0; col < grid_cols && success == true; col++) {
+			success = WriteCacheString(file, tags[row * grid_cols + col]);
+			success = success && WriteCacheValue(file, 0);
+			success = success && WriteCacheValue(file, col * element_width);
+			success = success && WriteCacheValue(file, row * element_height);
+			success = success && WriteCacheValue(file, element_width);
+			success = success && WriteCacheValue(file, element_height);
+		}
+	}
+
+	const uint8 zeros[4] = { 0, 0, 0, 0 };
+	if (success == true && padding > 0)
+		success = fwrite(zeros, padding, 1, file) == 1;
+
+	// Write the page one row at a time, filling the space beyond the edges of the source image with transparent pixels
+	vector<uint8> row_data(page_width * 4, 0);
+	for (uint32 y = 0; y < page_height && success == true; y++) {
+		if (y < static_cast<uint32>(multi_image.height) && multi_image.rgb_format == true) {
+			const uint8* source_row = static_cast<const uint8*>(multi_image.pixels) + y * multi_image.width * 3;
+			for (int32 x = 0; x < multi_image.width; x++) {
+				row_data[4 * x] = source_row[3 * x];
+				row_data[4 * x + 1] = source_row[3 * x + 1];
+				row_data[4 * x + 2] = source_row[3 * x + 2];
+				row_data[4 * x + 3] = 0xFF;
+			}
+		}
+		else if (y < static_cast<uint32>(multi_image.height))
+			memcpy(&row_data[0], static_cast<uint8*>(multi_image.pixels) + y * multi_image.width * 4, multi_image.width * 4);
+		else
+			memset(&row_data[0], 0, multi_image.width * 4);
+		success = fwrite(&row_data[0], row_data.size(), 1, file) == 1;
+	}
+
+	if (fclose(file) != 0)
+		success = false;
+
+	if (success == false || MoveFile(temp_filename, cache_filename) == false) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to write atlas cache file: " << cache_filename << endl;
+		DeleteFile(temp_filename);
+		return false;
+	}
+
+	IF_PRINT_DEBUG(VIDEO_DEBUG) << "wrote atlas cache file: " << cache_filename << " for image: " << filename << endl;
+	return true;
+} // bool AtlasCache::SaveMultiImage(...)
+
+
+
+string AtlasCache::_GetCacheFilename(const string& filename) {
+	if (_directory.empty() == true) {
+		string cache_directory = GetUserDataPath(false) + "cache/";
+		string atlas_directory = cache_directory + "atlas/";
+		if (MakeDirectory(cache_directory) == false || MakeDirectory(atlas_directory) == false) {
+			IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to create the atlas cache directory: " << atlas_directory << endl;
+			return "";
+		}
+		_directory = atlas_directory;
+	}
+
+	// Flatten the path of the image into a single filename
+	string cache_name = filename;
+	for (uint32 i = 0; i < cache_name.length(); i++) {
+		if (cache_name[i] == '/' || cache_name[i] == '\\' || cache_name[i] == ':')
+			cache_name[i] = '_';
+	}
+
+	return _directory + cache_name + ".atlas";
+}
+
+
+
+bool AtlasCache::_GetSourceInfo(const string& filename, uint32& size, uint32& modify_time) const {
+	struct stat buf;
+	if (stat(filename.c_str(), &buf) != 0)
+		return false;
+
+	size = static_cast<uint32>(buf.st_size);
+	modify_time = static_cast<uint32>(buf.st_mtime);
+	return true;
+}
+
+
+
+bool AtlasCache::_MapFile(const string& cache_filename, uint8*& data, uint32& size) const {
+	return MapFileIntoMemory(cache_filename, data, size);
+}
+
+
+
+void AtlasCache::_UnmapFile(uint8* data, uint32 size) const {
+	UnmapFileFromMemory(data, size);
+}
+
+
+
+bool AtlasCache::_ReadHeader(const string& filename, const uint8* data, uint32 size, uint32& page_width, uint32& page_height,
+	uint32& page_count, uint32& page_offset, map<string, AtlasCacheEntry>* entries) const
+{
+	if (size < sizeof(ATLAS_CACHE_MAGIC) || memcmp(data, ATLAS_CACHE_MAGIC, sizeof(ATLAS_CACHE_MAGIC)) != 0)
+		return false;
+
+	uint32 offset = sizeof(ATLAS_CACHE_MAGIC);
+	uint32 version, source_size, source_time, entry_count;
+	string source_filename;
+
+	if (ReadCacheValue(data, size, offset, version) == false || version != ATLAS_CACHE_VERSION)
+		return false;
+	if (ReadCacheString(data, size, offset, source_filename) == false || source_filename != filename)
+		return false;
+	if (ReadCacheValue(data, size, offset, source_size) == false || ReadCacheValue(data, size, offset, source_time) == false)
+		return false;
+
+	// The cache is out of date if the source image has changed since it was written
+	uint32 current_size, current_time;
+	if (_GetSourceInfo(filename, current_size, current_time) == false || current_size != source_size || current_time != source_time)
+		return false;
+
+	if (ReadCacheValue(data, size, offset, page_width) == false || ReadCacheValue(data, size, offset, page_height) == false ||
+		ReadCacheValue(data, size, offset, page_count) == false || ReadCacheValue(data, size, offset, entry_count) == false ||
+		ReadCacheValue(data, size, offset, page_offset) == false)
+	{
+		return false;
+	}
+
+	// Make sure that the file actually contains all of the pages that it claims to
+	if (page_width == 0 || page_height == 0 || page_count == 0 || page_offset > size ||
+		(size - page_offset) / page_count / 4 / page_width < page_height)
+	{
+		return false;
+	}
+
+	if (entries == NULL)
+		return true;
+
+	for (uint32 i = 0; i < entry_count; i++) {
+		string tags;
+		AtlasCacheEntry entry;
+		uint32 x, y, width, height;
+		if (ReadCacheString(data, size, offset, tags) == false || ReadCacheValue(data, size, offset, entry.page) == false ||
+			ReadCacheValue(data, size, offset, x) == false || ReadCacheValue(data, size, offset, y) == false ||
+			ReadCacheValue(data, size, offset, width) == false || ReadCacheValue(data, size, offset, height) == false)
+		{
+			return false;
+		}
+
+		entry.x = static_cast<int32>(x);
+		entry.y = static_cast<int32>(y);
+		entry.width = static_cast<int32>(width);
+		entry.height = static_cast<int32>(height);
+		entries->insert(make_pair(tags, entry));
+	}
+
+	return true;
+} // bool AtlasCache::_ReadHeader(...)
+
+} // namespace private_video
+
+} // namespace hoa_video
@@ -0,0 +1,171 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2015 by The Allacrost Project
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    atlas_cache.h
+*** \author  Tyler Olsen, roots@allacrost.org
+*** \brief   Header file for the on-disk texture atlas cache
+***
+*** Loading a multi image (such as a tileset) normally requires decoding the
+*** image file, slicing it into its individual elements, and packing each element
+*** into a texture sheet. The atlas cache stores the result of that work on disk
+*** the first time a multi image is loaded: raw RGBA texture sheet pages along
+*** with an index giving the location of every element on those pages. Later
+*** loads map the cache file into memory and upload each page with a single call.
+***
+*** Each cache file has the following layout. All values are unsigned 32-bit
+*** integers in the native byte order of the machine that wrote the file.
+***
+*** - The header: the magic string "HOAATLAS", the format version, the name of
+***   the source image file (length then characters), the size and modification
+***   time of the source file, the width, height, and number of pages, the number
+***   of index entries, and the file offset of the first page.
+*** - The index: for each element, its tags (length then characters), the page
+***   that it is on, and its x, y, width, and height on that page in pixels.
+*** - The pages: width * height * 4 bytes of RGBA pixel data for each page.
+***
+*** \note The cache is stored in the user's data directory and is specific to the
+*** machine that wrote it. A cache file is ignored and rewritten whenever the size
+*** or modification time of its source image changes.
+*** ***************************************************************************/
+
+#ifndef __ATLAS_CACHE_HEADER__
+#define __ATLAS_CACHE_HEADER__
+
+#include "defs.h"
+#include "utils.h"
+
+namespace hoa_video {
+
+namespace private_video {
+
+//! \brief The version number of the atlas cache file format. Files with any other version are ignored.
+const uint32 ATLAS_CACHE_VERSION = 1;
+
+/** \brief Multi images with an area smaller than this number of pixels are not cached
+*** Small images are cheap to decode, and their elements pack better when they share texture sheets with other images.
+**/
+const uint32 ATLAS_CACHE_MIN_AREA = 256 * 256;
+
+//! \brief The location of a single multi image element in the atlas cache
+class AtlasCacheEntry {
+public:
+	//! \brief The page of the cache file that the element is on
+	uint32 page;
+
+	//! \brief The pixel coordinates of the upper left corner of the element on the page
+	int32 x, y;
+
+	//! \brief The width and height of the element, in pixels
+	int32 width, height;
+}; // class AtlasCacheEntry
+
+
+/** ****************************************************************************
+*** \brief Reads and writes the prepacked texture sheet pages of multi images
+***
+*** The cache is keyed by the same filename and element tags that the TextureController
+*** uses to register image textures, so the textures created from a cache file are
+*** indistinguishable from those that were loaded from the original image. If the
+*** texture sheets are ever reloaded, the elements are restored from the original image.
+***
+*** \note The TextureController owns the single instance of this class.
+*** ***************************************************************************/
+class AtlasCache {
+public:
+	AtlasCache() :
+		_enabled(true) {}
+
+	~AtlasCache()
+		{}
+
+	/** \brief Checks whether a valid cache file exists for an image file
+	*** \param filename The name of the multi image file
+	*** \return True if the cache file exists and is up to date with the image file
+	**/
+	bool IsCached(const std::string& filename);
+
+	/** \brief Loads the elements of a multi image from its cache file
+	*** \param filename The name of the multi image file
+	*** \param tags The tags of each element to load
+	*** \param is_static Whether the texture sheets created for the cache pages should be labeled static or not
+	*** \param textures Filled with the newly created texture for each element, in the same order as the tags
+	*** \return False if there is no valid cache file for the image or it does not contain every requested element
+	***
+	*** The created textures are registered with the TextureController but have no references added to them.
+	**/
+	bool LoadMultiImage(const std::string& filename, const std::vector<std::string>& tags, bool is_static,
+		std::vector<ImageTexture*>& textures);
+
+	/** \brief Writes the cache file for a multi image that has been split into a grid of elements
+	*** \param filename The name of the multi image file
+	*** \param tags The tags of each element, in row-major order
+	*** \param multi_image The decoded pixel data of the entire multi image
+	*** \param grid_rows The number of rows of elements in the multi image
+	*** \param grid_cols The number of columns of elements in the multi image
+	*** \return True if the cache file was written
+	***
+	*** Nothing is written if the cache is disabled or if the image is too small or too large to be cached.
+	**/
+	bool SaveMultiImage(const std::string& filename, const std::vector<std::string>& tags, const ImageMemory& multi_image,
+		const uint32 grid_rows, const uint32 grid_cols);
+
+	//! \brief Enables or disables both reading and writing of cache files
+	void SetEnabled(bool enabled)
+		{ _enabled = enabled; }
+
+	bool IsEnabled() const
+		{ return _enabled; }
+
+private:
+	//! \brief When false, the cache is neither read from nor written to
+	bool _enabled;
+
+	//! \brief The directory that cache files are stored in. Determined and created the first time that it is needed.
+	std::string _directory;
+
+	//! \brief Returns the name of the cache file for an image file, creating the cache directory if necessary
+	std::string _GetCacheFilename(const std::string& filename);
+
+	/** \brief Retrieves the size and modification time of an image file
+	*** \return False if the file could not be found
+	**/
+	bool _GetSourceInfo(const std::string& filename, uint32& size, uint32& modify_time) const;
+
+	/** \brief Maps a cache file into memory for reading
+	*** \param cache_filename The name of the cache file
+	*** \param data Set to point at the contents of the file
+	*** \param size Set to the size of the file, in bytes
+	*** \return False if the file does not exist or could not be mapped
+	**/
+	bool _MapFile(const std::string& cache_filename, uint8*& data, uint32& size) const;
+
+	//! \brief Releases the memory for a file that was mapped by _MapFile()
+	void _UnmapFile(uint8* data, uint32 size) const;
+
+	/** \brief Validates the header and reads the index of a mapped cache file
+	*** \param filename The name of the multi image file that the cache file should correspond to
+	*** \param data The contents of the cache file
+	*** \param size The size of the cache file, in bytes
+	*** \param page_width Set to the width of the cache pages, in pixels
+	*** \param page_height Set to the height of the cache pages, in pixels
+	*** \param page_count Set to the number of pages in the cache file
+	*** \param page_offset Set to the file offset of the first page
+	*** \param entries If not NULL, filled with every entry in the index keyed by element tags
+	*** \return False if the cache file is invalid or out of date
+	**/
+	bool _ReadHeader(const std::string& filename, const uint8* data, uint32 size, uint32& page_width, uint32& page_height,
+		uint32& page_count, uint32& page_offset, std::map<std::string, AtlasCacheEntry>* entries) const;
+}; // class AtlasCache
+
+} // namespace private_video
+
+} // namespace hoa_video
+
+#endif // __ATLAS_CACHE_HEADER__
@@ -81,6 +81,15 @@ public:
 		{ normalisedX = (_left - localX) / (_right - _left); normalisedY = (_bottom - localY) / (_top - _bottom); }
 	//@}
 
+	//! \brief Comparison operators, used to avoid redundant projection changes
+	//@{
+	bool operator==(const CoordSys& other) const
+		{ return (_left == other._left && _right == other._right && _bottom == other._bottom && _top == other._top); }
+
+	bool operator!=(const CoordSys& other) const
+		{ return !(*this == other); }
+	//@}
+
 private:
 	//! \brief If the y-coordinates increase from bottom to top, this is 1.0f. Otherwise it is -1.0f.
 	float _vertical_direction;
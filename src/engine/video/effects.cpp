@@ -50,6 +50,17 @@ ParticleEffectID VideoEngine::AddParticleEffect(const string &filename, float x,
 }
 
 
+//-----------------------------------------------------------------------------
+// UpdateParticleEffects: updates all particle effects. This is done by Display()
+//                        each frame, so it is only needed outside the game loop
+//-----------------------------------------------------------------------------
+
+bool VideoEngine::UpdateParticleEffects(uint32 frame_time)
+{
+	return _particle_manager.Update(static_cast<int32>(frame_time));
+}
+
+
 //-----------------------------------------------------------------------------
 // DrawParticleEffects: call this once per frame. You should call this after
 //                      rendering things like tiles, characters, and monsters,
@@ -62,6 +73,23 @@ bool VideoEngine::DrawParticleEffects()
 }
 
 
+//-----------------------------------------------------------------------------
+// SetParticleUpdateThreads: sets how many threads the particle systems are
+//                           updated on, or zero to base it on the CPU count
+//-----------------------------------------------------------------------------
+
+void VideoEngine::SetParticleUpdateThreads(uint32 num_threads)
+{
+	_particle_manager.SetNumberUpdateThreads(num_threads);
+}
+
+
+uint32 VideoEngine::GetParticleUpdateThreads() const
+{
+	return _particle_manager.GetNumberUpdateThreads();
+}
+
+
 //-----------------------------------------------------------------------------
 // StopAllParticleEffects: stops all current particle effects. Pass true if
 //                         you want them to all stop immediately, or false (Default)
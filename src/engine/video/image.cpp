@@ -13,6 +13,8 @@
 *** \brief   Source file for image classes
 *** ***************************************************************************/
 
+#include <algorithm>
+
 #include "image.h"
 #include "video.h"
 
@@ -459,9 +461,8 @@ void ImageDescriptor::_RemoveTextureReference() {
 	if (_texture->RemoveReference() == true) {
 		_texture->texture_sheet->RemoveTexture(_texture);
 
-		// If the image exceeds 512 in either width or height, it has an un-shared texture sheet, which we
-		// should now delete that the image is being removed
-		if (_texture->width > 512 || _texture->height > 512) {
+		// A dedicated texture sheet is deleted once the last of the images it was created for has been removed
+		if (_texture->texture_sheet->dedicated == true && _texture->texture_sheet->GetNumberTextures() == 0) {
 			TextureManager->_RemoveSheet(_texture->texture_sheet);
 		}
 // 		else {
@@ -515,13 +516,13 @@ void ImageDescriptor::_DrawOrientation() const {
 		x_scale = -x_scale;
 	if (current_context.coordinate_system.GetVerticalDirection() < 0.0f)
 		y_scale = -y_scale;
-	glScalef(x_scale, y_scale, 1.0f);
+	VideoManager->Scale(x_scale, y_scale);
 }
 
 
 
 void ImageDescriptor::_DrawTexture(const Color* draw_color) const {
-	// Array of the four vertexes defined on the 2D plane for glDrawArrays()
+	// Array of the four vertexes defined on the 2D plane for the quad
 	// This is no longer const, because when tiling the background for the menu's
 	// sometimes you need to draw part of a texture
 	float vert_coords[] = {
@@ -535,108 +536,53 @@ void ImageDescriptor::_DrawTexture(const Color* draw_color) const {
 	if (draw_color == NULL)
 		draw_color = _color;
 
-	// Set blending parameters
-	if (VideoManager->_current_context.blend) {
-		glEnable(GL_BLEND);
-		if (VideoManager->_current_context.blend == 1)
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Normal blending
-		else
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE); // Additive blending
-	}
-	else if (_blend) {
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Normal blending
-	}
-	else {
-		glDisable(GL_BLEND);
-	}
-
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(2, GL_FLOAT, 0, vert_coords);
-
-	// If we have a valid image texture poiner, setup texture coordinates and the texture coordinate array for glDrawArrays()
-	if (_texture != NULL) {
-		// Set the texture coordinates
-		float s0, s1, t0, t1;
-
-		s0 = _texture->u1 + (_u1 * (_texture->u2 - _texture->u1));
-		s1 = _texture->u1 + (_u2 * (_texture->u2 - _texture->u1));
-		t0 = _texture->v1 + (_v1 * (_texture->v2 - _texture->v1));
-		t1 = _texture->v1 + (_v2 * (_texture->v2 - _texture->v1));
-
-		// Swap x texture coordinates if x flipping is enabled
-		if (VideoManager->_current_context.x_flip) {
-			float temp = s0;
-			s0 = s1;
-			s1 = temp;
-		}
+	// Determine the blending mode: the context blend flag takes precedence over the image's own blend property
+	int8 blend = 0;
+	if (VideoManager->_current_context.blend)
+		blend = (VideoManager->_current_context.blend == 1) ? 1 : 2; // Normal or additive blending
+	else if (_blend)
+		blend = 1;
 
-		// Swap y texture coordinates if y flipping is enabled
-		if (VideoManager->_current_context.y_flip) {
-			float temp = t0;
-			t0 = t1;
-			t1 = temp;
-		}
+	// If there is no image texture, we're drawing pure color on the vertices
+	if (_texture == NULL) {
+		VideoManager->_sprite_batch.AddQuad(vert_coords, NULL, draw_color, _unichrome_vertices, NULL, false, blend,
+			VideoManager->_transform);
+		return;
+	}
 
-		// Place the texture coordinates in a 4x2 array mirroring the structure of the vertex array for use in glDrawArrays().
-		float tex_coords[] = {
-			s0, t1,
-			s1, t1,
-			s1, t0,
-			s0, t0,
-		};
-
-		// Enable texturing and bind texture
-		glEnable(GL_TEXTURE_2D);
-		TextureManager->_BindTexture(_texture->texture_sheet->tex_id);
-		_texture->texture_sheet->Smooth(_texture->smooth);
-
-		// Enable and setup the texture coordinate array
-		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-		glTexCoordPointer(2, GL_FLOAT, 0, tex_coords);
-
-		if (_unichrome_vertices == true) {
-			glColor4fv((GLfloat*)draw_color[0].GetColors());
-			glDisableClientState(GL_COLOR_ARRAY);
-		}
-		else {
-			glEnableClientState(GL_COLOR_ARRAY);
-			glColorPointer(4, GL_FLOAT, 0, (GLfloat*)draw_color);
-		}
-	} // if (_texture != NULL)
+	// Set the texture coordinates
+	float s0, s1, t0, t1;
 
-	// Otherwise there is no image texture, so we're drawing pure color on the vertices
-	else {
-		// Use a single call to glColor for unichrome images, or a setup a gl color array for multiple colors
-		if (_unichrome_vertices == true) {
-			glColor4fv((GLfloat*)draw_color[0].GetColors());
-			glDisableClientState(GL_COLOR_ARRAY);
-		}
-		else {
-			glEnableClientState(GL_COLOR_ARRAY);
-			glColorPointer(4, GL_FLOAT, 0, (GLfloat*)draw_color);
-		}
+	s0 = _texture->u1 + (_u1 * (_texture->u2 - _texture->u1));
+	s1 = _texture->u1 + (_u2 * (_texture->u2 - _texture->u1));
+	t0 = _texture->v1 + (_v1 * (_texture->v2 - _texture->v1));
+	t1 = _texture->v1 + (_v2 * (_texture->v2 - _texture->v1));
 
-		// Disable texturing as we're using pure colour
-		glDisable(GL_TEXTURE_2D);
+	// Swap x texture coordinates if x flipping is enabled
+	if (VideoManager->_current_context.x_flip) {
+		float temp = s0;
+		s0 = s1;
+		s1 = temp;
 	}
 
-	// Use a vertex array to draw all of the vertices
-	glDrawArrays(GL_QUADS, 0, 4);
-	glDisableClientState(GL_VERTEX_ARRAY);
-
-	if (_texture != NULL)
-		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-
-	if (glIsEnabled(GL_COLOR_ARRAY))
-		glDisableClientState(GL_COLOR_ARRAY);
+	// Swap y texture coordinates if y flipping is enabled
+	if (VideoManager->_current_context.y_flip) {
+		float temp = t0;
+		t0 = t1;
+		t1 = temp;
+	}
 
-	if (VideoManager->_current_context.blend || _blend == true)
-		glDisable(GL_BLEND);
+	// Place the texture coordinates in a 4x2 array mirroring the structure of the vertex array
+	float tex_coords[] = {
+		s0, t1,
+		s1, t1,
+		s1, t0,
+		s0, t0,
+	};
 
-	if (VideoManager->CheckGLError() == true) {
-		IF_PRINT_WARNING(VIDEO_DEBUG) << "an OpenGL error occurred: " << VideoManager->CreateGLErrorString() << endl;
-	}
+	// The quad is only queued here. It is drawn when the texture sheet or blending state changes, or when the frame is displayed.
+	VideoManager->_sprite_batch.AddQuad(vert_coords, tex_coords, draw_color, _unichrome_vertices,
+		_texture->texture_sheet, _texture->smooth, blend, VideoManager->_transform);
 } // void ImageDescriptor::_DrawTexture(const Color* color_array) const
 
 
@@ -758,8 +704,7 @@ bool ImageDescriptor::_LoadMultiImage(vector<StillImage>& images, const string &
 	// already in texture memory and need to be loaded
 	for (x = 0; x < grid_rows; x++) {
 		for (y = 0; y < grid_cols; y++) {
-			tags.push_back("<X" + NumberToString(x) + "_" + NumberToString(grid_rows) + ">" +
-				"<Y" + NumberToString(y) + "_" + NumberToString(grid_cols) + ">");
+			tags.push_back(TextureController::_CreateMultiImageTag(x, grid_rows, y, grid_cols));
 
 			if (TextureManager->_IsImageTextureRegistered(filename + tags.back())) {
 				loaded.push_back(true);
@@ -771,6 +716,27 @@ bool ImageDescriptor::_LoadMultiImage(vector<StillImage>& images, const string &
 		}
 	}
 
+	// When none of the elements are loaded, try to load all of them from prepacked pages in the atlas cache
+	bool cache_miss = false;
+	if (need_load == true && count(loaded.begin(), loaded.end(), true) == 0) {
+		vector<ImageTexture*> cached_textures;
+		if (TextureManager->_atlas_cache.LoadMultiImage(filename, tags, images.at(0)._is_static, cached_textures) == true) {
+			for (uint32 i = 0; i < cached_textures.size(); i++) {
+				images.at(i)._filename = filename;
+				images.at(i)._texture = cached_textures[i];
+				images.at(i)._image_texture = cached_textures[i];
+				cached_textures[i]->AddReference();
+
+				if (images.at(i)._grayscale) {
+					images.at(i)._grayscale = false;
+					images.at(i).EnableGrayScale();
+				}
+			}
+			return true;
+		}
+		cache_miss = true;
+	}
+
 	// If the image elements are not all loaded, then load the multi image file
 	// from disk and create enough memory to copy over individual sub-image elements from it
 	ImageMemory multi_image;
@@ -781,6 +747,14 @@ bool ImageDescriptor::_LoadMultiImage(vector<StillImage>& images, const string &
 			return false;
 		}
 
+		// The elements are copied out of the image four bytes per pixel, so images without alpha (JPG files) are expanded
+		if (multi_image.rgb_format == true)
+			multi_image.RGBToRGBA();
+
+		// Store the decoded image in the atlas cache so that the next load of it can skip this work
+		if (cache_miss == true)
+			TextureManager->_atlas_cache.SaveMultiImage(filename, tags, multi_image, grid_rows, grid_cols);
+
 		sub_image.width = multi_image.width / grid_cols;
 		sub_image.height = multi_image.height / grid_rows;
 		sub_image.pixels = malloc(sub_image.width * sub_image.height * 4);
@@ -1019,7 +993,7 @@ void StillImage::Draw(const Color& draw_color) const {
 		return;
 	}
 
-	glPushMatrix();
+	VideoManager->PushMatrix();
 	_DrawOrientation();
 
 	float modulation = VideoManager->_screen_fader.GetFadeModulation();
@@ -1040,7 +1014,7 @@ void StillImage::Draw(const Color& draw_color) const {
 		_DrawTexture(modulated_colors);
 	}
 
-	glPopMatrix();
+	VideoManager->PopMatrix();
 } // void StillImage::Draw(const Color& draw_color) const
 
 
@@ -1578,7 +1552,7 @@ void CompositeImage::Draw(const Color& draw_color) const {
 		coord_sys.GetVerticalDirection();
 
 	// Save the draw cursor position as we move to draw each element
-	glPushMatrix();
+	VideoManager->PushMatrix();
 
 	VideoManager->MoveRelative(x_align_offset, y_align_offset);
 
@@ -1608,7 +1582,7 @@ void CompositeImage::Draw(const Color& draw_color) const {
 		x_off += x_shake;
 		y_off += y_shake;
 
-		glPushMatrix();
+		VideoManager->PushMatrix();
 		VideoManager->MoveRelative(x_off * coord_sys.GetHorizontalDirection(),
 			y_off * coord_sys.GetVerticalDirection());
 
@@ -1620,7 +1594,7 @@ void CompositeImage::Draw(const Color& draw_color) const {
 		if (coord_sys.GetVerticalDirection() < 0.0f)
 			y_scale = -y_scale;
 
-		glScalef(x_scale, y_scale, 1.0f);
+		VideoManager->Scale(x_scale, y_scale);
 
 		if (skip_modulation)
 			_elements[i].image._DrawTexture(_color);
@@ -1632,9 +1606,9 @@ void CompositeImage::Draw(const Color& draw_color) const {
 			modulated_colors[3] = _color[3] * fade_color;
 			_elements[i].image._DrawTexture(modulated_colors);
 		}
-		glPopMatrix();
+		VideoManager->PopMatrix();
 	}
-	glPopMatrix();
+	VideoManager->PopMatrix();
 } // void CompositeImage::Draw(const Color& draw_color) const
 
 
@@ -58,6 +58,23 @@ bool ImageMemory::LoadImage(const string& filename) {
 		pixels = NULL;
 	}
 
+	// Use the data from a background decode of this file if one was requested
+	bool success = false;
+	if (TextureManager->_image_decoder.TakeDecodedImage(filename, *this, success) == true)
+		return success;
+
+	return DecodeImage(filename);
+}
+
+
+
+bool ImageMemory::DecodeImage(const string& filename) {
+	if (pixels != NULL) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "pixels member was not NULL upon function invocation" << endl;
+		free(pixels);
+		pixels = NULL;
+	}
+
 	// Isolate the extension
 	size_t ext_position = filename.rfind('.');
 
@@ -160,6 +177,42 @@ void ImageMemory::RGBAToRGB() {
 
 
 
+void ImageMemory::RGBToRGBA() {
+	if (width <= 0 || height <= 0) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "width and/or height members were invalid (<= 0)" << endl;
+		return;
+	}
+
+	if (pixels == NULL) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "no image data (pixels == NULL)" << endl;
+		return;
+	}
+
+	if (rgb_format == false) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "image data was said to already be in RGBA format" << endl;
+		return;
+	}
+
+	void* new_pixels = realloc(pixels, width * height * 4);
+	if (new_pixels == NULL) {
+		PRINT_ERROR << "failed to realloc memory for the RGBA image data" << endl;
+		return;
+	}
+	pixels = new_pixels;
+
+	// Work backwards from the last pixel so that no RGB data is overwritten before it has been moved
+	uint8* pixel_data = static_cast<uint8*>(pixels);
+	for (int32 i = height * width - 1; i >= 0; i--) {
+		pixel_data[4 * i + 3] = 0xFF;
+		pixel_data[4 * i + 2] = pixel_data[3 * i + 2];
+		pixel_data[4 * i + 1] = pixel_data[3 * i + 1];
+		pixel_data[4 * i] = pixel_data[3 * i];
+	}
+	rgb_format = false;
+}
+
+
+
 void ImageMemory::CopyFromTexture(TexSheet* texture) {
 	if (pixels != NULL)
 		free(pixels);
@@ -83,9 +83,21 @@ public:
 	/** \brief Loads raw image data from a file and stores the data in the class members
 	*** \param file_name The filename of the image to load, which should have a .png or .jpg extension
 	*** \return True if the image was loaded successfully, false if it was not
+	***
+	*** If the file was queued with the TextureController's image decoder, the data decoded
+	*** by the worker thread is used (waiting for it if needed) instead of reading the file again.
 	**/
 	bool LoadImage(const std::string& filename);
 
+	/** \brief Decodes an image file and stores the data in the class members
+	*** \param file_name The filename of the image to load, which should have a .png or .jpg extension
+	*** \return True if the image was decoded successfully, false if it was not
+	***
+	*** Unlike LoadImage(), this function never consults the image decoder and does not touch any
+	*** global state, so it is safe to call from a thread other than the main thread.
+	**/
+	bool DecodeImage(const std::string& filename);
+
 	/** \brief Saves raw image data to a file
 	*** \param file_name The full filename of the image to load
 	*** \param png_image Set to true if this is a PNG image, or false if it is a JPG image
@@ -109,6 +121,12 @@ public:
 	**/
 	void RGBAToRGB();
 
+	/** \brief Converts the RGB pixel buffer to a RGBA one, with every pixel fully opaque
+	*** \note Upon conversion, this function will also increase the memory size pointed to
+	*** by pixels to 4/3s of its original size to make room for the alpha information.
+	**/
+	void RGBToRGBA();
+
 	/** \brief Set the class members by making a copy of a texture sheet
 	*** \param texture A pointer to the TexSheet to be copied
 	***
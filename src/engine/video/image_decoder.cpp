@@ -0,0 +1,370 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2015 by The Allacrost Project
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    image_decoder.cpp
+*** \author  Tyler Olsen, roots@allacrost.org
+*** \brief   Source file for background image decoding
+*** ***************************************************************************/
+
+#include <SDL2/SDL.h>
+
+#include "image_decoder.h"
+#include "video.h"
+
+using namespace std;
+using namespace hoa_utils;
+using namespace hoa_video::private_video;
+
+namespace hoa_video {
+
+namespace private_video {
+
+ImageDecoder::ImageDecoder() :
+	_mutex(NULL),
+	_job_queued(NULL),
+	_job_finished(NULL),
+	_shutdown(false)
+{}
+
+
+
+ImageDecoder::~ImageDecoder() {
+	if (_mutex != NULL) {
+		SDL_LockMutex(_mutex);
+		_shutdown = true;
+		SDL_CondBroadcast(_job_queued);
+		SDL_UnlockMutex(_mutex);
+	}
+
+	for (uint32 i = 0; i < _threads.size(); i++) {
+		SDL_WaitThread(_threads[i], NULL);
+	}
+	_threads.clear();
+
+	// With the workers stopped, every remaining job is owned solely by the map
+	for (map<string, ImageDecodeJob*>::iterator i = _jobs.begin(); i != _jobs.end(); i++) {
+		if (i->second->image.pixels != NULL) {
+			free(i->second->image.pixels);
+			i->second->image.pixels = NULL;
+		}
+		delete i->second;
+	}
+	_jobs.clear();
+	_queue.clear();
+
+	if (_job_finished != NULL)
+		SDL_DestroyCond(_job_finished);
+	if (_job_queued != NULL)
+		SDL_DestroyCond(_job_queued);
+	if (_mutex != NULL)
+		SDL_DestroyMutex(_mutex);
+}
+
+
+
+bool ImageDecoder::QueueDecode(const string& filename) {
+	if (_StartThreads() == false)
+		return false;
+
+	SDL_LockMutex(_mutex);
+	if (_jobs.find(filename) == _jobs.end()) {
+		ImageDecodeJob* job = new ImageDecodeJob(filename);
+		_jobs.insert(make_pair(filename, job));
+		_queue.push_back(job);
+		SDL_CondSignal(_job_queued);
+	}
+	SDL_UnlockMutex(_mutex);
+	return true;
+}
+
+
+
+uint32 ImageDecoder::WaitForDecode(const string& filename) {
+	if (_mutex == NULL)
+		return 0;
+
+	uint32 decode_time = 0;
+
+	SDL_LockMutex(_mutex);
+	map<string, ImageDecodeJob*>::iterator i = _jobs.find(filename);
+	if (i != _jobs.end()) {
+		ImageDecodeJob* job = i->second;
+		while (job->finished == false) {
+			SDL_CondWait(_job_finished, _mutex);
+		}
+		decode_time = job->decode_time;
+	}
+	SDL_UnlockMutex(_mutex);
+
+	return decode_time;
+}
+
+
+
+bool ImageDecoder::TakeDecodedImage(const string& filename, ImageMemory& image, bool& success) {
+	if (_mutex == NULL)
+		return false;
+
+	SDL_LockMutex(_mutex);
+	map<string, ImageDecodeJob*>::iterator i = _jobs.find(filename);
+	if (i == _jobs.end()) {
+		SDL_UnlockMutex(_mutex);
+		return false;
+	}
+
+	ImageDecodeJob* job = i->second;
+	while (job->finished == false) {
+		SDL_CondWait(_job_finished, _mutex);
+	}
+	_jobs.erase(filename);
+	SDL_UnlockMutex(_mutex);
+
+	// The job is no longer visible to the worker threads, so it is safe to access without the lock
+	success = job->success;
+	image.width = job->image.width;
+	image.height = job->image.height;
+	image.rgb_format = job->image.rgb_format;
+	image.pixels = job->image.pixels;
+	job->image.pixels = NULL;
+	delete job;
+
+	return true;
+}
+
+
+
+void ImageDecoder::Discard(const string& filename) {
+	if (_mutex == NULL)
+		return;
+
+	SDL_LockMutex(_mutex);
+	map<string, ImageDecodeJob*>::iterator i = _jobs.find(filename);
+	if (i == _jobs.end()) {
+		SDL_UnlockMutex(_mutex);
+		return;
+	}
+
+	ImageDecodeJob* job = i->second;
+	_jobs.erase(i);
+
+	// A job that is in the middle of being decoded is deleted by its worker thread when it finishes
+	if (job->started == true && job->finished == false) {
+		job->discarded = true;
+		SDL_UnlockMutex(_mutex);
+		return;
+	}
+
+	if (job->started == false) {
+		for (deque<ImageDecodeJob*>::iterator j = _queue.begin(); j != _queue.end(); j++) {
+			if (*j == job) {
+				_queue.erase(j);
+				break;
+			}
+		}
+	}
+	SDL_UnlockMutex(_mutex);
+
+	if (job->image.pixels != NULL) {
+		free(job->image.pixels);
+		job->image.pixels = NULL;
+	}
+	delete job;
+}
+
+
+
+bool ImageDecoder::_StartThreads() {
+	if (_threads.empty() == false)
+		return true;
+
+	if (_mutex == NULL) {
+		_mutex = SDL_CreateMutex();
+		_job_queued = SDL_CreateCond();
+		_job_finished = SDL_CreateCond();
+		if (_mutex == NULL || _job_queued == NULL || _job_finished == NULL) {
+			PRINT_ERROR << "failed to create the image decoder synchronization objects: " << SDL_GetError() << endl;
+			return false;
+		}
+	}
+
+	// Leave one core free for the main thread, which will be uploading images while the workers decode
+	int32 cpu_count = SDL_GetCPUCount();
+	uint32 num_threads = (cpu_count > 1) ? static_cast<uint32>(cpu_count - 1) : 1;
+	if (num_threads > MAX_IMAGE_DECODE_THREADS)
+		num_threads = MAX_IMAGE_DECODE_THREADS;
+
+	for (uint32 i = 0; i < num_threads; i++) {
+		SDL_Thread* thread = SDL_CreateThread(_WorkerThreadEntry, "ImageDecoder", this);
+		if (thread == NULL) {
+			IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to create an image decoder thread: " << SDL_GetError() << endl;
+			break;
+		}
+		_threads.push_back(thread);
+	}
+
+	if (_threads.empty() == true) {
+		PRINT_ERROR << "no image decoder threads could be created" << endl;
+		return false;
+	}
+
+	IF_PRINT_DEBUG(VIDEO_DEBUG) << "started " << _threads.size() << " image decoder threads" << endl;
+	return true;
+} // bool ImageDecoder::_StartThreads()
+
+
+
+int ImageDecoder::_WorkerThreadEntry(void* data) {
+	static_cast<ImageDecoder*>(data)->_WorkerThread();
+	return 0;
+}
+
+
+
+void ImageDecoder::_WorkerThread() {
+	SDL_LockMutex(_mutex);
+	while (true) {
+		while (_queue.empty() == true && _shutdown == false) {
+			SDL_CondWait(_job_queued, _mutex);
+		}
+		if (_shutdown == true)
+			break;
+
+		ImageDecodeJob* job = _queue.front();
+		_queue.pop_front();
+		job->started = true;
+		SDL_UnlockMutex(_mutex);
+
+		// No other thread touches the image of a started job until it is marked as finished
+		uint32 start_time = SDL_GetTicks();
+		bool success = job->image.DecodeImage(job->filename);
+		uint32 decode_time = SDL_GetTicks() - start_time;
+
+		SDL_LockMutex(_mutex);
+		job->finished = true;
+		job->success = success;
+		job->decode_time = decode_time;
+
+		if (job->discarded == true) {
+			if (job->image.pixels != NULL) {
+				free(job->image.pixels);
+				job->image.pixels = NULL;
+			}
+			delete job;
+		}
+		else {
+			SDL_CondBroadcast(_job_finished);
+		}
+	}
+	SDL_UnlockMutex(_mutex);
+} // void ImageDecoder::_WorkerThread()
+
+} // namespace private_video
+
+// -----------------------------------------------------------------------------
+// ImageLoadBatch class
+// -----------------------------------------------------------------------------
+
+ImageLoadBatch::~ImageLoadBatch() {
+	for (uint32 i = 0; i < _entries.size(); i++) {
+		TextureManager->_image_decoder.Discard(_entries[i].filename);
+	}
+}
+
+
+
+void ImageLoadBatch::AddImage(StillImage* image, const string& filename) {
+	if (image == NULL) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "NULL image argument for file: " << filename << endl;
+		return;
+	}
+
+	BatchEntry entry;
+	entry.image = image;
+	entry.multi_images = NULL;
+	entry.filename = filename;
+	entry.grid_rows = 0;
+	entry.grid_cols = 0;
+	_entries.push_back(entry);
+
+	// Images which are already in texture memory do not need to be decoded again
+	if (TextureManager->_IsImageTextureRegistered(filename) == false)
+		TextureManager->_image_decoder.QueueDecode(filename);
+}
+
+
+
+void ImageLoadBatch::AddMultiImage(vector<StillImage>* images, const string& filename, const uint32 grid_rows, const uint32 grid_cols) {
+	if (images == NULL) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "NULL image vector argument for file: " << filename << endl;
+		return;
+	}
+
+	BatchEntry entry;
+	entry.image = NULL;
+	entry.multi_images = images;
+	entry.filename = filename;
+	entry.grid_rows = grid_rows;
+	entry.grid_cols = grid_cols;
+	_entries.push_back(entry);
+
+	// Multi images whose elements are all in texture memory are not read at all, and images in the atlas cache
+	// are uploaded directly from the cache file. Neither of these has anything to decode.
+	if (TextureManager->_IsMultiImageRegistered(filename, grid_rows, grid_cols) == false
+		&& TextureManager->_atlas_cache.IsCached(filename) == false)
+	{
+		TextureManager->_image_decoder.QueueDecode(filename);
+	}
+}
+
+
+
+bool ImageLoadBatch::Finish() {
+	bool success = true;
+	uint32 decode_time = 0;
+
+	// Stage 1: wait for the worker threads to finish decoding every file
+	uint32 wait_start = SDL_GetTicks();
+	for (uint32 i = 0; i < _entries.size(); i++) {
+		decode_time += TextureManager->_image_decoder.WaitForDecode(_entries[i].filename);
+	}
+	uint32 wait_time = SDL_GetTicks() - wait_start;
+
+	// Stage 2: upload the images. Each load claims its decoded data from the decoder through ImageMemory::LoadImage()
+	uint32 upload_start = SDL_GetTicks();
+	for (uint32 i = 0; i < _entries.size(); i++) {
+		BatchEntry& entry = _entries[i];
+
+		if (entry.image != NULL) {
+			if (entry.image->Load(entry.filename) == false) {
+				IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to load image file: " << entry.filename << endl;
+				success = false;
+			}
+		}
+		else {
+			if (ImageDescriptor::LoadMultiImageFromElementGrid(*entry.multi_images, entry.filename, entry.grid_rows, entry.grid_cols) == false) {
+				IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to load multi image file: " << entry.filename << endl;
+				success = false;
+			}
+		}
+
+		// Free any decoded data that the load did not claim, which happens when the image was already in texture memory
+		TextureManager->_image_decoder.Discard(entry.filename);
+	}
+	uint32 upload_time = SDL_GetTicks() - upload_start;
+
+	IF_PRINT_DEBUG(VIDEO_DEBUG) << "loaded " << _entries.size() << " image files -- decode: " << decode_time
+		<< "ms across " << TextureManager->_image_decoder.GetNumberThreads() << " threads, wait: " << wait_time
+		<< "ms, upload: " << upload_time << "ms" << endl;
+
+	_entries.clear();
+	return success;
+} // bool ImageLoadBatch::Finish()
+
+} // namespace hoa_video
@@ -0,0 +1,234 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2015 by The Allacrost Project
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    image_decoder.h
+*** \author  Tyler Olsen, roots@allacrost.org
+*** \brief   Header file for background image decoding
+***
+*** Decoding a PNG or JPG file into raw pixel data is by far the most expensive
+*** part of loading an image, and it does not require the OpenGL context. This
+*** file contains a small pool of worker threads that decode image files ahead
+*** of time, and a batch class that allows a set of images to be decoded in
+*** parallel and then uploaded to texture memory together on the main thread.
+*** ***************************************************************************/
+
+#ifndef __IMAGE_DECODER_HEADER__
+#define __IMAGE_DECODER_HEADER__
+
+#include <deque>
+
+#include <SDL2/SDL_thread.h>
+#include <SDL2/SDL_mutex.h>
+
+#include "defs.h"
+#include "utils.h"
+
+#include "image_base.h"
+
+namespace hoa_video {
+
+namespace private_video {
+
+//! \brief The maximum number of worker threads that the image decoder will create
+const uint32 MAX_IMAGE_DECODE_THREADS = 4;
+
+/** ****************************************************************************
+*** \brief The state of a single image file that was queued for decoding
+***
+*** \note Every member of this class is protected by the decoder's mutex
+*** ***************************************************************************/
+class ImageDecodeJob {
+public:
+	ImageDecodeJob(const std::string& file) :
+		filename(file), started(false), finished(false), success(false), discarded(false), decode_time(0) {}
+
+	//! \brief The name of the image file to decode
+	std::string filename;
+
+	//! \brief Holds the decoded pixel data once the job has finished
+	ImageMemory image;
+
+	//! \brief Set to true when a worker thread begins decoding the file
+	bool started;
+
+	//! \brief Set to true when the worker thread has finished with the file, successfully or not
+	bool finished;
+
+	//! \brief Set to true if the file was decoded successfully
+	bool success;
+
+	//! \brief Set to true if nobody is interested in the result of a job that is still being decoded
+	bool discarded;
+
+	//! \brief The number of milliseconds that the worker thread spent decoding the file
+	uint32 decode_time;
+}; // class ImageDecodeJob
+
+
+/** ****************************************************************************
+*** \brief Decodes image files into system memory on a pool of worker threads
+***
+*** Only the decoding of the file into an ImageMemory object takes place on the
+*** worker threads. Nothing in this class touches OpenGL or any of the texture
+*** management structures, so the decoded data must still be uploaded to a texture
+*** sheet on the main thread. ImageMemory::LoadImage() checks with the decoder
+*** before reading a file from disk, so any image loaded through the ordinary
+*** load calls will pick up data that was decoded ahead of time.
+***
+*** The worker threads are not created until the first file is queued, so a
+*** game which never makes use of background decoding pays nothing for it.
+***
+*** \note The TextureController owns the single instance of this class.
+*** ***************************************************************************/
+class ImageDecoder {
+public:
+	ImageDecoder();
+
+	//! \brief Stops all worker threads and frees any decoded data that was never claimed
+	~ImageDecoder();
+
+	/** \brief Adds an image file to the queue of files to be decoded
+	*** \param filename The name of the image file to decode
+	*** \return False if the worker threads could not be started
+	*** \note Queueing a file which is already queued or decoded has no effect
+	**/
+	bool QueueDecode(const std::string& filename);
+
+	/** \brief Blocks until a queued file has finished decoding
+	*** \param filename The name of the queued image file
+	*** \return The number of milliseconds that the worker spent decoding the file
+	**/
+	uint32 WaitForDecode(const std::string& filename);
+
+	/** \brief Claims the decoded data for a file, waiting for the decode to finish if necessary
+	*** \param filename The name of the queued image file
+	*** \param image The ImageMemory object to move the decoded data into. Its pixels member must be NULL.
+	*** \param success Set to true if the file was decoded successfully
+	*** \return False if the file was never queued, in which case the caller must decode it itself
+	***
+	*** Ownership of the pixel data passes to the caller. The job is removed from the decoder, so a
+	*** second call with the same filename will return false.
+	**/
+	bool TakeDecodedImage(const std::string& filename, ImageMemory& image, bool& success);
+
+	/** \brief Removes a queued file from the decoder, freeing any data that was decoded for it
+	*** \param filename The name of the queued image file
+	*** \note This does not block. A file which is being decoded is freed by its worker when it finishes.
+	**/
+	void Discard(const std::string& filename);
+
+	//! \brief Returns the number of worker threads that have been created
+	uint32 GetNumberThreads() const
+		{ return _threads.size(); }
+
+private:
+	//! \brief The worker threads
+	std::vector<SDL_Thread*> _threads;
+
+	//! \brief Protects every other member of this class, as well as the contents of all jobs
+	SDL_mutex* _mutex;
+
+	//! \brief Signalled when a new job is queued or when the workers are to shut down
+	SDL_cond* _job_queued;
+
+	//! \brief Signalled when a worker has finished a job
+	SDL_cond* _job_finished;
+
+	//! \brief Jobs that are waiting to be picked up by a worker thread
+	std::deque<ImageDecodeJob*> _queue;
+
+	//! \brief All jobs that have not yet been claimed or discarded, indexed by filename
+	std::map<std::string, ImageDecodeJob*> _jobs;
+
+	//! \brief Set to true when the worker threads should exit
+	bool _shutdown;
+
+	//! \brief Creates the worker threads if they do not already exist
+	bool _StartThreads();
+
+	//! \brief The entry point of each worker thread. The data argument is a pointer to the ImageDecoder.
+	static int _WorkerThreadEntry(void* data);
+
+	//! \brief Pulls jobs off of the queue and decodes them until the decoder shuts down
+	void _WorkerThread();
+}; // class ImageDecoder
+
+} // namespace private_video
+
+
+/** ****************************************************************************
+*** \brief Loads a set of images with decoding performed in parallel
+***
+*** Images are added to the batch one at a time, which immediately queues their
+*** files for decoding on the worker threads. Nothing is written to the images
+*** until Finish() is called. Finish() waits for all of the files to be decoded
+*** and then uploads each image to texture memory on the calling thread, which
+*** must be the thread that owns the OpenGL context. The time spent in each stage
+*** of the load is printed when video debugging is enabled.
+***
+*** \note The images and image vectors passed to the batch must remain valid until
+*** Finish() returns. Destroying a batch before calling Finish() discards any
+*** decoded data without loading any of the images.
+*** ***************************************************************************/
+class ImageLoadBatch {
+public:
+	ImageLoadBatch()
+		{}
+
+	~ImageLoadBatch();
+
+	/** \brief Adds a single image to the batch
+	*** \param image A pointer to the image to load
+	*** \param filename The name of the image file to load
+	**/
+	void AddImage(StillImage* image, const std::string& filename);
+
+	/** \brief Adds a multi image to the batch, which will be split into a grid of images
+	*** \param images A pointer to the vector of images to load, as passed to ImageDescriptor::LoadMultiImageFromElementGrid()
+	*** \param filename The name of the multi image file to load
+	*** \param grid_rows The number of rows of elements in the multi image
+	*** \param grid_cols The number of columns of elements in the multi image
+	**/
+	void AddMultiImage(std::vector<StillImage>* images, const std::string& filename, const uint32 grid_rows, const uint32 grid_cols);
+
+	/** \brief Waits for all images in the batch to be decoded and loads them into texture memory
+	*** \return True only if every image in the batch was loaded successfully
+	*** \note The batch is empty after this call returns and may be reused
+	**/
+	bool Finish();
+
+	//! \brief Returns the number of files that are waiting to be loaded by the batch
+	uint32 GetNumberImages() const
+		{ return _entries.size(); }
+
+private:
+	//! \brief An image or multi image which was added to the batch
+	class BatchEntry {
+	public:
+		//! \brief The image to load, or NULL if this entry is for a multi image
+		StillImage* image;
+
+		//! \brief The vector of images to load a multi image into, or NULL if this entry is for a single image
+		std::vector<StillImage>* multi_images;
+
+		//! \brief The name of the image file
+		std::string filename;
+
+		//! \brief The grid dimensions of a multi image
+		uint32 grid_rows, grid_cols;
+	};
+
+	//! \brief The images that have been added to the batch since the last call to Finish()
+	std::vector<BatchEntry> _entries;
+}; // class ImageLoadBatch
+
+} // namespace hoa_video
+
+#endif // __IMAGE_DECODER_HEADER__
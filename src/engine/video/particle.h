@@ -12,11 +12,12 @@
  * \author  Raj Sharma, roos@allacrost.org
  * \brief   Header file for particle data
  *
- * This file contains structure(s) for representing a single particle. In theory,
- * we should be able to just have one structure which holds all properties for
- * a particle, but in fact we have two: one for the position, and one for everything
- * else. The reason is that having the positions separated is more efficient
- * for rendering.
+ * This file contains the structures for representing particles. The properties
+ * of all particles in a system are stored together as one array per property
+ * (structure of arrays), which lets the update code process several particles
+ * with each instruction and keeps the data used by each loop packed together.
+ * The vertex and texture coordinate structures below are what gets fed to
+ * OpenGL for rendering.
  *****************************************************************************/
 
 #ifndef __PARTICLE_HEADER__
@@ -69,101 +70,272 @@ public:
 
 
 /*!***************************************************************************
- *  \brief this is the structure we use to represent a particle
+ *  \brief identifies each of the per-particle float streams stored in a
+ *         ParticleArray. Every property of a particle lives in its own
+ *         contiguous array, so that the update loops can process several
+ *         particles at once with SIMD instructions.
  *****************************************************************************/
 
-
-class Particle
+enum ParticleStream
 {
-public:
-
 	//! position
-	float  x;
-	float  y;
-	
+	PARTICLE_X = 0,
+	PARTICLE_Y,
+
 	//! size
-	float  size_x;
-	float  size_y;
-	
+	PARTICLE_SIZE_X,
+	PARTICLE_SIZE_Y,
+
 	//! velocity
-	float  velocity_x;
-	float  velocity_y;
-	
+	PARTICLE_VELOCITY_X,
+	PARTICLE_VELOCITY_Y,
+
 	//! store the combined velocity (particle + wind + wave) so we only have
 	//! to calculate it once
-	float combined_velocity_x;
-	float combined_velocity_y;
-	
+	PARTICLE_COMBINED_VELOCITY_X,
+	PARTICLE_COMBINED_VELOCITY_Y,
+
 	//! color
-	Color  color;
-		
-	//! current rotation angle
-	float  rotation_angle;
-	
-	//! rotation speed
-	float  rotation_speed;
-	
-	//! seconds since particle was spawned
-	float  time;
-	
-	//! lifetime (when the particle is supposed to die)
-	float  lifetime;
-	
-	//! this is 2 * pi / wavelength. The reason we store this weird
-	//! number instead of the wavelength is because that's what we
-	//! will ultimately plug into the sin function
-	float wave_length_coefficient;	
-	
-	//! half the amplitude of the wave. We store half the amplitude
-	//! instead of the whole amplitude because that's what gets multiplied
-	//! with the sin function
-	float wave_half_amplitude;
+	PARTICLE_COLOR_R,
+	PARTICLE_COLOR_G,
+	PARTICLE_COLOR_B,
+	PARTICLE_COLOR_A,
+
+	//! current rotation angle and rotation speed
+	PARTICLE_ROTATION_ANGLE,
+	PARTICLE_ROTATION_SPEED,
+
+	//! when a particle is created, it is given a rotation direction: either
+	//! 1 (clockwise) or -1 (counterclockwise)
+	PARTICLE_ROTATION_DIRECTION,
+
+	//! seconds since particle was spawned, and when the particle is supposed to die
+	PARTICLE_TIME,
+	PARTICLE_LIFETIME,
+
+	//! this is 2 * pi / wavelength, and half the amplitude of the wave. These are
+	//! stored because they are what ultimately gets plugged into the sin function
+	PARTICLE_WAVE_LENGTH_COEFFICIENT,
+	PARTICLE_WAVE_HALF_AMPLITUDE,
 
 	//! acceleration, i.e. change in velocity per second. The most common use
-	//! for this is for simulating gravity. If you have multiple constant
-	//! forces acting on particles, then this vector should be the sum of
-	//! those forces.
-	float acceleration_x;
-	float acceleration_y;
-	
-	//! tangential acceleration- just like normal acceleration, except it
-	//! is applied in the tangent direction. positive = clockwise.
-	float tangential_acceleration;
-	
-	//! radial acceleration- acceleration towards (negative) or away (positive)
-	//! from an attractor. Note that the default attractor is the emitter position.
-	//! The client can set an attractor for the entire effect by calling
-	//! ParticleEffect::SetAttractor(x,y)
-	float radial_acceleration;
-	
+	//! for this is for simulating gravity.
+	PARTICLE_ACCELERATION_X,
+	PARTICLE_ACCELERATION_Y,
+
+	//! tangential acceleration (positive = clockwise) and radial acceleration
+	//! (positive = away from the attractor)
+	PARTICLE_TANGENTIAL_ACCELERATION,
+	PARTICLE_RADIAL_ACCELERATION,
+
 	//! wind velocity. this gets added to the particle's velocity each frame.
-	//! note that different particles might also have a slightly different wind
-	//! velocity, if the system has some wind velocity variation	
-	float wind_velocity_x;
-	float wind_velocity_y;
-	
+	PARTICLE_WIND_VELOCITY_X,
+	PARTICLE_WIND_VELOCITY_Y,
+
 	//! damping- the particle's velocity gets multiplied by this value each second.
-	//! So for example, a damping of .6 means that a particle slows down by 40% each
-	//! second.
-	float damping;	
-	
-	//! when a particle is created, it is given a rotation direction: either
-	//! 1 (clockwise) or -1 (counterclockwise)
-	float rotation_direction;
-		
-	//! property variations	
-	float current_size_variation_x;
-	float current_size_variation_y;
-	float next_size_variation_x;
-	float next_size_variation_y;	
-	float current_rotation_speed_variation;
-	float next_rotation_speed_variation;	
-	Color current_color_variation;
-	Color next_color_variation;
-	
-	//! keep track of current and next keyframes
-	ParticleKeyframe *current_keyframe;
-	ParticleKeyframe *next_keyframe;
+	PARTICLE_DAMPING,
+
+	//! the scaled time (0.0 to 1.0 over the particle's lifetime) of the current
+	//! keyframe, the scaled time at which the next keyframe is reached, and the
+	//! inverse of the difference between the two. When there is no next keyframe
+	//! the inverse is zero, so that interpolation always yields the start values.
+	PARTICLE_KEYFRAME_TIME,
+	PARTICLE_NEXT_KEYFRAME_TIME,
+	PARTICLE_KEYFRAME_INVERSE_DURATION,
+
+	//! the keyframed properties at the current keyframe and at the next keyframe,
+	//! with the random variations for this particle already applied. The keyframed
+	//! properties are interpolated between these start and end values.
+	PARTICLE_START_ROTATION_SPEED,
+	PARTICLE_END_ROTATION_SPEED,
+	PARTICLE_START_SIZE_X,
+	PARTICLE_END_SIZE_X,
+	PARTICLE_START_SIZE_Y,
+	PARTICLE_END_SIZE_Y,
+	PARTICLE_START_COLOR_R,
+	PARTICLE_END_COLOR_R,
+	PARTICLE_START_COLOR_G,
+	PARTICLE_END_COLOR_G,
+	PARTICLE_START_COLOR_B,
+	PARTICLE_END_COLOR_B,
+	PARTICLE_START_COLOR_A,
+	PARTICLE_END_COLOR_A,
+
+	PARTICLE_STREAM_TOTAL
+};
+
+
+//! SSE is used for the particle update code on any x86 compiler target which guarantees it.
+//! Otherwise, the same code is compiled as ordinary loops.
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#define PARTICLE_USE_SSE
+#endif
+
+
+//! the number of particles that are processed together by the SIMD update code.
+//! The length of every stream in a ParticleArray is a multiple of this number.
+const int32 PARTICLE_SIMD_WIDTH = 4;
+
+
+/*!***************************************************************************
+ *  \brief this is the structure we use to represent the particles of a
+ *         system. The properties of every particle are stored as a set of
+ *         streams (one array per property) in a single block of memory. Each
+ *         stream is aligned to 16 bytes and padded out to a multiple of
+ *         PARTICLE_SIMD_WIDTH particles, so the update loops may always work on
+ *         whole groups of particles, even past the last live particle.
+ *****************************************************************************/
+
+class ParticleArray
+{
+public:
+
+	ParticleArray();
+
+	~ParticleArray();
+
+	/*!
+	 *  \brief allocates room for the given number of particles. All streams
+	 *         are zeroed, and any previous contents are lost.
+	 * \param capacity the maximum number of particles that the array can hold
+	 */
+	void Allocate(int32 capacity);
+
+	/*!
+	 *  \brief frees all memory used by the array
+	 */
+	void Clear();
+
+	/*!
+	 *  \brief returns a pointer to the start of a property stream
+	 * \param stream the property to retrieve
+	 */
+	float *Stream(ParticleStream stream)
+	{ return _streams + stream * _stride; }
+
+	const float *Stream(ParticleStream stream) const
+	{ return _streams + stream * _stride; }
+
+	/*!
+	 *  \brief copies every property of the particle at index src to index dest
+	 */
+	void Move(int32 src, int32 dest);
+
+	/*!
+	 *  \brief returns the number of particles that can be held by the array
+	 */
+	int32 GetCapacity() const
+	{ return _capacity; }
+
+	/*!
+	 *  \brief returns the number of particles held by the array rounded up to a
+	 *         multiple of PARTICLE_SIMD_WIDTH
+	 */
+	int32 GetStride() const
+	{ return _stride; }
+
+	//! index of the next keyframe of each particle within the system definition's
+	//! keyframes. If it equals the number of keyframes, the particle is on the last one.
+	std::vector<int32> next_keyframe;
+
+private:
+
+	//! the requested number of particles, and the length of each stream
+	int32 _capacity;
+	int32 _stride;
+
+	//! the memory block returned by calloc, and the 16 byte aligned start of the streams within it
+	void  *_memory;
+	float *_streams;
+
+	ParticleArray(const ParticleArray &);
+	ParticleArray &operator=(const ParticleArray &);
+};
+
+
+/*!***************************************************************************
+ *  \brief holds the texture coordinate array for a system's particle quads.
+ *         Every particle uses the same coordinates, so the array is only
+ *         regenerated when the coordinates change or when there are more
+ *         particles than have been filled in so far.
+ *****************************************************************************/
+
+class ParticleTexCoordArray
+{
+public:
+
+	ParticleTexCoordArray() :
+		_num_filled(0),
+		_u1(0.0f),
+		_v1(0.0f),
+		_u2(0.0f),
+		_v2(0.0f)
+	{}
+
+	/*!
+	 *  \brief resizes the array to hold the given number of particles. All
+	 *         coordinates must be filled in again afterwards.
+	 */
+	void Resize(int32 max_particles)
+	{ coords.resize(max_particles * 4); _num_filled = 0; }
+
+	/*!
+	 *  \brief makes sure that the first num_particles quads use the given
+	 *         texture coordinates
+	 */
+	void Fill(int32 num_particles, float u1, float v1, float u2, float v2);
+
+	//! four texture coordinates for each particle, in the same order as the vertices
+	std::vector<ParticleTexCoord> coords;
+
+private:
+
+	//! the number of particles whose coordinates are filled in, and the coordinates that they use
+	int32 _num_filled;
+	float _u1, _v1, _u2, _v2;
+};
+
+
+/*!***************************************************************************
+ *  \brief a small random number generator owned by each particle system.
+ *         Systems are updated in parallel, so they can not share the global
+ *         rand() state. Giving every system its own seeded stream also makes
+ *         a system's behavior independent of which thread updates it, or of
+ *         the order in which systems are updated.
+ *****************************************************************************/
+
+class ParticleRandom
+{
+public:
+
+	ParticleRandom() :
+		_state(1)
+	{}
+
+	//! restarts the stream from the given seed
+	void Seed(uint32 seed)
+	{ _state = (seed != 0) ? seed : 0x9E3779B9; }
+
+	//! returns the next number in the stream (32-bit xorshift)
+	uint32 Next()
+	{
+		_state ^= _state << 13;
+		_state ^= _state >> 17;
+		_state ^= _state << 5;
+		return _state;
+	}
+
+	//! returns a random float between a and b, inclusive. The bounds may be given in either order.
+	float Float(float a, float b)
+	{ return a + (b - a) * (static_cast<float>(Next() >> 8) * (1.0f / 16777215.0f)); }
+
+	//! returns either -1.0f or 1.0f
+	float Sign()
+	{ return (Next() & 0x80000000) ? 1.0f : -1.0f; }
+
+private:
+
+	uint32 _state;
 };
 
 }
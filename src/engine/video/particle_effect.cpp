@@ -12,6 +12,7 @@
 
 #include "particle_effect.h"
 #include "particle_system.h"
+#include "particle_update_pool.h"
 
 using namespace std;
 using namespace hoa_script;
@@ -70,25 +71,24 @@ bool ParticleEffect::_Draw() {
 
 
 //-----------------------------------------------------------------------------
-// Update: updates particle effect. Called by ParticleManager, not by user.
+// _PrepareUpdate: removes dead systems and queues the remaining ones to be
+//                 updated. Called by ParticleManager, not by user.
 //-----------------------------------------------------------------------------
 
-bool ParticleEffect::_Update(float frame_time) {
+void ParticleEffect::_PrepareUpdate(float frame_time, vector<ParticleUpdateJob> &jobs) {
 	_age += frame_time;
-	_num_particles = 0;
 
 	if (!_alive)
-		return true;
-
-	bool success = true;
+		return;
 
-	private_video::EffectParameters effect_parameters;
-	effect_parameters.orientation = _orientation;
+	private_video::ParticleUpdateJob job;
+	job.success = true;
+	job.parameters.orientation = _orientation;
 
 	// note we subtract the effect position to put the attractor point in effect
 	// space instead of screen space
-	effect_parameters.attractor_x = _attractor_x - _x;
-	effect_parameters.attractor_y = _attractor_y - _y;
+	job.parameters.attractor_x = _attractor_x - _x;
+	job.parameters.attractor_y = _attractor_y - _y;
 
 	list<ParticleSystem *>::iterator iSystem = _systems.begin();
 
@@ -101,18 +101,31 @@ bool ParticleEffect::_Update(float frame_time) {
 				_alive = false;
 		}
 		else {
-			if (!(*iSystem)->Update(frame_time, effect_parameters)) {
-				success = false;
-				if(VIDEO_DEBUG)
-					cerr << "VIDEO ERROR: failed to update system in ParticleEffect::_Update()" << endl;
-			}
-
-			_num_particles += (*iSystem)->GetNumParticles();
+			job.system = *iSystem;
+			jobs.push_back(job);
 			++iSystem;
 		}
 	}
+}
 
-	return success;
+
+//-----------------------------------------------------------------------------
+// _FinishUpdate: counts the particles of the updated systems. Called by
+//                ParticleManager, not by user.
+//-----------------------------------------------------------------------------
+
+void ParticleEffect::_FinishUpdate() {
+	_num_particles = 0;
+
+	if (!_alive)
+		return;
+
+	list<ParticleSystem *>::iterator iSystem = _systems.begin();
+
+	while (iSystem != _systems.end()) {
+		_num_particles += (*iSystem)->GetNumParticles();
+		++iSystem;
+	}
 }
 
 
@@ -172,12 +172,20 @@ private:
 
 
 	/*!
-	 *  \brief updates the effect. This is private so that only the ParticleManager class
-	 *         can update effects.
-	 * \param the new frame time
-	 * \return success/failure
-	 */			
-	bool _Update(float frame_time);
+	 *  \brief prepares the effect for an update. This is private so that only the
+	 *         ParticleManager class can update effects. The systems themselves are
+	 *         not updated here. Instead, a job is added for each of them so that the
+	 *         manager can update the systems of all effects together.
+	 * \param frame_time the new frame time
+	 * \param jobs the list of systems to update this frame, which the effect's systems are added to
+	 */
+	void _PrepareUpdate(float frame_time, std::vector<private_video::ParticleUpdateJob> &jobs);
+
+
+	/*!
+	 *  \brief finishes an update once the effect's systems have been updated
+	 */
+	void _FinishUpdate();
 
 
 	/*!
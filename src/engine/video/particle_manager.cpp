@@ -13,6 +13,7 @@
 #include "particle_manager.h"
 #include "particle_effect.h"
 #include "particle_system.h"
+#include "particle_update_pool.h"
 #include "particle_keyframe.h"
 
 using namespace std;
@@ -306,7 +307,7 @@ ParticleEffectID ParticleManager::AddEffect(const ParticleEffectDef* definition,
 		return VIDEO_INVALID_EFFECT;
 	}
 
-	ParticleEffect* effect = _CreateEffect(definition);
+	ParticleEffect* effect = _CreateEffect(definition, _current_id);
 	if (effect == NULL) {
 		IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to add effect because the effect failed to create from the particle definition" << endl;
 		return VIDEO_INVALID_EFFECT;
@@ -327,6 +328,8 @@ bool ParticleManager::Update(int32 frame_time) {
 	bool success = true;
 	_num_particles = 0;
 
+	// Gather the systems of every effect so that they can all be updated together
+	vector<ParticleUpdateJob> jobs;
 	for (map<ParticleEffectID, ParticleEffect*>::iterator i = _effects.begin(); i != _effects.end();) {
 		// Remove any particle effects that have completed their life cycle
 		if ((i->second)->IsAlive() == false) {
@@ -335,16 +338,25 @@ bool ParticleManager::Update(int32 frame_time) {
 			_effects.erase(finished_effect);
 		}
 		else {
-			if ((i->second)->_Update(frame_time_seconds) == false) {
-				success = false;
-				IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to update particle effect with ID #" << i->first << endl;
-			}
-
-			_num_particles += i->second->GetNumParticles();
+			(i->second)->_PrepareUpdate(frame_time_seconds, jobs);
 			++i;
 		}
 	}
 
+	_update_pool.Run(jobs, frame_time_seconds);
+
+	for (uint32 i = 0; i < jobs.size(); ++i) {
+		if (jobs[i].success == false) {
+			success = false;
+			IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to update a particle system" << endl;
+		}
+	}
+
+	for (map<ParticleEffectID, ParticleEffect*>::iterator i = _effects.begin(); i != _effects.end(); ++i) {
+		(i->second)->_FinishUpdate();
+		_num_particles += i->second->GetNumParticles();
+	}
+
 	return success;
 }
 
@@ -403,7 +415,7 @@ void ParticleManager::Destroy() {
 
 
 
-ParticleEffect *ParticleManager::_CreateEffect(const ParticleEffectDef *definition) {
+ParticleEffect *ParticleManager::_CreateEffect(const ParticleEffectDef *definition, ParticleEffectID id) {
 	if (definition == NULL) {
 		return NULL;
 	}
@@ -415,14 +427,22 @@ ParticleEffect *ParticleManager::_CreateEffect(const ParticleEffectDef *definiti
 	ParticleEffect* effect = new ParticleEffect;
 	effect->_effect_def = definition;
 
-	for (list<ParticleSystemDef*>::const_iterator i = definition->_systems.begin(); i != definition->_systems.end(); ++i) {
+	uint32 system_index = 0;
+	for (list<ParticleSystemDef*>::const_iterator i = definition->_systems.begin(); i != definition->_systems.end(); ++i, ++system_index) {
 		if ((*i)->enabled == false) {
 			continue;
 		}
 
+		// Each system's random number stream is seeded from the effect ID and the system's position in the
+		// effect, so that the same effect always plays out the same way regardless of how it is updated
+		uint32 seed = static_cast<uint32>(id) * 0x9E3779B9 + system_index * 0x85EBCA6B + 1;
+		seed ^= seed >> 16;
+		seed *= 0x7FEB352D;
+		seed ^= seed >> 15;
+
 		ParticleSystem* system = new ParticleSystem;
 		// If any systems fail to create, delete all allocated resources and bail
-		if (system->Create(*i) == false) {
+		if (system->Create(*i, seed) == false) {
 			IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to create particle system for effect. The effect was not created." << endl;
 			system->Destroy();
 			delete system;
@@ -23,6 +23,8 @@
 #include "defs.h"
 #include "utils.h"
 
+#include "particle_update_pool.h"
+
 //! \brief A particle effet ID is an int
 typedef int32 ParticleEffectID;
 
@@ -39,7 +41,7 @@ namespace private_video {
 class ParticleManager {
 public:
 	ParticleManager()
-		{ _current_id = 0; }
+		{ _current_id = 0; _num_particles = 0; }
 
 	/** \brief Loads an effect definition from a particle file
 	*** \param filename The file to load the effect definition from
@@ -58,6 +60,8 @@ public:
 	/** \brief Updates all active particle effects
 	*** \param frame_time The number of milliseconds to update the effects by
 	*** \return True if all effects were updated successfully
+	***
+	*** The systems of every effect are updated together across the threads of the update pool.
 	**/
 	bool Update(int32 frame_time);
 
@@ -74,6 +78,16 @@ public:
 	**/
 	void StopAll(bool kill_immediately = false);
 
+	/** \brief Sets the number of threads used to update particle systems
+	*** \param num_threads The number of threads, including the main thread. Zero picks a number based on the number of CPU cores.
+	**/
+	void SetNumberUpdateThreads(uint32 num_threads)
+		{ _update_pool.SetNumberThreads(num_threads); }
+
+	//! \brief Returns the number of threads used to update particle systems
+	uint32 GetNumberUpdateThreads() const
+		{ return _update_pool.GetNumberThreads(); }
+
 	//! \brief Returns the total number of particles among all active effects
 	int32 GetNumParticles()
 		{ return _num_particles; }
@@ -105,11 +119,15 @@ private:
 	//! we can convert easily between an id and a pointer
 	std::map<ParticleEffectID, ParticleEffect*> _effects;
 
+	//! Updates the particle systems of all effects in parallel
+	ParticleUpdatePool _update_pool;
+
 	/** \brief Creates a new particle effect from a provided effect definition
 	*** \param definition A pointer to the definition data of the effect
+	*** \param id The ID that the effect will be given, which is used to seed the random number stream of each of its systems
 	*** \return A pointer to the created ParticleEffect object
 	**/
-	ParticleEffect* _CreateEffect(const ParticleEffectDef *definition);
+	ParticleEffect* _CreateEffect(const ParticleEffectDef *definition, ParticleEffectID id);
 
 	/** \brief A helper function that is used to read a table of color data (four floats)
 	*** \param script A reference to the script to read the data from
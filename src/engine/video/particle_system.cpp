@@ -7,11 +7,17 @@
 // See http://www.gnu.org/copyleft/gpl.html for details.
 ///////////////////////////////////////////////////////////////////////////////
 
+#include <cfloat>
+
 #include "video.h"
 
 #include "particle_system.h"
 #include "particle_keyframe.h"
 
+#ifdef PARTICLE_USE_SSE
+	#include <xmmintrin.h>
+#endif
+
 using namespace std;
 using namespace hoa_utils;
 
@@ -21,6 +27,264 @@ namespace hoa_video
 namespace private_video
 {
 
+//! the next keyframe time given to particles which are on their last keyframe, so that they never advance
+const float PARTICLE_NO_KEYFRAME_TIME = FLT_MAX;
+
+
+//-----------------------------------------------------------------------------
+// ParticleArray
+//-----------------------------------------------------------------------------
+
+ParticleArray::ParticleArray() :
+	_capacity(0),
+	_stride(0),
+	_memory(NULL),
+	_streams(NULL)
+{
+}
+
+
+
+ParticleArray::~ParticleArray()
+{
+	Clear();
+}
+
+
+
+void ParticleArray::Allocate(int32 capacity)
+{
+	Clear();
+
+	if(capacity <= 0)
+		return;
+
+	_capacity = capacity;
+	_stride = (capacity + PARTICLE_SIMD_WIDTH - 1) / PARTICLE_SIMD_WIDTH * PARTICLE_SIMD_WIDTH;
+
+	// allocate an extra 16 bytes so the start of the streams can be aligned for SIMD loads and stores.
+	// Since the stride is a multiple of 4 floats, every stream after the first is also aligned.
+	size_t stream_bytes = _stride * PARTICLE_STREAM_TOTAL * sizeof(float);
+	_memory = calloc(stream_bytes + 16, 1);
+	if(_memory == NULL)
+	{
+		PRINT_ERROR << "failed to allocate memory for " << capacity << " particles" << endl;
+		_capacity = 0;
+		_stride = 0;
+		return;
+	}
+
+	size_t address = reinterpret_cast<size_t>(_memory);
+	_streams = reinterpret_cast<float *>((address + 15) & ~static_cast<size_t>(15));
+
+	next_keyframe.assign(_stride, 0);
+}
+
+
+
+void ParticleArray::Clear()
+{
+	free(_memory);
+	_memory = NULL;
+	_streams = NULL;
+	_capacity = 0;
+	_stride = 0;
+	next_keyframe.clear();
+}
+
+
+
+void ParticleArray::Move(int32 src, int32 dest)
+{
+	for(int32 s = 0; s < PARTICLE_STREAM_TOTAL; ++s)
+		_streams[s * _stride + dest] = _streams[s * _stride + src];
+
+	next_keyframe[dest] = next_keyframe[src];
+}
+
+
+//-----------------------------------------------------------------------------
+// ParticleTexCoordArray
+//-----------------------------------------------------------------------------
+
+void ParticleTexCoordArray::Fill(int32 num_particles, float u1, float v1, float u2, float v2)
+{
+	// the texture coordinates are the same for every particle, so only particles which have never
+	// been given the current coordinates need to be filled in
+	int32 first = _num_filled;
+	if (u1 != _u1 || v1 != _v1 || u2 != _u2 || v2 != _v2)
+		first = 0;
+
+	int32 t = first * 4;
+	for (int32 j = first; j < num_particles; ++j) {
+		// upper-left
+		coords[t]._t0 = u1;
+		coords[t]._t1 = v1;
+		++t;
+
+		// upper-right
+		coords[t]._t0 = u2;
+		coords[t]._t1 = v1;
+		++t;
+
+		// lower-right
+		coords[t]._t0 = u2;
+		coords[t]._t1 = v2;
+		++t;
+
+		// lower-left
+		coords[t]._t0 = u1;
+		coords[t]._t1 = v2;
+		++t;
+	}
+
+	_num_filled = max(first, num_particles);
+	_u1 = u1;
+	_v1 = v1;
+	_u2 = u2;
+	_v2 = v2;
+}
+
+
+//-----------------------------------------------------------------------------
+// Update kernels: these operate on whole groups of PARTICLE_SIMD_WIDTH
+// particles, so count must be a multiple of it. When SSE is not available,
+// the same operations are performed one particle at a time.
+//-----------------------------------------------------------------------------
+
+//! the keyframed properties, paired with the streams that hold their start and end values
+static const ParticleStream KEYFRAMED_STREAMS[][3] =
+{
+	{ PARTICLE_ROTATION_SPEED, PARTICLE_START_ROTATION_SPEED, PARTICLE_END_ROTATION_SPEED },
+	{ PARTICLE_SIZE_X,         PARTICLE_START_SIZE_X,         PARTICLE_END_SIZE_X },
+	{ PARTICLE_SIZE_Y,         PARTICLE_START_SIZE_Y,         PARTICLE_END_SIZE_Y },
+	{ PARTICLE_COLOR_R,        PARTICLE_START_COLOR_R,        PARTICLE_END_COLOR_R },
+	{ PARTICLE_COLOR_G,        PARTICLE_START_COLOR_G,        PARTICLE_END_COLOR_G },
+	{ PARTICLE_COLOR_B,        PARTICLE_START_COLOR_B,        PARTICLE_END_COLOR_B },
+	{ PARTICLE_COLOR_A,        PARTICLE_START_COLOR_A,        PARTICLE_END_COLOR_A }
+};
+
+static const int32 NUM_KEYFRAMED_STREAMS = sizeof(KEYFRAMED_STREAMS) / sizeof(KEYFRAMED_STREAMS[0]);
+
+
+//! interpolates every keyframed property between its start and end values
+static void InterpolateKeyframes(ParticleArray &particles, int32 count)
+{
+	const float *time          = particles.Stream(PARTICLE_TIME);
+	const float *lifetime      = particles.Stream(PARTICLE_LIFETIME);
+	const float *keyframe_time = particles.Stream(PARTICLE_KEYFRAME_TIME);
+	const float *inv_duration  = particles.Stream(PARTICLE_KEYFRAME_INVERSE_DURATION);
+
+	// the interpolation factor is clamped to [0, 1]. This also turns the NaN that results from a
+	// zero lifetime into 1, which is harmless since such particles are expired
+#ifdef PARTICLE_USE_SSE
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one  = _mm_set1_ps(1.0f);
+
+	for(int32 j = 0; j < count; j += PARTICLE_SIMD_WIDTH)
+	{
+		__m128 scaled_time = _mm_div_ps(_mm_load_ps(time + j), _mm_load_ps(lifetime + j));
+		__m128 a = _mm_mul_ps(_mm_sub_ps(scaled_time, _mm_load_ps(keyframe_time + j)), _mm_load_ps(inv_duration + j));
+		a = _mm_max_ps(_mm_min_ps(a, one), zero);
+
+		for(int32 k = 0; k < NUM_KEYFRAMED_STREAMS; ++k)
+		{
+			__m128 start = _mm_load_ps(particles.Stream(KEYFRAMED_STREAMS[k][1]) + j);
+			__m128 end   = _mm_load_ps(particles.Stream(KEYFRAMED_STREAMS[k][2]) + j);
+			_mm_store_ps(particles.Stream(KEYFRAMED_STREAMS[k][0]) + j, _mm_add_ps(start, _mm_mul_ps(a, _mm_sub_ps(end, start))));
+		}
+	}
+#else
+	for(int32 k = 0; k < NUM_KEYFRAMED_STREAMS; ++k)
+	{
+		float *value       = particles.Stream(KEYFRAMED_STREAMS[k][0]);
+		const float *start = particles.Stream(KEYFRAMED_STREAMS[k][1]);
+		const float *end   = particles.Stream(KEYFRAMED_STREAMS[k][2]);
+
+		for(int32 j = 0; j < count; ++j)
+		{
+			float a = (time[j] / lifetime[j] - keyframe_time[j]) * inv_duration[j];
+			if(!(a < 1.0f))
+				a = 1.0f;
+			else if(a < 0.0f)
+				a = 0.0f;
+			value[j] = start[j] + a * (end[j] - start[j]);
+		}
+	}
+#endif
+}
+
+
+//! advances the rotation angles and adds the wind to the particle velocities
+static void IntegrateRotationAndWind(ParticleArray &particles, int32 count, float t)
+{
+	float *rotation_angle           = particles.Stream(PARTICLE_ROTATION_ANGLE);
+	const float *rotation_speed     = particles.Stream(PARTICLE_ROTATION_SPEED);
+	const float *rotation_direction = particles.Stream(PARTICLE_ROTATION_DIRECTION);
+	const float *velocity_x         = particles.Stream(PARTICLE_VELOCITY_X);
+	const float *velocity_y         = particles.Stream(PARTICLE_VELOCITY_Y);
+	const float *wind_x             = particles.Stream(PARTICLE_WIND_VELOCITY_X);
+	const float *wind_y             = particles.Stream(PARTICLE_WIND_VELOCITY_Y);
+	float *combined_x               = particles.Stream(PARTICLE_COMBINED_VELOCITY_X);
+	float *combined_y               = particles.Stream(PARTICLE_COMBINED_VELOCITY_Y);
+
+#ifdef PARTICLE_USE_SSE
+	const __m128 dt = _mm_set1_ps(t);
+
+	for(int32 j = 0; j < count; j += PARTICLE_SIMD_WIDTH)
+	{
+		__m128 spin = _mm_mul_ps(_mm_mul_ps(_mm_load_ps(rotation_speed + j), _mm_load_ps(rotation_direction + j)), dt);
+		_mm_store_ps(rotation_angle + j, _mm_add_ps(_mm_load_ps(rotation_angle + j), spin));
+		_mm_store_ps(combined_x + j, _mm_add_ps(_mm_load_ps(velocity_x + j), _mm_load_ps(wind_x + j)));
+		_mm_store_ps(combined_y + j, _mm_add_ps(_mm_load_ps(velocity_y + j), _mm_load_ps(wind_y + j)));
+	}
+#else
+	for(int32 j = 0; j < count; ++j)
+	{
+		rotation_angle[j] += rotation_speed[j] * rotation_direction[j] * t;
+		combined_x[j] = velocity_x[j] + wind_x[j];
+		combined_y[j] = velocity_y[j] + wind_y[j];
+	}
+#endif
+}
+
+
+//! moves the particles by their combined velocities, applies the constant acceleration, and ages them
+static void IntegrateMotion(ParticleArray &particles, int32 count, float t)
+{
+	float *x                    = particles.Stream(PARTICLE_X);
+	float *y                    = particles.Stream(PARTICLE_Y);
+	const float *combined_x     = particles.Stream(PARTICLE_COMBINED_VELOCITY_X);
+	const float *combined_y     = particles.Stream(PARTICLE_COMBINED_VELOCITY_Y);
+	float *velocity_x           = particles.Stream(PARTICLE_VELOCITY_X);
+	float *velocity_y           = particles.Stream(PARTICLE_VELOCITY_Y);
+	const float *acceleration_x = particles.Stream(PARTICLE_ACCELERATION_X);
+	const float *acceleration_y = particles.Stream(PARTICLE_ACCELERATION_Y);
+	float *time                 = particles.Stream(PARTICLE_TIME);
+
+#ifdef PARTICLE_USE_SSE
+	const __m128 dt = _mm_set1_ps(t);
+
+	for(int32 j = 0; j < count; j += PARTICLE_SIMD_WIDTH)
+	{
+		_mm_store_ps(x + j, _mm_add_ps(_mm_load_ps(x + j), _mm_mul_ps(_mm_load_ps(combined_x + j), dt)));
+		_mm_store_ps(y + j, _mm_add_ps(_mm_load_ps(y + j), _mm_mul_ps(_mm_load_ps(combined_y + j), dt)));
+		_mm_store_ps(velocity_x + j, _mm_add_ps(_mm_load_ps(velocity_x + j), _mm_mul_ps(_mm_load_ps(acceleration_x + j), dt)));
+		_mm_store_ps(velocity_y + j, _mm_add_ps(_mm_load_ps(velocity_y + j), _mm_mul_ps(_mm_load_ps(acceleration_y + j), dt)));
+		_mm_store_ps(time + j, _mm_add_ps(_mm_load_ps(time + j), dt));
+	}
+#else
+	for(int32 j = 0; j < count; ++j)
+	{
+		x[j] += combined_x[j] * t;
+		y[j] += combined_y[j] * t;
+		velocity_x[j] += acceleration_x[j] * t;
+		velocity_y[j] += acceleration_y[j] * t;
+		time[j] += t;
+	}
+#endif
+}
+
 
 //-----------------------------------------------------------------------------
 // ParticleSystem
@@ -43,17 +307,25 @@ ParticleSystem::ParticleSystem()
 // Create: initializes the particle system from the definition
 //-----------------------------------------------------------------------------
 
-bool ParticleSystem::Create(const ParticleSystemDef *sys_def)
+bool ParticleSystem::Create(const ParticleSystemDef *sys_def, uint32 seed)
 {
 	_system_def = sys_def;
 	_max_particles = sys_def->max_particles;
 	_num_particles = 0;
 
-	_particles.resize(_max_particles);
+	_particles.Allocate(_max_particles);
 	_particle_vertices.resize(_max_particles * 4);
-	_particle_texcoords.resize(_max_particles * 4);
+	_particle_texcoords.Resize(_max_particles);
 	_particle_colors.resize(_max_particles * 4);
 
+	if(sys_def->smooth_animation)
+	{
+		_particle_next_texcoords.Resize(_max_particles);
+		_particle_next_colors.resize(_max_particles * 4);
+	}
+
+	_random.Seed(seed);
+
 	_alive = true;
 	_stopped = false;
 	_age = 0.0f;
@@ -88,6 +360,9 @@ bool ParticleSystem::Draw()
 	if(!_system_def->enabled || _age < _system_def->emitter._start_time)
 		return true;
 
+	// particles are drawn directly, so draw any images still waiting in the sprite batch first
+	VideoManager->_sprite_batch.Flush();
+
 	// set blending parameters
 	if(_system_def->blend_mode == VIDEO_NO_BLEND)
 	{
@@ -143,16 +418,54 @@ bool ParticleSystem::Draw()
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
 	StillImage *id = _animation.GetFrame(_animation.GetCurrentFrameIndex());
-	ImageTexture *img = id->_image_texture;
-	TextureManager->_BindTexture(img->texture_sheet->tex_id);
+	TextureManager->_BindTexture(id->_image_texture->texture_sheet->tex_id);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glVertexPointer   (2, GL_FLOAT, 0, &_particle_vertices[0]);
+	glColorPointer    (4, GL_FLOAT, 0, &_particle_colors[0]);
+	glTexCoordPointer (2, GL_FLOAT, 0, &_particle_texcoords.coords[0]);
+
+	glDrawArrays(GL_QUADS, 0, _num_particles * 4);
+
+	if(_system_def->smooth_animation) {
+		int findex = _animation.GetCurrentFrameIndex();
+		findex = (findex + 1) % _animation.GetNumberOfFrames();
+
+		StillImage *id2 = _animation.GetFrame(findex);
+		TextureManager->_BindTexture(id2->_image_texture->texture_sheet->tex_id);
+
+		glColorPointer    (4, GL_FLOAT, 0, &_particle_next_colors[0]);
+		glTexCoordPointer (2, GL_FLOAT, 0, &_particle_next_texcoords.coords[0]);
+
+		glDrawArrays(GL_QUADS, 0, _num_particles * 4);
+	}
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+
+	return true;
+}
 
 
+//-----------------------------------------------------------------------------
+// _BuildVertexArrays: helper function to Update(), fills the arrays that are
+//                     passed to OpenGL when the system is drawn
+//-----------------------------------------------------------------------------
+
+void ParticleSystem::_BuildVertexArrays()
+{
+	StillImage *id = _animation.GetFrame(_animation.GetCurrentFrameIndex());
+	ImageTexture *img = id->_image_texture;
+
 	float frame_progress = _animation.GetPercentProgress();
 
-	float u1 = img->u1;
-	float u2 = img->u2;
-	float v1 = img->v1;
-	float v2 = img->v2;
+	const float u1 = img->u1;
+	const float u2 = img->u2;
+	const float v1 = img->v1;
+	const float v2 = img->v2;
 
 	float img_width  = static_cast<float>(img->width);
 	float img_height = static_cast<float>(img->height);
@@ -160,24 +473,32 @@ bool ParticleSystem::Draw()
 	float img_width_half = img_width * 0.5f;
 	float img_height_half = img_height * 0.5f;
 
+	const float *x      = _particles.Stream(PARTICLE_X);
+	const float *y      = _particles.Stream(PARTICLE_Y);
+	const float *size_x = _particles.Stream(PARTICLE_SIZE_X);
+	const float *size_y = _particles.Stream(PARTICLE_SIZE_Y);
+
 	// fill the vertex array
 	if (_system_def->rotation_used) {
+		const float *rotation_angle = _particles.Stream(PARTICLE_ROTATION_ANGLE);
+		const float *combined_x     = _particles.Stream(PARTICLE_COMBINED_VELOCITY_X);
+		const float *combined_y     = _particles.Stream(PARTICLE_COMBINED_VELOCITY_Y);
 		int32 v = 0;
 
 		for (int32 j = 0; j < _num_particles; ++j) {
-			float scaled_width_half  = img_width_half * _particles[j].size_x;
-			float scaled_height_half = img_height_half * _particles[j].size_y;
+			float scaled_width_half  = img_width_half * size_x[j];
+			float scaled_height_half = img_height_half * size_y[j];
 
-			float rotation_angle = _particles[j].rotation_angle;
+			float angle = rotation_angle[j];
 
 			if (_system_def->rotate_to_velocity) {
 				// calculate the angle based on the velocity
-				rotation_angle += UTILS_HALF_PI + atan2f(_particles[j].combined_velocity_y, _particles[j].combined_velocity_x);
+				angle += UTILS_HALF_PI + atan2f(combined_y[j], combined_x[j]);
 
 				// calculate the scaling due to speed
 				if (_system_def->speed_scale_used) {
 					// speed is magnitude of velocity
-					float speed = sqrtf(_particles[j].combined_velocity_x * _particles[j].combined_velocity_x + _particles[j].combined_velocity_y * _particles[j].combined_velocity_y);
+					float speed = sqrtf(combined_x[j] * combined_x[j] + combined_y[j] * combined_y[j]);
 					float scale_factor = _system_def->speed_scale * speed;
 
 					if(scale_factor < _system_def->min_speed_scale)
@@ -189,36 +510,32 @@ bool ParticleSystem::Draw()
 				}
 			}
 
+			// rotate the half extents of the quad once, and derive all four corners from them
+			float cos_angle = cosf(angle);
+			float sin_angle = sinf(angle);
+			float wx = scaled_width_half * cos_angle;
+			float wy = scaled_width_half * sin_angle;
+			float hx = -scaled_height_half * sin_angle;
+			float hy = scaled_height_half * cos_angle;
+
 			// upper-left vertex
-			_particle_vertices[v]._x = -scaled_width_half;
-			_particle_vertices[v]._y = -scaled_height_half;
-			RotatePoint(_particle_vertices[v]._x, _particle_vertices[v]._y, rotation_angle);
-			_particle_vertices[v]._x += _particles[j].x;
-			_particle_vertices[v]._y += _particles[j].y;
+			_particle_vertices[v]._x = x[j] - wx - hx;
+			_particle_vertices[v]._y = y[j] - wy - hy;
 			++v;
 
 			// upper-right vertex
-			_particle_vertices[v]._x = scaled_width_half;
-			_particle_vertices[v]._y = -scaled_height_half;
-			RotatePoint(_particle_vertices[v]._x, _particle_vertices[v]._y, rotation_angle);
-			_particle_vertices[v]._x += _particles[j].x;
-			_particle_vertices[v]._y += _particles[j].y;
+			_particle_vertices[v]._x = x[j] + wx - hx;
+			_particle_vertices[v]._y = y[j] + wy - hy;
 			++v;
 
 			// lower-right vertex
-			_particle_vertices[v]._x = scaled_width_half;
-			_particle_vertices[v]._y = scaled_height_half;
-			RotatePoint(_particle_vertices[v]._x, _particle_vertices[v]._y, rotation_angle);
-			_particle_vertices[v]._x += _particles[j].x;
-			_particle_vertices[v]._y += _particles[j].y;
+			_particle_vertices[v]._x = x[j] + wx + hx;
+			_particle_vertices[v]._y = y[j] + wy + hy;
 			++v;
 
 			// lower-left vertex
-			_particle_vertices[v]._x = -scaled_width_half;
-			_particle_vertices[v]._y = scaled_height_half;
-			RotatePoint(_particle_vertices[v]._x, _particle_vertices[v]._y, rotation_angle);
-			_particle_vertices[v]._x += _particles[j].x;
-			_particle_vertices[v]._y += _particles[j].y;
+			_particle_vertices[v]._x = x[j] - wx + hx;
+			_particle_vertices[v]._y = y[j] - wy + hy;
 			++v;
 		}
 	}
@@ -226,157 +543,76 @@ bool ParticleSystem::Draw()
 		int32 v = 0;
 
 		for (int32 j = 0; j < _num_particles; ++j) {
-			float scaled_width_half  = img_width_half * _particles[j].size_x;
-			float scaled_height_half = img_height_half * _particles[j].size_y;
+			float scaled_width_half  = img_width_half * size_x[j];
+			float scaled_height_half = img_height_half * size_y[j];
 
 			// upper-left vertex
-			_particle_vertices[v]._x = _particles[j].x - scaled_width_half;
-			_particle_vertices[v]._y = _particles[j].y - scaled_height_half;
+			_particle_vertices[v]._x = x[j] - scaled_width_half;
+			_particle_vertices[v]._y = y[j] - scaled_height_half;
 			++v;
 
 			// upper-right vertex
-			_particle_vertices[v]._x = _particles[j].x + scaled_width_half;
-			_particle_vertices[v]._y = _particles[j].y - scaled_height_half;
+			_particle_vertices[v]._x = x[j] + scaled_width_half;
+			_particle_vertices[v]._y = y[j] - scaled_height_half;
 			++v;
 
 			// lower-right vertex
-			_particle_vertices[v]._x = _particles[j].x + scaled_width_half;
-			_particle_vertices[v]._y = _particles[j].y + scaled_height_half;
+			_particle_vertices[v]._x = x[j] + scaled_width_half;
+			_particle_vertices[v]._y = y[j] + scaled_height_half;
 			++v;
 
 			// lower-left vertex
-			_particle_vertices[v]._x = _particles[j].x - scaled_width_half;
-			_particle_vertices[v]._y = _particles[j].y + scaled_height_half;
+			_particle_vertices[v]._x = x[j] - scaled_width_half;
+			_particle_vertices[v]._y = y[j] + scaled_height_half;
 			++v;
 		}
 	}
 
-	// fill the color array
-	int32 c = 0;
-	for (int32 j = 0; j < _num_particles; ++j) {
-		Color color = _particles[j].color;
-
-		if(_system_def->smooth_animation)
-			color = color * (1.0f - frame_progress);
-
-		_particle_colors[c] = color;
-		++c;
-		_particle_colors[c] = color;
-		++c;
-		_particle_colors[c] = color;
-		++c;
-		_particle_colors[c] = color;
-		++c;
-	}
-
-	// fill the texcoord array
-
-	int32 t = 0;
-	for (int32 j = 0; j < _num_particles; ++j) {
-		// upper-left
-		_particle_texcoords[t]._t0 = u1;
-		_particle_texcoords[t]._t1 = v1;
-		++t;
-
-		// upper-right
-		_particle_texcoords[t]._t0 = u2;
-		_particle_texcoords[t]._t1 = v1;
-		++t;
-
-		// lower-right
-		_particle_texcoords[t]._t0 = u2;
-		_particle_texcoords[t]._t1 = v2;
-		++t;
-
-		// lower-left
-		_particle_texcoords[t]._t0 = u1;
-		_particle_texcoords[t]._t1 = v2;
-		++t;
-	}
-
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
-	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-	glVertexPointer   (2, GL_FLOAT, 0, &_particle_vertices[0]);
-	glColorPointer    (4, GL_FLOAT, 0, &_particle_colors[0]);
-	glTexCoordPointer (2, GL_FLOAT, 0, &_particle_texcoords[0]);
-
-	glDrawArrays(GL_QUADS, 0, _num_particles * 4);
-
-	glDisableClientState(GL_VERTEX_ARRAY);
-
-	if(_system_def->smooth_animation) {
-		glEnableClientState(GL_VERTEX_ARRAY);
-
+	// fill the color and texcoord arrays
+	if(_system_def->smooth_animation)
+	{
 		int findex = _animation.GetCurrentFrameIndex();
 		findex = (findex + 1) % _animation.GetNumberOfFrames();
+		ImageTexture *img2 = _animation.GetFrame(findex)->_image_texture;
 
-		StillImage *id2 = _animation.GetFrame(findex);
-		ImageTexture *img2 = id2->_image_texture;
-		TextureManager->_BindTexture(img2->texture_sheet->tex_id);
-
-
-		u1 = img2->u1;
-		u2 = img2->u2;
-		v1 = img2->v1;
-		v2 = img2->v2;
-
-
-		t = 0;
-		for(int32 j = 0; j < _num_particles; ++j) {
-			// upper-left
-			_particle_texcoords[t]._t0 = u1;
-			_particle_texcoords[t]._t1 = v1;
-			++t;
-
-			// upper-right
-			_particle_texcoords[t]._t0 = u2;
-			_particle_texcoords[t]._t1 = v1;
-			++t;
-
-			// lower-right
-			_particle_texcoords[t]._t0 = u2;
-			_particle_texcoords[t]._t1 = v2;
-			++t;
-
-			// lower-left
-			_particle_texcoords[t]._t0 = u1;
-			_particle_texcoords[t]._t1 = v2;
-			++t;
-		}
-
-
+		_FillColors(_particle_colors, 1.0f - frame_progress);
+		_FillColors(_particle_next_colors, frame_progress);
+		_particle_texcoords.Fill(_num_particles, u1, v1, u2, v2);
+		_particle_next_texcoords.Fill(_num_particles, img2->u1, img2->v1, img2->u2, img2->v2);
+	}
+	else
+	{
+		_FillColors(_particle_colors, 1.0f);
+		_particle_texcoords.Fill(_num_particles, u1, v1, u2, v2);
+	}
+}
 
-		c = 0;
-		for(int32 j = 0; j < _num_particles; ++j) {
-			Color color = _particles[j].color;
-			color = color * frame_progress;
 
-			_particle_colors[c] = color;
-			++c;
-			_particle_colors[c] = color;
-			++c;
-			_particle_colors[c] = color;
-			++c;
-			_particle_colors[c] = color;
-			++c;
-		}
 
-		glVertexPointer   (2, GL_FLOAT, 0, &_particle_vertices[0]);
-		glColorPointer    (4, GL_FLOAT, 0, &_particle_colors[0]);
-		glTexCoordPointer (2, GL_FLOAT, 0, &_particle_texcoords[0]);
+void ParticleSystem::_FillColors(vector<Color> &colors, float modulation)
+{
+	const float *red   = _particles.Stream(PARTICLE_COLOR_R);
+	const float *green = _particles.Stream(PARTICLE_COLOR_G);
+	const float *blue  = _particles.Stream(PARTICLE_COLOR_B);
+	const float *alpha = _particles.Stream(PARTICLE_COLOR_A);
 
-		glDrawArrays(GL_QUADS, 0, _num_particles * 4);
+	int32 c = 0;
+	for (int32 j = 0; j < _num_particles; ++j) {
+		Color color(red[j] * modulation, green[j] * modulation, blue[j] * modulation, alpha[j]);
 
-		glDisableClientState(GL_VERTEX_ARRAY);
-		glDisableClientState(GL_COLOR_ARRAY);
-		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		colors[c] = color;
+		++c;
+		colors[c] = color;
+		++c;
+		colors[c] = color;
+		++c;
+		colors[c] = color;
+		++c;
 	}
-
-	return true;
 }
 
 
+
 //-----------------------------------------------------------------------------
 // IsAlive: returns whether the particle system has active particles or not
 //-----------------------------------------------------------------------------
@@ -473,6 +709,8 @@ bool ParticleSystem::Update(float frame_time, const EffectParameters &params)
 	}
 
 	_last_update_time = _age;
+
+	_BuildVertexArrays();
 	return true;
 }
 
@@ -493,7 +731,7 @@ int32 ParticleSystem::GetNumParticles() const
 
 void ParticleSystem::Destroy()
 {
-	_particles.clear();
+	_particles.Clear();
 	_particle_vertices.clear();
 }
 
@@ -514,208 +752,255 @@ void ParticleSystem::Stop()
 
 void ParticleSystem::_UpdateParticles(float t, const EffectParameters &params)
 {
-	for(int j = 0; j < _num_particles; ++j)
+	if(_num_particles == 0)
+		return;
+
+	// the SIMD kernels work on whole groups of particles. The streams are padded, so the
+	// particles past the end of the live ones are processed too, but their results are never used
+	int32 count = (_num_particles + PARTICLE_SIMD_WIDTH - 1) / PARTICLE_SIMD_WIDTH * PARTICLE_SIMD_WIDTH;
+
+	const float *time = _particles.Stream(PARTICLE_TIME);
+	const float *lifetime = _particles.Stream(PARTICLE_LIFETIME);
+	const float *next_keyframe_time = _particles.Stream(PARTICLE_NEXT_KEYFRAME_TIME);
+
+	// advancing to a new keyframe requires random numbers and is rare, so it is done one particle at a time
+	for(int32 j = 0; j < _num_particles; ++j)
 	{
 		// calculate a time for the particle from 0 to 1 since this is what
 		// the keyframes are based on
-		float scaled_time = _particles[j].time / _particles[j].lifetime;
+		float scaled_time = time[j] / lifetime[j];
 
-		// figure out which keyframe we're on
-		if(_particles[j].next_keyframe)
-		{
-			ParticleKeyframe *old_next = _particles[j].next_keyframe;
+		if(scaled_time >= next_keyframe_time[j])
+			_AdvanceKeyframe(j, scaled_time);
+	}
 
-			// check if we need to advance the keyframe
-			if(scaled_time >= _particles[j].next_keyframe->time)
-			{
-				// figure out what keyframe we're on
-				size_t num_keyframes = _system_def->keyframes.size();
-
-				size_t k;
-				for(k = 0; k < num_keyframes; ++k)
-				{
-					if(_system_def->keyframes[k]->time > scaled_time)
-					{
-						_particles[j].current_keyframe = _system_def->keyframes[k - 1];
-						_particles[j].next_keyframe    = _system_def->keyframes[k];
-						break;
-					}
-				}
+	InterpolateKeyframes(_particles, count);
+	IntegrateRotationAndWind(_particles, count, t);
 
-				// if we didn't find any keyframe whose time is larger than this
-				// particle's time, then we are on the last one
-				if(k == num_keyframes)
-				{
-					_particles[j].current_keyframe = _system_def->keyframes[k - 1];
-					_particles[j].next_keyframe = NULL;
-
-					// set all of the keyframed properties to the value stored in the last
-					// keyframe
-					_particles[j].color          = _particles[j].current_keyframe->color;
-					_particles[j].rotation_speed = _particles[j].current_keyframe->rotation_speed;
-					_particles[j].size_x         = _particles[j].current_keyframe->size_x;
-					_particles[j].size_y         = _particles[j].current_keyframe->size_y;
-				}
+	if(_system_def->wave_motion_used)
+		_ApplyWaveMotion();
 
-				// if we skipped ahead only 1 keyframe, then inherit the current variations
-				// from the next ones
-				if(_particles[j].current_keyframe == old_next)
-				{
-					_particles[j].current_color_variation = _particles[j].next_color_variation;
-					_particles[j].current_rotation_speed_variation = _particles[j].current_rotation_speed_variation;
-					_particles[j].current_size_variation_x = _particles[j].next_size_variation_x;
-					_particles[j].current_size_variation_y = _particles[j].next_size_variation_y;
-				}
-				else
-				{
-					_particles[j].current_rotation_speed_variation = RandomFloat(-_particles[j].current_keyframe->rotation_speed_variation, _particles[j].current_keyframe->rotation_speed_variation);
-					for(int32 c = 0; c < 4; ++c)
-						_particles[j].current_color_variation[c] = RandomFloat(-_particles[j].current_keyframe->color_variation[c], _particles[j].current_keyframe->color_variation[c]);
-					_particles[j].current_size_variation_x = RandomFloat(-_particles[j].current_keyframe->size_variation_x, _particles[j].current_keyframe->size_variation_x);
-					_particles[j].current_size_variation_y = RandomFloat(-_particles[j].current_keyframe->size_variation_y, _particles[j].current_keyframe->size_variation_y);
-				}
+	IntegrateMotion(_particles, count, t);
 
-				// if there is a next keyframe, generate variations for it
-				if(_particles[j].next_keyframe)
-				{
-					_particles[j].next_rotation_speed_variation = RandomFloat(-_particles[j].next_keyframe->rotation_speed_variation, _particles[j].next_keyframe->rotation_speed_variation);
-					for(int32 c = 0; c < 4; ++c)
-						_particles[j].next_color_variation[c] = RandomFloat(-_particles[j].next_keyframe->color_variation[c], _particles[j].next_keyframe->color_variation[c]);
-					_particles[j].next_size_variation_x = RandomFloat(-_particles[j].next_keyframe->size_variation_x, _particles[j].next_keyframe->size_variation_x);
-					_particles[j].next_size_variation_y = RandomFloat(-_particles[j].next_keyframe->size_variation_y, _particles[j].next_keyframe->size_variation_y);
-				}
-			}
-		}
+	if(_system_def->radial_acceleration != 0.0f || _system_def->radial_acceleration_variation != 0.0f ||
+		_system_def->tangential_acceleration != 0.0f || _system_def->tangential_acceleration_variation != 0.0f)
+	{
+		_ApplyAttractorAcceleration(t, params);
+	}
 
+	// damp the velocity
+	if(_system_def->damping != 1.0f || _system_def->damping_variation != 0.0f)
+	{
+		float *velocity_x = _particles.Stream(PARTICLE_VELOCITY_X);
+		float *velocity_y = _particles.Stream(PARTICLE_VELOCITY_Y);
+		const float *damping = _particles.Stream(PARTICLE_DAMPING);
 
-		// if we aren't already at the last keyframe, interpolate to figure out the
-		// current keyframed properties
-		if(_particles[j].next_keyframe)
+		for(int32 j = 0; j < _num_particles; ++j)
 		{
-			// figure out how far we are from the current to the next (0.0 to 1.0)
-			float a = (scaled_time - _particles[j].current_keyframe->time) / (_particles[j].next_keyframe->time - _particles[j].current_keyframe->time);
-
-			_particles[j].rotation_speed = Lerp(a, _particles[j].current_keyframe->rotation_speed + _particles[j].current_rotation_speed_variation, _particles[j].next_keyframe->rotation_speed + _particles[j].next_rotation_speed_variation);
-			_particles[j].size_x         = Lerp(a, _particles[j].current_keyframe->size_x + _particles[j].current_size_variation_x, _particles[j].next_keyframe->size_x + _particles[j].next_size_variation_x);
-			_particles[j].size_y         = Lerp(a, _particles[j].current_keyframe->size_y + _particles[j].current_size_variation_y, _particles[j].next_keyframe->size_y + _particles[j].next_size_variation_y);
-			_particles[j].color[0]       = Lerp(a, _particles[j].current_keyframe->color[0] + _particles[j].current_color_variation[0], _particles[j].next_keyframe->color[0] + _particles[j].next_color_variation[0]);
-			_particles[j].color[1]       = Lerp(a, _particles[j].current_keyframe->color[1] + _particles[j].current_color_variation[1], _particles[j].next_keyframe->color[1] + _particles[j].next_color_variation[1]);
-			_particles[j].color[2]       = Lerp(a, _particles[j].current_keyframe->color[2] + _particles[j].current_color_variation[2], _particles[j].next_keyframe->color[2] + _particles[j].next_color_variation[2]);
-			_particles[j].color[3]       = Lerp(a, _particles[j].current_keyframe->color[3] + _particles[j].current_color_variation[3], _particles[j].next_keyframe->color[3] + _particles[j].next_color_variation[3]);
+			if(damping[j] != 1.0f)
+			{
+				float damp = pow(damping[j], t);
+				velocity_x[j] *= damp;
+				velocity_y[j] *= damp;
+			}
 		}
+	}
+}
 
 
-		_particles[j].rotation_angle += _particles[j].rotation_speed * _particles[j].rotation_direction * t;
+//-----------------------------------------------------------------------------
+// _AdvanceKeyframe: helper function to _UpdateParticles(), moves a particle on
+//                   to its current keyframe and sets up the values it will be
+//                   interpolated between
+//-----------------------------------------------------------------------------
 
-		float wind_velocity_x = _particles[j].wind_velocity_x;
-		float wind_velocity_y = _particles[j].wind_velocity_y;
+void ParticleSystem::_AdvanceKeyframe(int32 i, float scaled_time)
+{
+	const vector<ParticleKeyframe *> &keyframes = _system_def->keyframes;
+	int32 num_keyframes = static_cast<int32>(keyframes.size());
+
+	// figure out what keyframe we're on
+	int32 old_next = _particles.next_keyframe[i];
+	int32 next = old_next;
+	while(next < num_keyframes && keyframes[next]->time <= scaled_time)
+		++next;
 
-		_particles[j].combined_velocity_x = _particles[j].velocity_x + wind_velocity_x;
-		_particles[j].combined_velocity_y = _particles[j].velocity_y + wind_velocity_y;
+	_particles.next_keyframe[i] = next;
+	ParticleKeyframe *current_keyframe = keyframes[next - 1];
 
-		if(_system_def->wave_motion_used && _particles[j].wave_half_amplitude > 0.0f)
+	// if we didn't find any keyframe whose time is larger than this particle's time, then we
+	// are on the last one. Hold all of the keyframed properties at the values stored in it
+	if(next == num_keyframes)
+	{
+		for(int32 k = 0; k < NUM_KEYFRAMED_STREAMS; ++k)
 		{
-			// find the magnitude of the wave velocity
-// 			float half_amp = _particles[j].wave_half_amplitude; UNUSED VARIABLE
-// 			float wcoef = _particles[j].wave_length_coefficient; UNUSED VARIABLE
-			float wave_speed = _particles[j].wave_half_amplitude * sinf(_particles[j].wave_length_coefficient * _particles[j].time);
-
-			// now the wave velocity is just that wave speed times the particle's tangential vector
-			float tangent_x = -_particles[j].combined_velocity_y;
-			float tangent_y = _particles[j].combined_velocity_x;
-			float speed = sqrtf(tangent_x * tangent_x + tangent_y * tangent_y);
-			tangent_x /= speed;
-			tangent_y /= speed;
-
-			float wave_velocity_x = tangent_x * wave_speed;
-			float wave_velocity_y = tangent_y * wave_speed;
-
-			_particles[j].combined_velocity_x += wave_velocity_x;
-			_particles[j].combined_velocity_y += wave_velocity_y;
+			float value;
+			switch(KEYFRAMED_STREAMS[k][0])
+			{
+				case PARTICLE_ROTATION_SPEED: value = current_keyframe->rotation_speed; break;
+				case PARTICLE_SIZE_X:         value = current_keyframe->size_x; break;
+				case PARTICLE_SIZE_Y:         value = current_keyframe->size_y; break;
+				case PARTICLE_COLOR_R:        value = current_keyframe->color[0]; break;
+				case PARTICLE_COLOR_G:        value = current_keyframe->color[1]; break;
+				case PARTICLE_COLOR_B:        value = current_keyframe->color[2]; break;
+				default:                      value = current_keyframe->color[3]; break;
+			}
+
+			_particles.Stream(KEYFRAMED_STREAMS[k][1])[i] = value;
+			_particles.Stream(KEYFRAMED_STREAMS[k][2])[i] = value;
 		}
 
-		_particles[j].x += (_particles[j].combined_velocity_x) * t;
-		_particles[j].y += (_particles[j].combined_velocity_y) * t;
+		_particles.Stream(PARTICLE_KEYFRAME_TIME)[i] = current_keyframe->time;
+		_particles.Stream(PARTICLE_NEXT_KEYFRAME_TIME)[i] = PARTICLE_NO_KEYFRAME_TIME;
+		_particles.Stream(PARTICLE_KEYFRAME_INVERSE_DURATION)[i] = 0.0f;
+		return;
+	}
 
+	// if we skipped ahead only 1 keyframe, then the values we were interpolating towards
+	// (including their variations) become the starting values
+	if(next - 1 == old_next)
+	{
+		for(int32 k = 0; k < NUM_KEYFRAMED_STREAMS; ++k)
+			_particles.Stream(KEYFRAMED_STREAMS[k][1])[i] = _particles.Stream(KEYFRAMED_STREAMS[k][2])[i];
+	}
+	else
+	{
+		_SetKeyframeValues(i, current_keyframe, true);
+	}
 
-		// client-specified acceleration (dv = a * t)
-		_particles[j].velocity_x += _particles[j].acceleration_x * t;
-		_particles[j].velocity_y += _particles[j].acceleration_y * t;
+	// generate the values for the next keyframe
+	_SetKeyframeValues(i, keyframes[next], false);
 
-		// radial acceleration: calculate unit vector from emitter center to this particle,
-		// and scale by the radial acceleration, if there is any
+	float duration = keyframes[next]->time - current_keyframe->time;
+	_particles.Stream(PARTICLE_KEYFRAME_TIME)[i] = current_keyframe->time;
+	_particles.Stream(PARTICLE_NEXT_KEYFRAME_TIME)[i] = keyframes[next]->time;
+	_particles.Stream(PARTICLE_KEYFRAME_INVERSE_DURATION)[i] = (duration > 0.0f) ? (1.0f / duration) : 0.0f;
+}
 
 
-		bool use_radial     = (_particles[j].radial_acceleration != 0.0f);
-		bool use_tangential = (_particles[j].tangential_acceleration != 0.0f);
+//-----------------------------------------------------------------------------
+// _SetKeyframeValues: helper function, sets the start or end values of a
+//                     particle's keyframed properties to those of a keyframe
+//                     plus a random variation
+//-----------------------------------------------------------------------------
 
+void ParticleSystem::_SetKeyframeValues(int32 i, const ParticleKeyframe *keyframe, bool start)
+{
+	int32 column = start ? 1 : 2;
 
-		if(use_radial || use_tangential)
-		{
-			// unit vector from attractor to particle
-			float attractor_to_particle_x;
-			float attractor_to_particle_y;
+	_particles.Stream(KEYFRAMED_STREAMS[0][column])[i] = keyframe->rotation_speed + _random.Float(-keyframe->rotation_speed_variation, keyframe->rotation_speed_variation);
+	_particles.Stream(KEYFRAMED_STREAMS[1][column])[i] = keyframe->size_x + _random.Float(-keyframe->size_variation_x, keyframe->size_variation_x);
+	_particles.Stream(KEYFRAMED_STREAMS[2][column])[i] = keyframe->size_y + _random.Float(-keyframe->size_variation_y, keyframe->size_variation_y);
 
-			if(_system_def->user_defined_attractor)
-			{
-				attractor_to_particle_x = _particles[j].x - params.attractor_x;
-				attractor_to_particle_y = _particles[j].y - params.attractor_y;
-			}
-			else
-			{
-				attractor_to_particle_x = _particles[j].x - _system_def->emitter._center_x;
-				attractor_to_particle_y = _particles[j].y - _system_def->emitter._center_y;
-			}
+	for(int32 c = 0; c < 4; ++c)
+		_particles.Stream(KEYFRAMED_STREAMS[3 + c][column])[i] = keyframe->color[c] + _random.Float(-keyframe->color_variation[c], keyframe->color_variation[c]);
+}
 
-			float distance = sqrtf(attractor_to_particle_x * attractor_to_particle_x + attractor_to_particle_y * attractor_to_particle_y);
 
-			if(distance != 0.0f)
-			{
-				attractor_to_particle_x /= distance;
-				attractor_to_particle_y /= distance;
-			}
+//-----------------------------------------------------------------------------
+// _ApplyWaveMotion: helper function to _UpdateParticles(), adds the wave
+//                   velocity to the combined velocities
+//-----------------------------------------------------------------------------
 
-			// radial acceleration
-			if(use_radial)
-			{
-				if(_system_def->attractor_falloff != 0.0f)
-				{
-					float attraction = 1.0f - _system_def->attractor_falloff * distance;
-					if(attraction > 0.0f)
-					{
-						_particles[j].velocity_x += attractor_to_particle_x * _particles[j].radial_acceleration * t * attraction;
-						_particles[j].velocity_y += attractor_to_particle_y * _particles[j].radial_acceleration * t * attraction;
-					}
-				}
-				else
-				{
-					_particles[j].velocity_x += attractor_to_particle_x * _particles[j].radial_acceleration * t;
-					_particles[j].velocity_y += attractor_to_particle_y * _particles[j].radial_acceleration * t;
-				}
-			}
+void ParticleSystem::_ApplyWaveMotion()
+{
+	float *combined_x = _particles.Stream(PARTICLE_COMBINED_VELOCITY_X);
+	float *combined_y = _particles.Stream(PARTICLE_COMBINED_VELOCITY_Y);
+	const float *time = _particles.Stream(PARTICLE_TIME);
+	const float *wave_length_coefficient = _particles.Stream(PARTICLE_WAVE_LENGTH_COEFFICIENT);
+	const float *wave_half_amplitude = _particles.Stream(PARTICLE_WAVE_HALF_AMPLITUDE);
 
-			// tangential acceleration
-			if(use_tangential)
-			{
-				// tangent vector is simply perpendicular vector
-				float tangent_x = -attractor_to_particle_y;
-				float tangent_y = attractor_to_particle_x;
+	for(int32 j = 0; j < _num_particles; ++j)
+	{
+		if(wave_half_amplitude[j] <= 0.0f)
+			continue;
 
-				_particles[j].velocity_x += tangent_x * _particles[j].tangential_acceleration * t;
-				_particles[j].velocity_y += tangent_y * _particles[j].tangential_acceleration * t;
-			}
-		}
+		// the tangent to the particle's direction of motion. A particle that is not moving has no tangent
+		float tangent_x = -combined_y[j];
+		float tangent_y = combined_x[j];
+		float speed = sqrtf(tangent_x * tangent_x + tangent_y * tangent_y);
+		if(speed == 0.0f)
+			continue;
+
+		// find the magnitude of the wave velocity. The wave velocity is just that times the unit tangent
+		float wave_speed = wave_half_amplitude[j] * sinf(wave_length_coefficient[j] * time[j]) / speed;
+
+		combined_x[j] += tangent_x * wave_speed;
+		combined_y[j] += tangent_y * wave_speed;
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// _ApplyAttractorAcceleration: helper function to _UpdateParticles(), applies
+//                              the radial and tangential accelerations
+//-----------------------------------------------------------------------------
+
+void ParticleSystem::_ApplyAttractorAcceleration(float t, const EffectParameters &params)
+{
+	const float *x = _particles.Stream(PARTICLE_X);
+	const float *y = _particles.Stream(PARTICLE_Y);
+	float *velocity_x = _particles.Stream(PARTICLE_VELOCITY_X);
+	float *velocity_y = _particles.Stream(PARTICLE_VELOCITY_Y);
+	const float *radial_acceleration = _particles.Stream(PARTICLE_RADIAL_ACCELERATION);
+	const float *tangential_acceleration = _particles.Stream(PARTICLE_TANGENTIAL_ACCELERATION);
+
+	float attractor_x;
+	float attractor_y;
 
+	if(_system_def->user_defined_attractor)
+	{
+		attractor_x = params.attractor_x;
+		attractor_y = params.attractor_y;
+	}
+	else
+	{
+		attractor_x = _system_def->emitter._center_x;
+		attractor_y = _system_def->emitter._center_y;
+	}
 
-		// damp the velocity
+	float falloff = _system_def->attractor_falloff;
 
-		if(_particles[j].damping != 1.0f)
+	for(int32 j = 0; j < _num_particles; ++j)
+	{
+		bool use_radial     = (radial_acceleration[j] != 0.0f);
+		bool use_tangential = (tangential_acceleration[j] != 0.0f);
+
+		if(!use_radial && !use_tangential)
+			continue;
+
+		// unit vector from attractor to particle
+		float attractor_to_particle_x = x[j] - attractor_x;
+		float attractor_to_particle_y = y[j] - attractor_y;
+
+		float distance = sqrtf(attractor_to_particle_x * attractor_to_particle_x + attractor_to_particle_y * attractor_to_particle_y);
+
+		if(distance != 0.0f)
 		{
-			_particles[j].velocity_x *= pow(_particles[j].damping, t);
-			_particles[j].velocity_y *= pow(_particles[j].damping, t);
+			attractor_to_particle_x /= distance;
+			attractor_to_particle_y /= distance;
+		}
+
+		// radial acceleration
+		if(use_radial)
+		{
+			float attraction = 1.0f;
+			if(falloff != 0.0f)
+				attraction -= falloff * distance;
+
+			if(attraction > 0.0f)
+			{
+				velocity_x[j] += attractor_to_particle_x * radial_acceleration[j] * t * attraction;
+				velocity_y[j] += attractor_to_particle_y * radial_acceleration[j] * t * attraction;
+			}
 		}
 
-		_particles[j].time += t;
+		// tangential acceleration. The tangent vector is simply the perpendicular vector
+		if(use_tangential)
+		{
+			velocity_x[j] += -attractor_to_particle_y * tangential_acceleration[j] * t;
+			velocity_y[j] += attractor_to_particle_x * tangential_acceleration[j] * t;
+		}
 	}
 }
 
@@ -729,10 +1014,13 @@ void ParticleSystem::_UpdateParticles(float t, const EffectParameters &params)
 
 void ParticleSystem::_KillParticles(int32 &num, const EffectParameters &params)
 {
+	const float *time = _particles.Stream(PARTICLE_TIME);
+	const float *lifetime = _particles.Stream(PARTICLE_LIFETIME);
+
 	// check each active particle to see if it is expired
 	for(int j = 0; j < _num_particles; ++j)
 	{
-		if(_particles[j].time > _particles[j].lifetime)
+		if(time[j] > lifetime[j])
 		{
 			if(num > 0)
 			{
@@ -777,7 +1065,7 @@ void ParticleSystem::_EmitParticles(int32 num, const EffectParameters &params)
 
 void ParticleSystem::_MoveParticle(int32 src, int32 dest)
 {
-	_particles[dest] = _particles[src];
+	_particles.Move(src, dest);
 }
 
 
@@ -790,25 +1078,28 @@ void ParticleSystem::_RespawnParticle(int32 i, const EffectParameters &params)
 {
 	const ParticleEmitter &emitter = _system_def->emitter;
 
+	float x = 0.0f;
+	float y = 0.0f;
+
 	switch(emitter._shape)
 	{
 		case EMITTER_SHAPE_POINT:
 		{
-			_particles[i].x = emitter._x;
-			_particles[i].y = emitter._y;
+			x = emitter._x;
+			y = emitter._y;
 			break;
 		}
 		case EMITTER_SHAPE_LINE:
 		{
-			_particles[i].x = RandomFloat(emitter._x, emitter._x2);
-			_particles[i].y = RandomFloat(emitter._y, emitter._y2);
+			x = _random.Float(emitter._x, emitter._x2);
+			y = _random.Float(emitter._y, emitter._y2);
 			break;
 		}
 		case EMITTER_SHAPE_CIRCLE:
 		{
-			float angle = RandomFloat(0.0f, UTILS_2PI);
-			_particles[i].x = emitter._radius * cosf(angle);
-			_particles[i].y = emitter._radius * sinf(angle);
+			float angle = _random.Float(0.0f, UTILS_2PI);
+			x = emitter._radius * cosf(angle);
+			y = emitter._radius * sinf(angle);
 			break;
 		}
 		case EMITTER_SHAPE_FILLED_CIRCLE:
@@ -821,18 +1112,17 @@ void ParticleSystem::_RespawnParticle(int32 i, const EffectParameters &params)
 			do
 			{
 				float half_radius = emitter._radius * 0.5f;
-				_particles[i].x = RandomFloat(-half_radius, half_radius);
-				_particles[i].y = RandomFloat(-half_radius, half_radius);
-			} while(_particles[i].x * _particles[i].x +
-			        _particles[i].y * _particles[i].y > radius_squared);
+				x = _random.Float(-half_radius, half_radius);
+				y = _random.Float(-half_radius, half_radius);
+			} while(x * x + y * y > radius_squared);
 
 
 			break;
 		}
 		case EMITTER_SHAPE_FILLED_RECTANGLE:
 		{
-			_particles[i].x = RandomFloat(emitter._x, emitter._x2);
-			_particles[i].y = RandomFloat(emitter._y, emitter._y2);
+			x = _random.Float(emitter._x, emitter._x2);
+			y = _random.Float(emitter._y, emitter._y2);
 			break;
 		}
 		default:
@@ -840,46 +1130,46 @@ void ParticleSystem::_RespawnParticle(int32 i, const EffectParameters &params)
 	};
 
 
-	_particles[i].x += RandomFloat(-emitter._x_variation, emitter._x_variation);
-	_particles[i].y += RandomFloat(-emitter._y_variation, emitter._y_variation);
+	x += _random.Float(-emitter._x_variation, emitter._x_variation);
+	y += _random.Float(-emitter._y_variation, emitter._y_variation);
 
 	if(params.orientation != 0.0f)
-		RotatePoint(_particles[i].x, _particles[i].y, params.orientation);
+		RotatePoint(x, y, params.orientation);
 
-	_particles[i].color = _system_def->keyframes[0]->color;
+	_particles.Stream(PARTICLE_X)[i] = x;
+	_particles.Stream(PARTICLE_Y)[i] = y;
 
-	_particles[i].rotation_speed  = _system_def->keyframes[0]->rotation_speed;
-	_particles[i].time            = 0.0f;
-	_particles[i].size_x            = _system_def->keyframes[0]->size_x;
-	_particles[i].size_y            = _system_def->keyframes[0]->size_y;
+	const ParticleKeyframe *first_keyframe = _system_def->keyframes[0];
 
-	if(_system_def->random_initial_angle)
-		_particles[i].rotation_angle = RandomFloat(0.0f, UTILS_2PI);
-	else
-		_particles[i].rotation_angle = 0.0f;
+	_particles.Stream(PARTICLE_COLOR_R)[i]        = first_keyframe->color[0];
+	_particles.Stream(PARTICLE_COLOR_G)[i]        = first_keyframe->color[1];
+	_particles.Stream(PARTICLE_COLOR_B)[i]        = first_keyframe->color[2];
+	_particles.Stream(PARTICLE_COLOR_A)[i]        = first_keyframe->color[3];
+	_particles.Stream(PARTICLE_ROTATION_SPEED)[i] = first_keyframe->rotation_speed;
+	_particles.Stream(PARTICLE_TIME)[i]           = 0.0f;
+	_particles.Stream(PARTICLE_SIZE_X)[i]         = first_keyframe->size_x;
+	_particles.Stream(PARTICLE_SIZE_Y)[i]         = first_keyframe->size_y;
 
-	_particles[i].current_keyframe = _system_def->keyframes[0];
-
-	if(_system_def->keyframes.size() > 1)
-		_particles[i].next_keyframe = _system_def->keyframes[1];
+	if(_system_def->random_initial_angle)
+		_particles.Stream(PARTICLE_ROTATION_ANGLE)[i] = _random.Float(0.0f, UTILS_2PI);
 	else
-		_particles[i].next_keyframe = NULL;
+		_particles.Stream(PARTICLE_ROTATION_ANGLE)[i] = 0.0f;
 
 	float speed = _system_def->emitter._initial_speed;
-	speed += RandomFloat(-emitter._initial_speed_variation, emitter._initial_speed_variation);
+	speed += _random.Float(-emitter._initial_speed_variation, emitter._initial_speed_variation);
 
 
 	if(_system_def->emitter._spin == EMITTER_SPIN_CLOCKWISE)
 	{
-		_particles[i].rotation_direction = 1.0f;
+		_particles.Stream(PARTICLE_ROTATION_DIRECTION)[i] = 1.0f;
 	}
 	else if(_system_def->emitter._spin == EMITTER_SPIN_COUNTERCLOCKWISE)
 	{
-		_particles[i].rotation_direction = -1.0f;
+		_particles.Stream(PARTICLE_ROTATION_DIRECTION)[i] = -1.0f;
 	}
 	else
 	{
-		_particles[i].rotation_direction = static_cast<float>(2 * (rand()%2)) - 1.0f;
+		_particles.Stream(PARTICLE_ROTATION_DIRECTION)[i] = _random.Sign();
 	}
 
 	// figure out the orientation
@@ -888,92 +1178,111 @@ void ParticleSystem::_RespawnParticle(int32 i, const EffectParameters &params)
 
 	if(emitter._omnidirectional)
 	{
-		angle = RandomFloat(0.0f, UTILS_2PI);
+		angle = _random.Float(0.0f, UTILS_2PI);
 	}
 	else if(emitter._inner_cone == 0.0f && emitter._outer_cone == 0.0f)
 	{
 		angle = emitter._orientation + params.orientation;
 	}
 
-	_particles[i].velocity_x = speed * cosf(angle);
-	_particles[i].velocity_y = speed * sinf(angle);
-
-	// figure out property variations
-
-	_particles[i].current_size_variation_x  = RandomFloat(-_system_def->keyframes[0]->size_variation_x, _system_def->keyframes[0]->size_variation_x);
-	_particles[i].current_size_variation_y  = RandomFloat(-_system_def->keyframes[0]->size_variation_y, _system_def->keyframes[0]->size_variation_y);
+	_particles.Stream(PARTICLE_VELOCITY_X)[i] = speed * cosf(angle);
+	_particles.Stream(PARTICLE_VELOCITY_Y)[i] = speed * sinf(angle);
 
-	for(int32 j = 0; j < 4; ++j)
-		_particles[i].current_color_variation[j] = RandomFloat(-_system_def->keyframes[0]->color_variation[j], _system_def->keyframes[0]->color_variation[j]);
+	// figure out the values to interpolate the keyframed properties between
 
-	_particles[i].current_rotation_speed_variation = RandomFloat(-_system_def->keyframes[0]->rotation_speed_variation, _system_def->keyframes[0]->rotation_speed_variation);
+	_particles.next_keyframe[i] = 1;
+	_particles.Stream(PARTICLE_KEYFRAME_TIME)[i] = first_keyframe->time;
 
 	if(_system_def->keyframes.size() > 1)
 	{
-		// figure out the next keyframe's variations
-		_particles[i].next_size_variation_x  = RandomFloat(-_system_def->keyframes[1]->size_variation_x, _system_def->keyframes[1]->size_variation_x);
-		_particles[i].next_size_variation_y  = RandomFloat(-_system_def->keyframes[1]->size_variation_y, _system_def->keyframes[1]->size_variation_y);
+		const ParticleKeyframe *second_keyframe = _system_def->keyframes[1];
 
-		for(int32 j = 0; j < 4; ++j)
-			_particles[i].next_color_variation[j] = RandomFloat(-_system_def->keyframes[1]->color_variation[j], _system_def->keyframes[1]->color_variation[j]);
+		_SetKeyframeValues(i, first_keyframe, true);
+		_SetKeyframeValues(i, second_keyframe, false);
 
-		_particles[i].next_rotation_speed_variation = RandomFloat(-_system_def->keyframes[1]->rotation_speed_variation, _system_def->keyframes[1]->rotation_speed_variation);
+		float duration = second_keyframe->time - first_keyframe->time;
+		_particles.Stream(PARTICLE_NEXT_KEYFRAME_TIME)[i] = second_keyframe->time;
+		_particles.Stream(PARTICLE_KEYFRAME_INVERSE_DURATION)[i] = (duration > 0.0f) ? (1.0f / duration) : 0.0f;
 	}
 	else
 	{
-		// if there's only 1 keyframe, then apply the variations now
-		for(int32 j = 0; j < 4; ++j)
-			_particles[i].color[j] += RandomFloat(-_particles[i].current_color_variation[j], _particles[i].current_color_variation[j]);
+		// if there's only 1 keyframe, then apply the variations now. The start and end values
+		// are the same, so the interpolation holds the properties constant
+		for(int32 k = 0; k < NUM_KEYFRAMED_STREAMS; ++k)
+		{
+			float variation;
+			switch(KEYFRAMED_STREAMS[k][0])
+			{
+				case PARTICLE_ROTATION_SPEED: variation = first_keyframe->rotation_speed_variation; break;
+				case PARTICLE_SIZE_X:         variation = first_keyframe->size_variation_x; break;
+				case PARTICLE_SIZE_Y:         variation = first_keyframe->size_variation_y; break;
+				case PARTICLE_COLOR_R:        variation = first_keyframe->color_variation[0]; break;
+				case PARTICLE_COLOR_G:        variation = first_keyframe->color_variation[1]; break;
+				case PARTICLE_COLOR_B:        variation = first_keyframe->color_variation[2]; break;
+				default:                      variation = first_keyframe->color_variation[3]; break;
+			}
+
+			variation = _random.Float(-variation, variation);
 
-		_particles[i].size_x += RandomFloat(-_particles[i].current_size_variation_x, _particles[i].current_size_variation_x);
-		_particles[i].size_y += RandomFloat(-_particles[i].current_size_variation_y, _particles[i].current_size_variation_y);
+			float *value = _particles.Stream(KEYFRAMED_STREAMS[k][0]);
+			value[i] += _random.Float(-variation, variation);
+			_particles.Stream(KEYFRAMED_STREAMS[k][1])[i] = value[i];
+			_particles.Stream(KEYFRAMED_STREAMS[k][2])[i] = value[i];
+		}
 
-		_particles[i].rotation_speed += RandomFloat(-_particles[i].current_rotation_speed_variation, _particles[i].current_rotation_speed_variation);
+		_particles.Stream(PARTICLE_NEXT_KEYFRAME_TIME)[i] = PARTICLE_NO_KEYFRAME_TIME;
+		_particles.Stream(PARTICLE_KEYFRAME_INVERSE_DURATION)[i] = 0.0f;
 	}
 
-	_particles[i].tangential_acceleration = _system_def->tangential_acceleration;
+	float tangential_acceleration = _system_def->tangential_acceleration;
 	if(_system_def->tangential_acceleration_variation != 0.0f)
-		_particles[i].tangential_acceleration += RandomFloat(-_system_def->tangential_acceleration_variation, _system_def->tangential_acceleration_variation);
+		tangential_acceleration += _random.Float(-_system_def->tangential_acceleration_variation, _system_def->tangential_acceleration_variation);
+	_particles.Stream(PARTICLE_TANGENTIAL_ACCELERATION)[i] = tangential_acceleration;
 
-	_particles[i].radial_acceleration = _system_def->radial_acceleration;
+	float radial_acceleration = _system_def->radial_acceleration;
 	if(_system_def->radial_acceleration_variation != 0.0f)
-		_particles[i].radial_acceleration += RandomFloat(-_system_def->radial_acceleration_variation, _system_def->radial_acceleration_variation);
+		radial_acceleration += _random.Float(-_system_def->radial_acceleration_variation, _system_def->radial_acceleration_variation);
+	_particles.Stream(PARTICLE_RADIAL_ACCELERATION)[i] = radial_acceleration;
 
-	_particles[i].acceleration_x = _system_def->acceleration_x;
+	float acceleration_x = _system_def->acceleration_x;
 	if(_system_def->acceleration_variation_x != 0.0f)
-		_particles[i].acceleration_x += RandomFloat(-_system_def->acceleration_variation_x, _system_def->acceleration_variation_x);
+		acceleration_x += _random.Float(-_system_def->acceleration_variation_x, _system_def->acceleration_variation_x);
+	_particles.Stream(PARTICLE_ACCELERATION_X)[i] = acceleration_x;
 
-	_particles[i].acceleration_y = _system_def->acceleration_y;
+	float acceleration_y = _system_def->acceleration_y;
 	if(_system_def->acceleration_variation_y != 0.0f)
-		_particles[i].acceleration_y += RandomFloat(-_system_def->acceleration_variation_y, _system_def->acceleration_variation_y);
+		acceleration_y += _random.Float(-_system_def->acceleration_variation_y, _system_def->acceleration_variation_y);
+	_particles.Stream(PARTICLE_ACCELERATION_Y)[i] = acceleration_y;
 
-	_particles[i].wind_velocity_x = _system_def->wind_velocity_x;
+	float wind_velocity_x = _system_def->wind_velocity_x;
 	if(_system_def->wind_velocity_variation_x != 0.0f)
-		_particles[i].wind_velocity_x += RandomFloat(-_system_def->wind_velocity_variation_x, _system_def->wind_velocity_variation_x);
+		wind_velocity_x += _random.Float(-_system_def->wind_velocity_variation_x, _system_def->wind_velocity_variation_x);
+	_particles.Stream(PARTICLE_WIND_VELOCITY_X)[i] = wind_velocity_x;
 
-	_particles[i].wind_velocity_y = _system_def->wind_velocity_y;
+	float wind_velocity_y = _system_def->wind_velocity_y;
 	if(_system_def->wind_velocity_variation_y != 0.0f)
-		_particles[i].wind_velocity_y += RandomFloat(-_system_def->wind_velocity_variation_y, _system_def->wind_velocity_variation_y);
+		wind_velocity_y += _random.Float(-_system_def->wind_velocity_variation_y, _system_def->wind_velocity_variation_y);
+	_particles.Stream(PARTICLE_WIND_VELOCITY_Y)[i] = wind_velocity_y;
 
-	_particles[i].damping = _system_def->damping;
+	float damping = _system_def->damping;
 	if(_system_def->damping_variation != 0.0f)
-		_particles[i].damping += RandomFloat(-_system_def->damping_variation, _system_def->damping_variation);
+		damping += _random.Float(-_system_def->damping_variation, _system_def->damping_variation);
+	_particles.Stream(PARTICLE_DAMPING)[i] = damping;
 
 	if(_system_def->wave_motion_used)
 	{
-		_particles[i].wave_length_coefficient = _system_def->wave_length;
+		float wave_length = _system_def->wave_length;
 		if(_system_def->wave_length_variation != 0.0f)
-			_particles[i].wave_length_coefficient += RandomFloat(-_system_def->wave_length_variation, _system_def->wave_length_variation);
-
-		_particles[i].wave_length_coefficient = UTILS_2PI / _particles[i].wave_length_coefficient;
+			wave_length += _random.Float(-_system_def->wave_length_variation, _system_def->wave_length_variation);
+		_particles.Stream(PARTICLE_WAVE_LENGTH_COEFFICIENT)[i] = UTILS_2PI / wave_length;
 
-		_particles[i].wave_half_amplitude = _system_def->wave_amplitude;
+		float wave_amplitude = _system_def->wave_amplitude;
 		if(_system_def->wave_amplitude != 0.0f)
-			_particles[i].wave_half_amplitude += RandomFloat(-_system_def->wave_amplitude_variation, _system_def->wave_amplitude_variation);
-		_particles[i].wave_half_amplitude *= 0.5f;
+			wave_amplitude += _random.Float(-_system_def->wave_amplitude_variation, _system_def->wave_amplitude_variation);
+		_particles.Stream(PARTICLE_WAVE_HALF_AMPLITUDE)[i] = wave_amplitude * 0.5f;
 	}
 
-	_particles[i].lifetime = _system_def->particle_lifetime + RandomFloat(-_system_def->particle_lifetime_variation, _system_def->particle_lifetime_variation);
+	_particles.Stream(PARTICLE_LIFETIME)[i] = _system_def->particle_lifetime + _random.Float(-_system_def->particle_lifetime_variation, _system_def->particle_lifetime_variation);
 }
 
 
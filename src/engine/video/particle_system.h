@@ -59,6 +59,27 @@ public:
 };
 
 
+/*!***************************************************************************
+ *  \brief a single particle system that is to be updated this frame, along
+ *         with the parameters of the effect that it belongs to. These are
+ *         handed to the ParticleUpdatePool by the ParticleManager.
+ *****************************************************************************/
+
+class ParticleUpdateJob
+{
+public:
+
+	//! the system to update
+	ParticleSystem* system;
+
+	//! the parameters of the effect that the system belongs to
+	EffectParameters parameters;
+
+	//! set to false by the pool if the system failed to update
+	bool success;
+};
+
+
 class ParticleSystemDef
 {
 public:
@@ -247,20 +268,25 @@ public:
 	 *  \brief initializes this particle system as an instance of the
 	 *         type of particle system specified by the ParticleSystemDef
 	 * \param sys_def particle definition to base the system off of
+	 * \param seed the seed for the system's random number stream
 	 * \return success/failure
 	 */		
-	bool Create(const ParticleSystemDef *sys_def);
+	bool Create(const ParticleSystemDef *sys_def, uint32 seed);
 
 
 	/*!
-	 *  \brief draws the system
+	 *  \brief draws the system. This only submits the vertex arrays that
+	 *         were built by the last call to Update() to OpenGL.
 	 * \return success/failure
 	 */	
 	bool Draw();
 	
 
 	/*!
-	 *  \brief updates the system
+	 *  \brief updates the system and builds the vertex arrays for drawing it
+	 *
+	 *  This does not touch OpenGL or any state shared with other systems, so
+	 *  different systems may be updated on different threads at the same time.
 	 * \param frame_time the current frame time
 	 * \param params the effect parameters to use for this update (orientation and attractor point)
 	 * \return success/failure
@@ -360,6 +386,57 @@ private:
 	void _RespawnParticle(int32 i, const EffectParameters &params);
 
 
+	/*!
+	 *  \brief moves a particle on to the keyframe that it has reached and
+	 *         computes the start and end values to interpolate between until
+	 *         the following keyframe
+	 * \param i index of the particle
+	 * \param scaled_time the particle's age divided by its lifetime
+	 */
+	void _AdvanceKeyframe(int32 i, float scaled_time);
+
+
+	/*!
+	 *  \brief sets either the start or the end values of a particle's keyframed
+	 *         properties to the values in a keyframe plus a random variation
+	 * \param i index of the particle
+	 * \param keyframe the keyframe to take the values from
+	 * \param start true to set the start values, false to set the end values
+	 */
+	void _SetKeyframeValues(int32 i, const ParticleKeyframe *keyframe, bool start);
+
+
+	/*!
+	 *  \brief helper function to _UpdateParticles() which applies wave motion
+	 *         to the combined velocities
+	 */
+	void _ApplyWaveMotion();
+
+
+	/*!
+	 *  \brief helper function to _UpdateParticles() which applies radial and
+	 *         tangential acceleration to the velocities
+	 * \param t the current frame time
+	 * \param params the effect parameters to use for this update (orientation and attractor point)
+	 */
+	void _ApplyAttractorAcceleration(float t, const EffectParameters &params);
+
+
+	/*!
+	 *  \brief helper function to Update() which fills the vertex, color, and
+	 *         texture coordinate arrays from the particle streams
+	 */
+	void _BuildVertexArrays();
+
+
+	/*!
+	 *  \brief helper function to _BuildVertexArrays() which fills a color array
+	 * \param colors the array to fill
+	 * \param modulation amount to scale the red, green, and blue components by
+	 */
+	void _FillColors(std::vector<Color> &colors, float modulation);
+
+
 	//! The system definition, contains information like the emitter properties, lifetime of
 	//! particles, particle keyframes, etc. Basically everything which isn't instance-specific
 	const ParticleSystemDef *_system_def;
@@ -378,11 +455,19 @@ private:
 	//! This is used for rendering the particles with OpenGL
 	std::vector <ParticleVertex>   _particle_vertices;
 	std::vector <Color>            _particle_colors;
-	std::vector <ParticleTexCoord> _particle_texcoords;
-	
-	//! This array holds everything except positions and colors. The reason we keep positions and
-	//! colors separate is so that they can be efficiently fed to OpenGL for rendering.
-	std::vector <Particle>     _particles;
+	ParticleTexCoordArray          _particle_texcoords;
+
+	//! The colors and texture coordinates for the second pass that blends in the next animation
+	//! frame. These are only filled in when smooth animation is used.
+	std::vector <Color>            _particle_next_colors;
+	ParticleTexCoordArray          _particle_next_texcoords;
+
+	//! The properties of every particle, stored as one stream per property. The vertex, color, and
+	//! texture coordinate arrays above are generated from these streams at the end of each update.
+	ParticleArray _particles;
+
+	//! The random number stream used for everything about this system's particles
+	ParticleRandom _random;
 	
 	//! if stopped is true, no new particles should be emitted
 	bool _stopped;
@@ -0,0 +1,204 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2015 by The Allacrost Project
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    particle_update_pool.cpp
+*** \author  Tyler Olsen, roots@allacrost.org
+*** \brief   Source file for updating particle systems on several threads
+*** ***************************************************************************/
+
+#include <SDL2/SDL.h>
+
+#include "video.h"
+#include "particle_update_pool.h"
+#include "particle_system.h"
+
+using namespace std;
+using namespace hoa_utils;
+
+namespace hoa_video {
+
+namespace private_video {
+
+ParticleUpdatePool::ParticleUpdatePool() :
+	_num_threads(1),
+	_mutex(NULL),
+	_work_ready(NULL),
+	_work_done(NULL),
+	_jobs(NULL),
+	_frame_time(0.0f),
+	_next_job(0),
+	_jobs_remaining(0),
+	_generation(0),
+	_shutdown(false)
+{
+	SetNumberThreads(0);
+}
+
+
+
+ParticleUpdatePool::~ParticleUpdatePool() {
+	_StopThreads();
+
+	if (_work_done != NULL)
+		SDL_DestroyCond(_work_done);
+	if (_work_ready != NULL)
+		SDL_DestroyCond(_work_ready);
+	if (_mutex != NULL)
+		SDL_DestroyMutex(_mutex);
+}
+
+
+
+void ParticleUpdatePool::Run(vector<ParticleUpdateJob>& jobs, float frame_time) {
+	if (jobs.empty() == true)
+		return;
+
+	// There is nothing to gain from waking the workers when there is only one system to update
+	if (_num_threads <= 1 || jobs.size() == 1 || _StartThreads() == false) {
+		for (uint32 i = 0; i < jobs.size(); i++) {
+			jobs[i].success = jobs[i].system->Update(frame_time, jobs[i].parameters);
+		}
+		return;
+	}
+
+	SDL_LockMutex(_mutex);
+	_jobs = &jobs;
+	_frame_time = frame_time;
+	_next_job = 0;
+	_jobs_remaining = jobs.size();
+	_generation++;
+	SDL_CondBroadcast(_work_ready);
+
+	// The calling thread works on the jobs too rather than sitting idle while it waits
+	_RunJobs();
+	while (_jobs_remaining > 0) {
+		SDL_CondWait(_work_done, _mutex);
+	}
+	_jobs = NULL;
+	SDL_UnlockMutex(_mutex);
+}
+
+
+
+void ParticleUpdatePool::SetNumberThreads(uint32 num_threads) {
+	_StopThreads();
+
+	if (num_threads == 0) {
+		int32 cpu_count = SDL_GetCPUCount();
+		num_threads = (cpu_count > 1) ? static_cast<uint32>(cpu_count) : 1;
+	}
+	if (num_threads > MAX_PARTICLE_UPDATE_THREADS)
+		num_threads = MAX_PARTICLE_UPDATE_THREADS;
+
+	_num_threads = num_threads;
+}
+
+
+
+bool ParticleUpdatePool::_StartThreads() {
+	if (_threads.empty() == false)
+		return true;
+
+	if (_mutex == NULL) {
+		_mutex = SDL_CreateMutex();
+		_work_ready = SDL_CreateCond();
+		_work_done = SDL_CreateCond();
+		if (_mutex == NULL || _work_ready == NULL || _work_done == NULL) {
+			PRINT_ERROR << "failed to create the particle update synchronization objects: " << SDL_GetError() << endl;
+			_num_threads = 1;
+			return false;
+		}
+	}
+
+	_shutdown = false;
+	for (uint32 i = 1; i < _num_threads; i++) {
+		SDL_Thread* thread = SDL_CreateThread(_WorkerThreadEntry, "ParticleUpdate", this);
+		if (thread == NULL) {
+			IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to create a particle update thread: " << SDL_GetError() << endl;
+			break;
+		}
+		_threads.push_back(thread);
+	}
+
+	if (_threads.empty() == true) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "no particle update threads could be created, particles will be updated on the main thread" << endl;
+		_num_threads = 1;
+		return false;
+	}
+
+	_num_threads = _threads.size() + 1;
+	IF_PRINT_DEBUG(VIDEO_DEBUG) << "started " << _threads.size() << " particle update threads" << endl;
+	return true;
+} // bool ParticleUpdatePool::_StartThreads()
+
+
+
+void ParticleUpdatePool::_StopThreads() {
+	if (_threads.empty() == true)
+		return;
+
+	SDL_LockMutex(_mutex);
+	_shutdown = true;
+	SDL_CondBroadcast(_work_ready);
+	SDL_UnlockMutex(_mutex);
+
+	for (uint32 i = 0; i < _threads.size(); i++) {
+		SDL_WaitThread(_threads[i], NULL);
+	}
+	_threads.clear();
+}
+
+
+
+void ParticleUpdatePool::_RunJobs() {
+	while (_jobs != NULL && _next_job < _jobs->size()) {
+		ParticleUpdateJob& job = (*_jobs)[_next_job];
+		float frame_time = _frame_time;
+		_next_job++;
+		SDL_UnlockMutex(_mutex);
+
+		// No other thread touches this job's system until the job is counted as finished
+		job.success = job.system->Update(frame_time, job.parameters);
+
+		SDL_LockMutex(_mutex);
+		_jobs_remaining--;
+		if (_jobs_remaining == 0)
+			SDL_CondBroadcast(_work_done);
+	}
+}
+
+
+
+int ParticleUpdatePool::_WorkerThreadEntry(void* data) {
+	static_cast<ParticleUpdatePool*>(data)->_WorkerThread();
+	return 0;
+}
+
+
+
+void ParticleUpdatePool::_WorkerThread() {
+	SDL_LockMutex(_mutex);
+	uint32 last_generation = _generation;
+	while (true) {
+		while (_generation == last_generation && _shutdown == false) {
+			SDL_CondWait(_work_ready, _mutex);
+		}
+		if (_shutdown == true)
+			break;
+
+		last_generation = _generation;
+		_RunJobs();
+	}
+	SDL_UnlockMutex(_mutex);
+}
+
+} // namespace private_video
+
+} // namespace hoa_video
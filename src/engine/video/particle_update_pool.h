@@ -0,0 +1,133 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2015 by The Allacrost Project
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    particle_update_pool.h
+*** \author  Tyler Olsen, roots@allacrost.org
+*** \brief   Header file for updating particle systems on several threads
+***
+*** Every particle system is independent of every other one: each owns its own
+*** particles, vertex arrays, and random number stream. The particle manager
+*** collects one job per system each frame and hands the whole set to the pool
+*** in this file, which updates the systems across a set of worker threads and
+*** returns once all of them are done. Drawing still takes place on the main
+*** thread, since it is the only thread that may use the OpenGL context.
+*** ***************************************************************************/
+
+#ifndef __PARTICLE_UPDATE_POOL_HEADER__
+#define __PARTICLE_UPDATE_POOL_HEADER__
+
+#include <SDL2/SDL_thread.h>
+#include <SDL2/SDL_mutex.h>
+
+#include "defs.h"
+#include "utils.h"
+
+namespace hoa_video {
+
+namespace private_video {
+
+//! \brief The maximum number of threads, including the calling thread, that will update particle systems
+const uint32 MAX_PARTICLE_UPDATE_THREADS = 8;
+
+/** ****************************************************************************
+*** \brief Updates a set of particle systems in parallel
+***
+*** The thread that calls Run() works on the jobs alongside the worker threads, so
+*** a pool set to use N threads only creates N - 1 workers. The workers sleep
+*** between calls to Run(). Jobs are handed out one system at a time, which keeps
+*** every thread busy when the systems differ greatly in their number of particles.
+***
+*** Because each system draws from its own random number stream, the results of
+*** an update are the same no matter how many threads are used or which thread
+*** happens to update a given system.
+***
+*** \note The ParticleManager owns the single instance of this class.
+*** ***************************************************************************/
+class ParticleUpdatePool {
+public:
+	ParticleUpdatePool();
+
+	//! \brief Stops all worker threads
+	~ParticleUpdatePool();
+
+	/** \brief Updates every system in a set of jobs, returning once all of them are finished
+	*** \param jobs The systems to update. The success member of each job is set by this call.
+	*** \param frame_time The number of seconds to update the systems by
+	*** \note ParticleUpdateJob is defined in particle_system.h, which must be included to make this call
+	**/
+	void Run(std::vector<ParticleUpdateJob>& jobs, float frame_time);
+
+	/** \brief Sets the number of threads to use for updates, including the calling thread
+	*** \param num_threads The number of threads to use. Zero picks a number based on the number of CPU cores.
+	*** \note Any existing worker threads are stopped and new ones are created on the next call to Run()
+	**/
+	void SetNumberThreads(uint32 num_threads);
+
+	//! \brief Returns the number of threads that will be used by the next call to Run()
+	uint32 GetNumberThreads() const
+		{ return _num_threads; }
+
+private:
+	//! \brief The number of threads to use, including the calling thread
+	uint32 _num_threads;
+
+	//! \brief The worker threads
+	std::vector<SDL_Thread*> _threads;
+
+	//! \brief Protects every member below
+	SDL_mutex* _mutex;
+
+	//! \brief Signalled when a new set of jobs is available or when the workers are to shut down
+	SDL_cond* _work_ready;
+
+	//! \brief Signalled when the last job of a set is finished
+	SDL_cond* _work_done;
+
+	//! \brief The jobs being run by the current call to Run(), or NULL when there are none
+	std::vector<ParticleUpdateJob>* _jobs;
+
+	//! \brief The frame time for the current set of jobs
+	float _frame_time;
+
+	//! \brief The index of the next job to hand out
+	uint32 _next_job;
+
+	//! \brief The number of jobs in the current set that have not yet finished
+	uint32 _jobs_remaining;
+
+	//! \brief Incremented for every new set of jobs, so that the workers can tell a new set from one they have already seen
+	uint32 _generation;
+
+	//! \brief Set to true when the worker threads should exit
+	bool _shutdown;
+
+	//! \brief Creates the worker threads if they do not already exist
+	bool _StartThreads();
+
+	//! \brief Stops and waits for all worker threads
+	void _StopThreads();
+
+	/** \brief Takes jobs from the current set and runs them until none are left
+	*** \note The mutex must be locked when this is called, and is locked again when it returns
+	**/
+	void _RunJobs();
+
+	//! \brief The entry point of each worker thread. The data argument is a pointer to the ParticleUpdatePool.
+	static int _WorkerThreadEntry(void* data);
+
+	//! \brief Waits for new sets of jobs and helps to run them until the pool shuts down
+	void _WorkerThread();
+}; // class ParticleUpdatePool
+
+} // namespace private_video
+
+} // namespace hoa_video
+
+#endif // __PARTICLE_UPDATE_POOL_HEADER__
@@ -0,0 +1,574 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2015 by The Allacrost Project
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    screen_capture.cpp
+*** \author  Tyler Olsen, roots@allacrost.org
+*** \brief   Source file for writing screenshots without stalling the game loop
+*** ***************************************************************************/
+
+#include <cstddef>
+#include <iomanip>
+
+#include <SDL2/SDL.h>
+
+#include "screen_capture.h"
+#include "video.h"
+
+using namespace std;
+using namespace hoa_utils;
+
+// Pixel buffer objects were added to the core of OpenGL 2.1, which the headers on some platforms predate
+#ifndef GL_PIXEL_PACK_BUFFER
+	#define GL_PIXEL_PACK_BUFFER 0x88EB
+#endif
+#ifndef GL_STREAM_READ
+	#define GL_STREAM_READ 0x88E1
+#endif
+#ifndef GL_READ_ONLY
+	#define GL_READ_ONLY 0x88B8
+#endif
+#ifndef APIENTRY
+	#define APIENTRY
+#endif
+
+namespace hoa_video {
+
+namespace private_video {
+
+// -----------------------------------------------------------------------------
+// Pixel buffer object functions
+// -----------------------------------------------------------------------------
+
+// These are retrieved at run time rather than linked against, so that the game still runs where they are missing
+typedef void (APIENTRY* GenBuffersFunction)(GLsizei count, GLuint* buffers);
+typedef void (APIENTRY* DeleteBuffersFunction)(GLsizei count, const GLuint* buffers);
+typedef void (APIENTRY* BindBufferFunction)(GLenum target, GLuint buffer);
+typedef void (APIENTRY* BufferDataFunction)(GLenum target, ptrdiff_t size, const GLvoid* data, GLenum usage);
+typedef GLvoid* (APIENTRY* MapBufferFunction)(GLenum target, GLenum access);
+typedef GLboolean (APIENTRY* UnmapBufferFunction)(GLenum target);
+
+static GenBuffersFunction GenBuffers = NULL;
+static DeleteBuffersFunction DeleteBuffers = NULL;
+static BindBufferFunction BindBuffer = NULL;
+static BufferDataFunction BufferData = NULL;
+static MapBufferFunction MapBuffer = NULL;
+static UnmapBufferFunction UnmapBuffer = NULL;
+
+//! \brief Retrieves an OpenGL function by its core name, or by the name of its ARB extension if the core name is unavailable
+static void* GetBufferFunction(const string& name) {
+	void* function = SDL_GL_GetProcAddress(name.c_str());
+	if (function == NULL)
+		function = SDL_GL_GetProcAddress((name + "ARB").c_str());
+	return function;
+}
+
+//! \brief Retrieves every function needed to read the screen into pixel buffer objects. Returns false if they are not supported.
+static bool LoadBufferFunctions() {
+	const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+	const char* extensions = reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+
+	bool supported = false;
+	if (version != NULL && (version[0] > '2' || (version[0] == '2' && version[1] == '.' && version[2] >= '1')))
+		supported = true;
+	else if (extensions != NULL && strstr(extensions, "GL_ARB_pixel_buffer_object") != NULL)
+		supported = true;
+	if (supported == false)
+		return false;
+
+	GenBuffers = reinterpret_cast<GenBuffersFunction>(GetBufferFunction("glGenBuffers"));
+	DeleteBuffers = reinterpret_cast<DeleteBuffersFunction>(GetBufferFunction("glDeleteBuffers"));
+	BindBuffer = reinterpret_cast<BindBufferFunction>(GetBufferFunction("glBindBuffer"));
+	BufferData = reinterpret_cast<BufferDataFunction>(GetBufferFunction("glBufferData"));
+	MapBuffer = reinterpret_cast<MapBufferFunction>(GetBufferFunction("glMapBuffer"));
+	UnmapBuffer = reinterpret_cast<UnmapBufferFunction>(GetBufferFunction("glUnmapBuffer"));
+
+	return (GenBuffers != NULL && DeleteBuffers != NULL && BindBuffer != NULL && BufferData != NULL &&
+		MapBuffer != NULL && UnmapBuffer != NULL);
+}
+
+// -----------------------------------------------------------------------------
+// Capture jobs
+// -----------------------------------------------------------------------------
+
+//! \brief Flips the rows of a capture, writes it to its file, and frees its pixels. Safe to call from any thread.
+static void WriteCapture(ScreenCaptureJob* job) {
+	ImageMemory& image = job->image;
+	uint32 row_size = image.width * 4;
+	uint8* pixels = static_cast<uint8*>(image.pixels);
+
+	// OpenGL returns the bottom row first, so swap the rows in place rather than copying the whole image
+	vector<uint8> row(row_size);
+	for (int32 top = 0, bottom = image.height - 1; top < bottom; top++, bottom--) {
+		memcpy(&row[0], pixels + top * row_size, row_size);
+		memcpy(pixels + top * row_size, pixels + bottom * row_size, row_size);
+		memcpy(pixels + bottom * row_size, &row[0], row_size);
+	}
+
+	// The alpha channel of the screen is meaningless and would leave holes in a PNG image
+	if (job->png == true) {
+		uint8* end = pixels + row_size * image.height;
+		for (uint8* i = pixels + 3; i < end; i += 4) {
+			*i = 0xFF;
+		}
+	}
+
+	job->success = image.SaveImage(job->filename, job->png);
+
+	free(image.pixels);
+	image.pixels = NULL;
+}
+
+
+
+//! \brief Invokes the callback of a capture and deletes it
+static void FinishJob(ScreenCaptureJob* job) {
+	if (job->image.pixels != NULL) {
+		free(job->image.pixels);
+		job->image.pixels = NULL;
+	}
+
+	if (job->success == false)
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to write screen capture: " << job->filename << endl;
+
+	if (job->callback != NULL)
+		job->callback(job->filename, job->success, job->callback_data);
+	delete job;
+}
+
+// -----------------------------------------------------------------------------
+// ScreenCapture class
+// -----------------------------------------------------------------------------
+
+ScreenCapture::ScreenCapture() :
+	_next_read(0),
+	_buffers_checked(false),
+	_use_buffers(false),
+	_sequence_active(false),
+	_sequence_interval(1),
+	_sequence_png(false),
+	_sequence_frame(0),
+	_sequence_captured(0),
+	_sequence_dropped(0),
+	_thread(NULL),
+	_mutex(NULL),
+	_job_queued(NULL),
+	_job_finished(NULL),
+	_jobs_pending(0),
+	_shutdown(false)
+{}
+
+
+
+ScreenCapture::~ScreenCapture() {
+	// The worker writes every capture left in its queue before it exits
+	if (_thread != NULL) {
+		SDL_LockMutex(_mutex);
+		_shutdown = true;
+		SDL_CondBroadcast(_job_queued);
+		SDL_UnlockMutex(_mutex);
+		SDL_WaitThread(_thread, NULL);
+		_thread = NULL;
+	}
+
+	// Anything still waiting on the screen can no longer be read, and the objects that the callbacks refer to may already be gone
+	for (uint32 i = 0; i < _requests.size(); i++) {
+		delete _requests[i];
+	}
+	_requests.clear();
+	for (uint32 i = 0; i < SCREEN_CAPTURE_READ_BUFFERS; i++) {
+		for (uint32 j = 0; j < _reads[i].jobs.size(); j++) {
+			delete _reads[i].jobs[j];
+		}
+		_reads[i].jobs.clear();
+	}
+	for (uint32 i = 0; i < _finished.size(); i++) {
+		delete _finished[i];
+	}
+	_finished.clear();
+
+	if (_job_finished != NULL)
+		SDL_DestroyCond(_job_finished);
+	if (_job_queued != NULL)
+		SDL_DestroyCond(_job_queued);
+	if (_mutex != NULL)
+		SDL_DestroyMutex(_mutex);
+}
+
+
+
+void ScreenCapture::RequestCapture(const string& filename, ScreenCaptureCallback callback, void* callback_data) {
+	ScreenCaptureJob* job = new ScreenCaptureJob();
+	job->filename = filename;
+	// Only the .png and .jpg extensions are part of the game's file standard, so there is no need to consider other forms of them
+	job->png = (filename.length() >= 4 && filename.compare(filename.length() - 4, 4, ".png") == 0);
+	job->callback = callback;
+	job->callback_data = callback_data;
+	_requests.push_back(job);
+}
+
+
+
+bool ScreenCapture::StartSequence(const string& filename_prefix, uint32 frame_interval, bool png) {
+	if (_sequence_active == true) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "a capture sequence was already active: " << _sequence_prefix << endl;
+		return false;
+	}
+
+	_sequence_active = true;
+	_sequence_prefix = filename_prefix;
+	_sequence_interval = (frame_interval > 0) ? frame_interval : 1;
+	_sequence_png = png;
+	_sequence_frame = 0;
+	_sequence_captured = 0;
+	_sequence_dropped = 0;
+	return true;
+}
+
+
+
+uint32 ScreenCapture::StopSequence() {
+	if (_sequence_active == false)
+		return 0;
+
+	_sequence_active = false;
+	if (_sequence_dropped > 0) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "dropped " << _sequence_dropped << " frames of capture sequence: " << _sequence_prefix
+			<< " because they could not be written quickly enough" << endl;
+	}
+	IF_PRINT_DEBUG(VIDEO_DEBUG) << "captured " << _sequence_captured << " of " << _sequence_frame << " frames for sequence: "
+		<< _sequence_prefix << endl;
+	return _sequence_captured;
+}
+
+
+
+void ScreenCapture::Update() {
+	// Every read in flight was issued on an earlier frame, so the GPU is done with them by now
+	for (uint32 i = 0; i < SCREEN_CAPTURE_READ_BUFFERS; i++) {
+		if (_reads[i].jobs.empty() == false)
+			_CompleteRead(_reads[i]);
+	}
+
+	vector<ScreenCaptureJob*> jobs;
+	jobs.swap(_requests);
+
+	if (_sequence_active == true) {
+		if (_sequence_frame % _sequence_interval == 0) {
+			if (_GetPendingJobs() >= SCREEN_CAPTURE_MAX_PENDING) {
+				_sequence_dropped++;
+			}
+			else {
+				ostringstream filename;
+				filename << _sequence_prefix << setw(6) << setfill('0') << _sequence_captured << (_sequence_png ? ".png" : ".jpg");
+
+				ScreenCaptureJob* job = new ScreenCaptureJob();
+				job->filename = filename.str();
+				job->png = _sequence_png;
+				jobs.push_back(job);
+				_sequence_captured++;
+			}
+		}
+		_sequence_frame++;
+	}
+
+	if (jobs.empty() == false)
+		_ReadScreen(jobs);
+
+	_InvokeCallbacks();
+}
+
+
+
+void ScreenCapture::Finish() {
+	for (uint32 i = 0; i < SCREEN_CAPTURE_READ_BUFFERS; i++) {
+		if (_reads[i].jobs.empty() == false)
+			_CompleteRead(_reads[i]);
+	}
+
+	// Requests made since the last frame are read right away, and then completed without waiting for another frame
+	if (_requests.empty() == false) {
+		vector<ScreenCaptureJob*> jobs;
+		jobs.swap(_requests);
+		_ReadScreen(jobs);
+		for (uint32 i = 0; i < SCREEN_CAPTURE_READ_BUFFERS; i++) {
+			if (_reads[i].jobs.empty() == false)
+				_CompleteRead(_reads[i]);
+		}
+	}
+
+	if (_mutex != NULL) {
+		SDL_LockMutex(_mutex);
+		while (_jobs_pending > 0) {
+			SDL_CondWait(_job_finished, _mutex);
+		}
+		SDL_UnlockMutex(_mutex);
+	}
+
+	_InvokeCallbacks();
+}
+
+
+
+void ScreenCapture::DestroyBuffers() {
+	if (_use_buffers == true) {
+		for (uint32 i = 0; i < SCREEN_CAPTURE_READ_BUFFERS; i++) {
+			if (_reads[i].jobs.empty() == false)
+				_CompleteRead(_reads[i]);
+			DeleteBuffers(1, &_reads[i].buffer);
+			_reads[i].buffer = 0;
+		}
+	}
+
+	// The new context may differ in its support, so it is checked again the next time a buffer is needed
+	_buffers_checked = false;
+	_use_buffers = false;
+}
+
+
+
+bool ScreenCapture::_StartThread() {
+	if (_thread != NULL)
+		return true;
+
+	if (_mutex == NULL) {
+		_mutex = SDL_CreateMutex();
+		_job_queued = SDL_CreateCond();
+		_job_finished = SDL_CreateCond();
+		if (_mutex == NULL || _job_queued == NULL || _job_finished == NULL) {
+			PRINT_ERROR << "failed to create the screen capture synchronization objects: " << SDL_GetError() << endl;
+			return false;
+		}
+	}
+
+	_shutdown = false;
+	_thread = SDL_CreateThread(_WorkerThreadEntry, "ScreenCapture", this);
+	if (_thread == NULL) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to create the screen capture thread, captures will be written on the main thread: "
+			<< SDL_GetError() << endl;
+		return false;
+	}
+
+	return true;
+}
+
+
+
+void ScreenCapture::_CreateBuffers() {
+	_buffers_checked = true;
+	_use_buffers = LoadBufferFunctions();
+	if (_use_buffers == false) {
+		IF_PRINT_DEBUG(VIDEO_DEBUG) << "pixel buffer objects are not supported, the screen will be read directly" << endl;
+		return;
+	}
+
+	for (uint32 i = 0; i < SCREEN_CAPTURE_READ_BUFFERS; i++) {
+		GenBuffers(1, &_reads[i].buffer);
+	}
+
+	if (VideoManager->CheckGLError() == true) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to create pixel buffer objects: " << VideoManager->CreateGLErrorString() << endl;
+		for (uint32 i = 0; i < SCREEN_CAPTURE_READ_BUFFERS; i++) {
+			DeleteBuffers(1, &_reads[i].buffer);
+			_reads[i].buffer = 0;
+		}
+		_use_buffers = false;
+	}
+}
+
+
+
+void ScreenCapture::_ReadScreen(vector<ScreenCaptureJob*>& jobs) {
+	if (_buffers_checked == false)
+		_CreateBuffers();
+
+	GLint viewport_dimensions[4]; // viewport_dimensions[2] is the width, [3] is the height
+	glGetIntegerv(GL_VIEWPORT, viewport_dimensions);
+	int32 width = viewport_dimensions[2];
+	int32 height = viewport_dimensions[3];
+
+	// Reading RGBA keeps every row aligned, and the conversion to RGB for JPEG images is done on the worker thread
+	if (_use_buffers == true) {
+		PendingRead& read = _reads[_next_read];
+		_next_read = (_next_read + 1) % SCREEN_CAPTURE_READ_BUFFERS;
+
+		BindBuffer(GL_PIXEL_PACK_BUFFER, read.buffer);
+		BufferData(GL_PIXEL_PACK_BUFFER, width * height * 4, NULL, GL_STREAM_READ);
+		glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		if (VideoManager->CheckGLError() == false) {
+			read.width = width;
+			read.height = height;
+			read.jobs.swap(jobs);
+			return;
+		}
+
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "an OpenGL error occurred: " << VideoManager->CreateGLErrorString() << endl;
+		for (uint32 i = 0; i < jobs.size(); i++) {
+			FinishJob(jobs[i]);
+		}
+		jobs.clear();
+		return;
+	}
+
+	ImageMemory& image = jobs[0]->image;
+	image.width = width;
+	image.height = height;
+	image.rgb_format = false;
+	image.pixels = malloc(width * height * 4);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels);
+
+	if (VideoManager->CheckGLError() == true) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "an OpenGL error occurred: " << VideoManager->CreateGLErrorString() << endl;
+		for (uint32 i = 0; i < jobs.size(); i++) {
+			FinishJob(jobs[i]);
+		}
+		jobs.clear();
+		return;
+	}
+
+	_QueueJobs(jobs);
+} // void ScreenCapture::_ReadScreen(vector<ScreenCaptureJob*>& jobs)
+
+
+
+void ScreenCapture::_CompleteRead(PendingRead& read) {
+	vector<ScreenCaptureJob*> jobs;
+	jobs.swap(read.jobs);
+
+	BindBuffer(GL_PIXEL_PACK_BUFFER, read.buffer);
+	void* data = MapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+	if (data == NULL) {
+		BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to map a pixel buffer object" << endl;
+		for (uint32 i = 0; i < jobs.size(); i++) {
+			FinishJob(jobs[i]);
+		}
+		return;
+	}
+
+	// The buffer may only be mapped on the thread that owns the context, so its contents are copied out for the worker
+	ImageMemory& image = jobs[0]->image;
+	image.width = read.width;
+	image.height = read.height;
+	image.rgb_format = false;
+	image.pixels = malloc(read.width * read.height * 4);
+	memcpy(image.pixels, data, read.width * read.height * 4);
+
+	UnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	_QueueJobs(jobs);
+}
+
+
+
+void ScreenCapture::_QueueJobs(vector<ScreenCaptureJob*>& jobs) {
+	// Every capture requested on the same frame shares the one read of the screen
+	const ImageMemory& source = jobs[0]->image;
+	for (uint32 i = 1; i < jobs.size(); i++) {
+		ImageMemory& image = jobs[i]->image;
+		image.width = source.width;
+		image.height = source.height;
+		image.rgb_format = source.rgb_format;
+		image.pixels = malloc(source.width * source.height * 4);
+		memcpy(image.pixels, source.pixels, source.width * source.height * 4);
+	}
+
+	if (_StartThread() == false) {
+		for (uint32 i = 0; i < jobs.size(); i++) {
+			WriteCapture(jobs[i]);
+			FinishJob(jobs[i]);
+		}
+		jobs.clear();
+		return;
+	}
+
+	SDL_LockMutex(_mutex);
+	for (uint32 i = 0; i < jobs.size(); i++) {
+		_queue.push_back(jobs[i]);
+	}
+	_jobs_pending += jobs.size();
+	SDL_CondSignal(_job_queued);
+	SDL_UnlockMutex(_mutex);
+	jobs.clear();
+}
+
+
+
+void ScreenCapture::_InvokeCallbacks() {
+	if (_mutex == NULL)
+		return;
+
+	vector<ScreenCaptureJob*> finished;
+	SDL_LockMutex(_mutex);
+	finished.swap(_finished);
+	SDL_UnlockMutex(_mutex);
+
+	// The lock is not held here, since a callback may well request another capture
+	for (uint32 i = 0; i < finished.size(); i++) {
+		FinishJob(finished[i]);
+	}
+}
+
+
+
+uint32 ScreenCapture::_GetPendingJobs() {
+	uint32 pending = 0;
+	for (uint32 i = 0; i < SCREEN_CAPTURE_READ_BUFFERS; i++) {
+		pending += _reads[i].jobs.size();
+	}
+
+	if (_mutex != NULL) {
+		SDL_LockMutex(_mutex);
+		pending += _jobs_pending;
+		SDL_UnlockMutex(_mutex);
+	}
+	return pending;
+}
+
+
+
+int ScreenCapture::_WorkerThreadEntry(void* data) {
+	static_cast<ScreenCapture*>(data)->_WorkerThread();
+	return 0;
+}
+
+
+
+void ScreenCapture::_WorkerThread() {
+	SDL_LockMutex(_mutex);
+	while (true) {
+		while (_queue.empty() == true && _shutdown == false) {
+			SDL_CondWait(_job_queued, _mutex);
+		}
+		if (_queue.empty() == true)
+			break;
+
+		ScreenCaptureJob* job = _queue.front();
+		_queue.pop_front();
+		SDL_UnlockMutex(_mutex);
+
+		// No other thread touches a job between the time it is taken from the queue and the time it is finished
+		uint32 start_time = SDL_GetTicks();
+		WriteCapture(job);
+		IF_PRINT_DEBUG(VIDEO_DEBUG) << "wrote screen capture: " << job->filename << " in " << (SDL_GetTicks() - start_time) << "ms" << endl;
+
+		SDL_LockMutex(_mutex);
+		_finished.push_back(job);
+		_jobs_pending--;
+		SDL_CondBroadcast(_job_finished);
+	}
+	SDL_UnlockMutex(_mutex);
+} // void ScreenCapture::_WorkerThread()
+
+} // namespace private_video
+
+} // namespace hoa_video
@@ -0,0 +1,264 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2015 by The Allacrost Project
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    screen_capture.h
+*** \author  Tyler Olsen, roots@allacrost.org
+*** \brief   Header file for writing screenshots without stalling the game loop
+***
+*** Reading the screen back with glReadPixels forces the CPU to wait for the GPU
+*** to finish drawing, and encoding the result as an image file takes far longer
+*** than a frame. This file moves both of those costs out of the way of the game
+*** loop. At the end of a frame that a capture was requested for, the screen is
+*** read into a pixel buffer object, which returns immediately. One frame later
+*** the buffer is mapped, by which time the GPU has long since finished with it,
+*** and the pixels are handed to a worker thread that flips the rows and writes
+*** the image file.
+***
+*** When the OpenGL implementation lacks pixel buffer objects, the screen is
+*** read directly instead. The flipping and encoding still take place on the
+*** worker thread in that case.
+*** ***************************************************************************/
+
+#ifndef __SCREEN_CAPTURE_HEADER__
+#define __SCREEN_CAPTURE_HEADER__
+
+#include <deque>
+
+#include <SDL2/SDL_thread.h>
+#include <SDL2/SDL_mutex.h>
+
+#include "defs.h"
+#include "utils.h"
+
+#include "image_base.h"
+
+namespace hoa_video {
+
+/** \brief The type of function called when a screen capture has been written to a file
+*** \param filename The name of the file that the capture was written to
+*** \param success True if the file was written successfully
+*** \param data The pointer that was given when the capture was requested
+***
+*** Callbacks are always invoked on the main thread, either from within VideoEngine::Display()
+*** or from a call that waits for every outstanding capture to be written.
+**/
+typedef void (*ScreenCaptureCallback)(const std::string& filename, bool success, void* data);
+
+namespace private_video {
+
+//! \brief The number of pixel buffer objects used to hold screen reads while they complete
+const uint32 SCREEN_CAPTURE_READ_BUFFERS = 2;
+
+/** \brief The number of frames of a capture sequence that may wait to be written before further frames are dropped
+*** Each waiting frame holds a full copy of the screen in memory, so this keeps a slow disk from exhausting memory.
+**/
+const uint32 SCREEN_CAPTURE_MAX_PENDING = 8;
+
+//! \brief A single screen image to be written to a file
+class ScreenCaptureJob {
+public:
+	ScreenCaptureJob() :
+		png(false), callback(NULL), callback_data(NULL), success(false) {}
+
+	//! \brief The name of the file to write the image to
+	std::string filename;
+
+	//! \brief True to write the image as a PNG, false to write it as a JPEG
+	bool png;
+
+	//! \brief The function to call once the file is written. May be NULL.
+	ScreenCaptureCallback callback;
+
+	//! \brief The pointer to pass to the callback
+	void* callback_data;
+
+	//! \brief The RGBA pixels of the screen, with the bottom row first as OpenGL returns them
+	ImageMemory image;
+
+	//! \brief Set by the worker thread to indicate whether the file was written
+	bool success;
+}; // class ScreenCaptureJob
+
+
+/** ****************************************************************************
+*** \brief Reads the screen asynchronously and writes the captures on a worker thread
+***
+*** Captures may be requested one at a time or as a continuous sequence of frames,
+*** which is used to record the game for comparison against later runs. Reads are
+*** only ever issued from Update(), which the VideoEngine calls once per frame after
+*** everything has been drawn, so a capture always holds a complete frame.
+***
+*** \note The VideoEngine owns the single instance of this class. Every method must
+*** be called from the main thread, since most of them use the OpenGL context.
+*** ***************************************************************************/
+class ScreenCapture {
+public:
+	ScreenCapture();
+
+	//! \brief Stops the worker thread. Finish() should be called before this while the OpenGL context still exists.
+	~ScreenCapture();
+
+	/** \brief Requests that the next frame drawn be written to a file
+	*** \param filename The name of the file to write. Files ending in ".png" are written as PNG images, all others as JPEG.
+	*** \param callback The function to call once the file is written. May be NULL.
+	*** \param callback_data The pointer to pass to the callback
+	**/
+	void RequestCapture(const std::string& filename, ScreenCaptureCallback callback, void* callback_data);
+
+	/** \brief Begins writing every frame drawn to a numbered series of files
+	*** \param filename_prefix The path and beginning of each filename. The frame number and extension are appended to this.
+	*** \param frame_interval The number of frames drawn for every frame captured. A value of one captures every frame.
+	*** \param png True to write PNG images, false to write JPEG images
+	*** \return False if a sequence is already being captured
+	***
+	*** Frames of the sequence are dropped rather than allowed to stall the game when the worker thread
+	*** falls too far behind. The number of frames dropped is reported when the sequence is stopped.
+	**/
+	bool StartSequence(const std::string& filename_prefix, uint32 frame_interval, bool png);
+
+	/** \brief Stops capturing the current sequence of frames
+	*** \return The number of frames of the sequence that were captured
+	*** \note Frames that have been captured but not yet written will still be written
+	**/
+	uint32 StopSequence();
+
+	bool IsCapturingSequence() const
+		{ return _sequence_active; }
+
+	/** \brief Reads the screen for any requested captures and completes the reads from previous frames
+	*** This also invokes the callbacks for each capture that the worker thread has finished writing.
+	**/
+	void Update();
+
+	/** \brief Blocks until every requested capture has been read and written to its file
+	*** This is called when the OpenGL context is about to be lost and when the VideoEngine is destroyed,
+	*** and may be called by anything that needs to use a capture file right after requesting it.
+	**/
+	void Finish();
+
+	//! \brief Deletes the pixel buffer objects, which must be done before the OpenGL context is lost
+	void DestroyBuffers();
+
+private:
+	//! \brief A screen read that has been issued into a pixel buffer object but not yet mapped
+	class PendingRead {
+	public:
+		PendingRead() :
+			buffer(0), width(0), height(0) {}
+
+		//! \brief The pixel buffer object that the screen was read into
+		GLuint buffer;
+
+		//! \brief The width and height of the screen that was read
+		int32 width, height;
+
+		//! \brief The captures waiting on this read. Empty when the buffer is not in use.
+		std::vector<ScreenCaptureJob*> jobs;
+	};
+
+	//! \brief Captures that have been requested but whose frame has not yet been read
+	std::vector<ScreenCaptureJob*> _requests;
+
+	//! \brief Screen reads that are in flight, which are completed on the frame after they were issued
+	PendingRead _reads[SCREEN_CAPTURE_READ_BUFFERS];
+
+	//! \brief The index of the read buffer to use for the next read
+	uint32 _next_read;
+
+	//! \brief True once the pixel buffer objects have been created or found to be unsupported
+	bool _buffers_checked;
+
+	//! \brief True if the screen is read through pixel buffer objects
+	bool _use_buffers;
+
+	//! \brief True while a sequence of frames is being captured
+	bool _sequence_active;
+
+	//! \brief The path and beginning of each filename in the sequence
+	std::string _sequence_prefix;
+
+	//! \brief The number of frames drawn for every frame of the sequence captured
+	uint32 _sequence_interval;
+
+	//! \brief True if the frames of the sequence are written as PNG images
+	bool _sequence_png;
+
+	//! \brief The number of frames drawn since the sequence was started
+	uint32 _sequence_frame;
+
+	//! \brief The number of frames of the sequence that have been captured
+	uint32 _sequence_captured;
+
+	//! \brief The number of frames of the sequence that were skipped because the worker thread was too far behind
+	uint32 _sequence_dropped;
+
+	//! \brief The worker thread that flips and writes each capture
+	SDL_Thread* _thread;
+
+	//! \brief Protects every member below
+	SDL_mutex* _mutex;
+
+	//! \brief Signalled when a capture is queued for writing or when the worker is to shut down
+	SDL_cond* _job_queued;
+
+	//! \brief Signalled when the worker finishes writing a capture
+	SDL_cond* _job_finished;
+
+	//! \brief Captures waiting to be written, in the order that they were read
+	std::deque<ScreenCaptureJob*> _queue;
+
+	//! \brief Captures that have been written but whose callback has not yet been invoked
+	std::vector<ScreenCaptureJob*> _finished;
+
+	//! \brief The number of captures queued for writing or being written
+	uint32 _jobs_pending;
+
+	//! \brief Set to true when the worker thread should exit
+	bool _shutdown;
+
+	//! \brief Creates the worker thread if it does not already exist
+	bool _StartThread();
+
+	//! \brief Creates the pixel buffer objects the first time that they are needed, if they are supported
+	void _CreateBuffers();
+
+	/** \brief Reads the current contents of the screen for a set of captures
+	*** \param jobs The captures to fill with this frame. Ownership of the jobs passes to this function.
+	**/
+	void _ReadScreen(std::vector<ScreenCaptureJob*>& jobs);
+
+	/** \brief Maps a pixel buffer object that was read into and passes its pixels on to be written
+	*** \param read The read to complete. Its buffer is free for another read once this returns.
+	**/
+	void _CompleteRead(PendingRead& read);
+
+	/** \brief Gives the captures of a completed read to the worker thread
+	*** \param jobs The captures to write. The image of the first job holds the pixels, which are copied to any others.
+	**/
+	void _QueueJobs(std::vector<ScreenCaptureJob*>& jobs);
+
+	//! \brief Invokes the callback of every capture that has been written and deletes the jobs
+	void _InvokeCallbacks();
+
+	//! \brief Returns the number of captures queued for writing or being written
+	uint32 _GetPendingJobs();
+
+	//! \brief The entry point of the worker thread. The data argument is a pointer to the ScreenCapture.
+	static int _WorkerThreadEntry(void* data);
+
+	//! \brief Flips and writes queued captures until the object shuts down
+	void _WorkerThread();
+}; // class ScreenCapture
+
+} // namespace private_video
+
+} // namespace hoa_video
+
+#endif // __SCREEN_CAPTURE_HEADER__
@@ -69,6 +69,15 @@ public:
 		}
 	}
 
+	//! \brief Comparison operators
+	//@{
+	bool operator==(const ScreenRect& other) const
+		{ return (left == other.left && top == other.top && width == other.width && height == other.height); }
+
+	bool operator!=(const ScreenRect& other) const
+		{ return !(*this == other); }
+	//@}
+
 	//! \brief Coordinates for the top left corner of the rectangle
 	int32 left, top;
 
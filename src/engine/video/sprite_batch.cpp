@@ -0,0 +1,271 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2015 by The Allacrost Project
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    sprite_batch.cpp
+*** \author  Tyler Olsen, roots@allacrost.org
+*** \brief   Source file for the quad batching code
+*** ***************************************************************************/
+
+#include "sprite_batch.h"
+#include "video.h"
+
+using namespace std;
+using namespace hoa_utils;
+using namespace hoa_video::private_video;
+
+namespace hoa_video {
+
+namespace private_video {
+
+void BatchTransform::Rotate(float angle) {
+	float radians = angle * UTILS_PI / 180.0f;
+	float cos_angle = cosf(radians);
+	float sin_angle = sinf(radians);
+
+	float new_a = a * cos_angle + c * sin_angle;
+	float new_b = b * cos_angle + d * sin_angle;
+	c = c * cos_angle - a * sin_angle;
+	d = d * cos_angle - b * sin_angle;
+	a = new_a;
+	b = new_b;
+}
+
+
+
+SpriteBatch::SpriteBatch() :
+	_sheet(NULL),
+	_smooth(false),
+	_blend(0),
+	_debug_num_quads(0),
+	_debug_num_flushes(0)
+{
+	// Reserve enough room for a full screen of 32x32 tiles so that the common case never reallocates
+	_vertices.reserve(4096);
+}
+
+
+
+void SpriteBatch::AddQuad(const float vertex_coords[8], const float tex_coords[8], const Color* colors, bool unichrome,
+	TexSheet* sheet, bool smooth, int8 blend, const BatchTransform& transform)
+{
+	if (sheet == NULL)
+		smooth = false;
+
+	// Any change in the draw state requires that the pending quads be drawn first
+	if (_vertices.empty() == false && (sheet != _sheet || smooth != _smooth || blend != _blend)) {
+		Flush();
+	}
+
+	_sheet = sheet;
+	_smooth = smooth;
+	_blend = blend;
+
+	for (uint32 i = 0; i < 4; ++i) {
+		BatchVertex vertex;
+		transform.Apply(vertex_coords[i * 2], vertex_coords[i * 2 + 1], vertex.x, vertex.y);
+
+		if (tex_coords != NULL) {
+			vertex.u = tex_coords[i * 2];
+			vertex.v = tex_coords[i * 2 + 1];
+		}
+		else {
+			vertex.u = 0.0f;
+			vertex.v = 0.0f;
+		}
+
+		const Color& color = unichrome ? colors[0] : colors[i];
+		vertex.r = color[0];
+		vertex.g = color[1];
+		vertex.b = color[2];
+		vertex.a = color[3];
+
+		_vertices.push_back(vertex);
+	}
+
+	_debug_num_quads++;
+}
+
+
+
+void SpriteBatch::Flush() {
+	if (_vertices.empty() == true)
+		return;
+
+	// Set blending parameters
+	if (_blend == 0) {
+		glDisable(GL_BLEND);
+	}
+	else {
+		glEnable(GL_BLEND);
+		if (_blend == 1)
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Normal blending
+		else
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE); // Additive blending
+	}
+
+	const GLsizei stride = sizeof(BatchVertex);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(2, GL_FLOAT, stride, &(_vertices[0].x));
+	glEnableClientState(GL_COLOR_ARRAY);
+	glColorPointer(4, GL_FLOAT, stride, &(_vertices[0].r));
+
+	if (_sheet != NULL) {
+		glEnable(GL_TEXTURE_2D);
+		TextureManager->_BindTexture(_sheet->tex_id);
+		_sheet->Smooth(_smooth);
+
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glTexCoordPointer(2, GL_FLOAT, stride, &(_vertices[0].u));
+	}
+	else {
+		glDisable(GL_TEXTURE_2D);
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	}
+
+	// The vertices have already been transformed by the modelview matrix that was active when they were added
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+
+	glDrawArrays(GL_QUADS, 0, static_cast<GLsizei>(_vertices.size()));
+
+	glPopMatrix();
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_COLOR_ARRAY);
+	if (_sheet != NULL)
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+
+	if (_blend != 0)
+		glDisable(GL_BLEND);
+
+	_vertices.clear();
+	_debug_num_flushes++;
+
+	if (VideoManager->CheckGLError() == true) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "an OpenGL error occurred: " << VideoManager->CreateGLErrorString() << endl;
+	}
+} // void SpriteBatch::Flush()
+
+} // namespace private_video
+
+// -----------------------------------------------------------------------------
+// StaticSpriteBatch class
+// -----------------------------------------------------------------------------
+
+bool StaticSpriteBatch::AddImage(const StillImage& image, float x, float y) {
+	const BaseTexture* texture = image._texture;
+	if (texture == NULL) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "attempted to add an image that had no texture" << endl;
+		return false;
+	}
+
+	// Find the run for the image's texture sheet, or start a new one. There are rarely more than a few sheets in a batch.
+	StaticSpriteRun* run = NULL;
+	for (uint32 i = 0; i < _runs.size(); ++i) {
+		if (_runs[i].sheet == texture->texture_sheet && _runs[i].smooth == texture->smooth) {
+			run = &_runs[i];
+			break;
+		}
+	}
+
+	if (run == NULL) {
+		_runs.push_back(StaticSpriteRun());
+		run = &_runs.back();
+		run->sheet = texture->texture_sheet;
+		run->smooth = texture->smooth;
+	}
+
+	// Texture coordinates of the portion of the texture that the image uses, as computed in ImageDescriptor::_DrawTexture()
+	float s0 = texture->u1 + (image._u1 * (texture->u2 - texture->u1));
+	float s1 = texture->u1 + (image._u2 * (texture->u2 - texture->u1));
+	float t0 = texture->v1 + (image._v1 * (texture->v2 - texture->v1));
+	float t1 = texture->v1 + (image._v2 * (texture->v2 - texture->v1));
+
+	float x2 = x + image._width;
+	float y2 = y + image._height;
+
+	float quad[] = {
+		x,  y,  s0, t0,
+		x2, y,  s1, t0,
+		x2, y2, s1, t1,
+		x,  y2, s0, t1
+	};
+	run->vertices.insert(run->vertices.end(), quad, quad + 16);
+	return true;
+}
+
+
+
+void StaticSpriteBatch::Draw() const {
+	if (_runs.empty() == true)
+		return;
+
+	// Anything waiting in the sprite batch was drawn before this call and must remain beneath these quads
+	VideoManager->_sprite_batch.Flush();
+
+	Context& current_context = VideoManager->_current_context;
+
+	if (current_context.blend == 0) {
+		glDisable(GL_BLEND);
+	}
+	else {
+		glEnable(GL_BLEND);
+		if (current_context.blend == 1)
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Normal blending
+		else
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE); // Additive blending
+	}
+
+	float modulation = VideoManager->_screen_fader.GetFadeModulation();
+	glColor4f(modulation, modulation, modulation, 1.0f);
+
+	glPushMatrix();
+
+	// Apply any screen shaking in the same manner as ImageDescriptor::_DrawOrientation()
+	if (VideoManager->_shake_forces.empty() == false) {
+		CoordSys& cs = current_context.coordinate_system;
+		float x_shake = VideoManager->_x_shake * (cs.GetRight() - cs.GetLeft()) / 1024.0f;
+		float y_shake = VideoManager->_y_shake * (cs.GetTop() - cs.GetBottom()) / 768.0f;
+		glTranslatef(x_shake * cs.GetHorizontalDirection(), y_shake * cs.GetVerticalDirection(), 0.0f);
+	}
+
+	const GLsizei stride = 4 * sizeof(float);
+
+	glEnable(GL_TEXTURE_2D);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+
+	for (uint32 i = 0; i < _runs.size(); ++i) {
+		const StaticSpriteRun& run = _runs[i];
+
+		TextureManager->_BindTexture(run.sheet->tex_id);
+		run.sheet->Smooth(run.smooth);
+
+		glVertexPointer(2, GL_FLOAT, stride, &(run.vertices[0]));
+		glTexCoordPointer(2, GL_FLOAT, stride, &(run.vertices[2]));
+		glDrawArrays(GL_QUADS, 0, static_cast<GLsizei>(run.vertices.size() / 4));
+	}
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+
+	glPopMatrix();
+
+	if (current_context.blend != 0)
+		glDisable(GL_BLEND);
+
+	if (VideoManager->CheckGLError() == true) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "an OpenGL error occurred: " << VideoManager->CreateGLErrorString() << endl;
+	}
+} // void StaticSpriteBatch::Draw() const
+
+} // namespace hoa_video
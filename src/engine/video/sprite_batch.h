@@ -0,0 +1,245 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2015 by The Allacrost Project
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    sprite_batch.h
+*** \author  Tyler Olsen, roots@allacrost.org
+*** \brief   Header file for the quad batching code
+***
+*** This code collects the quads drawn by image descriptors into a single vertex
+*** array so that many images which share a texture sheet and blending state can
+*** be submitted to OpenGL with one draw call. It also provides a batch of
+*** prebuilt quads for large sets of images that rarely change, such as the
+*** still tiles of a map.
+*** ***************************************************************************/
+
+#ifndef __SPRITE_BATCH_HEADER__
+#define __SPRITE_BATCH_HEADER__
+
+#ifdef __APPLE__
+	#include <OpenGL/gl.h>
+#else
+	#include <GL/gl.h>
+#endif
+
+#include "defs.h"
+#include "utils.h"
+
+#include "color.h"
+
+namespace hoa_video {
+
+namespace private_video {
+
+/** ****************************************************************************
+*** \brief A CPU-side copy of the 2D affine part of the OpenGL modelview matrix
+***
+*** All drawing takes place on the z = 0 plane, so only the six matrix entries which
+*** affect x and y are kept. The VideoEngine applies every modelview change to both
+*** OpenGL and this class, which lets the sprite batch transform its vertices without
+*** querying the matrix back from the driver. Each operation post-multiplies the
+*** matrix, exactly as the corresponding glTranslatef/glScalef/glRotatef call does.
+*** ***************************************************************************/
+class BatchTransform {
+public:
+	BatchTransform()
+		{ LoadIdentity(); }
+
+	//! \brief Resets the transform to the identity matrix
+	void LoadIdentity()
+		{ a = 1.0f; b = 0.0f; c = 0.0f; d = 1.0f; tx = 0.0f; ty = 0.0f; }
+
+	//! \brief Loads the 2D affine part of a column-major 4x4 OpenGL matrix
+	void Load(const float matrix[16])
+		{ a = matrix[0]; b = matrix[1]; c = matrix[4]; d = matrix[5]; tx = matrix[12]; ty = matrix[13]; }
+
+	//! \brief Equivalent to glTranslatef(x, y, 0)
+	void Translate(float x, float y)
+		{ tx += a * x + c * y; ty += b * x + d * y; }
+
+	//! \brief Equivalent to glScalef(x, y, 1)
+	void Scale(float x, float y)
+		{ a *= x; b *= x; c *= y; d *= y; }
+
+	//! \brief Equivalent to glRotatef(angle, 0, 0, 1), where angle is in degrees
+	void Rotate(float angle);
+
+	//! \brief Transforms the point (x, y) and stores the result in (out_x, out_y)
+	void Apply(float x, float y, float& out_x, float& out_y) const
+		{ out_x = a * x + c * y + tx; out_y = b * x + d * y + ty; }
+
+private:
+	//! \brief The columns of the upper-left 2x2 matrix: x' = a * x + c * y + tx, y' = b * x + d * y + ty
+	float a, b, c, d;
+
+	//! \brief The translation column of the matrix
+	float tx, ty;
+}; // class BatchTransform
+
+
+//! \brief A single interleaved vertex of a batched quad
+class BatchVertex {
+public:
+	//! \brief The vertex position, already transformed by the modelview matrix
+	float x, y;
+
+	//! \brief The texture coordinates of the vertex
+	float u, v;
+
+	//! \brief The RGBA color of the vertex
+	float r, g, b, a;
+};
+
+
+/** ****************************************************************************
+*** \brief Accumulates textured and colored quads and draws them in as few calls as possible
+***
+*** Every quad added to the batch is transformed on the CPU by the modelview matrix
+*** that is active at the time of the call (as tracked by the VideoEngine's BatchTransform,
+*** so no driver query is needed), so pending quads are unaffected by any later
+*** Move/Scale/Rotate/PopMatrix calls. The batch is flushed to OpenGL whenever a quad is
+*** added which requires a different texture sheet, smoothing, or blending state than
+*** the quads already waiting in the batch. It must also be flushed before any state that
+*** is <b>not</b> recorded in the vertices changes (the projection, viewport, scissor
+*** rectangle, or the contents of a texture sheet) and before any code outside of the
+*** batch issues its own draw calls.
+***
+*** \note The VideoEngine owns the single instance of this class and flushes it at the
+*** start and end of VideoEngine::Display().
+*** ***************************************************************************/
+class SpriteBatch {
+public:
+	SpriteBatch();
+
+	~SpriteBatch()
+		{}
+
+	/** \brief Adds a single quad to the batch, flushing the batch first if the draw state changes
+	*** \param vertex_coords The four (x, y) vertex positions of the quad in object space
+	*** \param tex_coords The four (u, v) texture coordinates of the quad, or NULL if the quad is untextured
+	*** \param colors An array of four vertex colors, or one color when unichrome is true
+	*** \param unichrome If true, colors[0] is applied to all four vertices
+	*** \param sheet The texture sheet to draw from, or NULL if the quad is untextured
+	*** \param smooth The smoothing state required for the texture sheet
+	*** \param blend The blending mode to use: 0 for none, 1 for normal alpha blending, 2 for additive blending
+	*** \param transform The modelview transform to apply to the vertex positions
+	**/
+	void AddQuad(const float vertex_coords[8], const float tex_coords[8], const Color* colors, bool unichrome,
+		TexSheet* sheet, bool smooth, int8 blend, const BatchTransform& transform);
+
+	//! \brief Draws all quads that are waiting in the batch and empties it
+	void Flush();
+
+	//! \brief Flushes the batch if the pending quads reference a texture sheet that is about to be modified or destroyed
+	void FlushSheet(TexSheet* sheet)
+		{ if (sheet == _sheet && _vertices.empty() == false) Flush(); }
+
+	//! \brief Returns true if there are no quads waiting to be drawn
+	bool IsEmpty() const
+		{ return _vertices.empty(); }
+
+	//! \brief Resets the per-frame debugging counters
+	void ResetDebugCounters()
+		{ _debug_num_quads = 0; _debug_num_flushes = 0; }
+
+	//! \brief Returns the number of quads that were added to the batch during this frame
+	uint32 GetDebugNumQuads() const
+		{ return _debug_num_quads; }
+
+	//! \brief Returns the number of draw calls that the batch has made during this frame
+	uint32 GetDebugNumFlushes() const
+		{ return _debug_num_flushes; }
+
+private:
+	//! \brief Vertices of all quads waiting to be drawn. The capacity is retained between flushes.
+	std::vector<BatchVertex> _vertices;
+
+	//! \brief The texture sheet used by the pending quads, or NULL if they are untextured
+	TexSheet* _sheet;
+
+	//! \brief The smoothing state used by the pending quads
+	bool _smooth;
+
+	//! \brief The blending mode used by the pending quads
+	int8 _blend;
+
+	//! \brief The number of quads that have been added to the batch since the counters were last reset
+	uint32 _debug_num_quads;
+
+	//! \brief The number of draw calls that the batch has issued since the counters were last reset
+	uint32 _debug_num_flushes;
+}; // class SpriteBatch
+
+
+//! \brief The quads of a StaticSpriteBatch which are drawn from the same texture sheet
+class StaticSpriteRun {
+public:
+	//! \brief The texture sheet that all quads in this run are drawn from
+	TexSheet* sheet;
+
+	//! \brief The smoothing state required for the texture sheet
+	bool smooth;
+
+	//! \brief Interleaved (x, y, u, v) coordinates for the four vertices of every quad in the run
+	std::vector<float> vertices;
+}; // class StaticSpriteRun
+
+} // namespace private_video
+
+
+/** ****************************************************************************
+*** \brief A prebuilt set of still image quads that is drawn with one call per texture sheet
+***
+*** Unlike the SpriteBatch, which is rebuilt every frame, the quads of this class are built
+*** once and then drawn as many times as needed. This is intended for large sets of images
+*** which rarely change, such as the tiles of a map. The images themselves are not retained,
+*** so the batch must be cleared and rebuilt if any of them are modified or destroyed.
+***
+*** Images are placed without regard to the alignment or flip draw flags. The upper left
+*** corner of an image is placed at the position passed to AddImage(), and the image extends
+*** in the positive direction of both axes by its width and height. This matches the orientation
+*** of an image drawn in a coordinate system where y increases downward, like map mode's.
+*** Blending is determined solely by the blend draw flag, and the vertex colors of the images are
+*** ignored; the quads are drawn in white modulated only by any screen fading.
+*** ***************************************************************************/
+class StaticSpriteBatch {
+public:
+	StaticSpriteBatch()
+		{}
+
+	~StaticSpriteBatch()
+		{}
+
+	//! \brief Removes all quads from the batch
+	void Clear()
+		{ _runs.clear(); }
+
+	/** \brief Adds the quad for a still image to the batch
+	*** \param image The image to add. It must have been loaded.
+	*** \param x The x coordinate to place the upper left corner of the image at, relative to the draw cursor at draw time
+	*** \param y The y coordinate to place the upper left corner of the image at, relative to the draw cursor at draw time
+	*** \return False if the image has no texture and could not be added
+	**/
+	bool AddImage(const StillImage& image, float x, float y);
+
+	//! \brief Draws every quad in the batch relative to the current draw cursor position
+	void Draw() const;
+
+	//! \brief Returns true if there are no quads in the batch
+	bool IsEmpty() const
+		{ return _runs.empty(); }
+
+private:
+	//! \brief The quads of the batch, grouped by texture sheet
+	std::vector<private_video::StaticSpriteRun> _runs;
+}; // class StaticSpriteBatch
+
+} // namespace hoa_video
+
+#endif // __SPRITE_BATCH_HEADER__
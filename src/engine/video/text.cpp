@@ -263,7 +263,7 @@ void TextElement::Draw(const Color& draw_color) const {
 		return;
 	}
 
-	glPushMatrix();
+	VideoManager->PushMatrix();
 	_DrawOrientation();
 
 	float modulation = VideoManager->_screen_fader.GetFadeModulation();
@@ -284,7 +284,7 @@ void TextElement::Draw(const Color& draw_color) const {
 		_DrawTexture(modulated_colors);
 	}
 
-	glPopMatrix();
+	VideoManager->PopMatrix();
 } // void TextElement::Draw(const Color& draw_color) const
 
 
@@ -401,12 +401,12 @@ void TextImage::Clear() {
 
 
 void TextImage::Draw() const {
-	glPushMatrix();
+	VideoManager->PushMatrix();
 	for (uint32 i = 0; i < _text_sections.size(); ++i) {
 		_text_sections[i]->Draw();
 		VideoManager->MoveRelative(0.0f, TextManager->GetFontProperties(_style.font)->line_skip * -VideoManager->_current_context.coordinate_system.GetVerticalDirection());
 	}
-	glPopMatrix();
+	VideoManager->PopMatrix();
 }
 
 
@@ -417,12 +417,12 @@ void TextImage::Draw(const Color& draw_color) const {
 		return;
 	}
 
-	glPushMatrix();
+	VideoManager->PushMatrix();
 	for (uint32 i = 0; i < _text_sections.size(); ++i) {
 		_text_sections[i]->Draw(draw_color);
 		VideoManager->MoveRelative(0.0f, TextManager->GetFontProperties(_style.font)->line_skip * -VideoManager->_current_context.coordinate_system.GetVerticalDirection());
 	}
-	glPopMatrix();
+	VideoManager->PopMatrix();
 }
 
 
@@ -520,13 +520,13 @@ TextSupervisor::~TextSupervisor() {
 		if (fp->ttf_font)
 			TTF_CloseFont(fp->ttf_font);
 
-		if (fp->glyph_cache != NULL) {
-			for (uint32 j = 0; j < fp->glyph_cache->size(); j++) {
-				if (fp->glyph_cache->at(j) != NULL)
-					delete fp->glyph_cache->at(j);
-			}
+		_ClearGlyphCache(fp);
+		if (fp->glyph_cache != NULL)
 			delete fp->glyph_cache;
-		}
+		if (fp->glyph_pages != NULL)
+			delete fp->glyph_pages;
+		if (fp->glyph_advances != NULL)
+			delete fp->glyph_advances;
 
 		delete fp;
 	}
@@ -581,8 +581,10 @@ bool TextSupervisor::LoadFont(const string& filename, const string& font_name, u
 	fp->ascent = TTF_FontAscent(font);
 	fp->descent = TTF_FontDescent(font);
 
-	// Create the glyph cache for the font and add it to the font map
+	// Create the glyph cache and glyph page container for the font and add it to the font map
 	fp->glyph_cache = new vector<FontGlyph*>;
+	fp->glyph_pages = new vector<GlyphTexSheet*>;
+	fp->glyph_advances = new vector<int32>;
 	_font_map[font_name] = fp;
 	return true;
 } // bool TextSupervisor::LoadFont(...)
@@ -648,20 +650,20 @@ void TextSupervisor::Draw(const ustring& text, const TextStyle& style) {
 		}
 
 		// Save the draw cursor position before drawing this text
-		glPushMatrix();
+		VideoManager->PushMatrix();
 
 		// If text shadows are enabled, draw the shadow first
 		if (style.shadow_style != VIDEO_TEXT_SHADOW_NONE) {
-			glPushMatrix();
+			VideoManager->PushMatrix();
 			VideoManager->MoveRelative(VideoManager->_current_context.coordinate_system.GetHorizontalDirection() * style.shadow_offset_x, 0.0f);
 			VideoManager->MoveRelative(0.0f, VideoManager->_current_context.coordinate_system.GetVerticalDirection() * style.shadow_offset_y);
 			_DrawTextHelper(buffer, fp, _GetTextShadowColor(style));
-			glPopMatrix();
+			VideoManager->PopMatrix();
 		}
 
 		// Now draw the text itself, restore the position of the draw cursor, and move the draw cursor one line down
 		_DrawTextHelper(buffer, fp, style.color);
-		glPopMatrix();
+		VideoManager->PopMatrix();
 		VideoManager->MoveRelative(0, -fp->line_skip * VideoManager->_current_context.coordinate_system.GetVerticalDirection());
 
 	} while (last_line < text.length());
@@ -677,27 +679,11 @@ int32 TextSupervisor::CalculateTextWidth(const string& font_name, const hoa_util
 		return -1;
 	}
 
-	int32 width;
-	if (TTF_SizeUNICODE(_font_map[font_name]->ttf_font, text.c_str(), &width, NULL) == -1) {
-		IF_PRINT_WARNING(VIDEO_DEBUG) << "call to TTF_SizeUNICODE failed with TTF error: " << TTF_GetError() << endl;
-		return -1;
-	}
-
-	return width;
-}
-
-
-
-int32 TextSupervisor::CalculateTextWidth(const string& font_name, const string& text) {
-	if (IsFontValid(font_name) == false) {
-		IF_PRINT_WARNING(VIDEO_DEBUG) << "font name argument was invalid: " << font_name << endl;
-		return -1;
-	}
-
-	int32 width;
-	if (TTF_SizeText(_font_map[font_name]->ttf_font, text.c_str(), &width, NULL) == -1) {
-		IF_PRINT_WARNING(VIDEO_DEBUG) << "call to TTF_SizeText failed with TTF error: " << TTF_GetError() << endl;
-		return -1;
+	// Sum the advances that _DrawTextHelper() moves by, so that the width always agrees with the text that is drawn
+	FontProperties* fp = _font_map[font_name];
+	int32 width = 0;
+	for (uint32 i = 0; i < text.length(); i++) {
+		width += CalculateCharacterAdvance(fp, text[i]);
 	}
 
 	return width;
@@ -760,7 +746,8 @@ void TextSupervisor::_CacheGlyphs(const uint16* text, FontProperties* fp) {
 	SDL_Surface* initial = NULL;
 	SDL_Surface* intermediary = NULL;
 	int32 w, h;
-	GLuint texture;
+	int32 page_x, page_y;
+	GlyphTexSheet* page = NULL;
 
 	// First find the maximum character and make sure that the glyph cache is large enough to hold it
 	uint16 max_character = 0;
@@ -794,8 +781,10 @@ void TextSupervisor::_CacheGlyphs(const uint16* text, FontProperties* fp) {
 			}
 		}
 
-		w = RoundUpPow2(initial->w);
-		h = RoundUpPow2(initial->h);
+		// The glyph is surrounded by a transparent border of one pixel so that linear filtering never samples
+		// its neighbors in the glyph page
+		w = initial->w + 2;
+		h = initial->h + 2;
 
 		intermediary = SDL_CreateRGBSurface(0, w, h, 32, RMASK, GMASK, BMASK, AMASK);
 		if (intermediary == NULL) {
@@ -804,17 +793,25 @@ void TextSupervisor::_CacheGlyphs(const uint16* text, FontProperties* fp) {
 			return;
 		}
 
-
-		if (SDL_BlitSurface(initial, 0, intermediary, 0) < 0) {
+		SDL_Rect glyph_rect;
+		glyph_rect.x = 1;
+		glyph_rect.y = 1;
+		glyph_rect.w = initial->w;
+		glyph_rect.h = initial->h;
+		if (SDL_BlitSurface(initial, 0, intermediary, &glyph_rect) < 0) {
 			SDL_FreeSurface(initial);
 			SDL_FreeSurface(intermediary);
 			IF_PRINT_WARNING(VIDEO_DEBUG) << "call to SDL_BlitSurface() failed" << endl;
 			return;
 		}
 
-		glGenTextures(1, &texture);
-		TextureManager->_BindTexture(texture);
-
+		page = _ReserveGlyphSpace(fp, w, h, page_x, page_y);
+		if (page == NULL) {
+			SDL_FreeSurface(initial);
+			SDL_FreeSurface(intermediary);
+			IF_PRINT_WARNING(VIDEO_DEBUG) << "could not find room for the glyph in any glyph page" << endl;
+			return;
+		}
 
 		SDL_LockSurface(intermediary);
 
@@ -826,10 +823,9 @@ void TextSupervisor::_CacheGlyphs(const uint16* text, FontProperties* fp) {
 			(static_cast<uint8*>(intermediary->pixels))[j+2] = 0xff;
 		}
 
-		glTexImage2D(GL_TEXTURE_2D, 0, 4, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, intermediary->pixels );
+		TextureManager->_BindTexture(page->tex_id);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, page_x, page_y, w, h, GL_RGBA, GL_UNSIGNED_BYTE, intermediary->pixels);
 		SDL_UnlockSurface(intermediary);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
 		if (VideoManager->CheckGLError()) {
 			SDL_FreeSurface(initial);
@@ -849,13 +845,15 @@ void TextSupervisor::_CacheGlyphs(const uint16* text, FontProperties* fp) {
 		}
 
 		FontGlyph* glyph = new FontGlyph;
-		glyph->texture = texture;
+		glyph->sheet = page;
 		glyph->min_x = minx;
 		glyph->min_y = miny;
 		glyph->width = initial->w;
 		glyph->height = initial->h;
-		glyph->max_x = static_cast<float>(initial->w) / static_cast<float>(w);
-		glyph->max_y = static_cast<float>(initial->h) / static_cast<float>(h);
+		glyph->u1 = static_cast<float>(page_x + 1) / static_cast<float>(page->width);
+		glyph->v1 = static_cast<float>(page_y + 1) / static_cast<float>(page->height);
+		glyph->u2 = static_cast<float>(page_x + 1 + initial->w) / static_cast<float>(page->width);
+		glyph->v2 = static_cast<float>(page_y + 1 + initial->h) / static_cast<float>(page->height);
 		glyph->advance = advance;
 
 		fp->glyph_cache->at(character) = glyph;
@@ -867,6 +865,67 @@ void TextSupervisor::_CacheGlyphs(const uint16* text, FontProperties* fp) {
 
 
 
+GlyphTexSheet* TextSupervisor::_ReserveGlyphSpace(FontProperties* fp, int32 width, int32 height, int32& x, int32& y) {
+	// Only the most recently created page is considered. Older pages are left as they are once they fill up.
+	if (fp->glyph_pages->empty() == false && fp->glyph_pages->back()->ReserveSpace(width, height, x, y) == true)
+		return fp->glyph_pages->back();
+
+	// Glyphs of very large fonts may not fit in a page of the standard size
+	int32 page_width = RoundUpPow2(width) > GLYPH_PAGE_SIZE ? RoundUpPow2(width) : GLYPH_PAGE_SIZE;
+	int32 page_height = RoundUpPow2(height) > GLYPH_PAGE_SIZE ? RoundUpPow2(height) : GLYPH_PAGE_SIZE;
+
+	GlyphTexSheet* page = TextureManager->_CreateGlyphTexSheet(page_width, page_height);
+	if (page == NULL) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to create a new glyph page texture sheet" << endl;
+		return NULL;
+	}
+	fp->glyph_pages->push_back(page);
+
+	if (page->ReserveSpace(width, height, x, y) == false) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "glyph did not fit in a newly created glyph page" << endl;
+		return NULL;
+	}
+
+	return page;
+} // GlyphTexSheet* TextSupervisor::_ReserveGlyphSpace(FontProperties* fp, int32 width, int32 height, int32& x, int32& y)
+
+
+
+void TextSupervisor::_ClearGlyphCache(FontProperties* fp) {
+	if (fp->glyph_cache != NULL) {
+		for (uint32 i = 0; i < fp->glyph_cache->size(); i++) {
+			if (fp->glyph_cache->at(i) != NULL)
+				delete fp->glyph_cache->at(i);
+		}
+		fp->glyph_cache->clear();
+	}
+
+	if (fp->glyph_pages != NULL) {
+		for (uint32 i = 0; i < fp->glyph_pages->size(); i++) {
+			TextureManager->_RemoveSheet(fp->glyph_pages->at(i));
+		}
+		fp->glyph_pages->clear();
+	}
+}
+
+
+
+int32 TextSupervisor::_MeasureCharacterAdvance(FontProperties* fp, uint16 character) {
+	if (character >= fp->glyph_advances->size())
+		fp->glyph_advances->resize(character + 1, -1);
+
+	int minx, maxx, miny, maxy, advance;
+	if (TTF_GlyphMetrics(fp->ttf_font, character, &minx, &maxx, &miny, &maxy, &advance) != 0) {
+		// The glyph cache also fails to cache such characters, so they are never drawn and take up no space
+		advance = 0;
+	}
+
+	(*fp->glyph_advances)[character] = advance;
+	return advance;
+}
+
+
+
 void TextSupervisor::_DrawTextHelper(const uint16* const text, FontProperties* fp, Color text_color) {
 	if (*text == 0) {
 		IF_PRINT_WARNING(VIDEO_DEBUG) << "invalid argument, empty string" << endl;
@@ -878,6 +937,9 @@ void TextSupervisor::_DrawTextHelper(const uint16* const text, FontProperties* f
 		return;
 	}
 
+	// Glyphs are drawn directly, so any images waiting in the sprite batch must be drawn beneath them first
+	VideoManager->_sprite_batch.Flush();
+
 	glBlendFunc(GL_ONE, GL_ONE);
 	glEnable(GL_BLEND);
 
@@ -890,13 +952,16 @@ void TextSupervisor::_DrawTextHelper(const uint16* const text, FontProperties* f
 	glEnable(GL_ALPHA_TEST);
 	glAlphaFunc(GL_GREATER, 0.1f);
 
-	glPushMatrix();
+	VideoManager->PushMatrix();
 
-	int font_width, font_height;
-	if (TTF_SizeUNICODE(fp->ttf_font, text, &font_width, &font_height) != 0) {
-		IF_PRINT_WARNING(VIDEO_DEBUG) << "call to TTF_SizeUNICODE() failed" << endl;
-		return;
+	// Left aligned text, which is the common case, does not need to be measured at all
+	int32 font_width = 0;
+	if (VideoManager->_current_context.x_align != -1) {
+		for (const uint16* glyph = text; *glyph != 0; ++glyph) {
+			font_width += CalculateCharacterAdvance(fp, *glyph);
+		}
 	}
+	int32 font_height = fp->height;
 
 	float xoff = ((VideoManager->_current_context.x_align + 1) * font_width) * 0.5f * -cs.GetHorizontalDirection();
 	float yoff = ((VideoManager->_current_context.y_align + 1) * font_height) * 0.5f * -cs.GetVerticalDirection();
@@ -908,16 +973,29 @@ void TextSupervisor::_DrawTextHelper(const uint16* const text, FontProperties* f
 
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glColor4fv((GLfloat*)&final_color);
 
-	GLint vertices[8];
-	GLfloat tex_coords[8];
-	glVertexPointer(2, GL_INT, 0, vertices);
-	glTexCoordPointer(2, GL_FLOAT, 0, tex_coords);
+	_glyph_vertices.clear();
+	_glyph_tex_coords.clear();
 
-	// Iterate through each character in the string and render the character glyphs one at a time
+	// Build the quads for every glyph in the string. Consecutive glyphs that share a glyph page (normally the
+	// entire string) are submitted together with a single bind and draw call.
+	GlyphTexSheet* page = NULL;
 	int xpos = 0;
 	for (const uint16* glyph = text; *glyph != 0; ++glyph) {
 		FontGlyph* glyph_info = (*fp->glyph_cache)[*glyph];
+		if (glyph_info == NULL)
+			continue;
+
+		if (glyph_info->sheet != page && _glyph_vertices.empty() == false) {
+			TextureManager->_BindTexture(page->tex_id);
+			glVertexPointer(2, GL_INT, 0, &_glyph_vertices[0]);
+			glTexCoordPointer(2, GL_FLOAT, 0, &_glyph_tex_coords[0]);
+			glDrawArrays(GL_QUADS, 0, static_cast<GLsizei>(_glyph_vertices.size() / 2));
+			_glyph_vertices.clear();
+			_glyph_tex_coords.clear();
+		}
+		page = glyph_info->sheet;
 
 		int x_hi = glyph_info->width;
 		int y_hi = glyph_info->height;
@@ -928,42 +1006,40 @@ void TextSupervisor::_DrawTextHelper(const uint16* const text, FontProperties* f
 
 		int min_x = xpos, min_y = 0;
 
-		float tx, ty;
-		tx = glyph_info->max_x;
-		ty = glyph_info->max_y;
-
-		TextureManager->_BindTexture(glyph_info->texture);
-		if (VideoManager->CheckGLError()) {
-			IF_PRINT_WARNING(VIDEO_DEBUG) << "OpenGL error detected: " << VideoManager->CreateGLErrorString() << endl;
-			return;
-		}
-
-		vertices[0] = min_x;
-		vertices[1] = min_y;
-		vertices[2] = min_x + x_hi;
-		vertices[3] = min_y;
-		vertices[4] = min_x + x_hi;
-		vertices[5] = min_y + y_hi;
-		vertices[6] = min_x;
-		vertices[7] = min_y + y_hi;
-		tex_coords[0] = 0.0f;
-		tex_coords[1] = ty;
-		tex_coords[2] = tx;
-		tex_coords[3] = ty;
-		tex_coords[4] = tx;
-		tex_coords[5] = 0.0f;
-		tex_coords[6] = 0.0f;
-		tex_coords[7] = 0.0f;
-
-		glColor4fv((GLfloat*)&final_color);
-		glDrawArrays(GL_QUADS, 0, 4);
+		_glyph_vertices.push_back(min_x);
+		_glyph_vertices.push_back(min_y);
+		_glyph_vertices.push_back(min_x + x_hi);
+		_glyph_vertices.push_back(min_y);
+		_glyph_vertices.push_back(min_x + x_hi);
+		_glyph_vertices.push_back(min_y + y_hi);
+		_glyph_vertices.push_back(min_x);
+		_glyph_vertices.push_back(min_y + y_hi);
+		_glyph_tex_coords.push_back(glyph_info->u1);
+		_glyph_tex_coords.push_back(glyph_info->v2);
+		_glyph_tex_coords.push_back(glyph_info->u2);
+		_glyph_tex_coords.push_back(glyph_info->v2);
+		_glyph_tex_coords.push_back(glyph_info->u2);
+		_glyph_tex_coords.push_back(glyph_info->v1);
+		_glyph_tex_coords.push_back(glyph_info->u1);
+		_glyph_tex_coords.push_back(glyph_info->v1);
 
 		xpos += glyph_info->advance;
 	} // for (const uint16* glyph = text; *glyph != 0; glyph++)
 
+	if (_glyph_vertices.empty() == false) {
+		TextureManager->_BindTexture(page->tex_id);
+		glVertexPointer(2, GL_INT, 0, &_glyph_vertices[0]);
+		glTexCoordPointer(2, GL_FLOAT, 0, &_glyph_tex_coords[0]);
+		glDrawArrays(GL_QUADS, 0, static_cast<GLsizei>(_glyph_vertices.size() / 2));
+	}
+
+	if (VideoManager->CheckGLError()) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "OpenGL error detected: " << VideoManager->CreateGLErrorString() << endl;
+	}
+
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
-	glPopMatrix();
+	VideoManager->PopMatrix();
 
 	glDisable(GL_ALPHA_TEST);
 } // void TextSupervisor::_DrawTextHelper(const uint16* const text, FontProperties* fp, Color color)
@@ -51,13 +51,21 @@ enum TEXT_SHADOW_STYLE {
 };
 
 
+namespace private_video {
+
+//! \brief The width and height of each texture page that font glyphs are packed into
+const int32 GLYPH_PAGE_SIZE = 512;
+
+} // namespace private_video
+
+
 /** ****************************************************************************
 *** \brief A structure to hold properties about a particular font glyph
 *** ***************************************************************************/
 class FontGlyph {
 public:
-	//! \brief The index of the GL texture for this glyph.
-	GLuint texture;
+	//! \brief The texture sheet that this glyph is stored in.
+	private_video::GlyphTexSheet* sheet;
 
 	//! \brief The width and height of the glyph in pixels.
 	int32 width, height;
@@ -65,8 +73,8 @@ public:
 	//! \brief The mininum x and y pixel coordinates of the glyph in texture space (refer to TTF_GlyphMetrics).
 	int min_x, min_y;
 
-	//! \brief The maximum x and y pixel coordinates of the glyph in texture space (refer to TTF_GlyphMetrics).
-	float max_x, max_y;
+	//! \brief The texture coordinates of the top left and bottom right corners of the glyph within its glyph page.
+	float u1, v1, u2, v2;
 
 	//! \brief The amount of space between glyphs.
 	int32 advance;
@@ -92,6 +100,15 @@ public:
 
 	//! \brief A pointer to a cache which holds all of the glyphs used in this font.
 	std::vector<FontGlyph*>* glyph_cache;
+
+	//! \brief A pointer to the texture sheets which the cached glyphs of this font are stored in. The sheets are owned by the TextureController.
+	std::vector<private_video::GlyphTexSheet*>* glyph_pages;
+
+	/** \brief A pointer to the advance of every character that has been measured in this font, indexed by character
+	*** Characters which have not yet been measured hold a negative value. Unlike the glyph cache, this table does not
+	*** require the glyphs to be rendered, so text can be measured and laid out without touching texture memory.
+	**/
+	std::vector<int32>* glyph_advances;
 }; // class FontProperties
 
 
@@ -455,6 +472,7 @@ public:
 	*** \param font_name The reference name of the font to use for the calculation
 	*** \param text The text string in unicode format
 	*** \return The width of the text as it would be rendered, or -1 if there was an error
+	*** \note The width is the sum of the advances of each character, which is exactly how far Draw() moves across the line
 	**/
 	int32 CalculateTextWidth(const std::string& font_name, const hoa_utils::ustring& text);
 
@@ -463,7 +481,20 @@ public:
 	*** \param text The text string in standard format
 	*** \return The width of the text as it would be rendered, or -1 if there was an error
 	**/
-	int32 CalculateTextWidth(const std::string& font_name, const std::string& text);
+	int32 CalculateTextWidth(const std::string& font_name, const std::string& text)
+		{ return CalculateTextWidth(font_name, hoa_utils::MakeUnicodeString(text)); }
+
+	/** \brief Returns the distance that drawing a single character moves the draw cursor
+	*** \param fp A pointer to the properties of the font to use, as returned by GetFontProperties()
+	*** \param character The unicode character to measure
+	*** \return The advance of the character in pixels
+	***
+	*** Each character is only measured by SDL_ttf the first time that it is requested in a font. This
+	*** is intended for code that lays out a large amount of text, such as the TextBox GUI control.
+	**/
+	int32 CalculateCharacterAdvance(FontProperties* fp, uint16 character)
+		{ return (character < fp->glyph_advances->size() && (*fp->glyph_advances)[character] >= 0) ?
+			(*fp->glyph_advances)[character] : _MeasureCharacterAdvance(fp, character); }
 	//@}
 
 	//! \name Class member access methods
@@ -488,6 +519,12 @@ private:
 	**/
 	std::map<std::string, FontProperties*> _font_map;
 
+	//! \brief Vertex positions of the glyph quads for the string being drawn. The capacity is retained between calls.
+	std::vector<GLint> _glyph_vertices;
+
+	//! \brief Texture coordinates of the glyph quads for the string being drawn. The capacity is retained between calls.
+	std::vector<GLfloat> _glyph_tex_coords;
+
 	// ---------- Private methods
 
 	/** \brief Retrieves the color for a shadow based on the current text color and a shadow style
@@ -502,6 +539,28 @@ private:
 	**/
 	void _CacheGlyphs(const uint16* text, FontProperties* fp);
 
+	/** \brief Finds room for a glyph in one of the font's glyph pages, creating a new page if necessary
+	*** \param fp A pointer to the FontProperties of the font that the glyph belongs to
+	*** \param width The width of the area to reserve, in pixels
+	*** \param height The height of the area to reserve, in pixels
+	*** \param x Set to the x pixel coordinate of the reserved area within the returned page
+	*** \param y Set to the y pixel coordinate of the reserved area within the returned page
+	*** \return A pointer to the page where the area was reserved, or NULL if a new page could not be created
+	**/
+	private_video::GlyphTexSheet* _ReserveGlyphSpace(FontProperties* fp, int32 width, int32 height, int32& x, int32& y);
+
+	/** \brief Deletes all of a font's cached glyphs and removes the texture sheets that store them
+	*** \param fp A pointer to the FontProperties of the font whose cache should be emptied
+	**/
+	void _ClearGlyphCache(FontProperties* fp);
+
+	/** \brief Retrieves the advance of a character from SDL_ttf and stores it in the font's advance table
+	*** \param fp A pointer to the FontProperties of the font to measure the character in
+	*** \param character The unicode character to measure
+	*** \return The advance of the character in pixels, or zero if the font does not contain the character
+	**/
+	int32 _MeasureCharacterAdvance(FontProperties* fp, uint16 character);
+
 	/** \brief Draws text to the screen using OpenGL commands
 	*** \param text A pointer to a unicode string holding the text to draw
 	*** \param fp A pointer to the properties of the font to use in drawing the text
@@ -35,7 +35,8 @@ TexSheet::TexSheet(int32 sheet_width, int32 sheet_height, GLuint sheet_id, TexSh
 	type(sheet_type),
 	is_static(sheet_static),
 	smoothed(false),
-	loaded(true)
+	loaded(true),
+	dedicated(false)
 {
 	Smooth();
 }
@@ -98,6 +99,8 @@ bool TexSheet::Reload() {
 
 
 bool TexSheet::CopyRect(int32 x, int32 y, ImageMemory& data) {
+	// Quads waiting in the sprite batch must be drawn with the sheet contents that existed when they were added
+	VideoManager->_sprite_batch.FlushSheet(this);
 	TextureManager->_BindTexture(tex_id);
 
 	glTexSubImage2D(
@@ -123,6 +126,8 @@ bool TexSheet::CopyRect(int32 x, int32 y, ImageMemory& data) {
 
 
 bool TexSheet::CopyScreenRect(int32 x, int32 y, const ScreenRect& screen_rect) {
+	// The screen must contain every image drawn so far before it is copied
+	VideoManager->_sprite_batch.Flush();
 	TextureManager->_BindTexture(tex_id);
 
 	glCopyTexSubImage2D(
@@ -181,6 +186,8 @@ void TexSheet::DEBUG_Draw() const {
 		0.0f, 0.0f, // Upper left
 	};
 
+	VideoManager->_sprite_batch.Flush();
+
 	// Enable texturing and bind the texture
 	glDisable(GL_BLEND);
 	glEnable(GL_TEXTURE_2D);
@@ -272,7 +279,8 @@ bool FixedTexSheet::InsertTexture(BaseTexture* img) {
 	// Check if there's already an image allocated at this block (an image was freed earlier, but not removed)
 	// If so, we must now remove it from memory
 	if (node->image != NULL) {
-		// TODO: TextureManager needs to have the image element removed from its map containers
+		// No image references a freed texture, so it is deleted here. Its destructor removes it from the TextureController.
+		delete node->image;
 		node->image = NULL;
 	}
 
@@ -430,9 +438,7 @@ FixedTexNode* FixedTexSheet::_RemoveOpenNode() {
 VariableTexSheet::VariableTexSheet(int32 sheet_width, int32 sheet_height, GLuint sheet_id, TexSheetType sheet_type, bool sheet_static) :
 	TexSheet(sheet_width, sheet_height, sheet_id, sheet_type, sheet_static)
 {
-	_block_width = width / 16;
-	_block_height = height / 16;
-	_blocks = new VariableTexNode[_block_width * _block_height];
+	_free_rects.push_back(VariableTexRect(0, 0, width, height));
 }
 
 
@@ -440,8 +446,6 @@ VariableTexSheet::VariableTexSheet(int32 sheet_width, int32 sheet_height, GLuint
 VariableTexSheet::~VariableTexSheet() {
 	if (GetNumberTextures() != 0)
 		IF_PRINT_WARNING(VIDEO_DEBUG) << "texture sheet being deleted when it has a non-zero allocated texture count: " << GetNumberTextures() << endl;
-
-	delete[] _blocks;
 }
 
 
@@ -467,68 +471,53 @@ bool VariableTexSheet::InsertTexture(BaseTexture* img) {
 		return false;
 	}
 
-	// Don't allow insertions into a texture sheet containing a texture larger than 512x512.
-	// Texture sheets with this property may only be used by one texture at a time
-	if (_block_width > 32 || _block_height > 32) { // 32 blocks == 512 pixels
-		if (_blocks[0].free_image == false)
-			return false;
-	}
-
-	// Attempt to find an open region in the texture sheet to fit this texture
-	int32 block_x = -1, block_y = -1;
-	int32 w = (img->width + 15) / 16;
-	int32 h = (img->height + 15) / 16;
-
-	// This is a brute force algorithm to try and find space to allocate the texture.
-	// If this becomes a bottleneck, we may wish to use a more intellegent algorithm here.
-	bool continue_search = true;
-	for (int32 y = 0; y < _block_height - h + 1 && continue_search; y++) {
-		for (int32 x = 0; x < _block_width - w + 1; x++) {
-			int32 furthest_blocker = -1;
-
-			bool continue_neighbor_search = true;
-			for (int32 dy = 0; dy < h && continue_neighbor_search; dy++) {
-				for (int32 dx = 0; dx < w; dx++) {
-					if (_blocks[(x + dx) + ((y + dy) * _block_width)].free_image == false) {
-						furthest_blocker = x + dx;
-						continue_neighbor_search = false;
-						break;
-					}
-				}
-			}
+	// A dedicated texture sheet may only be used by one texture at a time
+	if (dedicated == true && _textures.empty() == false)
+		return false;
 
-			if (furthest_blocker == -1) {
-				block_x = x;
-				block_y = y;
-				continue_search = false;
-				break;
-			}
+	int32 index = _FindFreeRect(img->width, img->height);
+
+	// If there is no room for the texture, reclaim the space of any freed textures and try again
+	if (index < 0 && _freed_textures.empty() == false) {
+		while (_freed_textures.empty() == false) {
+			// No image references a freed texture, so it is deleted once its space has been returned to the sheet.
+			// Its destructor removes it from the TextureController, so later loads of it will not find the stale texture.
+			BaseTexture* freed_texture = *(_freed_textures.begin());
+			RemoveTexture(freed_texture);
+			delete freed_texture;
 		}
+		index = _FindFreeRect(img->width, img->height);
 	}
 
-	// If either of these conditions is true, it means we were unable to allocate enough space to insert this texture
-	if (block_x == -1 || block_y == -1)
+	if (index < 0)
 		return false;
 
-	// Go through each block that is to be occupied by the new texture and set its properties
-	for (int32 y = block_y; y < block_y + h; y++) {
-		for (int32 x = block_x; x < block_x + w; x++) {
-			int32 index = x + (y * _block_width);
+	// Place the texture in the upper left corner of the free rectangle and split the remaining space into two
+	// new free rectangles. The cut is made along the shorter leftover axis, which keeps the larger piece as big as possible.
+	VariableTexRect rect = _free_rects[index];
+	_free_rects.erase(_free_rects.begin() + index);
 
-			// If the texture pointer for the block is not NULL, this means it contains a freed texture.
-			// Now we must remove that texture entirely since we are overwriting at least one of its blocks.
-			if (_blocks[index].image) {
-				RemoveTexture(_blocks[index].image);
-			}
+	int32 leftover_width = rect.width - img->width;
+	int32 leftover_height = rect.height - img->height;
 
-			_blocks[index].free_image = false;
-			_blocks[index].image = img;
-		}
+	if (leftover_width <= leftover_height) {
+		// Horizontal cut: the bottom piece spans the full width of the rectangle
+		if (leftover_width > 0)
+			_free_rects.push_back(VariableTexRect(rect.x + img->width, rect.y, leftover_width, img->height));
+		if (leftover_height > 0)
+			_free_rects.push_back(VariableTexRect(rect.x, rect.y + img->height, rect.width, leftover_height));
+	}
+	else {
+		// Vertical cut: the right piece spans the full height of the rectangle
+		if (leftover_width > 0)
+			_free_rects.push_back(VariableTexRect(rect.x + img->width, rect.y, leftover_width, rect.height));
+		if (leftover_height > 0)
+			_free_rects.push_back(VariableTexRect(rect.x, rect.y + img->height, img->width, leftover_height));
 	}
 
 	// Calculate the pixel and uv coordinates for the newly inserted texture
-	img->x = block_x * 16;
-	img->y = block_y * 16;
+	img->x = rect.x;
+	img->y = rect.y;
 
 	float sheet_width = static_cast<float>(width);
 	float sheet_height = static_cast<float>(height);
@@ -547,39 +536,228 @@ bool VariableTexSheet::InsertTexture(BaseTexture* img) {
 
 
 void VariableTexSheet::RemoveTexture(BaseTexture* img) {
-	_SetBlockProperties(img, NULL, true);
-	_textures.erase(img);
+	if (img == NULL) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "NULL pointer was given as function argument" << endl;
+		return;
+	}
+
+	if (_textures.erase(img) == 0) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "texture pointer argument was not contained within this texture sheet" << endl;
+		return;
+	}
+
+	_freed_textures.erase(img);
+	_free_rects.push_back(VariableTexRect(img->x, img->y, img->width, img->height));
+	_MergeFreeRects();
 }
 
 
 
-void VariableTexSheet::_SetBlockProperties(BaseTexture* tex, BaseTexture* new_tex, bool free) {
-	if (tex == NULL) {
-		IF_PRINT_WARNING(VIDEO_DEBUG) << "NULL pointer was given as function argument" << endl;
+void VariableTexSheet::FreeTexture(BaseTexture* img) {
+	if (_textures.find(img) == _textures.end()) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "texture pointer argument was not contained within this texture sheet" << endl;
 		return;
 	}
 
-	if (_textures.find(tex) == _textures.end()) {
-		IF_PRINT_WARNING(VIDEO_DEBUG) << "texture pointer argument was not contained within this texture sheet" << endl;
+	_freed_textures.insert(img);
+}
+
+
+
+void VariableTexSheet::RestoreTexture(BaseTexture* img) {
+	if (_freed_textures.erase(img) == 0) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to restore, texture was not marked as freed" << endl;
 	}
+}
+
+
+
+uint32 VariableTexSheet::GetOccupiedArea() {
+	uint32 area = 0;
+	for (set<BaseTexture*>::iterator i = _textures.begin(); i != _textures.end(); i++) {
+		area += (*i)->width * (*i)->height;
+	}
+	return area;
+}
+
+
+
+uint32 VariableTexSheet::GetLargestFreeArea() const {
+	uint32 largest = 0;
+	for (uint32 i = 0; i < _free_rects.size(); i++) {
+		uint32 area = _free_rects[i].width * _free_rects[i].height;
+		if (area > largest)
+			largest = area;
+	}
+	return largest;
+}
+
+
+
+int32 VariableTexSheet::_FindFreeRect(int32 width, int32 height) const {
+	int32 best_index = -1;
+	int32 best_area_fit = 0;
+	int32 best_short_side_fit = 0;
 
-	// Calculate upper-left corner in blocks
-	int32 block_x = tex->x / 16;
-	int32 block_y = tex->y / 16;
+	for (uint32 i = 0; i < _free_rects.size(); i++) {
+		const VariableTexRect& rect = _free_rects[i];
+		if (rect.width < width || rect.height < height)
+			continue;
 
-	// Calculate width and height in blocks
-	int32 w = (tex->width  + 15) / 16;
-	int32 h = (tex->height + 15) / 16;
+		// Prefer the rectangle with the least area left over, breaking ties by the shorter leftover side
+		int32 area_fit = rect.width * rect.height - width * height;
+		int32 short_side_fit = min(rect.width - width, rect.height - height);
+		if (best_index < 0 || area_fit < best_area_fit || (area_fit == best_area_fit && short_side_fit < best_short_side_fit)) {
+			best_index = static_cast<int32>(i);
+			best_area_fit = area_fit;
+			best_short_side_fit = short_side_fit;
+		}
+	}
+
+	return best_index;
+}
+
+
+
+void VariableTexSheet::_MergeFreeRects() {
+	bool merged = true;
+	while (merged == true) {
+		merged = false;
+		for (uint32 i = 0; i < _free_rects.size() && merged == false; i++) {
+			for (uint32 j = i + 1; j < _free_rects.size(); j++) {
+				VariableTexRect& a = _free_rects[i];
+				const VariableTexRect& b = _free_rects[j];
+
+				// Rectangles in the same column with the same width which touch vertically
+				if (a.x == b.x && a.width == b.width) {
+					if (a.y + a.height == b.y) {
+						a.height += b.height;
+						merged = true;
+					}
+					else if (b.y + b.height == a.y) {
+						a.y = b.y;
+						a.height += b.height;
+						merged = true;
+					}
+				}
+				// Rectangles in the same row with the same height which touch horizontally
+				else if (a.y == b.y && a.height == b.height) {
+					if (a.x + a.width == b.x) {
+						a.width += b.width;
+						merged = true;
+					}
+					else if (b.x + b.width == a.x) {
+						a.x = b.x;
+						a.width += b.width;
+						merged = true;
+					}
+				}
 
-	for (int32 y = block_y; y < block_y + h; y++) {
-		for (int32 x = block_x; x < block_x + w; x++) {
-			int32 index = x + y * _block_width;
-			if (_blocks[index].image == tex) {
-				_blocks[index].free_image = free;
-				_blocks[index].image = new_tex;
+				if (merged == true) {
+					_free_rects.erase(_free_rects.begin() + j);
+					break;
+				}
 			}
 		}
 	}
+} // void VariableTexSheet::_MergeFreeRects()
+
+// -----------------------------------------------------------------------------
+// AtlasTexSheet class
+// -----------------------------------------------------------------------------
+
+AtlasTexSheet::AtlasTexSheet(int32 sheet_width, int32 sheet_height, GLuint sheet_id, bool sheet_static) :
+	TexSheet(sheet_width, sheet_height, sheet_id, VIDEO_TEXSHEET_ANY, sheet_static)
+{
+	dedicated = true;
+}
+
+
+
+void AtlasTexSheet::RemoveTexture(BaseTexture* img) {
+	if (_textures.erase(img) == 0) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "texture was not found in the atlas sheet" << endl;
+	}
+}
+
+
+
+uint32 AtlasTexSheet::GetOccupiedArea() {
+	uint32 area = 0;
+	for (set<BaseTexture*>::iterator i = _textures.begin(); i != _textures.end(); i++) {
+		area += (*i)->width * (*i)->height;
+	}
+	return area;
+}
+
+
+
+bool AtlasTexSheet::PlaceTexture(BaseTexture* img, int32 x, int32 y) {
+	if (img == NULL) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "NULL pointer was given as function argument" << endl;
+		return false;
+	}
+
+	if (x < 0 || y < 0 || x + img->width > width || y + img->height > height) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "texture does not fit within the atlas sheet at the requested location" << endl;
+		return false;
+	}
+
+	img->x = x;
+	img->y = y;
+
+	float sheet_width = static_cast<float>(width);
+	float sheet_height = static_cast<float>(height);
+
+	img->u1 = static_cast<float>(img->x + 0.5f) / sheet_width;
+	img->u2 = static_cast<float>(img->x + img->width - 0.5f) / sheet_width;
+	img->v1 = static_cast<float>(img->y + 0.5f) / sheet_height;
+	img->v2 = static_cast<float>(img->y + img->height - 0.5f) / sheet_height;
+
+	img->texture_sheet = this;
+	_textures.insert(img);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// GlyphTexSheet class
+// -----------------------------------------------------------------------------
+
+GlyphTexSheet::GlyphTexSheet(int32 sheet_width, int32 sheet_height, GLuint sheet_id) :
+	TexSheet(sheet_width, sheet_height, sheet_id, VIDEO_TEXSHEET_ANY, true),
+	_shelf_x(0),
+	_shelf_y(0),
+	_shelf_height(0),
+	_num_glyphs(0),
+	_occupied_area(0)
+{
+	dedicated = true;
+}
+
+
+
+bool GlyphTexSheet::ReserveSpace(int32 glyph_width, int32 glyph_height, int32& x, int32& y) {
+	// Start a new shelf if the glyph does not fit on the right side of the current one
+	if (_shelf_x + glyph_width > width) {
+		_shelf_x = 0;
+		_shelf_y += _shelf_height;
+		_shelf_height = 0;
+	}
+
+	// The sheet is full if the glyph would extend past its bottom edge
+	if (_shelf_x + glyph_width > width || _shelf_y + glyph_height > height)
+		return false;
+
+	x = _shelf_x;
+	y = _shelf_y;
+	_shelf_x += glyph_width;
+	if (glyph_height > _shelf_height)
+		_shelf_height = glyph_height;
+
+	_num_glyphs++;
+	_occupied_area += glyph_width * glyph_height;
+	return true;
 }
 
 } // namespace private_video
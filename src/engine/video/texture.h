@@ -34,8 +34,13 @@
 *** This sheet allows textures of any size to be inserted, but has slower
 *** performance than the FixedTexSheet.
 ***
-*** - <b>VariableTexNode</b>: represents a texture node entry for the
-*** VariableTexSheet class.
+*** - <b>VariableTexRect</b>: represents a rectangular region of free space
+*** in the VariableTexSheet class.
+***
+*** - <b>AtlasTexSheet</b>: a texture sheet uploaded whole from a page of the
+*** atlas cache, with the location of every texture already decided.
+***
+*** - <b>GlyphTexSheet</b>: a texture sheet holding the rendered glyphs of a font.
 *** ***************************************************************************/
 
 #ifndef __TEXTURE_HEADER__
@@ -149,6 +154,9 @@ public:
 	//! \brief Returns the number of textures that are contained on this texture sheet
 	virtual uint32 GetNumberTextures() = 0;
 
+	//! \brief Returns the number of pixels in the sheet that are allocated to textures, including freed textures
+	virtual uint32 GetOccupiedArea() = 0;
+
 	/** \brief Unloads all texture memory used by OpenGL for this sheet
 	*** \return Success/failure
 	**/
@@ -218,6 +226,12 @@ public:
 	//! \brief Flag indicating if texture sheet is loaded or not
 	bool loaded;
 
+	/** \brief If true, this sheet was created to hold a specific texture or set of textures
+	*** No other texture may be inserted into a dedicated sheet, and the sheet is destroyed when its last texture is removed.
+	*** This is used for textures that are too large to share a sheet with others, for captured screens, and for atlas pages.
+	**/
+	bool dedicated;
+
 protected:
 	//! \brief The width and height of the sheet in number of texture blocks
 	int32 _block_width, _block_height;
@@ -299,6 +313,9 @@ public:
 	void RestoreTexture(BaseTexture* img);
 
 	uint32 GetNumberTextures();
+
+	uint32 GetOccupiedArea()
+		{ return GetNumberTextures() * _texture_width * _texture_height; }
 	//@}
 
 private:
@@ -336,29 +353,35 @@ private:
 
 
 /** ****************************************************************************
-*** \brief Keeps track of which images are used/freed in the variable texture mem manager
+*** \brief A rectangular region of unallocated space in a variable texture sheet
 *** ***************************************************************************/
-class VariableTexNode {
+class VariableTexRect {
 public:
-	VariableTexNode() :
-		image(NULL), free_image(true) {}
+	VariableTexRect(int32 x_, int32 y_, int32 width_, int32 height_) :
+		x(x_), y(y_), width(width_), height(height_) {}
 
-	//! \brief A pointer to the image
-	BaseTexture* image;
+	//! \brief The pixel coordinates of the upper left corner of the region
+	int32 x, y;
 
-	//! \brief Set to true if the image is freed
-	bool free_image;
-}; // class VariableTexNode
+	//! \brief The width and height of the region, in pixels
+	int32 width, height;
+}; // class VariableTexRect
 
 
 /** ****************************************************************************
 *** \brief Used to manage texture sheets of variable image sizes
 ***
-*** This class divides a texture sheet up into 16x16 pixel blocks, and keeps
-*** track of which images have allocated which blocks. This is done to reduce
-*** the time complexity for doing texture insertion and removal operations, but
-*** the downside is that it may leave some space in the texture sheet occupied
-*** but unused for images that are not divisible by 16 in width or height.
+*** This class packs textures into the sheet with a guillotine algorithm. The sheet
+*** keeps a list of free rectangles, initially a single rectangle covering the entire
+*** sheet. A new texture is placed in the upper left corner of the free rectangle that
+*** it fits most tightly (the one with the least area left over), and the remaining
+*** L-shaped space of that rectangle is cut into two new free rectangles along the
+*** shorter leftover axis. When a texture is removed its rectangle is returned to the
+*** list, and free rectangles which share a full edge are merged back together.
+***
+*** Textures that are marked as freed keep their space in the sheet so that they may
+*** be restored later. If a new texture does not fit anywhere, all freed textures are
+*** removed to reclaim their space and the insertion is tried once more.
 *** ***************************************************************************/
 class VariableTexSheet : public TexSheet {
 public:
@@ -381,35 +404,188 @@ public:
 
 	void RemoveTexture(BaseTexture* img);
 
-	void FreeTexture(BaseTexture* img)
-		{ _SetBlockProperties(img, img, true); }
+	void FreeTexture(BaseTexture* img);
 
-	void RestoreTexture(BaseTexture* img)
-		{ _SetBlockProperties(img, img, false); }
+	void RestoreTexture(BaseTexture* img);
 
 	uint32 GetNumberTextures()
 		{ return _textures.size(); }
+
+	uint32 GetOccupiedArea();
 	//@}
 
+	//! \brief Returns the number of rectangles in the list of free space
+	uint32 GetNumberFreeRects() const
+		{ return _free_rects.size(); }
+
+	//! \brief Returns the area, in pixels, of the largest rectangle in the list of free space
+	uint32 GetLargestFreeArea() const;
+
+	//! \brief Returns the number of textures in the sheet that are marked as freed
+	uint32 GetNumberFreedTextures() const
+		{ return _freed_textures.size(); }
+
 private:
-	/** \brief The list of 16x16 pixel blocks in the sheet.
-	*** The size of this structure is: (width / 16) * (height / 16)
-	**/
-	VariableTexNode* _blocks;
+	//! \brief The regions of the sheet that are not allocated to any texture
+	std::vector<VariableTexRect> _free_rects;
 
 	/** \brief A set containing each texture that has been inserted into this class
 	*** This container is used to be able to quickly determine if a texture is loaded by an object of this class
 	**/
 	std::set<BaseTexture*> _textures;
 
-	/** \brief Updates the properties of all of the blocks associated with a given texture
-	*** \param tex The texture to update
-	*** \param new_tex The texture pointer to set the block to
-	*** \param new_image The boolean value to set the free status flag to
+	//! \brief The textures which are marked as freed. Each of these is also contained in the _textures set.
+	std::set<BaseTexture*> _freed_textures;
+
+	/** \brief Finds the free rectangle that a texture of a given size fits in most tightly
+	*** \param width The width of the texture, in pixels
+	*** \param height The height of the texture, in pixels
+	*** \return The index of the free rectangle in _free_rects, or -1 if the texture does not fit in any of them
 	**/
-	void _SetBlockProperties(BaseTexture* tex, BaseTexture* new_tex, bool free);
+	int32 _FindFreeRect(int32 width, int32 height) const;
+
+	//! \brief Repeatedly merges pairs of free rectangles which share a full edge until no more merges are possible
+	void _MergeFreeRects();
 }; // class VariableTexSheet : public TexSheet
 
+
+/** ****************************************************************************
+*** \brief A texture sheet holding a page that was loaded from the atlas cache
+***
+*** The contents of the sheet are uploaded all at once when it is created, and the
+*** location of every texture on the page is read from the cache's index. Textures
+*** are placed with PlaceTexture() rather than being allocated space by the sheet,
+*** so AddTexture() and InsertTexture() always fail. This keeps the sheet from
+*** being chosen to hold any image other than the ones that it was built with.
+***
+*** \note Atlas sheets are always dedicated, so the sheet is destroyed once the
+*** last of its textures is removed.
+*** ***************************************************************************/
+class AtlasTexSheet : public TexSheet {
+public:
+	/** \brief Constructs a new texture sheet
+	*** \param sheet_width The width of the sheet
+	*** \param sheet_height The height of the sheet
+	*** \param sheet_id The OpenGL texture ID value for the sheet
+	*** \param sheet_static Whether the sheet should be labeled static or not
+	**/
+	AtlasTexSheet(int32 sheet_width, int32 sheet_height, GLuint sheet_id, bool sheet_static);
+
+	~AtlasTexSheet()
+		{}
+
+	//! \name Methods inherited from TexSheet
+	//@{
+	bool AddTexture(BaseTexture* img, ImageMemory& data)
+		{ return false; }
+
+	bool InsertTexture(BaseTexture* img)
+		{ return false; }
+
+	void RemoveTexture(BaseTexture* img);
+
+	void FreeTexture(BaseTexture* img)
+		{}
+
+	void RestoreTexture(BaseTexture* img)
+		{}
+
+	uint32 GetNumberTextures()
+		{ return _textures.size(); }
+
+	uint32 GetOccupiedArea();
+	//@}
+
+	/** \brief Places a texture at a known location in the sheet
+	*** \param img A pointer to the texture to place. Its width and height must already be set.
+	*** \param x The x coordinate of the upper left corner of the texture, in pixels
+	*** \param y The y coordinate of the upper left corner of the texture, in pixels
+	*** \return False if the texture does not lie entirely within the sheet
+	**/
+	bool PlaceTexture(BaseTexture* img, int32 x, int32 y);
+
+private:
+	//! \brief All textures which have been placed in this sheet
+	std::set<BaseTexture*> _textures;
+}; // class AtlasTexSheet : public TexSheet
+
+
+/** ****************************************************************************
+*** \brief A texture sheet holding the rendered glyphs of a single font
+***
+*** Glyphs are packed into the sheet in rows (shelves). A glyph is placed to the right
+*** of the previous glyph on the current shelf, and when the shelf is full a new one
+*** is started beneath it which is as tall as the tallest glyph of the shelf above.
+*** When the sheet is full the TextSupervisor creates a new sheet for the font.
+***
+*** Glyphs are not BaseTexture objects, so AddTexture() and InsertTexture() always fail
+*** and no image is ever placed in a glyph sheet. The contents of the sheet can not be
+*** reloaded from a file, so the TextureController removes every glyph sheet along with
+*** the glyph caches that refer to it when textures are unloaded. The glyphs are then
+*** rendered again the next time that they are drawn.
+***
+*** \note Glyph sheets are always dedicated and always filtered linearly.
+*** ***************************************************************************/
+class GlyphTexSheet : public TexSheet {
+public:
+	/** \brief Constructs a new texture sheet
+	*** \param sheet_width The width of the sheet
+	*** \param sheet_height The height of the sheet
+	*** \param sheet_id The OpenGL texture ID value for the sheet
+	**/
+	GlyphTexSheet(int32 sheet_width, int32 sheet_height, GLuint sheet_id);
+
+	~GlyphTexSheet()
+		{}
+
+	//! \name Methods inherited from TexSheet
+	//@{
+	bool AddTexture(BaseTexture* img, ImageMemory& data)
+		{ return false; }
+
+	bool InsertTexture(BaseTexture* img)
+		{ return false; }
+
+	void RemoveTexture(BaseTexture* img)
+		{}
+
+	void FreeTexture(BaseTexture* img)
+		{}
+
+	void RestoreTexture(BaseTexture* img)
+		{}
+
+	//! \note Returns the number of glyphs in the sheet
+	uint32 GetNumberTextures()
+		{ return _num_glyphs; }
+
+	uint32 GetOccupiedArea()
+		{ return _occupied_area; }
+	//@}
+
+	/** \brief Finds room for a glyph of the given size in the sheet
+	*** \param glyph_width The width of the glyph, in pixels
+	*** \param glyph_height The height of the glyph, in pixels
+	*** \param x Set to the x coordinate of the upper left corner of the reserved space
+	*** \param y Set to the y coordinate of the upper left corner of the reserved space
+	*** \return False if the sheet is full and the glyph must be placed in a new sheet
+	**/
+	bool ReserveSpace(int32 glyph_width, int32 glyph_height, int32& x, int32& y);
+
+private:
+	//! \brief The pixel position where the next glyph on the current shelf will be placed
+	int32 _shelf_x, _shelf_y;
+
+	//! \brief The height of the tallest glyph on the current shelf
+	int32 _shelf_height;
+
+	//! \brief The number of glyphs that have been placed in the sheet
+	uint32 _num_glyphs;
+
+	//! \brief The number of pixels that have been reserved for glyphs
+	uint32 _occupied_area;
+}; // class GlyphTexSheet : public TexSheet
+
 }  // namespace private_video
 
 }  // namespace hoa_video
@@ -32,8 +32,16 @@ TextureController* TextureManager = NULL;
 TextureController::TextureController() :
 	debug_current_sheet(-1),
 	_last_tex_id(INVALID_TEXTURE_ID),
-	_debug_num_tex_switches(0)
-{}
+	_debug_num_tex_switches(0),
+	_variable_sheet_size(DEFAULT_VARIABLE_SHEET_SIZE),
+	_max_texture_size(DEFAULT_VARIABLE_SHEET_SIZE)
+{
+	// The GL context has been created by the time the controller is, so the limit is known before any sheet size is set
+	GLint max_texture_size = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_size);
+	if (max_texture_size > 0)
+		_max_texture_size = max_texture_size;
+}
 
 
 
@@ -57,6 +65,10 @@ TextureController::~TextureController() {
 
 
 bool TextureController::SingletonInitialize() {
+	// Variable texture sheets may not be larger than the implementation allows
+	if (_variable_sheet_size > _max_texture_size)
+		_variable_sheet_size = _max_texture_size;
+
 	// Create a default set of texture sheets
 	if (_CreateTexSheet(512, 512, VIDEO_TEXSHEET_32x32, false) == NULL) {
 		PRINT_ERROR << "could not create default 32x32 texture sheet" << endl;
@@ -70,11 +82,11 @@ bool TextureController::SingletonInitialize() {
 		PRINT_ERROR << "could not create default 64x64 texture sheet" << endl;
 		return false;
 	}
-	if (_CreateTexSheet(512, 512, VIDEO_TEXSHEET_ANY, true) == NULL) {
+	if (_CreateTexSheet(_variable_sheet_size, _variable_sheet_size, VIDEO_TEXSHEET_ANY, true) == NULL) {
 		PRINT_ERROR << "could not create default static variable sized texture sheet" << endl;
 		return false;
 	}
-	if (_CreateTexSheet(512, 512, VIDEO_TEXSHEET_ANY, false) == NULL) {
+	if (_CreateTexSheet(_variable_sheet_size, _variable_sheet_size, VIDEO_TEXSHEET_ANY, false) == NULL) {
 		PRINT_ERROR << "could not create default variable sized tex sheet" << endl;
 		return false;
 	}
@@ -87,6 +99,16 @@ bool TextureController::SingletonInitialize() {
 bool TextureController::UnloadTextures() {
 	bool success = true;
 
+	VideoManager->_sprite_batch.Flush();
+
+	// Clear all font caches and remove their glyph sheets. The glyphs can not be reloaded into a sheet, so they
+	// are instead rendered again when they are next drawn.
+	map<string, FontProperties*>::iterator j = TextManager->_font_map.begin();
+	while (j != TextManager->_font_map.end()) {
+		TextManager->_ClearGlyphCache(j->second);
+		j++;
+	}
+
 	// Save temporary textures to disk, in other words textures which were not
 	// loaded from a file. This way when we recreate the GL context we will
 	// be able to load them again.
@@ -112,25 +134,6 @@ bool TextureController::UnloadTextures() {
 		i++;
 	}
 
-	// Clear all font caches
-	map<string, FontProperties*>::iterator j = TextManager->_font_map.begin();
-	while (j != TextManager->_font_map.end()) {
-		FontProperties *fp = j->second;
-
-		if (fp->glyph_cache != NULL) {
-			for (uint32 k = 0; k < fp->glyph_cache->size(); ++k) {
-				if (fp->glyph_cache->at(k) != NULL) {
-					_DeleteTexture(fp->glyph_cache->at(k)->texture);
-					delete fp->glyph_cache->at(k);
-				}
-			}
-
-			fp->glyph_cache->clear();
-		}
-
-		j++;
-	}
-
 	return success;
 } // bool TextureController::UnloadTextures()
 
@@ -162,6 +165,32 @@ bool TextureController::ReloadTextures() {
 
 
 
+bool TextureController::SetVariableSheetSize(int32 size) {
+	if (IsPowerOfTwo(size) == false || size < 512 || size > _max_texture_size) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "invalid texture sheet size argument: " << size << endl;
+		return false;
+	}
+
+	_variable_sheet_size = size;
+	return true;
+}
+
+
+
+bool TextureController::PredecodeImage(const string& filename, bool multi_image) {
+	if (multi_image == true) {
+		if (_atlas_cache.IsCached(filename) == true)
+			return false;
+	}
+	else if (_IsImageTextureRegistered(filename) == true) {
+		return false;
+	}
+
+	return _image_decoder.QueueDecode(filename);
+}
+
+
+
 void TextureController::DEBUG_NextTexSheet() {
 	debug_current_sheet++;
 
@@ -210,13 +239,13 @@ void TextureController::DEBUG_ShowTexSheet() {
 	VideoManager->SetDrawFlags(VIDEO_NO_BLEND, VIDEO_X_LEFT, VIDEO_Y_BOTTOM, 0);
 	VideoManager->SetCoordSys(0.0f, 1024.0f, 0.0f, 768.0f);
 
-	glPushMatrix();
+	VideoManager->PushMatrix();
 	VideoManager->Move(0.0f,0.0f);
-	glScalef(sheet->width / 2.0f, sheet->height / 2.0f, 1.0f);
+	VideoManager->Scale(sheet->width / 2.0f, sheet->height / 2.0f);
 
 	sheet->DEBUG_Draw();
 
-	glPopMatrix();
+	VideoManager->PopMatrix();
 
 	char buf[200];
 
@@ -231,7 +260,11 @@ void TextureController::DEBUG_ShowTexSheet() {
 	sprintf(buf, "  Size:    %dx%d", sheet->width, sheet->height);
 	TextManager->Draw(buf);
 
-	if (sheet->type == VIDEO_TEXSHEET_32x32)
+	if (dynamic_cast<AtlasTexSheet*>(sheet) != NULL)
+		sprintf(buf, "  Type:    Atlas page");
+	else if (dynamic_cast<GlyphTexSheet*>(sheet) != NULL)
+		sprintf(buf, "  Type:    Font glyphs");
+	else if (sheet->type == VIDEO_TEXSHEET_32x32)
 		sprintf(buf, "  Type:    32x32");
 	else if (sheet->type == VIDEO_TEXSHEET_32x64)
 		sprintf(buf, "  Type:    32x64");
@@ -253,6 +286,31 @@ void TextureController::DEBUG_ShowTexSheet() {
 	VideoManager->MoveRelative(0, -20);
 	TextManager->Draw(buf);
 
+	uint32 sheet_area = sheet->width * sheet->height;
+	sprintf(buf, "  Textures: %d (%.1f%% occupied)", sheet->GetNumberTextures(), 100.0f * sheet->GetOccupiedArea() / sheet_area);
+	VideoManager->MoveRelative(0, -20);
+	TextManager->Draw(buf);
+
+	VariableTexSheet* variable_sheet = dynamic_cast<VariableTexSheet*>(sheet);
+	if (variable_sheet != NULL) {
+		sprintf(buf, "  Free:    %d rects, largest %.1f%%, %d freed textures", variable_sheet->GetNumberFreeRects(),
+			100.0f * variable_sheet->GetLargestFreeArea() / sheet_area, variable_sheet->GetNumberFreedTextures());
+		VideoManager->MoveRelative(0, -20);
+		TextManager->Draw(buf);
+	}
+
+	// Statistics for all texture sheets combined
+	float total_area = 0.0f;
+	float total_occupied_area = 0.0f;
+	for (uint32 i = 0; i < _tex_sheets.size(); i++) {
+		total_area += static_cast<float>(_tex_sheets[i]->width * _tex_sheets[i]->height);
+		total_occupied_area += static_cast<float>(_tex_sheets[i]->GetOccupiedArea());
+	}
+
+	sprintf(buf, "All sheets: %d (%.1f%% occupied)", num_sheets, 100.0f * total_occupied_area / total_area);
+	VideoManager->MoveRelative(0, -40);
+	TextManager->Draw(buf);
+
 	VideoManager->PopState();
 } // void TextureController::DEBUG_ShowTexSheet()
 
@@ -381,6 +439,44 @@ TexSheet* TextureController::_CreateTexSheet(int32 width, int32 height, TexSheet
 
 
 
+AtlasTexSheet* TextureController::_CreateAtlasTexSheet(int32 width, int32 height, bool is_static) {
+	if (width > _max_texture_size || height > _max_texture_size) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "requested atlas sheet size exceeds the maximum texture size: " << width << "x" << height << endl;
+		return NULL;
+	}
+
+	GLuint tex_id = _CreateBlankGLTexture(width, height);
+	if (tex_id == INVALID_TEXTURE_ID) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to create a new blank OpenGL texture" << endl;
+		return NULL;
+	}
+
+	AtlasTexSheet* sheet = new AtlasTexSheet(width, height, tex_id, is_static);
+	_tex_sheets.push_back(sheet);
+	return sheet;
+}
+
+
+
+GlyphTexSheet* TextureController::_CreateGlyphTexSheet(int32 width, int32 height) {
+	if (width > _max_texture_size || height > _max_texture_size) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "requested glyph sheet size exceeds the maximum texture size: " << width << "x" << height << endl;
+		return NULL;
+	}
+
+	GLuint tex_id = _CreateBlankGLTexture(width, height);
+	if (tex_id == INVALID_TEXTURE_ID) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to create a new blank OpenGL texture" << endl;
+		return NULL;
+	}
+
+	GlyphTexSheet* sheet = new GlyphTexSheet(width, height, tex_id);
+	_tex_sheets.push_back(sheet);
+	return sheet;
+}
+
+
+
 void TextureController::_RemoveSheet(TexSheet* sheet) {
 	if (sheet == NULL) {
 		IF_PRINT_WARNING(VIDEO_DEBUG) << "NULL argument passed to function" << endl;
@@ -392,6 +488,9 @@ void TextureController::_RemoveSheet(TexSheet* sheet) {
 		return;
 	}
 
+	// Any quads waiting in the sprite batch for this sheet must be drawn before the sheet is destroyed
+	VideoManager->_sprite_batch.FlushSheet(sheet);
+
 	vector<TexSheet*>::iterator i = _tex_sheets.begin();
 
 	while(i != _tex_sheets.end()) {
@@ -409,8 +508,8 @@ void TextureController::_RemoveSheet(TexSheet* sheet) {
 
 
 TexSheet* TextureController::_InsertImageInTexSheet(BaseTexture *image, ImageMemory& load_info, bool is_static) {
-	// Image sizes larger than 512 in either dimension require their own texture sheet
-	if (load_info.width > 512 || load_info.height > 512) {
+	// Images larger than a variable texture sheet in either dimension require their own texture sheet
+	if (load_info.width > _variable_sheet_size || load_info.height > _variable_sheet_size) {
 		int32 round_width = RoundUpPow2(load_info.width);
 		int32 round_height = RoundUpPow2(load_info.height);
 		TexSheet* sheet = _CreateTexSheet(round_width, round_height, VIDEO_TEXSHEET_ANY, false);
@@ -420,6 +519,7 @@ TexSheet* TextureController::_InsertImageInTexSheet(BaseTexture *image, ImageMem
 			IF_PRINT_WARNING(VIDEO_DEBUG) << "could not create new texture sheet for image" << endl;
 			return NULL;
 		}
+		sheet->dedicated = true;
 
 		if (sheet->AddTexture(image, load_info) == true)
 			return sheet;
@@ -458,7 +558,8 @@ TexSheet* TextureController::_InsertImageInTexSheet(BaseTexture *image, ImageMem
 	}
 
 	// We couldn't add it to any existing sheets, so we must create a new one for it
-	TexSheet *sheet = _CreateTexSheet(512, 512, type, is_static);
+	int32 sheet_size = (type == VIDEO_TEXSHEET_ANY) ? _variable_sheet_size : 512;
+	TexSheet *sheet = _CreateTexSheet(sheet_size, sheet_size, type, is_static);
 	if (sheet == NULL) {
 		IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to create a new texture sheet for image" << endl;
 		return NULL;
@@ -502,6 +603,8 @@ bool TextureController::_ReloadImagesToSheet(TexSheet* sheet) {
 					success = false;
 					continue;
 				}
+				if (load_info.rgb_format == true)
+					load_info.RGBToRGBA();
 
 				// Copy the part of the image in a buffer
 				image.height = img->height;
@@ -622,6 +725,18 @@ void TextureController::_RegisterImageTexture(ImageTexture* img) {
 
 
 
+bool TextureController::_IsMultiImageRegistered(const string& filename, uint32 grid_rows, uint32 grid_cols) const {
+	for (uint32 row = 0; row < grid_rows; row++) {
+		for (uint32 col = 0; col < grid_cols; col++) {
+			if (_IsImageTextureRegistered(filename + _CreateMultiImageTag(row, grid_rows, col, grid_cols)) == false)
+				return false;
+		}
+	}
+	return true;
+}
+
+
+
 void TextureController::_UnregisterImageTexture(ImageTexture* img) {
 	if (img == NULL) {
 		IF_PRINT_WARNING(VIDEO_DEBUG) << "NULL argument passed to function" << endl;
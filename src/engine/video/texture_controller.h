@@ -34,12 +34,17 @@
 
 #include "texture.h"
 #include "image_base.h"
+#include "image_decoder.h"
+#include "atlas_cache.h"
 
 namespace hoa_video {
 
 //! \brief The singleton pointer for the instance of the texture controller
 extern TextureController* TextureManager;
 
+//! \brief The default width and height of texture sheets which hold images of any size
+const int32 DEFAULT_VARIABLE_SHEET_SIZE = 1024;
+
 class TextureController : public hoa_utils::Singleton<TextureController> {
 	friend class hoa_utils::Singleton<TextureController>;
 	friend class VideoEngine;
@@ -54,6 +59,10 @@ class TextureController : public hoa_utils::Singleton<TextureController> {
 	friend class private_video::FixedTexSheet;
 	friend class private_video::VariableTexSheet;
 	friend class private_video::ParticleSystem;
+	friend class private_video::SpriteBatch;
+	friend class StaticSpriteBatch;
+	friend class ImageLoadBatch;
+	friend class private_video::AtlasCache;
 
 public:
 	TextureController();
@@ -77,6 +86,39 @@ public:
 	**/
 	bool ReloadTextures();
 
+	/** \brief Sets the width and height of new texture sheets created to hold images of any size
+	*** \param size The sheet size in pixels. Must be a power of two of at least 512 and no larger than the maximum texture size
+	*** \return True if the size was valid and was set
+	***
+	*** Sheets that already exist keep their size. Images larger than this size in either dimension are given a dedicated sheet.
+	*** \note The VideoEngine calls this with the size read from the settings file before SingletonInitialize() creates
+	*** the default sheets.
+	**/
+	bool SetVariableSheetSize(int32 size);
+
+	int32 GetVariableSheetSize() const
+		{ return _variable_sheet_size; }
+
+	//! \brief Returns the maximum texture width and height supported by the OpenGL implementation
+	int32 GetMaxTextureSize() const
+		{ return _max_texture_size; }
+
+	/** \brief Begins decoding an image file on the image decoder threads so that a later load of it is faster
+	*** \param filename The name of the image file
+	*** \param multi_image True if the file will be loaded as a multi image, which may come from the atlas cache instead
+	*** \return True if the file was queued for decoding
+	***
+	*** Nothing is queued for an image which is already in texture memory or in the atlas cache. The decoded
+	*** data is held until the image is loaded or until DiscardPredecodedImage() is called for it.
+	**/
+	bool PredecodeImage(const std::string& filename, bool multi_image);
+
+	/** \brief Frees any data decoded by PredecodeImage() which was never claimed by a load of the image
+	*** \param filename The name of the image file
+	**/
+	void DiscardPredecodedImage(const std::string& filename)
+		{ _image_decoder.Discard(filename); }
+
 	//! \brief Cycles forward to show the next texture sheet
 	void DEBUG_NextTexSheet();
 
@@ -85,7 +127,7 @@ public:
 
 	/** \brief Displays the currently selected texture sheet.
 	*** By using DEBUG_NextTexSheet() and DEBUG_PrevTexSheet(), you can change the current texture sheet so the sheet shown by this function
-	*** cycles through all currently loaded texture sheets.
+	*** cycles through all currently loaded texture sheets. The occupancy of the sheet and of all sheets combined is displayed with it.
 	**/
 	void DEBUG_ShowTexSheet();
 
@@ -110,6 +152,18 @@ private:
 	//! \brief Keeps track of the number of texture switches per frame
 	uint32 _debug_num_tex_switches;
 
+	//! \brief The width and height used for new texture sheets which hold images of any size
+	int32 _variable_sheet_size;
+
+	//! \brief Decodes image files on worker threads ahead of their upload to texture memory
+	private_video::ImageDecoder _image_decoder;
+
+	//! \brief Stores and retrieves prepacked texture sheet pages for multi images
+	private_video::AtlasCache _atlas_cache;
+
+	//! \brief The value of GL_MAX_TEXTURE_SIZE, retrieved when the singleton is initialized
+	int32 _max_texture_size;
+
 	// ---------- Private methods
 
 	//! \name Texture Operations
@@ -159,6 +213,21 @@ private:
 	**/
 	private_video::TexSheet* _CreateTexSheet(int32 width, int32 height, private_video::TexSheetType type, bool is_static);
 
+	/** \brief Creates a new texture sheet for a page of the atlas cache
+	*** \param width The width of the sheet, in pixels
+	*** \param height The height of the sheet, in pixels
+	*** \param is_static If true, the images of this sheet are not expected to be loaded and unloaded very often
+	*** \return A pointer to the newly created AtlasTexSheet, or NULL if a new sheet could not be created
+	**/
+	private_video::AtlasTexSheet* _CreateAtlasTexSheet(int32 width, int32 height, bool is_static);
+
+	/** \brief Creates a new texture sheet for the glyphs of a font
+	*** \param width The width of the sheet, in pixels
+	*** \param height The height of the sheet, in pixels
+	*** \return A pointer to the newly created GlyphTexSheet, or NULL if a new sheet could not be created
+	**/
+	private_video::GlyphTexSheet* _CreateGlyphTexSheet(int32 width, int32 height);
+
 	/** \brief Removes references to a texture sheet and deletes it from memory
 	*** \param sheet A pointer to the sheet we wish to remove
 	**/
@@ -207,6 +276,25 @@ private:
 	 **/
 	hoa_video::private_video::ImageTexture* _GetImageTexture(std::string nametag)
 		{ if (_IsImageTextureRegistered(nametag) == true) return _images[nametag]; else return NULL; }
+
+	/** \brief Creates the tag that identifies one element of a multi image
+	*** \param row The row of the element in the multi image grid
+	*** \param grid_rows The number of rows in the multi image grid
+	*** \param col The column of the element in the multi image grid
+	*** \param grid_cols The number of columns in the multi image grid
+	*** \return The tag string, which is appended to the filename to form the element's nametag
+	**/
+	static std::string _CreateMultiImageTag(uint32 row, uint32 grid_rows, uint32 col, uint32 grid_cols)
+		{ return "<X" + hoa_utils::NumberToString(row) + "_" + hoa_utils::NumberToString(grid_rows) + ">" +
+			"<Y" + hoa_utils::NumberToString(col) + "_" + hoa_utils::NumberToString(grid_cols) + ">"; }
+
+	/** \brief Determines if every element of a multi image is currently registered
+	*** \param filename The name of the multi image file
+	*** \param grid_rows The number of rows in the multi image grid
+	*** \param grid_cols The number of columns in the multi image grid
+	*** \return True only if none of the elements would require the file to be loaded
+	**/
+	bool _IsMultiImageRegistered(const std::string& filename, uint32 grid_rows, uint32 grid_cols) const;
 	//@}
 
 	//! \name Text Texture Operations
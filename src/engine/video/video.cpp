@@ -82,6 +82,7 @@ VideoEngine::VideoEngine() :
 	_fullscreen = false;
 	_temp_width = 0;
 	_temp_height = 0;
+	_temp_texture_sheet_size = DEFAULT_VARIABLE_SHEET_SIZE;
 	_temp_fullscreen = false;
 	_smooth_textures = true;
 	_advanced_display = false;
@@ -129,6 +130,10 @@ VideoEngine::VideoEngine() :
 
 
 VideoEngine::~VideoEngine() {
+	// Write out every screenshot that was requested before the OpenGL context goes away
+	_screen_capture.Finish();
+	_screen_capture.DestroyBuffers();
+
 	_particle_manager.Destroy();
 	TextManager->SingletonDestroy();
 
@@ -226,6 +231,11 @@ bool VideoEngine::FinalizeInitialization() {
 	TextureManager = TextureController::SingletonCreate();
 	TextManager = TextSupervisor::SingletonCreate();
 
+	// The sheet size must be set before the texture manager creates its default sheets
+	if (TextureManager->SetVariableSheetSize(_temp_texture_sheet_size) == false) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "invalid texture sheet size, using the default size: " << DEFAULT_VARIABLE_SHEET_SIZE << endl;
+	}
+
 	// Initialize all sub-systems
 	if (TextureManager->SingletonInitialize() == false) {
 		PRINT_ERROR << "could not initialize texture manager" << endl;
@@ -350,6 +360,7 @@ void VideoEngine::Clear(const Color &c) {
 	glClear(GL_COLOR_BUFFER_BIT);
 
 	TextureManager->_debug_num_tex_switches = 0;
+	_sprite_batch.ResetDebugCounters();
 
 	if (CheckGLError() == true) {
 		IF_PRINT_WARNING(VIDEO_DEBUG) << "an OpenGL error occured: " << CreateGLErrorString() << endl;
@@ -368,6 +379,12 @@ void VideoEngine::Display(uint32 frame_time) {
 	// Update all particle effects
 	_particle_manager.Update(frame_time);
 
+	// Draw any images that are still waiting in the sprite batch so that the statistics below are complete
+	_sprite_batch.Flush();
+
+	// Screenshots are taken here so that they contain the whole frame, but not the debugging information drawn below
+	_screen_capture.Update();
+
 	// Update shaking effect
 	PushState();
 	SetStandardCoordSys();
@@ -385,6 +402,7 @@ void VideoEngine::Display(uint32 frame_time) {
 	DrawFPS(frame_time); // Draw FPS Counter If We Need To
 
 	PopState();
+	_sprite_batch.Flush();
 
 	SDL_GL_SwapWindow(window);
 
@@ -418,6 +436,9 @@ bool VideoEngine::ApplySettings() {
 		if (TextureManager && TextureManager->UnloadTextures() == false) {
 			IF_PRINT_WARNING(VIDEO_DEBUG) << "failed to delete OpenGL textures during a context change" << endl;
 		}
+		// Any screen reads still in flight must be completed while their buffers exist
+		_screen_capture.Finish();
+		_screen_capture.DestroyBuffers();
 
 		Uint32 flags = SDL_WINDOW_OPENGL;
 
@@ -526,13 +547,20 @@ void VideoEngine::SetViewport(float left, float right, float bottom, float top)
 	if (t > _screen_height)
 		t = _screen_height;
 
-	_current_context.viewport = ScreenRect(l, b, r - l, t - b);
+	ScreenRect viewport(l, b, r - l, t - b);
+	if (viewport != _current_context.viewport)
+		_sprite_batch.Flush();
+
+	_current_context.viewport = viewport;
 	glViewport(l, b, r - l, t - b);
 }
 
 
 
 void VideoEngine::SetCoordSys(const CoordSys& coordinate_system) {
+	// Pending quads were transformed into the old coordinate system, so they must be drawn with the old projection
+	if (coordinate_system != _current_context.coordinate_system)
+		_sprite_batch.Flush();
 	_current_context.coordinate_system = coordinate_system;
 
 	glMatrixMode(GL_PROJECTION);
@@ -545,11 +573,14 @@ void VideoEngine::SetCoordSys(const CoordSys& coordinate_system) {
 	// This small translation is supposed to help with pixel-perfect 2D rendering in OpenGL.
 	// Reference: http://www.opengl.org/resources/faq/technical/transformations.htm#tran0030
 	glTranslatef(0.375, 0.375, 0);
+	_transform.LoadIdentity();
+	_transform.Translate(0.375f, 0.375f);
 }
 
 
 
 void VideoEngine::EnableScissoring() {
+	_sprite_batch.Flush();
 	_current_context.scissoring_enabled = true;
 	glEnable(GL_SCISSOR_TEST);
 }
@@ -557,6 +588,7 @@ void VideoEngine::EnableScissoring() {
 
 
 void VideoEngine::DisableScissoring() {
+	_sprite_batch.Flush();
 	_current_context.scissoring_enabled = false;
 	glDisable(GL_SCISSOR_TEST);
 }
@@ -564,7 +596,11 @@ void VideoEngine::DisableScissoring() {
 
 
 void VideoEngine::SetScissorRect(float left, float right, float bottom, float top) {
-	_current_context.scissor_rectangle = CalculateScreenRect(left, right, bottom, top);
+	ScreenRect scissor_rectangle = CalculateScreenRect(left, right, bottom, top);
+	if (_current_context.scissoring_enabled == true && scissor_rectangle != _current_context.scissor_rectangle)
+		_sprite_batch.Flush();
+
+	_current_context.scissor_rectangle = scissor_rectangle;
 
 	glScissor(static_cast<GLint>((_current_context.scissor_rectangle.left / static_cast<float>(VIDEO_STANDARD_RESOLUTION_WIDTH)) * _current_context.viewport.width),
 		static_cast<GLint>((_current_context.scissor_rectangle.top / static_cast<float>(VIDEO_STANDARD_RESOLUTION_HEIGHT)) * _current_context.viewport.height),
@@ -576,6 +612,9 @@ void VideoEngine::SetScissorRect(float left, float right, float bottom, float to
 
 
 void VideoEngine::SetScissorRect(const ScreenRect& rect) {
+	if (_current_context.scissoring_enabled == true && rect != _current_context.scissor_rectangle)
+		_sprite_batch.Flush();
+
 	_current_context.scissor_rectangle = rect;
 
 	glScissor(static_cast<GLint>((_current_context.scissor_rectangle.left / static_cast<float>(VIDEO_STANDARD_RESOLUTION_WIDTH)) * _current_context.viewport.width),
@@ -623,6 +662,8 @@ ScreenRect VideoEngine::CalculateScreenRect(float left, float right, float botto
 void VideoEngine::Move(float x, float y) {
 	glLoadIdentity();
 	glTranslatef(x, y, 0);
+	_transform.LoadIdentity();
+	_transform.Translate(x, y);
 	_x_cursor = x;
 	_y_cursor = y;
 }
@@ -631,17 +672,31 @@ void VideoEngine::Move(float x, float y) {
 
 void VideoEngine::MoveRelative(float x, float y) {
 	glTranslatef(x, y, 0);
+	_transform.Translate(x, y);
 	_x_cursor += x;
 	_y_cursor += y;
 }
 
 
 
+void VideoEngine::PopMatrix() {
+	if (_transform_stack.empty() == true) {
+		IF_PRINT_WARNING(VIDEO_DEBUG) << "no transformations were saved on the stack" << endl;
+		return;
+	}
+
+	glPopMatrix();
+	_transform = _transform_stack.back();
+	_transform_stack.pop_back();
+}
+
+
 
 void VideoEngine::PushState() {
 	// Push current modelview transformation
 	glMatrixMode(GL_MODELVIEW);
 	glPushMatrix();
+	_transform_stack.push_back(_transform);
 
 	_context_stack.push(_current_context);
 }
@@ -655,6 +710,17 @@ void VideoEngine::PopState() {
 		return;
 	}
 
+	// The restored context may change the projection, viewport, or scissoring state. Only those changes require
+	// the pending quads to be drawn, so that images drawn within a push/pop pair can continue to share a batch.
+	const Context& restored_context = _context_stack.top();
+	if (restored_context.coordinate_system != _current_context.coordinate_system
+		|| restored_context.viewport != _current_context.viewport
+		|| restored_context.scissoring_enabled != _current_context.scissoring_enabled
+		|| (restored_context.scissoring_enabled == true && restored_context.scissor_rectangle != _current_context.scissor_rectangle))
+	{
+		_sprite_batch.Flush();
+	}
+
 	_current_context = _context_stack.top();
 	_context_stack.pop();
 
@@ -667,6 +733,10 @@ void VideoEngine::PopState() {
 	// Restore the modelview transformation
 	glMatrixMode(GL_MODELVIEW);
 	glPopMatrix();
+	if (_transform_stack.empty() == false) {
+		_transform = _transform_stack.back();
+		_transform_stack.pop_back();
+	}
 	glViewport(_current_context.viewport.left, _current_context.viewport.top, _current_context.viewport.width, _current_context.viewport.height);
 
 	if (_current_context.scissoring_enabled) {
@@ -688,6 +758,7 @@ void VideoEngine::SetTransform(float matrix[16]) {
 	glMatrixMode(GL_MODELVIEW);
 	glLoadIdentity();
 	glLoadMatrixf(matrix);
+	_transform.Load(matrix);
 }
 
 
@@ -894,6 +965,9 @@ StillImage VideoEngine::CaptureScreen() throw(Exception) {
 
 	StillImage screen_image;
 
+	// The screen must contain every image drawn so far before it is copied
+	_sprite_batch.Flush();
+
 	// TEMP: temporary resolution until capture screen bug is fixed
 // 	return screen_image;
 
@@ -920,6 +994,7 @@ StillImage VideoEngine::CaptureScreen() throw(Exception) {
 		screen_image.Clear();
 		return screen_image;
 	}
+	sheet->dedicated = true;
 	if (sheet->InsertTexture(new_image) == false) {
 		TextureManager->_RemoveSheet(sheet);
 		delete new_image;
@@ -972,44 +1047,9 @@ void VideoEngine::SetGamma(float value) {
 
 
 
-void VideoEngine::MakeScreenshot(const std::string& filename) {
-	private_video::ImageMemory buffer;
-
-	// Retrieve the width and height of the viewport.
-	GLint viewport_dimensions[4]; // viewport_dimensions[2] is the width, [3] is the height
-	glGetIntegerv(GL_VIEWPORT, viewport_dimensions);
-
-	// Buffer to store the image before it is flipped
-	buffer.width = viewport_dimensions[2];
-	buffer.height = viewport_dimensions[3];
-	buffer.pixels = malloc(buffer.width * buffer.height * 3);
-	buffer.rgb_format = true;
-
-	// Read pixel data
-	glReadPixels(0, 0, buffer.width, buffer.height, GL_RGB, GL_UNSIGNED_BYTE, buffer.pixels);
-
-	if (CheckGLError() == true) {
-		IF_PRINT_WARNING(VIDEO_DEBUG) << "an OpenGL error occured: " << CreateGLErrorString() << endl;
-
-		free(buffer.pixels);
-		buffer.pixels = NULL;
-		return;
-	}
-
-	// Vertically flip the image, then swap the flipped and original images
-	void* buffer_temp = malloc(buffer.width * buffer.height * 3);
-	for (int32 i=0; i < buffer.height; ++i) {
-		memcpy((uint8*)buffer_temp + i * buffer.width * 3, (uint8*)buffer.pixels + (buffer.height - i - 1) * buffer.width * 3, buffer.width * 3);
-	}
-	void* temp = buffer.pixels;
-	buffer.pixels = buffer_temp;
-	buffer_temp = temp;
-
-	buffer.SaveImage(filename, false);
-
-	free(buffer_temp);
-	free(buffer.pixels);
-	buffer.pixels = NULL;
+void VideoEngine::MakeScreenshot(const std::string& filename, ScreenCaptureCallback callback, void* callback_data) {
+	// The screen is read at the end of the frame and written to the file on the screen capture thread
+	_screen_capture.RequestCapture(filename, callback, callback_data);
 }
 
 //-----------------------------------------------------------------------------
@@ -1204,8 +1244,9 @@ void VideoEngine::_UpdateLightning(uint32 frame_time) {
 
 
 void VideoEngine::_DEBUG_ShowAdvancedStats() {
-	char text[50];
-	sprintf(text, "Switches: %d\nParticles: %d", TextureManager->_debug_num_tex_switches, _particle_manager.GetNumParticles());
+	char text[100];
+	sprintf(text, "Switches: %d\nQuads: %d\nDraw calls: %d\nParticles: %d", TextureManager->_debug_num_tex_switches,
+		_sprite_batch.GetDebugNumQuads(), _sprite_batch.GetDebugNumFlushes(), _particle_manager.GetNumParticles());
 
 	Move(896.0f, 690.0f);
 	TextManager->Draw(text);
@@ -1219,6 +1260,7 @@ void VideoEngine::DrawLine(float x1, float y1, float x2, float y2, float width,
 		x1, y1,
 		x2, y2
 	};
+	_sprite_batch.Flush();
 	glEnable(GL_BLEND);
 	glDisable(GL_TEXTURE_2D);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Normal blending
@@ -1263,6 +1305,7 @@ void VideoEngine::DrawGrid(float x, float y, float x_step, float y_step, const C
 		vertices.push_back(y);
 		num_vertices += 2;
 	}
+	_sprite_batch.Flush();
 	glColor4fv(&c[0]);
 	glDisable(GL_TEXTURE_2D);
 	glEnableClientState(GL_VERTEX_ARRAY);
@@ -66,9 +66,12 @@ extern "C" {
 #include "coord_sys.h"
 #include "fade.h"
 #include "image.h"
+#include "image_decoder.h"
 #include "interpolator.h"
 #include "shake.h"
+#include "screen_capture.h"
 #include "screen_rect.h"
+#include "sprite_batch.h"
 #include "texture_controller.h"
 #include "text.h"
 #include "particle_manager.h"
@@ -222,6 +225,7 @@ class VideoEngine : public hoa_utils::Singleton<VideoEngine> {
 	friend class ImageDescriptor;
 	friend class StillImage;
 	friend class CompositeImage;
+	friend class StaticSpriteBatch;
 	friend class private_video::TextElement;
 	friend class TextImage;
 
@@ -236,6 +240,11 @@ public:
 	//! \brief Delayed setup calls, that require data from the settings file.
 	//@{
 	void SetInitialResolution(int32 width, int32 height);
+
+	//! \brief Sets the size of the texture sheets which hold images of any size. Must be called before FinalizeInitialization().
+	void SetTextureSheetSize(int32 size)
+		{ _temp_texture_sheet_size = size; }
+
 	bool FinalizeInitialization();
 	//@}
 
@@ -464,11 +473,10 @@ public:
 	*** calls (Move/MoveRelative/Scale/Rotate)
 	**/
 	void PushMatrix()
-		{ glPushMatrix(); }
+		{ glPushMatrix(); _transform_stack.push_back(_transform); }
 
 	//! \brief Pops the modelview transformation from the stack
-	void PopMatrix()
-		{ glPopMatrix(); }
+	void PopMatrix();
 
 	/** \brief Saves relevant state of the video engine on to an internal stack
 	*** The contents saved include the modelview transformation and the current
@@ -492,7 +500,7 @@ public:
 	*** prior to using this function.
 	**/
 	void Rotate(float angle)
-		{ glRotatef(angle, 0, 0, 1); }
+		{ glRotatef(angle, 0, 0, 1); _transform.Rotate(angle); }
 
 	/** \brief Scales all subsequent image drawing calls in the horizontal and vertical direction
 	*** \param x The amount of horizontal scaling to perform (0.5 for half, 1.0 for normal, 2.0 for double, etc)
@@ -501,7 +509,7 @@ public:
 	*** prior to using this function.
 	**/
 	void Scale(float x, float y)
-		{ glScalef(x, y, 1.0f); }
+		{ glScalef(x, y, 1.0f); _transform.Scale(x, y); }
 
 	/** \brief Sets the OpenGL transform to the contents of 4x4 matrix
 	*** \param matrix A pointer to an array of 16 float values that form a 4x4 transformation matrix
@@ -687,11 +695,26 @@ public:
 	**/
 	ParticleEffectID AddParticleEffect(const std::string &filename, float x, float y, bool reload = false);
 
+	/** \brief Updates all active particle effects
+	*** \param frame_time The number of milliseconds to update the effects by
+	*** \return True if all effects were updated successfully
+	*** \note Display() already does this every frame. This is only needed by code that runs outside of the game loop, such as benchmarks.
+	**/
+	bool UpdateParticleEffects(uint32 frame_time);
+
 	/** \brief draws all active particle effects
 	 * \return success/failure
 	 */
 	bool DrawParticleEffects();
 
+	/** \brief Sets the number of threads used to update particle effects
+	*** \param num_threads The number of threads, including the main thread. Zero picks a number based on the number of CPU cores.
+	**/
+	void SetParticleUpdateThreads(uint32 num_threads);
+
+	//! \brief Returns the number of threads used to update particle effects
+	uint32 GetParticleUpdateThreads() const;
+
 	/** \brief stops all active particle effects
 	 *  \param kill_immediate  If this is true, then the particle effects die out immediately
 	 *                         If it is false, then they don't immediately die, but new particles
@@ -773,8 +796,39 @@ public:
 
 	/** \brief Takes a screenshot and saves the image to a file
 	*** \param filename The name of the file, if any, to save the screenshot as. Default is "screenshot.jpg"
+	*** \param callback An optional function to call once the file has been written
+	*** \param callback_data The pointer to pass to the callback
+	***
+	*** The screenshot is of the next frame to be drawn, and the file is written by a worker thread
+	*** some time after that. Call FinishScreenCaptures() if the file is needed right away.
+	**/
+	void MakeScreenshot(const std::string& filename = "screenshot.jpg", ScreenCaptureCallback callback = NULL,
+		void* callback_data = NULL);
+
+	/** \brief Begins saving every frame drawn to a numbered series of image files
+	*** \param filename_prefix The path and beginning of each filename, to which a six digit frame number and the extension are appended
+	*** \param frame_interval The number of frames drawn for every frame saved. A value of one saves every frame.
+	*** \param png_images True to save PNG images, false to save JPEG images
+	*** \return False if a capture sequence is already in progress
+	***
+	*** This is used to record the game for performance and regression comparisons. Frames are dropped
+	*** instead of stalling the game if they can not be written as quickly as they are drawn.
 	**/
-	void MakeScreenshot(const std::string& filename = "screenshot.jpg");
+	bool StartCaptureSequence(const std::string& filename_prefix, uint32 frame_interval = 1, bool png_images = false)
+		{ return _screen_capture.StartSequence(filename_prefix, frame_interval, png_images); }
+
+	/** \brief Stops saving the frames of the current capture sequence
+	*** \return The number of frames that were captured for the sequence
+	**/
+	uint32 StopCaptureSequence()
+		{ return _screen_capture.StopSequence(); }
+
+	bool IsCapturingSequence() const
+		{ return _screen_capture.IsCapturingSequence(); }
+
+	//! \brief Blocks until every screenshot and sequence frame requested so far has been written to its file
+	void FinishScreenCaptures()
+		{ _screen_capture.Finish(); }
 
 	/** \brief toggles advanced information display for video engine, shows
 	 *         things like number of texture switches per frame, etc.
@@ -926,6 +980,18 @@ private:
 	//! particle manager, does dirty work of managing particle effects
 	private_video::ParticleManager _particle_manager;
 
+	//! \brief Collects the quads of all image draw calls so that they can be submitted to OpenGL together
+	private_video::SpriteBatch _sprite_batch;
+
+	//! \brief A copy of the modelview transformation, kept in sync with OpenGL so that it never needs to be queried
+	private_video::BatchTransform _transform;
+
+	//! \brief The transformations saved by PushMatrix() and PushState()
+	std::vector<private_video::BatchTransform> _transform_stack;
+
+	//! \brief Reads the screen for screenshots and capture sequences and writes them out on a worker thread
+	private_video::ScreenCapture _screen_capture;
+
 	// changing the video settings does not actually do anything until
 	// you call ApplySettings(). Up til that point, store them in temp
 	// variables so if the new settings are invalid, we can roll back.
@@ -939,6 +1005,9 @@ private:
 	//! holds the desired screen height. Not actually applied until ApplySettings() is called
 	int32 _temp_height;
 
+	//! holds the desired size of variable texture sheets. Applied when the texture controller is created in FinalizeInitialization()
+	int32 _temp_texture_sheet_size;
+
 	//! image which is to be used as the cursor
 	StillImage _default_menu_cursor;
 
@@ -1024,7 +1093,8 @@ private:
 	void _DrawLightning();
 
 	/** \brief Shows graphical statistics useful for performance tweaking
-	*** This includes, for instance, the number of texture switches made during a frame.
+	*** This includes, for instance, the number of texture switches made during a frame and the
+	*** number of quads drawn compared to the number of draw calls that the sprite batch needed for them.
 	**/
 	void _DEBUG_ShowAdvancedStats();
 }; // class VideoEngine : public hoa_utils::Singleton<VideoEngine>
@@ -50,6 +50,7 @@
 #include "gui.h"
 
 #include "boot.h"
+#include "map.h"
 #include "test.h"
 #include "main_options.h"
 
@@ -88,6 +89,9 @@ void QuitAllacrost() {
 	// Delete the mode manager first so that all game modes free their resources
 	ModeEngine::SingletonDestroy();
 
+	// Map preloads are kept between map modes, so they must be freed separately before the engine components they use
+	hoa_map::MapMode::ClearPreloads();
+
 	// Delete the global manager second to remove all object references corresponding to other engine subsystems
 	GameGlobal::SingletonDestroy();
 
@@ -182,6 +186,9 @@ bool LoadSettings()
 	int32 resy = settings.ReadInt("screen_resy");
 	VideoManager->SetInitialResolution(resx, resy);
 	VideoManager->SetFullscreen(fullscreen);
+	// This is a hidden setting that is not available in the in-game options menu
+	if (settings.DoesIntExist("texture_sheet_size"))
+		VideoManager->SetTextureSheetSize(static_cast<int32>(settings.ReadInt("texture_sheet_size")));
 	settings.CloseTable();
 
 	if (settings.IsErrorDetected()) {
@@ -244,6 +251,8 @@ void InitializeEngine() throw (Exception) {
 	if (ScriptManager->SingletonInitialize() == false) {
 		throw Exception("ERROR: unable to initialize ScriptManager", __FILE__, __LINE__, __FUNCTION__);
 	}
+	// Tileset definitions are pure data kept within their tablespaces, and are opened every time that a map loads
+	ScriptManager->EnableEnvironmentReuse("lua/data/tilesets/");
 
 	// Bind the C++ interfaces to Lua
 	hoa_defs::BindEngineCode();
@@ -29,9 +29,11 @@
 
 // Local map mode headers
 #include "map.h"
+#include "map_data.h"
 #include "map_dialogue.h"
 #include "map_events.h"
 #include "map_objects.h"
+#include "map_preload.h"
 #include "map_sprites.h"
 #include "map_tiles.h"
 #include "map_treasure.h"
@@ -56,6 +58,7 @@ namespace hoa_map {
 
 // Initialize static class variables
 MapMode* MapMode::_current_instance = NULL;
+vector<MapPreload*> MapMode::_preloads;
 
 // The maximum value of the run stamina bar
 const uint32 RUN_STAMINA_MAX = 10000;
@@ -137,7 +140,7 @@ MapMode::MapMode(string script_filename) :
 
 	_context_transition_timer.Initialize(DEFAULT_CONTEXT_TRANSITION_TIME, 0);
 
-	// TODO: Load the map files in a seperate thread
+	// Any work that can be done off of the main thread is done ahead of time by a map preload, if one was requested
 	_LoadMapFiles();
 
 	// Load miscellaneous map graphics
@@ -221,10 +224,10 @@ void MapMode::Update() {
 		return;
 	}
 
-	// ---------- (1) Update all animated tile images
+	// ---------- (1) Update all animated tile images and advance any maps being preloaded
 	_tile_supervisor->Update();
+	_UpdatePreloads();
 	_object_supervisor->Update();
-	_object_supervisor->SortObjectLayers();
 
 	// ---------- (2) Update the active state of the map
 	switch (CurrentState()) {
@@ -272,6 +275,8 @@ void MapMode::Update() {
 
 void MapMode::Draw() {
 	_CalculateMapFrame();
+	// Sorting immediately before drawing ensures that objects moved by events or scripts after the update are culled correctly
+	_object_supervisor->SortObjectLayers();
 
 	if (_draw_function)
 		ScriptCallFunction<void>(_draw_function);
@@ -356,6 +361,44 @@ void MapMode::PlayMusic(uint32 track_num) {
 
 
 
+void MapMode::PreloadMap(const string& filename) {
+	if (filename == _script_filename)
+		return;
+
+	// Move an existing preload for the map to the front, or create a new one there
+	MapPreload* preload = NULL;
+	for (vector<MapPreload*>::iterator i = _preloads.begin(); i != _preloads.end(); i++) {
+		if ((*i)->GetScriptFilename() == filename) {
+			preload = *i;
+			_preloads.erase(i);
+			break;
+		}
+	}
+
+	if (preload == NULL) {
+		if (_preloads.size() >= MAX_MAP_PRELOADS) {
+			IF_PRINT_DEBUG(MAP_DEBUG) << "discarding the preload of map: " << _preloads.back()->GetScriptFilename() << endl;
+			delete _preloads.back();
+			_preloads.pop_back();
+		}
+		preload = new MapPreload(filename);
+	}
+
+	_preloads.insert(_preloads.begin(), preload);
+}
+
+
+
+void MapMode::ClearPreloads() {
+	// The MapPreload destructor waits for its thread to finish before freeing anything
+	for (uint32 i = 0; i < _preloads.size(); i++) {
+		delete _preloads[i];
+	}
+	_preloads.clear();
+}
+
+
+
 void MapMode::SetCamera(VirtualSprite* sprite, uint32 duration) {
 	if (_camera == sprite) {
 		IF_PRINT_WARNING(MAP_DEBUG) << "Camera was moved to the same sprite" << endl;
@@ -499,19 +542,51 @@ void MapMode::_LoadMapFiles() {
 	_map_script.OpenTable(_script_tablespace);
 	_data_filename = _map_script.ReadString("data_file");
 
-	// ---------- (2) Open the map data file and load its contents into the appropriate supervisor classes
-	ReadScriptDescriptor map_data;
-	if (map_data.OpenFile(_data_filename) == false) {
-		PRINT_ERROR << "failed to open map data file: " << _data_filename << endl;
-		return;
+	// ---------- (2) Load the map data and pass its contents to the appropriate supervisor classes
+	// If this map was preloaded, its data has already been read. Every other preload was requested for a map that is
+	// no longer a neighbor, so they are discarded. This must happen before the tiles are loaded so that the images
+	// they queued for decoding are not mistaken for those of this map.
+	MapPreload* preload = NULL;
+	for (uint32 i = 0; i < _preloads.size(); i++) {
+		if (preload == NULL && _preloads[i]->GetScriptFilename() == _script_filename)
+			preload = _preloads[i];
+		else
+			delete _preloads[i];
+	}
+	_preloads.clear();
+
+	// The compiled form of the data file is used when one is available. Otherwise the Lua data file is read and then
+	// compiled so that the next load of this map can skip parsing it.
+	MapData loaded_data;
+	const MapData* map_data = (preload != NULL) ? preload->GetMapData() : NULL;
+	if (map_data == NULL) {
+		if (loaded_data.LoadCompiled(_data_filename) == false) {
+			ReadScriptDescriptor data_file;
+			if (data_file.OpenFile(_data_filename) == false) {
+				PRINT_ERROR << "failed to open map data file: " << _data_filename << endl;
+				delete preload;
+				return;
+			}
+
+			data_file.OpenTable(DetermineLuaFileTablespaceName(_data_filename));
+			bool data_loaded = loaded_data.LoadScript(data_file);
+			data_file.CloseAllTables();
+			data_file.CloseFile();
+			if (data_loaded == false) {
+				PRINT_ERROR << "failed to load map data file: " << _data_filename << endl;
+				delete preload;
+				return;
+			}
+			loaded_data.Compile();
+		}
+		map_data = &loaded_data;
 	}
 
-	map_data.OpenTable(DetermineLuaFileTablespaceName(_data_filename));
-	_num_map_contexts = map_data.ReadUInt("number_map_contexts");
-	_tile_supervisor->Load(map_data, this);
-	_object_supervisor->Load(map_data);
-	map_data.CloseAllTables();
-	map_data.CloseFile();
+	_num_map_contexts = map_data->context_count;
+	_tile_supervisor->Load(*map_data, this);
+	_object_supervisor->Load(*map_data);
+	// Deleting the preload frees the map data along with any of its decoded images that the tiles did not use
+	delete preload;
 
 	// ---------- (3) Load all necessary content from the map script file
 	// Read the map's location graphic and name
@@ -583,6 +658,19 @@ void MapMode::_LoadMapFiles() {
 
 
 
+void MapMode::_UpdatePreloads() {
+	// Only one step of one preload is performed per update so that preloading never takes a noticeable amount of time
+	for (uint32 i = 0; i < _preloads.size(); i++) {
+		MAP_PRELOAD_STATE state = _preloads[i]->GetState();
+		if (state != PRELOAD_COMPLETE && state != PRELOAD_FAILED) {
+			_preloads[i]->Update();
+			return;
+		}
+	}
+}
+
+
+
 bool MapMode::_IsContextTransitionValid(MAP_CONTEXT new_context) {
 	if (new_context == MAP_CONTEXT_NONE) {
 		IF_PRINT_WARNING(MAP_DEBUG) << "received a context argument with no value" << endl;
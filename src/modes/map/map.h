@@ -142,6 +142,22 @@ public:
 
 	void PlayMusic(uint32 track_num);
 
+	/** \brief Begins loading another map in the background so that transitioning to it is faster
+	*** \param filename The name of the script file of the map to preload
+	***
+	*** Map scripts call this for the maps that the player may enter next, such as the maps on the other side of
+	*** each exit. The preload proceeds a little at a time as this map updates and is used when a map with the same
+	*** script filename is constructed. The most recently requested map is preloaded first. Preloads that are not
+	*** used are discarded when the next map is loaded.
+	**/
+	void PreloadMap(const std::string& filename);
+
+	/** \brief Waits for and deletes every map preload
+	*** This must be called before the engine shuts down, because the preloads hold open files, image data decoded
+	*** for the video engine, and possibly a running thread, which would otherwise outlive the engine components.
+	**/
+	static void ClearPreloads();
+
 	/** \brief A convenience function for moving the virtual focus sprite to a new position
 	*** \param x The x coordinator to move to
 	*** \param y The y coordinator to move to
@@ -316,6 +332,11 @@ private:
 	**/
 	static MapMode* _current_instance;
 
+	/** \brief The maps that are being preloaded for a later transition
+	*** This is shared by all instances so that the preloads requested by one map are available to the next map constructed.
+	**/
+	static std::vector<private_map::MapPreload*> _preloads;
+
 	//! \brief The name of the Lua file that holds the map data
 	std::string _data_filename;
 
@@ -501,6 +522,9 @@ private:
 	//! \brief Opens both the map data and script files and loads all necessary data from them
 	void _LoadMapFiles();
 
+	//! \brief Advances the first map preload that has not yet finished its work
+	void _UpdatePreloads();
+
 	/** \brief Checks if the map can begin transitioning to a new context
 	*** \param new_context The context to change to
 	*** \return True if the transition is okay to proceed. False if the context argument is invalid or
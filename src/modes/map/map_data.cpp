@@ -0,0 +1,391 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2015 by The Allacrost Project
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    map_data.cpp
+*** \author  Tyler Olsen, roots@allacrost.org
+*** \brief   Source file for loading and compiling map data files
+*** ***************************************************************************/
+
+#include <cstdio>
+#include <sys/stat.h>
+
+// Allacrost engines
+#include "script.h"
+
+// Local map mode headers
+#include "map_data.h"
+#include "map_utils.h"
+
+using namespace std;
+using namespace hoa_utils;
+using namespace hoa_script;
+
+namespace hoa_map {
+
+namespace private_map {
+
+//! \brief The string which begins every compiled map data file
+static const char MAP_DATA_MAGIC[8] = { 'H', 'O', 'A', 'M', 'A', 'P', 'D', 'T' };
+
+//! \brief Reads a single value from a mapped compiled file, advancing the offset. Returns false if the read would pass the end of the file.
+static bool ReadMapDataValue(const uint8* data, uint32 size, uint32& offset, uint32& value) {
+	if (offset + sizeof(uint32) > size)
+		return false;
+
+	memcpy(&value, data + offset, sizeof(uint32));
+	offset += sizeof(uint32);
+	return true;
+}
+
+//! \brief Reads a length-prefixed string from a mapped compiled file, advancing the offset
+static bool ReadMapDataString(const uint8* data, uint32 size, uint32& offset, string& value) {
+	uint32 length;
+	if (ReadMapDataValue(data, size, offset, length) == false || length > size - offset)
+		return false;
+
+	value.assign(reinterpret_cast<const char*>(data + offset), length);
+	offset += length;
+	return true;
+}
+
+//! \brief Writes a single value to a compiled file
+static bool WriteMapDataValue(FILE* file, uint32 value) {
+	return fwrite(&value, sizeof(uint32), 1, file) == 1;
+}
+
+//! \brief Writes a length-prefixed string to a compiled file
+static bool WriteMapDataString(FILE* file, const string& value) {
+	if (WriteMapDataValue(file, value.length()) == false)
+		return false;
+	return value.empty() || fwrite(value.data(), value.length(), 1, file) == 1;
+}
+
+
+
+MapData::MapData() :
+	row_count(0),
+	column_count(0),
+	tileset_count(0),
+	tile_layer_count(0),
+	context_count(0),
+	collision_row_count(0),
+	collision_column_count(0),
+	collision_grid(NULL),
+	tiles(NULL),
+	_mapped_data(NULL),
+	_mapped_size(0)
+{}
+
+
+
+MapData::~MapData() {
+	_Clear();
+}
+
+
+
+bool MapData::LoadCompiled(const string& data_filename, const string& compiled_filename) {
+	_Clear();
+
+	if (MapFileIntoMemory(compiled_filename, _mapped_data, _mapped_size) == false)
+		return false;
+
+	const uint8* data = _mapped_data;
+	uint32 size = _mapped_size;
+
+	// ---------- (1) Validate the header and make sure that the compiled file is up to date with its source
+	if (size < sizeof(MAP_DATA_MAGIC) || memcmp(data, MAP_DATA_MAGIC, sizeof(MAP_DATA_MAGIC)) != 0) {
+		_Clear();
+		return false;
+	}
+
+	uint32 offset = sizeof(MAP_DATA_MAGIC);
+	uint32 version, source_size, source_time, current_size, current_time, data_offset;
+	string source_filename;
+
+	bool valid = ReadMapDataValue(data, size, offset, version) == true && version == MAP_DATA_VERSION;
+	valid = valid && ReadMapDataString(data, size, offset, source_filename) == true && source_filename == data_filename;
+	valid = valid && ReadMapDataValue(data, size, offset, source_size) == true;
+	valid = valid && ReadMapDataValue(data, size, offset, source_time) == true;
+	valid = valid && _GetSourceInfo(data_filename, current_size, current_time) == true;
+	valid = valid && current_size == source_size && current_time == source_time;
+
+	valid = valid && ReadMapDataValue(data, size, offset, row_count) == true;
+	valid = valid && ReadMapDataValue(data, size, offset, column_count) == true;
+	valid = valid && ReadMapDataValue(data, size, offset, tileset_count) == true;
+	valid = valid && ReadMapDataValue(data, size, offset, tile_layer_count) == true;
+	valid = valid && ReadMapDataValue(data, size, offset, context_count) == true;
+	valid = valid && ReadMapDataValue(data, size, offset, collision_row_count) == true;
+	valid = valid && ReadMapDataValue(data, size, offset, collision_column_count) == true;
+	valid = valid && ReadMapDataValue(data, size, offset, data_offset) == true;
+
+	// ---------- (2) Read the tileset list and context inheritance
+	for (uint32 i = 0; i < tileset_count && valid == true; i++) {
+		tileset_filenames.push_back(string());
+		valid = ReadMapDataString(data, size, offset, tileset_filenames.back());
+	}
+	for (uint32 i = 0; i < context_count && valid == true; i++) {
+		uint32 inheritance;
+		valid = ReadMapDataValue(data, size, offset, inheritance);
+		context_inheritance.push_back(static_cast<int32>(inheritance));
+	}
+
+	// ---------- (3) Point the collision grid and tiles at the mapped file after making sure it contains all of them
+	// The sizes are checked by division so that a corrupt header can not overflow the calculations
+	valid = valid && row_count > 0 && column_count > 0 && tile_layer_count > 0 && context_count > 0 && context_count <= 32;
+	valid = valid && collision_row_count == row_count * 2 && collision_column_count == column_count * 2;
+	valid = valid && data_offset >= offset && data_offset <= size && data_offset % sizeof(uint32) == 0;
+	valid = valid && (size - data_offset) / sizeof(uint32) / collision_column_count >= collision_row_count;
+	uint32 collision_size = valid ? collision_row_count * collision_column_count * sizeof(uint32) : 0;
+	valid = valid && (size - data_offset - collision_size) / sizeof(int16) / column_count / row_count / context_count >= tile_layer_count;
+
+	if (valid == false) {
+		IF_PRINT_DEBUG(MAP_DEBUG) << "ignoring invalid or out of date compiled map data for file: " << data_filename << endl;
+		_Clear();
+		return false;
+	}
+
+	filename = data_filename;
+	collision_grid = reinterpret_cast<const uint32*>(data + data_offset);
+	tiles = reinterpret_cast<const int16*>(data + data_offset + collision_size);
+	return true;
+} // bool MapData::LoadCompiled(const string& data_filename, const string& compiled_filename)
+
+
+
+bool MapData::LoadScript(ReadScriptDescriptor& map_file) {
+	_Clear();
+
+	// ---------- (1) Load the map properties and do some basic sanity checks
+	filename = map_file.GetFilename();
+	row_count = map_file.ReadUInt("map_height");
+	column_count = map_file.ReadUInt("map_length");
+	tileset_count = map_file.ReadUInt("number_tilesets");
+	tile_layer_count = map_file.ReadUInt("number_tile_layers");
+	context_count = map_file.ReadUInt("number_map_contexts");
+	collision_row_count = row_count * 2;
+	collision_column_count = column_count * 2;
+
+	if (row_count == 0 || column_count == 0 || tile_layer_count == 0 || context_count == 0 || context_count > 32) {
+		PRINT_ERROR << "the map dimensions, number of tile layers, or number of contexts are invalid" << endl;
+		return false;
+	}
+
+	if (map_file.GetTableSize("tileset_filenames") != tileset_count) {
+		PRINT_ERROR << "the number of tilesets declared does not match the size of the tileset_filenames table" << endl;
+		return false;
+	}
+
+	if (map_file.GetTableSize("tile_layer_names") != tile_layer_count) {
+		PRINT_ERROR << "the number of tile layers declared does not match the size of the tile_layer_names table" << endl;
+		return false;
+	}
+
+	if (map_file.GetTableSize("map_context_inheritance") != context_count) {
+		PRINT_ERROR << "the number of map contexts declared does not match the size of the map_context_inheritance table" << endl;
+		return false;
+	}
+
+	if (map_file.GetTableSize("collision_grid") != collision_row_count) {
+		PRINT_ERROR << "the collision_grid table size is incorrect" << endl;
+		return false;
+	}
+
+	if (map_file.GetTableSize("map_tiles") != row_count) {
+		PRINT_ERROR << "the map_tiles table size was not equal to the number of tile rows specified by the map" << endl;
+		return false;
+	}
+
+	map_file.ReadStringVector("tileset_filenames", tileset_filenames);
+	map_file.ReadIntVector("map_context_inheritance", context_inheritance);
+
+	// ---------- (2) Read the collision grid into a single row-major array
+	_collision_storage.resize(collision_row_count * collision_column_count);
+	map_file.OpenTable("collision_grid");
+	for (uint32 r = 0; r < collision_row_count; ++r) {
+		if (map_file.ReadUIntArray(r, &_collision_storage[r * collision_column_count], collision_column_count) == false) {
+			PRINT_ERROR << "the collision_grid row " << r << " does not have the expected number of columns" << endl;
+			map_file.CloseTable();
+			return false;
+		}
+	}
+	map_file.CloseTable();
+
+	// ---------- (3) Read the tile data of every context and layer
+	// Each entry in the map_tiles table holds the tiles of every context and layer at a single row and column, so the
+	// tiles are scattered into the [context][layer][row][column] layout as they are read.
+	uint32 layer_size = row_count * column_count;
+	_tile_storage.assign(context_count * tile_layer_count * layer_size, UNREFERENCED_TILE);
+	vector<int32> tile_data(context_count * tile_layer_count);
+	map_file.OpenTable("map_tiles");
+	for (uint32 y = 0; y < row_count; ++y) {
+		map_file.OpenTable(y);
+		for (uint32 x = 0; x < column_count; ++x) {
+			if (map_file.ReadIntArray(x, &tile_data[0], tile_data.size()) == false) {
+				PRINT_ERROR << "the map_tiles entry at row " << y << " and column " << x << " does not hold one tile for every context and layer" << endl;
+				map_file.CloseTable();
+				map_file.CloseTable();
+				return false;
+			}
+
+			uint32 tile_index = y * column_count + x;
+			for (uint32 i = 0; i < context_count * tile_layer_count; ++i, tile_index += layer_size) {
+				_tile_storage[tile_index] = static_cast<int16>(tile_data[i]);
+			}
+		}
+		map_file.CloseTable();
+	}
+	map_file.CloseTable();
+
+	if (map_file.IsErrorDetected() == true) {
+		PRINT_ERROR << "errors occurred while reading the map data file: " << filename << endl << map_file.GetErrorMessages() << endl;
+		return false;
+	}
+
+	collision_grid = &_collision_storage[0];
+	tiles = &_tile_storage[0];
+	return true;
+} // bool MapData::LoadScript(ReadScriptDescriptor& map_file)
+
+
+
+bool MapData::Compile() {
+	if (collision_grid == NULL || tiles == NULL) {
+		IF_PRINT_WARNING(MAP_DEBUG) << "no map data was loaded to compile" << endl;
+		return false;
+	}
+
+	uint32 source_size, source_time;
+	if (_GetSourceInfo(filename, source_size, source_time) == false)
+		return false;
+
+	string compiled_filename = GetCompiledFilename(filename);
+	if (compiled_filename.empty() == true)
+		return false;
+
+	// Write to a temporary file first so that an interrupted write never leaves behind a partial compiled file
+	string temp_filename = compiled_filename + ".tmp";
+	FILE* file = fopen(temp_filename.c_str(), "wb");
+	if (file == NULL) {
+		IF_PRINT_WARNING(MAP_DEBUG) << "failed to open compiled map data file for writing: " << temp_filename << endl;
+		return false;
+	}
+
+	// The size of the header, tileset list, and context inheritance must be known to record the offset of the collision grid
+	uint32 data_offset = sizeof(MAP_DATA_MAGIC) + 12 * sizeof(uint32) + filename.length();
+	for (uint32 i = 0; i < tileset_filenames.size(); i++) {
+		data_offset += sizeof(uint32) + tileset_filenames[i].length();
+	}
+	data_offset += context_count * sizeof(uint32);
+	// Align the arrays so that they can be read in place when the file is mapped
+	uint32 padding = (4 - (data_offset % 4)) % 4;
+	data_offset += padding;
+
+	bool success = fwrite(MAP_DATA_MAGIC, sizeof(MAP_DATA_MAGIC), 1, file) == 1;
+	success = success && WriteMapDataValue(file, MAP_DATA_VERSION);
+	success = success && WriteMapDataString(file, filename);
+	success = success && WriteMapDataValue(file, source_size);
+	success = success && WriteMapDataValue(file, source_time);
+	success = success && WriteMapDataValue(file, row_count);
+	success = success && WriteMapDataValue(file, column_count);
+	success = success && WriteMapDataValue(file, tileset_count);
+	success = success && WriteMapDataValue(file, tile_layer_count);
+	success = success && WriteMapDataValue(file, context_count);
+	success = success && WriteMapDataValue(file, collision_row_count);
+	success = success && WriteMapDataValue(file, collision_column_count);
+	success = success && WriteMapDataValue(file, data_offset);
+
+	for (uint32 i = 0; i < tileset_filenames.size() && success == true; i++) {
+		success = WriteMapDataString(file, tileset_filenames[i]);
+	}
+	for (uint32 i = 0; i < context_count && success == true; i++) {
+		success = WriteMapDataValue(file, static_cast<uint32>(context_inheritance[i]));
+	}
+
+	const uint8 zeros[4] = { 0, 0, 0, 0 };
+	if (success == true && padding > 0)
+		success = fwrite(zeros, padding, 1, file) == 1;
+
+	uint32 collision_count = collision_row_count * collision_column_count;
+	uint32 tile_count = context_count * tile_layer_count * row_count * column_count;
+	success = success && fwrite(collision_grid, sizeof(uint32), collision_count, file) == collision_count;
+	success = success && fwrite(tiles, sizeof(int16), tile_count, file) == tile_count;
+
+	if (fclose(file) != 0)
+		success = false;
+
+	if (success == false || MoveFile(temp_filename, compiled_filename) == false) {
+		IF_PRINT_WARNING(MAP_DEBUG) << "failed to write compiled map data file: " << compiled_filename << endl;
+		DeleteFile(temp_filename);
+		return false;
+	}
+
+	IF_PRINT_DEBUG(MAP_DEBUG) << "wrote compiled map data file: " << compiled_filename << " for map data: " << filename << endl;
+	return true;
+} // bool MapData::Compile()
+
+
+
+void MapData::_Clear() {
+	UnmapFileFromMemory(_mapped_data, _mapped_size);
+	_mapped_data = NULL;
+	_mapped_size = 0;
+
+	filename.clear();
+	row_count = 0;
+	column_count = 0;
+	tileset_count = 0;
+	tile_layer_count = 0;
+	context_count = 0;
+	collision_row_count = 0;
+	collision_column_count = 0;
+	tileset_filenames.clear();
+	context_inheritance.clear();
+	collision_grid = NULL;
+	tiles = NULL;
+	_collision_storage.clear();
+	_tile_storage.clear();
+}
+
+
+
+string MapData::GetCompiledFilename(const string& data_filename) const {
+	string cache_directory = GetUserDataPath(false) + "cache/";
+	string map_directory = cache_directory + "maps/";
+	if (MakeDirectory(cache_directory) == false || MakeDirectory(map_directory) == false) {
+		IF_PRINT_WARNING(MAP_DEBUG) << "failed to create the compiled map data directory: " << map_directory << endl;
+		return "";
+	}
+
+	// Flatten the path of the data file into a single filename
+	string compiled_name = data_filename;
+	for (uint32 i = 0; i < compiled_name.length(); i++) {
+		if (compiled_name[i] == '/' || compiled_name[i] == '\\' || compiled_name[i] == ':')
+			compiled_name[i] = '_';
+	}
+
+	return map_directory + compiled_name + ".mapdata";
+}
+
+
+
+bool MapData::_GetSourceInfo(const string& data_filename, uint32& size, uint32& modify_time) const {
+	struct stat buf;
+	if (stat(data_filename.c_str(), &buf) != 0)
+		return false;
+
+	size = static_cast<uint32>(buf.st_size);
+	modify_time = static_cast<uint32>(buf.st_mtime);
+	return true;
+}
+
+} // namespace private_map
+
+} // namespace hoa_map
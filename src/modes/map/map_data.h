@@ -0,0 +1,152 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2015 by The Allacrost Project
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    map_data.h
+*** \author  Tyler Olsen, roots@allacrost.org
+*** \brief   Header file for loading and compiling map data files
+***
+*** Map data files are Lua scripts written by the map editor that contain the
+*** tile layers and collision grid of a map. Parsing these scripts one value at a
+*** time is the slowest part of loading a map. The first time that a data file is
+*** loaded it is compiled into a binary file in the user's cache directory, and
+*** later loads map that file into memory and read the tile and collision arrays
+*** directly from it.
+***
+*** Each compiled file has the following layout. All values are unsigned 32-bit
+*** integers in the native byte order of the machine that wrote the file, except
+*** for the tiles which are signed 16-bit integers.
+***
+*** - The header: the magic string "HOAMAPDT", the format version, the name of
+***   the source data file (length then characters), the size and modification
+***   time of the source file, the number of tile rows and columns, tilesets,
+***   tile layers, and map contexts, the number of collision grid rows and
+***   columns, and the file offset of the collision grid.
+*** - The tileset list: the definition filename of each tileset (length then characters).
+*** - The context inheritance: the inherited context of each context, as written in the data file.
+*** - The collision grid: one value for every grid element in row-major order.
+*** - The tile layers: one tile for every context, layer, row, and column, in that order.
+***
+*** \note A compiled file is ignored and rewritten whenever the size or modification
+*** time of its source data file changes, so no separate build step is needed.
+*** ***************************************************************************/
+
+#ifndef __MAP_DATA_HEADER__
+#define __MAP_DATA_HEADER__
+
+// Allacrost utilities
+#include "utils.h"
+#include "defs.h"
+
+namespace hoa_map {
+
+namespace private_map {
+
+//! \brief The version number of the compiled map data format. Files with any other version are ignored.
+const uint32 MAP_DATA_VERSION = 1;
+
+/** ****************************************************************************
+*** \brief The contents of a map data file, loaded either from Lua or from its compiled form
+***
+*** The tile and collision arrays point either into storage owned by this class when
+*** the data was read from the Lua file, or straight into the memory mapped compiled
+*** file. Either way they remain valid only for the lifetime of this object, so the
+*** supervisors copy what they need out of them while the map is loading.
+*** ***************************************************************************/
+class MapData {
+public:
+	MapData();
+
+	~MapData();
+
+	//! \brief The name of the Lua map data file that this data was loaded from
+	std::string filename;
+
+	//! \brief The number of tile rows and columns in the map
+	uint32 row_count, column_count;
+
+	//! \brief The number of tilesets, tile layers, and contexts used by the map
+	uint32 tileset_count, tile_layer_count, context_count;
+
+	//! \brief The number of rows and columns in the collision grid, which are twice the number of tile rows and columns
+	uint32 collision_row_count, collision_column_count;
+
+	//! \brief The definition filename of each tileset
+	std::vector<std::string> tileset_filenames;
+
+	//! \brief The context that each context inherits from, enumerated from 1..n where 0 indicates no inheritance
+	std::vector<int32> context_inheritance;
+
+	//! \brief The collision grid in row-major order, holding collision_row_count * collision_column_count elements
+	const uint32* collision_grid;
+
+	/** \brief The tileset tile indeces of every tile, holding context_count * tile_layer_count * row_count * column_count elements
+	*** The tiles are laid out as [context][layer][row][column], so each context is a contiguous block that matches
+	*** the layout of TileSupervisor::_tile_grid.
+	**/
+	const int16* tiles;
+
+	/** \brief Loads the data from the compiled form of a map data file
+	*** \param data_filename The name of the Lua map data file
+	*** \return False if there is no compiled file or it is invalid or out of date
+	**/
+	bool LoadCompiled(const std::string& data_filename)
+		{ return LoadCompiled(data_filename, GetCompiledFilename(data_filename)); }
+
+	/** \brief Loads the data from a compiled file whose name has already been determined
+	*** \param data_filename The name of the Lua map data file
+	*** \param compiled_filename The name of the compiled file, as returned by GetCompiledFilename()
+	*** \return False if the compiled file does not exist or is invalid or out of date
+	*** \note Unlike the other load methods, this method is safe to call from a thread other than the main thread
+	**/
+	bool LoadCompiled(const std::string& data_filename, const std::string& compiled_filename);
+
+	/** \brief Loads the data from a Lua map data file
+	*** \param map_file A reference to the map data file, which should be open with its tablespace table opened
+	*** \return False if the data in the file was malformed
+	**/
+	bool LoadScript(hoa_script::ReadScriptDescriptor& map_file);
+
+	/** \brief Writes the compiled form of the map data that is currently loaded
+	*** \return True if the compiled file was written
+	**/
+	bool Compile();
+
+	/** \brief Returns the name of the compiled file for a data file, creating the cache directory if necessary
+	*** \return The filename, or an empty string if the cache directory could not be created
+	**/
+	std::string GetCompiledFilename(const std::string& data_filename) const;
+
+private:
+	//! \brief Holds the collision grid when the data was read from the Lua file
+	std::vector<uint32> _collision_storage;
+
+	//! \brief Holds the tiles when the data was read from the Lua file
+	std::vector<int16> _tile_storage;
+
+	//! \brief The contents of the mapped compiled file, or NULL if the data was not loaded from one
+	uint8* _mapped_data;
+
+	//! \brief The size of the mapped compiled file, in bytes
+	uint32 _mapped_size;
+
+	//! \brief Releases the compiled file and clears all data
+	void _Clear();
+
+	/** \brief Retrieves the size and modification time of a data file
+	*** \return False if the file could not be found
+	**/
+	bool _GetSourceInfo(const std::string& data_filename, uint32& size, uint32& modify_time) const;
+}; // class MapData
+
+} // namespace private_map
+
+} // namespace hoa_map
+
+#endif // __MAP_DATA_HEADER__
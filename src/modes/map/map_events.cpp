@@ -299,6 +299,9 @@ void MapTransitionEvent::_Start() {
 	// to perform a manual fade of the screen.
 	VideoManager->FadeScreen(Color::black, _fade_timer.GetDuration());
 
+	// Use the time spent fading out to get a head start on loading the next map, if its script did not already request it
+	MapMode::CurrentInstance()->PreloadMap(_transition_map_filename);
+
 	// TODO: fade out the map music
 }
 
@@ -1224,6 +1227,9 @@ bool CustomSpriteEvent::_Update() {
 
 EventSupervisor::~EventSupervisor() {
 	_active_events.clear();
+	_paused_events.clear();
+	_active_index.clear();
+	_paused_index.clear();
 	_launch_events.clear();
 	_event_history.clear();
 
@@ -1271,7 +1277,7 @@ void EventSupervisor::StartEvent(MapEvent* event) {
 
 	IF_PRINT_DEBUG(MAP_DEBUG) << "Starting event: " << event->GetEventID() << endl;
 
-	_active_events.push_back(event);
+	_AddToList(event, _active_events, _active_index);
 	event->_Start();
 	event->_CommitRecords(); // Commit any records for the event now that it has been started
 	_event_history.emplace(event->GetEventID(), 0);
@@ -1294,7 +1300,7 @@ void EventSupervisor::StartEvent(uint32 event_id, uint32 wait_time) {
 		return;
 	}
 
-	_launch_events.push_back(make_pair(static_cast<int32>(wait_time), event));
+	_ScheduleLaunch(event, wait_time);
 }
 
 
@@ -1311,18 +1317,18 @@ void EventSupervisor::StartEvent(MapEvent* event, uint32 wait_time) {
 		return;
 	}
 
-	_launch_events.push_back(make_pair(static_cast<int32>(wait_time), event));
+	_ScheduleLaunch(event, wait_time);
 }
 
 
 
 void EventSupervisor::PauseEvent(uint32 event_id) {
-	for (list<MapEvent*>::iterator i = _active_events.begin(); i != _active_events.end(); i++) {
-		if ((*i)->_event_id == event_id) {
-			_paused_events.push_back(*i);
-			_active_events.erase(i);
-			return;
-		}
+	unordered_multimap<uint32, list<MapEvent*>::iterator>::iterator i = _active_index.find(event_id);
+	if (i != _active_index.end()) {
+		MapEvent* paused_event = *(i->second);
+		_RemoveFromList(i->second, _active_events, _active_index);
+		_AddToList(paused_event, _paused_events, _paused_index);
+		return;
 	}
 
 	IF_PRINT_WARNING(MAP_DEBUG) << "operation failed because no active event was found corresponding to event id: " << event_id << endl;
@@ -1331,12 +1337,12 @@ void EventSupervisor::PauseEvent(uint32 event_id) {
 
 
 void EventSupervisor::ResumeEvent(uint32 event_id) {
-	for (list<MapEvent*>::iterator i = _paused_events.begin(); i != _paused_events.end(); i++) {
-		if ((*i)->_event_id == event_id) {
-			_active_events.push_back(*i);
-			_paused_events.erase(i);
-			return;
-		}
+	unordered_multimap<uint32, list<MapEvent*>::iterator>::iterator i = _paused_index.find(event_id);
+	if (i != _paused_index.end()) {
+		MapEvent* resumed_event = *(i->second);
+		_RemoveFromList(i->second, _paused_events, _paused_index);
+		_AddToList(resumed_event, _active_events, _active_index);
+		return;
 	}
 
 	IF_PRINT_WARNING(MAP_DEBUG) << "operation failed because no paused event was found corresponding to event id: " << event_id << endl;
@@ -1346,14 +1352,13 @@ void EventSupervisor::ResumeEvent(uint32 event_id) {
 
 void EventSupervisor::TerminateEvent(uint32 event_id) {
 	// TODO: what if the event is in the active queue in more than one location?
-	for (list<MapEvent*>::iterator i = _active_events.begin(); i != _active_events.end(); i++) {
-		if ((*i)->_event_id == event_id) {
-			MapEvent* terminated_event = *i;
-			i = _active_events.erase(i);
-			// We examine the event links only after the event has been removed from the active list
-			_ExamineEventLinks(terminated_event, false);
-			return;
-		}
+	unordered_multimap<uint32, list<MapEvent*>::iterator>::iterator i = _active_index.find(event_id);
+	if (i != _active_index.end()) {
+		MapEvent* terminated_event = *(i->second);
+		_RemoveFromList(i->second, _active_events, _active_index);
+		// We examine the event links only after the event has been removed from the active list
+		_ExamineEventLinks(terminated_event, false);
+		return;
 	}
 
 	IF_PRINT_WARNING(MAP_DEBUG) << "attempted to terminate an event that was not active, id: " << event_id << endl;
@@ -1362,25 +1367,21 @@ void EventSupervisor::TerminateEvent(uint32 event_id) {
 
 
 void EventSupervisor::Update() {
-	// Update all launch event timers and start all events whose timers have finished
-	for (list<pair<int32, MapEvent*> >::iterator i = _launch_events.begin(); i != _launch_events.end();) {
-		i->first -= SystemManager->GetUpdateTime();
-
-		if (i->first <= 0) { // Timer has expired
-			MapEvent* start_event = i->second;
-			i = _launch_events.erase(i);
-			// We begin the event only after it has been removed from the launch list
-			StartEvent(start_event);
-		}
-		else
-			++i;
+	// Advance the game time and start all events whose launch time has arrived. Only the events that are due are examined.
+	_current_time += SystemManager->GetUpdateTime();
+	while (_launch_events.empty() == false && _launch_events.front().launch_time <= _current_time) {
+		MapEvent* start_event = _launch_events.front().event;
+		pop_heap(_launch_events.begin(), _launch_events.end());
+		_launch_events.pop_back();
+		// We begin the event only after it has been removed from the launch heap
+		StartEvent(start_event);
 	}
 
 	// Check for active events which have finished
 	for (list<MapEvent*>::iterator i = _active_events.begin(); i != _active_events.end();) {
 		if ((*i)->_Update() == true) {
 			MapEvent* finished_event = *i;
-			i = _active_events.erase(i);
+			i = _RemoveFromList(i, _active_events, _active_index);
 			// We examine the event links only after the event has been removed from the active list
 			_ExamineEventLinks(finished_event, false);
 		}
@@ -1392,12 +1393,7 @@ void EventSupervisor::Update() {
 
 
 bool EventSupervisor::IsEventActive(uint32 event_id) const {
-	for (list<MapEvent*>::const_iterator i = _active_events.begin(); i != _active_events.end(); i++) {
-		if ((*i)->_event_id == event_id) {
-			return true;
-		}
-	}
-	return false;
+	return (_active_index.find(event_id) != _active_index.end());
 }
 
 
@@ -1445,12 +1441,43 @@ void EventSupervisor::_ExamineEventLinks(MapEvent* parent_event, bool event_star
 				continue;
 			}
 			else {
-				_launch_events.push_back(make_pair(static_cast<int32>(link.launch_timer), child));
+				_ScheduleLaunch(child, link.launch_timer);
 			}
 		}
 	}
 }
 
+
+
+void EventSupervisor::_ScheduleLaunch(MapEvent* event, uint32 wait_time) {
+	_launch_events.push_back(EventLaunch(_current_time + wait_time, _launch_count++, event));
+	push_heap(_launch_events.begin(), _launch_events.end());
+}
+
+
+
+void EventSupervisor::_AddToList(MapEvent* event, list<MapEvent*>& events, unordered_multimap<uint32, list<MapEvent*>::iterator>& index) {
+	events.push_back(event);
+	index.insert(make_pair(event->_event_id, --events.end()));
+}
+
+
+
+list<MapEvent*>::iterator EventSupervisor::_RemoveFromList(list<MapEvent*>::iterator entry, list<MapEvent*>& events,
+	unordered_multimap<uint32, list<MapEvent*>::iterator>& index)
+{
+	pair<unordered_multimap<uint32, list<MapEvent*>::iterator>::iterator, unordered_multimap<uint32, list<MapEvent*>::iterator>::iterator>
+		range = index.equal_range((*entry)->_event_id);
+	for (unordered_multimap<uint32, list<MapEvent*>::iterator>::iterator i = range.first; i != range.second; ++i) {
+		if (i->second == entry) {
+			index.erase(i);
+			break;
+		}
+	}
+
+	return events.erase(entry);
+}
+
 } // namespace private_map
 
 } // namespace hoa_map
@@ -24,6 +24,8 @@
 #ifndef __MAP_EVENTS_HEADER__
 #define __MAP_EVENTS_HEADER__
 
+#include <unordered_map>
+
 // Allacrost utilities
 #include "defs.h"
 #include "utils.h"
@@ -1111,6 +1113,34 @@ protected:
 }; // class CustomSpriteEvent : public SpriteEvent
 
 
+/** ****************************************************************************
+*** \brief An event that is waiting to be launched by the EventSupervisor
+***
+*** The comparison operator orders launches so that the std heap functions keep the
+*** launch that is due first on the top of the heap.
+*** ***************************************************************************/
+class EventLaunch {
+public:
+	EventLaunch(uint32 time, uint32 order, MapEvent* e) :
+		launch_time(time), launch_order(order), event(e) {}
+
+	//! \brief The game time, in milliseconds, at which the event should be started
+	uint32 launch_time;
+
+	//! \brief Ensures that events launching at the same time are started in the order that they were scheduled
+	uint32 launch_order;
+
+	//! \brief A pointer to the event to start
+	MapEvent* event;
+
+	bool operator<(const EventLaunch& that) const {
+		if (launch_time != that.launch_time)
+			return launch_time > that.launch_time;
+		return launch_order > that.launch_order;
+	}
+}; // class EventLaunch
+
+
 /** ****************************************************************************
 *** \brief Manages, processes, and launches map events
 ***
@@ -1129,7 +1159,10 @@ protected:
 *** the base event. If they are to start a certain time after the start of the parent
 *** event, they are placed in a container and their countdown timers are initialized.
 *** These timers will count down on every update call to the event manager and after
-*** the timers expire, these events will be launched. When an active event ends, again
+*** the timers expire, these events will be launched. Rather than counting every timer
+*** down each update, the supervisor records the game time at which each waiting event
+*** should launch and keeps them in a heap ordered by that time, so an update only has
+*** to look at the events that are due. When an active event ends, again
 *** its event links are examined to determine if any children events exist that start
 *** relative to the end of the parent event.
 ***
@@ -1146,8 +1179,8 @@ protected:
 *** ***************************************************************************/
 class EventSupervisor {
 public:
-	EventSupervisor()
-		{}
+	EventSupervisor() :
+		_current_time(0), _launch_count(0) {}
 
 	~EventSupervisor();
 
@@ -1246,14 +1279,27 @@ private:
 	//! \brief A list of all events which have started but are not yet finished
 	std::list<MapEvent*> _active_events;
 
-	/** \brief A list of all events that are waiting on their launch timers to expire before being started
-	*** The interger part of this std::pair is the countdown timer for this event to be launched
-	**/
-	std::list<std::pair<int32, MapEvent*> > _launch_events;
-
 	//! \brief A list of all events which have been paused
 	std::list<MapEvent*> _paused_events;
 
+	/** \brief Locates the entries of _active_events and _paused_events by event ID
+	*** An event may be started again while it is already active, so an ID may have several entries.
+	*** These indices must be kept up to date by every function that adds or removes list entries.
+	**/
+	std::unordered_multimap<uint32, std::list<MapEvent*>::iterator> _active_index, _paused_index;
+
+	/** \brief All events that are waiting for their launch time to arrive before being started
+	*** This is kept as a heap with the next event to launch on top. The events that launch at the same
+	*** time are launched in the order that they were scheduled.
+	**/
+	std::vector<EventLaunch> _launch_events;
+
+	//! \brief The number of milliseconds of game time that this supervisor has been updated for
+	uint32 _current_time;
+
+	//! \brief The number of launches that have been scheduled, used to order launches scheduled for the same time
+	uint32 _launch_count;
+
 	/** \brief Maintains a history of how many times each event has been started
 	*** The first integer is the event ID and the second is how many times that event has been started.
 	*** It does not track how many times the event has completed or been terminated.
@@ -1265,6 +1311,21 @@ private:
 	*** \param event_start The event has just started if this member is true, or if it just finished it will be false
 	**/
 	void _ExamineEventLinks(MapEvent* parent_event, bool event_start);
+
+	/** \brief Schedules an event to be started once a wait period expires
+	*** \param event A pointer to the event to start
+	*** \param wait_time The number of milliseconds of game time to wait before starting the event
+	**/
+	void _ScheduleLaunch(MapEvent* event, uint32 wait_time);
+
+	//! \brief Adds an event to the end of a list of events and to the index for that list
+	void _AddToList(MapEvent* event, std::list<MapEvent*>& events, std::unordered_multimap<uint32, std::list<MapEvent*>::iterator>& index);
+
+	/** \brief Removes an entry from a list of events and from the index for that list
+	*** \return An iterator to the list entry that followed the removed entry
+	**/
+	std::list<MapEvent*>::iterator _RemoveFromList(std::list<MapEvent*>::iterator entry, std::list<MapEvent*>& events,
+		std::unordered_multimap<uint32, std::list<MapEvent*>::iterator>& index);
 }; // class EventSupervisor
 
 } // namespace private_map
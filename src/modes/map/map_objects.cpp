@@ -27,6 +27,7 @@
 
 // Local map mode headers
 #include "map.h"
+#include "map_data.h"
 #include "map_dialogue.h"
 #include "map_objects.h"
 #include "map_sprites.h"
@@ -62,7 +63,13 @@ MapObject::MapObject() :
 	updatable(true),
 	visible(true),
 	collidable(true),
-	_object_layer_id(DEFAULT_LAYER_ID)
+	_object_layer_id(DEFAULT_LAYER_ID),
+	_grid_context(MAP_CONTEXT_NONE),
+	_grid_left(0),
+	_grid_right(0),
+	_grid_top(0),
+	_grid_bottom(0),
+	_grid_search(0)
 {}
 
 
@@ -294,9 +301,37 @@ void ObjectLayer::Update() {
 
 
 void ObjectLayer::Draw(MAP_CONTEXT context) const {
-	for (uint32 i = 0; i < _objects.size(); ++i) {
-		if (_objects[i]->context == context)
-			_objects[i]->Draw();
+	const MapRectangle& screen = MapMode::CurrentInstance()->GetMapFrame().screen_edges;
+
+	// Find the first object whose image does not lie entirely above the screen
+	uint32 first = 0;
+	uint32 last = _objects.size();
+	while (first < last) {
+		uint32 middle = first + (last - first) / 2;
+		if (static_cast<float>(_objects[middle]->y_position) + _objects[middle]->y_offset < screen.top)
+			first = middle + 1;
+		else
+			last = middle;
+	}
+
+	// Past this height, even the tallest object on the layer would lie entirely below the screen
+	const float bottom_limit = screen.bottom + _max_image_height;
+	for (uint32 i = first; i < _objects.size(); ++i) {
+		MapObject* object = _objects[i];
+		float y_pos = static_cast<float>(object->y_position) + object->y_offset;
+		if (y_pos > bottom_limit)
+			break;
+
+		if (object->context != context)
+			continue;
+
+		float x_pos = static_cast<float>(object->x_position) + object->x_offset;
+		if (x_pos + object->img_half_width < screen.left || x_pos - object->img_half_width > screen.right)
+			continue;
+		if (y_pos - object->img_height > screen.bottom)
+			continue;
+
+		object->Draw();
 	}
 }
 
@@ -334,6 +369,285 @@ void ObjectLayer::RemoveObject(MapObject* object) {
 	_objects.erase(location);
 }
 
+
+
+void ObjectLayer::SortObjects() {
+	MapObject_Sort_Compare compare;
+
+	_max_image_height = 0.0f;
+	for (uint32 i = 0; i < _objects.size(); i++) {
+		if (_objects[i]->img_height > _max_image_height)
+			_max_image_height = _objects[i]->img_height;
+	}
+
+	for (uint32 i = 1; i < _objects.size(); i++) {
+		// Objects already in order relative to their predecessor are the common case and require no further work
+		if (compare(_objects[i], _objects[i - 1]) == false)
+			continue;
+
+		MapObject* object = _objects[i];
+		uint32 j = i;
+		do {
+			_objects[j] = _objects[j - 1];
+			j--;
+		} while (j > 0 && compare(object, _objects[j - 1]) == true);
+		_objects[j] = object;
+	}
+}
+
+// ----------------------------------------------------------------------------
+// ---------- ObjectGrid Class Functions
+// ----------------------------------------------------------------------------
+
+ObjectGrid::ObjectGrid() :
+	_num_cell_rows(0),
+	_num_cell_cols(0),
+	_search_count(0)
+{}
+
+
+
+void ObjectGrid::Initialize(uint16 num_grid_rows, uint16 num_grid_cols) {
+	_num_cell_rows = (num_grid_rows + OBJECT_GRID_CELL_SIZE - 1) / OBJECT_GRID_CELL_SIZE;
+	_num_cell_cols = (num_grid_cols + OBJECT_GRID_CELL_SIZE - 1) / OBJECT_GRID_CELL_SIZE;
+
+	for (uint32 i = 0; i < OBJECT_GRID_NUM_CONTEXTS; i++) {
+		_cells[i].clear();
+	}
+}
+
+
+
+void ObjectGrid::UpdateObject(MapObject* object) {
+	if (_num_cell_rows == 0 || _num_cell_cols == 0)
+		return;
+
+	MapRectangle coll_rect;
+	object->GetCollisionRectangle(coll_rect);
+	uint16 left, right, top, bottom;
+	_ComputeCellRange(coll_rect, left, right, top, bottom);
+
+	// Most objects stay within the same cells from one frame to the next, so there is usually nothing to do
+	if (object->_grid_context == object->context && object->_grid_left == left && object->_grid_right == right &&
+		object->_grid_top == top && object->_grid_bottom == bottom) {
+		return;
+	}
+
+	RemoveObject(object);
+	if (object->context == MAP_CONTEXT_NONE)
+		return;
+
+	for (uint32 i = 0; i < OBJECT_GRID_NUM_CONTEXTS; i++) {
+		if ((static_cast<uint32>(object->context) & (static_cast<uint32>(1) << i)) == 0)
+			continue;
+
+		vector<vector<MapObject*> >& cells = _cells[i];
+		if (cells.empty() == true)
+			cells.resize(_num_cell_rows * _num_cell_cols);
+
+		for (uint32 r = top; r <= bottom; r++) {
+			for (uint32 c = left; c <= right; c++) {
+				cells[r * _num_cell_cols + c].push_back(object);
+			}
+		}
+	}
+
+	object->_grid_context = object->context;
+	object->_grid_left = left;
+	object->_grid_right = right;
+	object->_grid_top = top;
+	object->_grid_bottom = bottom;
+} // void ObjectGrid::UpdateObject(MapObject* object)
+
+
+
+void ObjectGrid::RemoveObject(MapObject* object) {
+	if (object->_grid_context == MAP_CONTEXT_NONE)
+		return;
+
+	for (uint32 i = 0; i < OBJECT_GRID_NUM_CONTEXTS; i++) {
+		if ((static_cast<uint32>(object->_grid_context) & (static_cast<uint32>(1) << i)) == 0 || _cells[i].empty() == true)
+			continue;
+
+		for (uint32 r = object->_grid_top; r <= object->_grid_bottom; r++) {
+			for (uint32 c = object->_grid_left; c <= object->_grid_right; c++) {
+				// The order of objects within a cell does not matter, so the last object is moved into the vacated slot
+				vector<MapObject*>& cell = _cells[i][r * _num_cell_cols + c];
+				vector<MapObject*>::iterator location = find(cell.begin(), cell.end(), object);
+				if (location != cell.end()) {
+					*location = cell.back();
+					cell.pop_back();
+				}
+			}
+		}
+	}
+
+	object->_grid_context = MAP_CONTEXT_NONE;
+}
+
+
+
+void ObjectGrid::FindObjects(const MapRectangle& area, uint32 context, vector<MapObject*>& results) {
+	results.clear();
+	if (_num_cell_rows == 0 || _num_cell_cols == 0)
+		return;
+
+	uint16 left, right, top, bottom;
+	_ComputeCellRange(area, left, right, top, bottom);
+	_search_count++;
+
+	for (uint32 i = 0; i < OBJECT_GRID_NUM_CONTEXTS; i++) {
+		if ((context & (static_cast<uint32>(1) << i)) == 0 || _cells[i].empty() == true)
+			continue;
+
+		for (uint32 r = top; r <= bottom; r++) {
+			for (uint32 c = left; c <= right; c++) {
+				const vector<MapObject*>& cell = _cells[i][r * _num_cell_cols + c];
+				for (uint32 j = 0; j < cell.size(); j++) {
+					// Objects that are larger than a cell, or that reside in several of the searched contexts, are found more than once
+					if (cell[j]->_grid_search != _search_count) {
+						cell[j]->_grid_search = _search_count;
+						results.push_back(cell[j]);
+					}
+				}
+			}
+		}
+	}
+}
+
+
+
+void ObjectGrid::_ComputeCellRange(const MapRectangle& area, uint16& left, uint16& right, uint16& top, uint16& bottom) const {
+	const float cell_size = static_cast<float>(OBJECT_GRID_CELL_SIZE);
+	const float max_col = static_cast<float>(_num_cell_cols - 1);
+	const float max_row = static_cast<float>(_num_cell_rows - 1);
+
+	left = static_cast<uint16>(min(max(area.left / cell_size, 0.0f), max_col));
+	right = static_cast<uint16>(min(max(area.right / cell_size, 0.0f), max_col));
+	top = static_cast<uint16>(min(max(area.top / cell_size, 0.0f), max_row));
+	bottom = static_cast<uint16>(min(max(area.bottom / cell_size, 0.0f), max_row));
+}
+
+// ----------------------------------------------------------------------------
+// ---------- CollisionGrid Class Functions
+// ----------------------------------------------------------------------------
+
+CollisionGrid::CollisionGrid() :
+	_num_rows(0),
+	_num_cols(0),
+	_words_per_row(0),
+	_blocked_contexts(0)
+{
+	for (uint32 i = 0; i < OBJECT_GRID_NUM_CONTEXTS; i++) {
+		_plane_indices[i] = -1;
+	}
+}
+
+
+
+void CollisionGrid::Initialize(const uint32* grid, uint16 num_rows, uint16 num_cols) {
+	_num_rows = num_rows;
+	_num_cols = num_cols;
+	_words_per_row = (num_cols + COLLISION_GRID_WORD_BITS - 1) / COLLISION_GRID_WORD_BITS;
+	_planes.clear();
+
+	// Find which contexts have any unwalkable elements so that planes are only allocated for those
+	const uint32 num_elements = static_cast<uint32>(num_rows) * num_cols;
+	_blocked_contexts = 0;
+	for (uint32 i = 0; i < num_elements; i++) {
+		_blocked_contexts |= grid[i];
+	}
+
+	uint32 num_planes = 0;
+	for (uint32 i = 0; i < OBJECT_GRID_NUM_CONTEXTS; i++) {
+		if ((_blocked_contexts & (static_cast<uint32>(1) << i)) != 0) {
+			_plane_indices[i] = static_cast<int8>(num_planes);
+			num_planes++;
+		}
+		else {
+			_plane_indices[i] = -1;
+		}
+	}
+
+	_planes.assign(num_planes * num_rows * _words_per_row, 0);
+	for (uint32 i = 0; i < OBJECT_GRID_NUM_CONTEXTS; i++) {
+		if (_plane_indices[i] < 0)
+			continue;
+
+		const uint32 context = static_cast<uint32>(1) << i;
+		uint32* plane = &_planes[_plane_indices[i] * num_rows * _words_per_row];
+		for (uint16 r = 0; r < num_rows; r++) {
+			const uint32* grid_row = grid + r * num_cols;
+			uint32* plane_row = plane + r * _words_per_row;
+			for (uint16 c = 0; c < num_cols; c++) {
+				if ((grid_row[c] & context) != 0)
+					plane_row[c / COLLISION_GRID_WORD_BITS] |= static_cast<uint32>(1) << (c % COLLISION_GRID_WORD_BITS);
+			}
+		}
+	}
+}
+
+
+
+bool CollisionGrid::IsElementBlocked(uint16 row, uint16 col, uint32 context) const {
+	context &= _blocked_contexts;
+	const uint32 word_offset = row * _words_per_row + col / COLLISION_GRID_WORD_BITS;
+	const uint32 bit = static_cast<uint32>(1) << (col % COLLISION_GRID_WORD_BITS);
+
+	for (uint32 i = 0; context != 0; i++, context >>= 1) {
+		if ((context & 1) == 0)
+			continue;
+
+		if ((_planes[_plane_indices[i] * _num_rows * _words_per_row + word_offset] & bit) != 0)
+			return true;
+	}
+
+	return false;
+}
+
+
+
+bool CollisionGrid::IsAreaBlocked(uint16 top, uint16 bottom, uint16 left, uint16 right, uint32 context) const {
+	context &= _blocked_contexts;
+	if (context == 0 || _num_rows == 0 || _num_cols == 0)
+		return false;
+
+	bottom = min(bottom, static_cast<uint16>(_num_rows - 1));
+	right = min(right, static_cast<uint16>(_num_cols - 1));
+	if (top > bottom || left > right)
+		return false;
+
+	// Mask away the columns outside of the area in the first and last word of each row
+	const uint16 first_word = left / COLLISION_GRID_WORD_BITS;
+	const uint16 last_word = right / COLLISION_GRID_WORD_BITS;
+	uint32 first_mask = 0xFFFFFFFF << (left % COLLISION_GRID_WORD_BITS);
+	const uint32 last_mask = 0xFFFFFFFF >> (COLLISION_GRID_WORD_BITS - 1 - right % COLLISION_GRID_WORD_BITS);
+	if (first_word == last_word)
+		first_mask &= last_mask;
+
+	for (uint32 i = 0; context != 0; i++, context >>= 1) {
+		if ((context & 1) == 0)
+			continue;
+
+		const uint32* row = &_planes[(_plane_indices[i] * _num_rows + top) * _words_per_row];
+		for (uint16 r = top; r <= bottom; r++, row += _words_per_row) {
+			if ((row[first_word] & first_mask) != 0)
+				return true;
+			if (first_word == last_word)
+				continue;
+
+			for (uint16 w = first_word + 1; w < last_word; w++) {
+				if (row[w] != 0)
+					return true;
+			}
+			if ((row[last_word] & last_mask) != 0)
+				return true;
+		}
+	}
+
+	return false;
+} // bool CollisionGrid::IsAreaBlocked(uint16 top, uint16 bottom, uint16 left, uint16 right, uint32 context) const
+
 // ----------------------------------------------------------------------------
 // ---------- ObjectSupervisor Class Functions
 // ----------------------------------------------------------------------------
@@ -341,7 +655,8 @@ void ObjectLayer::RemoveObject(MapObject* object) {
 ObjectSupervisor::ObjectSupervisor() :
 	_num_grid_rows(0),
 	_num_grid_cols(0),
-	_last_id(1000)
+	_last_id(1000),
+	_path_search_id(0)
 {
 	_object_layers.push_back(ObjectLayer(DEFAULT_LAYER_ID));
 }
@@ -405,21 +720,34 @@ VirtualSprite* ObjectSupervisor::GetSprite(uint32 object_id) {
 
 
 
-void ObjectSupervisor::Load(ReadScriptDescriptor& map_file) {
-	// ---------- Construct the collision grid
-	map_file.OpenTable("collision_grid");
-	_num_grid_rows = map_file.GetTableSize();
-	for (uint16 r = 0; r < _num_grid_rows; ++r) {
-		_collision_grid.push_back(vector<uint32>());
-		map_file.ReadUIntVector(r, _collision_grid.back());
+void ObjectSupervisor::Load(const MapData& map_data) {
+	// ---------- Construct the collision grid, packing the map data into a bit-plane for each context
+	_num_grid_rows = map_data.collision_row_count;
+	_num_grid_cols = map_data.collision_column_count;
+	_collision_grid.Initialize(map_data.collision_grid, _num_grid_rows, _num_grid_cols);
+
+	// ---------- Size the object grid to the map and file any objects that were added before the map was loaded
+	for (map<uint16, MapObject*>::iterator i = _all_objects.begin(); i != _all_objects.end(); ++i) {
+		_object_grid.RemoveObject(i->second);
+	}
+	_object_grid.Initialize(_num_grid_rows, _num_grid_cols);
+	_UpdateObjectGrid();
+
+	// ---------- Allocate the path search state once so that FindPath() never needs to allocate it
+	_path_nodes.assign(static_cast<uint32>(_num_grid_rows) * _num_grid_cols, PathSearchNode());
+	_path_open.reserve(_num_grid_cols * 2 + _num_grid_rows * 2);
+	_path_search_id = 0;
+	for (uint32 i = 0; i < OBJECT_GRID_NUM_CONTEXTS; i++) {
+		_flow_fields[i] = FlowField();
 	}
-	map_file.CloseTable();
-	_num_grid_cols = _collision_grid[0].size();
 }
 
 
 
 void ObjectSupervisor::Update() {
+	// Pick up any objects that were moved or had their context changed by events or the map script since the last update
+	_UpdateObjectGrid();
+
 	for (uint32 i = 0; i < _object_layers.size(); ++i) {
 		_object_layers[i].Update();
 	}
@@ -428,6 +756,9 @@ void ObjectSupervisor::Update() {
 		_zones[i]->Update();
 	}
 
+	// Zones may have changed the context of objects or placed new enemies on the map
+	_UpdateObjectGrid();
+
 	// TODO: examine all sprites for movement and context change, then check all resident zones to see if the sprite has entered
 }
 
@@ -471,6 +802,7 @@ void ObjectSupervisor::AddObject(MapObject* new_object, uint32 layer_id) {
 
 	_all_objects.insert(make_pair(new_object->GetObjectID(), new_object));
 	_object_layers[layer_id].AddObject(new_object);
+	_object_grid.UpdateObject(new_object);
 }
 
 
@@ -530,17 +862,20 @@ MapObject* ObjectSupervisor::FindNearestObject(const VirtualSprite* sprite, floa
 		return NULL;
 	}
 
-	// ---------- (2) Go through all objects and determine which (if any) lie within the search area
+	// ---------- (2) Go through all nearby objects and determine which (if any) lie within the search area
 	vector<MapObject*> valid_objects; // A vector to hold objects which are inside the search area (either partially or fully)
-	vector<MapObject*>* search_vector = NULL; // A pointer to the vector of objects to search
 
-	// TODO: use the object layer that the sprite belongs to instead of the default layer_id
-	search_vector = _object_layers[DEFAULT_LAYER_ID].GetObjects();
+	// The object grid only returns objects that reside in the same context as the sprite
+	_object_grid.FindObjects(search_area, sprite->context, _grid_results);
 
-	for (vector<MapObject*>::iterator i = (*search_vector).begin(); i != (*search_vector).end(); i++) {
+	for (vector<MapObject*>::iterator i = _grid_results.begin(); i != _grid_results.end(); i++) {
 		if (*i == sprite) // Don't allow the sprite itself to be considered in the search
 			continue;
 
+		// TODO: use the object layer that the sprite belongs to instead of the default layer_id
+		if ((*i)->GetObjectLayerID() != DEFAULT_LAYER_ID)
+			continue;
+
 		// If the object and sprite do not exist in the same context, do not consider the object for the search
 		if (((*i)->context & sprite->context) == 0)
 			continue;
@@ -599,18 +934,8 @@ bool ObjectSupervisor::CheckMapCollision(const private_map::MapObject* const obj
 	}
 
 	// Determine if the object's collision rectangle overlaps any unwalkable tiles
-	// Note that because the sprite's collision rectangle was previously determined to be within the map bounds,
-	// the map grid tile indeces referenced in this loop are all valid entries and do not need to be checked.
-	for (uint32 r = static_cast<uint32>(coll_rect.top); r <= static_cast<uint32>(coll_rect.bottom); r++) {
-		for (uint32 c = static_cast<uint32>(coll_rect.left); c <= static_cast<uint32>(coll_rect.right); c++) {
-			// Checks the collision grid at the row-column at the object's current context
-			if ((_collision_grid[r][c] & obj->context) != 0) {
-				return true;
-			}
-		}
-	}
-
-	return false;
+	return _collision_grid.IsAreaBlocked(static_cast<uint16>(coll_rect.top), static_cast<uint16>(coll_rect.bottom),
+		static_cast<uint16>(coll_rect.left), static_cast<uint16>(coll_rect.right), obj->context);
 }
 
 
@@ -657,99 +982,98 @@ COLLISION_TYPE ObjectSupervisor::DetectCollision(VirtualSprite* sprite, MapObjec
 	MapRectangle coll_rect;
 	sprite->GetCollisionRectangle(coll_rect);
 
+	MapObject* obstruction_object = NULL;
+	COLLISION_TYPE collision = _DetectCollision(sprite, coll_rect, &obstruction_object, ignore_sprites);
+
+	if (collision == BOUNDARY_COLLISION) {
+		NotificationManager->Notify(new MapCollisionNotificationEvent(BOUNDARY_COLLISION, sprite));
+	}
+	else if (collision == GRID_COLLISION) {
+		NotificationManager->Notify(new MapCollisionNotificationEvent(GRID_COLLISION, sprite));
+	}
+	else if (collision == OBJECT_COLLISION) {
+		if (collision_object != NULL) {
+			*collision_object = obstruction_object;
+		}
+		NotificationManager->Notify(new MapCollisionNotificationEvent(GRID_COLLISION, sprite, obstruction_object));
+	}
+
+	return collision;
+} // bool ObjectSupervisor::DetectCollision(VirtualSprite* sprite, MapObject** collision_object, bool ignore_sprites)
+
+
+
+COLLISION_TYPE ObjectSupervisor::_DetectCollision(const VirtualSprite* sprite, const MapRectangle& coll_rect, MapObject** collision_object, bool ignore_sprites) {
 	// ---------- (1) Check if any part of the object's collision rectangle is outside of the map boundary
 	if (coll_rect.left < 0.0f || coll_rect.right > static_cast<float>(_num_grid_cols) ||
 		coll_rect.top < 0.0f || coll_rect.bottom > static_cast<float>(_num_grid_rows)) {
-		NotificationManager->Notify(new MapCollisionNotificationEvent(BOUNDARY_COLLISION, sprite));
 		return BOUNDARY_COLLISION;
 	}
 
 	// ---------- (2) Check if the object's collision rectangle overlaps with any unwalkable elements on the collision grid
 	// Determine if the object's collision rectangle overlaps any unwalkable tiles
-	// Note that because the sprite's collision rectangle was previously determined to be within the map bounds,
-	// the map grid tile indeces referenced in this loop are all valid entries and do not need to be checked for out-of-bounds conditions
-	uint32 left, right, top, bottom;
+	uint16 left, right, top, bottom;
 	float integer;
 
 	// We need to figure out what range of collision grid coordinates need to be examined. Extract the integer component from each side of the
 	// collision rectangle. These will directly translate into the row and column indeces of the collision grid that we need to check against.
 	modf(coll_rect.left, &integer);
-	left = static_cast<uint32>(integer);
+	left = static_cast<uint16>(integer);
 	modf(coll_rect.right, &integer);
-	right = static_cast<uint32>(integer);
+	right = static_cast<uint16>(integer);
 	modf(coll_rect.top, &integer);
-	top = static_cast<uint32>(integer);
+	top = static_cast<uint16>(integer);
 	modf(coll_rect.bottom, &integer);
-	bottom = static_cast<uint32>(integer);
-
-	for (uint32 r = top; r <= bottom; r++) {
-		for (uint32 c = left; c <= right; c++) {
-			// Checks the collision grid at the row-column at the object's current context
-			if ((_collision_grid[r][c] & sprite->context) != 0) {
-				NotificationManager->Notify(new MapCollisionNotificationEvent(GRID_COLLISION, sprite));
-				return GRID_COLLISION;
-			}
-		}
+	bottom = static_cast<uint16>(integer);
+
+	if (_collision_grid.IsAreaBlocked(top, bottom, left, right, sprite->context) == true) {
+		return GRID_COLLISION;
 	}
 
 	// ---------- (3) Determine which set of objects to do collision detection with
-	MapObject* obstruction_object = NULL;
-	vector<MapObject*>* objects = NULL; // A pointer to the layer of objects to do the collision detection with
-	// TODO: use the object layer that the sprite belongs to instead of the default layer_id
-	objects = _object_layers[DEFAULT_LAYER_ID].GetObjects();
+	// Only objects filed in the object grid cells around the sprite in one of its contexts can possibly overlap it
+	_object_grid.FindObjects(coll_rect, sprite->context, _grid_results);
 
 	// ---------- (4) Check collision areas for all objects matching the layer and context of the sprite
-	MapRectangle sprite_rect;
-	sprite->GetCollisionRectangle(sprite_rect);
+	for (uint32 i = 0; i < _grid_results.size(); i++) {
+		MapObject* object = _grid_results[i];
 
-	for (uint32 i = 0; i < objects->size(); i++) {
 		// Check for conditions where we would not want to do collision detection between the two objects
-		if ((*objects)[i]->object_id == sprite->object_id)
+		if (object->object_id == sprite->object_id)
 			continue; // Object and sprite are the same
-		if ((*objects)[i]->collidable == false)
+		if (object->GetObjectLayerID() != DEFAULT_LAYER_ID)
+			continue; // TODO: use the object layer that the sprite belongs to instead of the default layer_id
+		if (object->collidable == false)
 			continue; // Object has no collision detection property set
-		if (((*objects)[i]->context & sprite->context) == 0)
+		if ((object->context & sprite->context) == 0)
 			continue; // Sprite and object do not exist in the same context
-		if (ignore_sprites == true && ((*objects)[i]->GetType() == SPRITE_TYPE || (*objects)[i]->GetType() == ENEMY_TYPE))
+		if (ignore_sprites == true && (object->GetType() == SPRITE_TYPE || object->GetType() == ENEMY_TYPE))
 			continue; // Object is a sprite and caller instructed to avoid sprite collisions
 
-		if (CheckObjectCollision(sprite_rect, (*objects)[i]) == true) {
-			obstruction_object = (*objects)[i];
-			break;
-		}
-	}
-
-	if (obstruction_object != NULL) {
-		if (collision_object != NULL) {
-			*collision_object = obstruction_object;
+		if (CheckObjectCollision(coll_rect, object) == true) {
+			if (collision_object != NULL) {
+				*collision_object = object;
+			}
+			return OBJECT_COLLISION;
 		}
-		NotificationManager->Notify(new MapCollisionNotificationEvent(GRID_COLLISION, sprite, obstruction_object));
-		return OBJECT_COLLISION;
 	}
 
 	return NO_COLLISION;
-} // bool ObjectSupervisor::DetectCollision(VirtualSprite* sprite, MapObject** collision_object, bool ignore_sprites)
+} // COLLISION_TYPE ObjectSupervisor::_DetectCollision(const VirtualSprite* sprite, const MapRectangle& coll_rect, ... )
 
 
 
 MapObject* ObjectSupervisor::IsPositionOccupied(int16 row, int16 col) {
-	// TODO: currently only examines the default object layer. Needs to be able to examine the appropriate layer
-	vector<MapObject*>* objects = _object_layers[DEFAULT_LAYER_ID].GetObjects();
+	MapRectangle element(static_cast<float>(col), static_cast<float>(col + 1), static_cast<float>(row), static_cast<float>(row + 1));
+	_object_grid.FindObjects(element, MAP_CONTEXT_ALL, _grid_results);
 
-	uint16 tmp_x;
-	uint16 tmp_y;
-	float tmp_x_offset;
-	float tmp_y_offset;
-
-	for (uint32 i = 0; i < objects->size(); i++) {
-		(*objects)[i]->GetXPosition(tmp_x, tmp_x_offset);
-		(*objects)[i]->GetYPosition(tmp_y, tmp_y_offset);
+	for (uint32 i = 0; i < _grid_results.size(); i++) {
+		// TODO: currently only examines the default object layer. Needs to be able to examine the appropriate layer
+		if (_grid_results[i]->GetObjectLayerID() != DEFAULT_LAYER_ID)
+			continue;
 
-		if (col >= tmp_x - (*objects)[i]->GetCollHalfWidth() && col <= tmp_x + (*objects)[i]->GetCollHalfWidth()) {
-			if (row <= tmp_y + (*objects)[i]->GetCollHeight() && row >= tmp_y) {
-				return (*objects)[i];
-			}
-		}
+		if (CheckObjectCollision(element, _grid_results[i]) == true)
+			return _grid_results[i];
 	}
 
 	return NULL;
@@ -821,161 +1145,342 @@ bool ObjectSupervisor::AdjustSpriteAroundCollision(private_map::VirtualSprite* s
 
 
 bool ObjectSupervisor::FindPath(VirtualSprite* sprite, vector<PathNode>& path, const PathNode& dest) {
-	// NOTE: Refer to the implementation of the A* algorithm to understand what all these lists and score values are for
-	std::vector<PathNode> open_list;
-	std::vector<PathNode> closed_list;
-
-	// The starting node of this path discovery
-	PathNode source_node(static_cast<int16>(sprite->y_position), static_cast<int16>(sprite->x_position));
-
-	// The current "best node"
-	PathNode best_node;
-	// Used to hold the eight adjacent nodes
-	PathNode nodes[8];
+	// NOTE: Refer to the implementation of the A* algorithm to understand what the open set and score values are for
 
-	// Temporary delta variables used in calculation of a node's heuristic (h score)
-	uint32 x_delta, y_delta;
-	// The number to add to a node's g_score, depending on whether it is a lateral or diagonal movement
-	int16 g_add;
-
-	// Original offset for sprite
-	float x_offset, y_offset;
+	// Row and column offsets of the eight adjacent nodes. The first four are lateral moves and the last four are diagonal.
+	static const int16 ADJACENT_ROW[8] = { -1, 1, 0, 0, -1, -1, 1, 1 };
+	static const int16 ADJACENT_COL[8] = { 0, 0, -1, 1, -1, 1, -1, 1 };
 
 	path.clear();
 
+	// The starting node of this path discovery
+	PathNode source_node(static_cast<int16>(sprite->y_position), static_cast<int16>(sprite->x_position));
+
 	// Check that the source node is not the same as the destination node
 	if (source_node == dest) {
 		PRINT_ERROR << "source node coordinates are the same as the destination" << endl;
 		return false;
 	}
 
-	// TODO: need to determine what to set the offsets to during path calculation
-	x_offset = sprite->x_offset;
-	y_offset = sprite->y_offset;
-// 	sprite->x_offset = 0.0f;
-// 	sprite->y_offset = 0.0f;
+	if (_path_nodes.empty() == true) {
+		PRINT_ERROR << "no collision grid has been loaded" << endl;
+		return false;
+	}
+
+	if (source_node.row < 0 || source_node.row >= static_cast<int16>(_num_grid_rows) ||
+		source_node.col < 0 || source_node.col >= static_cast<int16>(_num_grid_cols)) {
+		PRINT_ERROR << "sprite's current position is outside of the collision grid" << endl;
+		return false;
+	}
+
+	// Begin a new search. Every node still carries the ID of an earlier search, so all of them are now treated as unvisited.
+	if (++_path_search_id == 0) {
+		// The ID wrapped around, so old IDs can no longer be told apart from new ones and every node must be reset
+		for (uint32 i = 0; i < _path_nodes.size(); ++i) {
+			_path_nodes[i].search_id = 0;
+		}
+		_path_search_id = 1;
+	}
+	_path_open.clear();
 
 	// Check that the destination is valid for the sprite to move to before beginning
-	sprite->x_position = dest.col;
-	sprite->y_position = dest.row;
-	if (DetectCollision(sprite, NULL, true) != NO_COLLISION) {
-		sprite->x_position = source_node.col;
-		sprite->y_position = source_node.row;
-		sprite->x_offset = x_offset;
-		sprite->y_offset = y_offset;
+	if (_IsPathNodeBlocked(sprite, dest.row, dest.col) == true) {
 		PRINT_ERROR << "sprite can not move to destination node on path because one or more grid tiles are unwalkable" << endl;
 		return false;
 	}
 
-	open_list.push_back(source_node);
+	const int32 num_cols = static_cast<int32>(_num_grid_cols);
+	const uint32 source_index = source_node.row * num_cols + source_node.col;
+	const uint32 dest_index = dest.row * num_cols + dest.col;
 
-	while (open_list.empty() == false) {
-		sort(open_list.begin(), open_list.end());
-		best_node = open_list.back();
-		open_list.pop_back();
-		closed_list.push_back(best_node);
+	PathSearchNode& source = _path_nodes[source_index];
+	source.g_score = 0;
+	source.parent = -1;
+	source.search_id = _path_search_id;
+	source.blocked = false;
+	source.closed = false;
+	_path_open.push_back(PathSearchEntry(0, 0, source_index));
+
+	bool dest_found = false;
+	while (_path_open.empty() == false) {
+		pop_heap(_path_open.begin(), _path_open.end());
+		PathSearchEntry best_entry = _path_open.back();
+		_path_open.pop_back();
+
+		PathSearchNode& best_node = _path_nodes[best_entry.index];
+		// A node is pushed again each time a shorter path to it is found, so older entries for it are skipped here
+		if (best_node.closed == true)
+			continue;
+		best_node.closed = true;
 
 		// Check if destination has been reached, and break out of the loop if so
-		if (best_node == dest) {
+		if (best_entry.index == dest_index) {
+			dest_found = true;
 			break;
 		}
 
-		// Setup the coordinates of the 8 adjacent nodes to the best node
-		nodes[0].row = best_node.row - 1; nodes[0].col = best_node.col;
-		nodes[1].row = best_node.row + 1; nodes[1].col = best_node.col;
-		nodes[2].row = best_node.row;     nodes[2].col = best_node.col - 1;
-		nodes[3].row = best_node.row;     nodes[3].col = best_node.col + 1;
-		nodes[4].row = best_node.row - 1; nodes[4].col = best_node.col - 1;
-		nodes[5].row = best_node.row - 1; nodes[5].col = best_node.col + 1;
-		nodes[6].row = best_node.row + 1; nodes[6].col = best_node.col - 1;
-		nodes[7].row = best_node.row + 1; nodes[7].col = best_node.col + 1;
+		int16 best_row = static_cast<int16>(best_entry.index / num_cols);
+		int16 best_col = static_cast<int16>(best_entry.index % num_cols);
 
 		// Check the eight adjacent nodes
 		for (uint8 i = 0; i < 8; ++i) {
-			// ---------- (A): Check if all tiles are walkable
-			sprite->x_position = nodes[i].col;
-			sprite->y_position = nodes[i].row;
+			int16 row = best_row + ADJACENT_ROW[i];
+			int16 col = best_col + ADJACENT_COL[i];
 
-			if (DetectCollision(sprite, NULL, true) != NO_COLLISION) {
+			// ---------- (A): Check that the node lies on the collision grid
+			if (row < 0 || row >= static_cast<int16>(_num_grid_rows) || col < 0 || col >= static_cast<int16>(_num_grid_cols))
 				continue;
-			}
 
-			// ---------- (B): Check if the node is already in the closed list
-			if (find(closed_list.begin(), closed_list.end(), nodes[i]) != closed_list.end()) {
+			uint32 index = row * num_cols + col;
+			PathSearchNode& node = _path_nodes[index];
+
+			// ---------- (B): The first time a node is seen in this search, determine whether the sprite can stand on it
+			if (node.search_id != _path_search_id) {
+				node.search_id = _path_search_id;
+				node.blocked = _IsPathNodeBlocked(sprite, row, col);
+				node.closed = false;
+				node.parent = -1;
+				node.g_score = 0;
+			}
+			else if (node.closed == true) {
 				continue;
 			}
 
-			// ---------- (C): If this point has been reached, the node is valid for the sprite to move to
-			// If this is a lateral adjacent node, g_score is +10, otherwise diagonal adjacent node is +14
-			if (i < 4)
-				g_add = 10;
+			if (node.blocked == true)
+				continue;
+
+			// ---------- (C): If this is a lateral adjacent node, g_score is +10, otherwise diagonal adjacent node is +14
+			int32 g_score = best_node.g_score + ((i < 4) ? 10 : 14);
+			if (node.parent != -1 && node.g_score <= g_score)
+				continue; // The node is already on the open set with a path that is at least as short
+
+			// ---------- (D): Add the node to the open set with its new path
+			node.g_score = g_score;
+			node.parent = static_cast<int32>(best_entry.index);
+
+			// Calculate the H and F score of the node (the heuristic used is diagonal)
+			int32 x_delta = abs(dest.col - col);
+			int32 y_delta = abs(dest.row - row);
+			int32 h_score;
+			if (x_delta > y_delta)
+				h_score = 14 * y_delta + 10 * (x_delta - y_delta);
 			else
-				g_add = 14;
-
-			// Set the node's parent and calculate its g_score
-			nodes[i].parent_row = best_node.row;
-			nodes[i].parent_col = best_node.col;
-			nodes[i].g_score = best_node.g_score + g_add;
-
-			// ---------- (D): Check to see if the node is already on the open list and update it if necessary
-			vector<PathNode>::iterator iter = find(open_list.begin(), open_list.end(), nodes[i]);
-			if (iter != open_list.end()) {
-				// If its G is higher, it means that the path we are on is better, so switch the parent
-				if (iter->g_score > nodes[i].g_score) {
-					iter->g_score = nodes[i].g_score;
-					iter->f_score = nodes[i].g_score + iter->h_score;
-					iter->parent_row = nodes[i].parent_row;
-					iter->parent_col = nodes[i].parent_col;
-				}
-			}
-			// ---------- (E): Add the new node to the open list
-			else {
-				// Calculate the H and F score of the new node (the heuristic used is diagonal)
-				x_delta = abs(dest.col - nodes[i].col);
-				y_delta = abs(dest.row - nodes[i].row);
-				if (x_delta > y_delta)
-					nodes[i].h_score = 14 * y_delta + 10 * (x_delta - y_delta);
-				else
-					nodes[i].h_score = 14 * x_delta + 10 * (y_delta - x_delta);
-
-				nodes[i].f_score = nodes[i].g_score + nodes[i].h_score;
-				open_list.push_back(nodes[i]);
-			}
+				h_score = 14 * x_delta + 10 * (y_delta - x_delta);
+
+			_path_open.push_back(PathSearchEntry(g_score + h_score, h_score, index));
+			push_heap(_path_open.begin(), _path_open.end());
 		} // for (uint8 i = 0; i < 8; ++i)
-	} // while (open_list.empty() == false)
+	} // while (_path_open.empty() == false)
 
-	if (open_list.empty() == true) {
+	if (dest_found == false) {
 		IF_PRINT_WARNING(MAP_DEBUG) << "could not find path to destination" << endl;
 		return false;
 	}
 
-	// Add the destination node to the vector, retain its parent, and remove it from the closed list
-	path.push_back(best_node);
-	int16 parent_row = best_node.parent_row;
-	int16 parent_col = best_node.parent_col;
-	closed_list.pop_back();
-
-	// Go backwards through the closed list following the parent nodes to construct the path
-	for (vector<PathNode>::iterator iter = closed_list.end() - 1; iter != closed_list.begin(); --iter) {
-		if (iter->col == parent_col && iter->row == parent_row) {
-			path.push_back(*iter);
-			parent_col = iter->parent_col;
-			parent_row = iter->parent_row;
-		}
+	// Follow the parent nodes back from the destination to construct the path. The source node is not included.
+	for (int32 index = static_cast<int32>(dest_index); index != static_cast<int32>(source_index); index = _path_nodes[index].parent) {
+		const PathSearchNode& node = _path_nodes[index];
+		PathNode path_node(static_cast<int16>(index / num_cols), static_cast<int16>(index % num_cols));
+		path_node.g_score = static_cast<int16>(node.g_score);
+		path_node.parent_row = static_cast<int16>(node.parent / num_cols);
+		path_node.parent_col = static_cast<int16>(node.parent % num_cols);
+		path.push_back(path_node);
 	}
 	std::reverse(path.begin(), path.end());
 
-	// Move sprite back to original position
-	sprite->x_position = source_node.col;
-	sprite->y_position = source_node.row;
-	sprite->x_offset = x_offset;
-	sprite->y_offset = y_offset;
-
 	return true;
 } // bool ObjectSupervisor::FindPath(const VirtualSprite* sprite, std::vector<PathNode>& path, const PathNode& dest)
 
 
 
+bool ObjectSupervisor::_IsPathNodeBlocked(const VirtualSprite* sprite, int16 row, int16 col) {
+	// Nodes are only kept for elements of the collision grid, so the sprite may never stand outside of it
+	if (row < 0 || row >= static_cast<int16>(_num_grid_rows) || col < 0 || col >= static_cast<int16>(_num_grid_cols)) {
+		return true;
+	}
+
+	// A sprite with collision detection disabled may stand anywhere else on the map
+	if (sprite->collidable == false) {
+		return false;
+	}
+
+	// Compute the collision rectangle the sprite would have at this node, in the same way as MapObject::GetCollisionRectangle()
+	MapRectangle coll_rect;
+	float x_pos = static_cast<float>(col) + sprite->x_offset;
+	float y_pos = static_cast<float>(row) + sprite->y_offset;
+	coll_rect.left = x_pos - sprite->coll_half_width;
+	coll_rect.right = x_pos + sprite->coll_half_width;
+	coll_rect.top = y_pos - sprite->coll_height;
+	coll_rect.bottom = y_pos;
+
+	return (_DetectCollision(sprite, coll_rect, NULL, true) != NO_COLLISION);
+}
+
+
+
+uint16 ObjectSupervisor::FindPursuitDirection(const VirtualSprite* pursuer, const VirtualSprite* target) {
+	if (_num_grid_rows == 0 || _num_grid_cols == 0)
+		return 0;
+
+	// Use the field of the lowest context that the two sprites share
+	uint32 shared_context = static_cast<uint32>(pursuer->context) & static_cast<uint32>(target->context);
+	if (shared_context == 0)
+		return 0;
+	uint32 field_index = 0;
+	while ((shared_context & (static_cast<uint32>(1) << field_index)) == 0) {
+		field_index++;
+	}
+
+	FlowField& field = _flow_fields[field_index];
+	if (field.nodes.empty() == true || field.target_row != static_cast<int16>(target->y_position) ||
+		field.target_col != static_cast<int16>(target->x_position)) {
+		_BuildFlowField(field, target);
+	}
+
+	int32 row = static_cast<int32>(pursuer->y_position);
+	int32 col = static_cast<int32>(pursuer->x_position);
+	if (row >= _num_grid_rows || col >= _num_grid_cols)
+		return 0;
+
+	const PathSearchNode& node = field.nodes[row * _num_grid_cols + col];
+	if (node.search_id != field.build_id || node.closed == false || node.parent == -1)
+		return 0;
+
+	// The parent is always one of the eight adjacent nodes, so each delta is -1, 0, or 1
+	int32 row_delta = node.parent / _num_grid_cols - row;
+	int32 col_delta = node.parent % _num_grid_cols - col;
+	if (row_delta < 0) {
+		if (col_delta < 0)
+			return MOVING_NORTHWEST;
+		else if (col_delta > 0)
+			return MOVING_NORTHEAST;
+		else
+			return NORTH;
+	}
+	else if (row_delta > 0) {
+		if (col_delta < 0)
+			return MOVING_SOUTHWEST;
+		else if (col_delta > 0)
+			return MOVING_SOUTHEAST;
+		else
+			return SOUTH;
+	}
+	else {
+		return (col_delta < 0) ? WEST : EAST;
+	}
+} // uint16 ObjectSupervisor::FindPursuitDirection(const VirtualSprite* pursuer, const VirtualSprite* target)
+
+
+
+void ObjectSupervisor::_BuildFlowField(FlowField& field, const VirtualSprite* target) {
+	// Row and column offsets of the eight adjacent nodes. The first four are lateral moves and the last four are diagonal.
+	static const int16 ADJACENT_ROW[8] = { -1, 1, 0, 0, -1, -1, 1, 1 };
+	static const int16 ADJACENT_COL[8] = { 0, 0, -1, 1, -1, 1, -1, 1 };
+
+	if (field.nodes.empty() == true) {
+		field.nodes.assign(static_cast<uint32>(_num_grid_rows) * _num_grid_cols, PathSearchNode());
+		field.build_id = 0;
+	}
+
+	if (++field.build_id == 0) {
+		// The ID wrapped around, so old IDs can no longer be told apart from new ones and every node must be reset
+		for (uint32 i = 0; i < field.nodes.size(); ++i) {
+			field.nodes[i].search_id = 0;
+		}
+		field.build_id = 1;
+	}
+
+	field.target_row = static_cast<int16>(target->y_position);
+	field.target_col = static_cast<int16>(target->x_position);
+	if (field.target_row >= static_cast<int16>(_num_grid_rows) || field.target_col >= static_cast<int16>(_num_grid_cols))
+		return;
+
+	const int32 num_cols = static_cast<int32>(_num_grid_cols);
+	const uint32 target_index = field.target_row * num_cols + field.target_col;
+
+	// The target's own element is never tested, as the target is already standing on it
+	PathSearchNode& target_node = field.nodes[target_index];
+	target_node.g_score = 0;
+	target_node.parent = -1;
+	target_node.search_id = field.build_id;
+	target_node.blocked = false;
+	target_node.closed = false;
+
+	_path_open.clear();
+	_path_open.push_back(PathSearchEntry(0, 0, target_index));
+
+	while (_path_open.empty() == false) {
+		pop_heap(_path_open.begin(), _path_open.end());
+		PathSearchEntry best_entry = _path_open.back();
+		_path_open.pop_back();
+
+		PathSearchNode& best_node = field.nodes[best_entry.index];
+		if (best_node.closed == true)
+			continue;
+		best_node.closed = true;
+
+		int16 best_row = static_cast<int16>(best_entry.index / num_cols);
+		int16 best_col = static_cast<int16>(best_entry.index % num_cols);
+
+		for (uint8 i = 0; i < 8; ++i) {
+			int16 row = best_row + ADJACENT_ROW[i];
+			int16 col = best_col + ADJACENT_COL[i];
+
+			if (_IsFlowFieldNodeBlocked(field, target, row, col) == true)
+				continue;
+
+			// A diagonal step is only taken when both of the lateral nodes beside it are open, so that sprites do not catch on corners
+			if (i >= 4 && (_IsFlowFieldNodeBlocked(field, target, best_row, col) == true ||
+				_IsFlowFieldNodeBlocked(field, target, row, best_col) == true)) {
+				continue;
+			}
+
+			uint32 index = row * num_cols + col;
+			PathSearchNode& node = field.nodes[index];
+			if (node.closed == true)
+				continue;
+
+			int32 g_score = best_node.g_score + ((i < 4) ? 10 : 14);
+			if (g_score > FLOW_FIELD_MAX_COST)
+				continue;
+			if (node.parent != -1 && node.g_score <= g_score)
+				continue;
+
+			node.g_score = g_score;
+			node.parent = static_cast<int32>(best_entry.index);
+			_path_open.push_back(PathSearchEntry(g_score, 0, index));
+			push_heap(_path_open.begin(), _path_open.end());
+		}
+	} // while (_path_open.empty() == false)
+} // void ObjectSupervisor::_BuildFlowField(FlowField& field, const VirtualSprite* target)
+
+
+
+bool ObjectSupervisor::_IsFlowFieldNodeBlocked(FlowField& field, const VirtualSprite* target, int16 row, int16 col) {
+	if (row < 0 || row >= static_cast<int16>(_num_grid_rows) || col < 0 || col >= static_cast<int16>(_num_grid_cols))
+		return true;
+
+	PathSearchNode& node = field.nodes[row * _num_grid_cols + col];
+	if (node.search_id != field.build_id) {
+		node.search_id = field.build_id;
+		node.blocked = _IsPathNodeBlocked(target, row, col);
+		node.closed = false;
+		node.parent = -1;
+		node.g_score = 0;
+	}
+	return node.blocked;
+}
+
+
+
+void ObjectSupervisor::_UpdateObjectGrid() {
+	for (map<uint16, MapObject*>::iterator i = _all_objects.begin(); i != _all_objects.end(); ++i) {
+		_object_grid.UpdateObject(i->second);
+	}
+}
+
+
+
 bool ObjectSupervisor::_AlignSpriteWithCollision(VirtualSprite* sprite, uint16 direction, COLLISION_TYPE coll_type,
 	const MapRectangle& sprite_coll_rect, const MapRectangle& object_coll_rect)
 {
@@ -1167,13 +1672,13 @@ bool ObjectSupervisor::_MoveSpriteAroundCollisionCorner(VirtualSprite* sprite, C
 	vector<bool> grid_line(end_point - start_point);
 
 	if (horizontal_adjustment == true) {
-		for (uint16 i = start_point, j = 0; i <= end_point && i < _collision_grid[line_axis].size(); i++, j++) {
-			grid_line[j] = (_collision_grid[line_axis][i] & sprite->context);
+		for (uint16 i = start_point, j = 0; i <= end_point && i < _num_grid_cols; i++, j++) {
+			grid_line[j] = _collision_grid.IsElementBlocked(line_axis, i, sprite->context);
 		}
 	}
 	else {
-		for (uint16 i = start_point, j = 0; i <= end_point && i < _collision_grid.size(); i++, j++) {
-			grid_line[j] = (_collision_grid[i][line_axis] & sprite->context);
+		for (uint16 i = start_point, j = 0; i <= end_point && i < _num_grid_rows; i++, j++) {
+			grid_line[j] = _collision_grid.IsElementBlocked(i, line_axis, sprite->context);
 		}
 	}
 
@@ -1349,25 +1854,15 @@ bool ObjectSupervisor::_MoveSpriteAroundCollisionDiagonal(VirtualSprite* sprite,
 		}
 	}
 	else if (coll_type == GRID_COLLISION) {
-		uint32 axis;
+		uint16 axis;
 
-		check_vertical_align = false;
-		axis = (north_or_south == true) ? static_cast<uint32>(mod_sprite_rect.top) : static_cast<uint32>(mod_sprite_rect.bottom);
-		for (uint32 i = static_cast<uint32>(sprite_coll_rect.left); i <= static_cast<uint32>(sprite_coll_rect.right); i++) {
-			if (_collision_grid[axis][i] & sprite->context) {
-				check_vertical_align = true;
-				break;
-			}
-		}
+		axis = (north_or_south == true) ? static_cast<uint16>(mod_sprite_rect.top) : static_cast<uint16>(mod_sprite_rect.bottom);
+		check_vertical_align = _collision_grid.IsAreaBlocked(axis, axis, static_cast<uint16>(sprite_coll_rect.left),
+			static_cast<uint16>(sprite_coll_rect.right), sprite->context);
 
-		check_horizontal_align = false;
-		axis = (east_or_west == true) ? static_cast<uint32>(mod_sprite_rect.right) : static_cast<uint32>(mod_sprite_rect.left);
-		for (uint32 i = static_cast<uint32>(sprite_coll_rect.top); i <= static_cast<uint32>(sprite_coll_rect.bottom); i++) {
-			if (_collision_grid[i][axis] & sprite->context) {
-				check_horizontal_align = true;
-				break;
-			}
-		}
+		axis = (east_or_west == true) ? static_cast<uint16>(mod_sprite_rect.right) : static_cast<uint16>(mod_sprite_rect.left);
+		check_horizontal_align = _collision_grid.IsAreaBlocked(static_cast<uint16>(sprite_coll_rect.top),
+			static_cast<uint16>(sprite_coll_rect.bottom), axis, axis, sprite->context);
 	}
 	else if (coll_type == OBJECT_COLLISION) {
 		if (north_or_south == true) {
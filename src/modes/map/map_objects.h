@@ -61,6 +61,8 @@ namespace private_map {
 *** they are much more likely to be subject to bugs and other issues.
 *** ***************************************************************************/
 class MapObject {
+	friend class ObjectGrid;
+
 public:
 	MapObject();
 
@@ -319,6 +321,18 @@ protected:
 
 	//! \brief The ID of the object layer that this object exists on
 	uint32 _object_layer_id;
+
+private:
+	/** \brief The context that the object is filed under in the object grid
+	*** This is MAP_CONTEXT_NONE when the object is not filed in any cells of the grid.
+	**/
+	MAP_CONTEXT _grid_context;
+
+	//! \brief The range of object grid cells, inclusive, that the object is filed in
+	uint16 _grid_left, _grid_right, _grid_top, _grid_bottom;
+
+	//! \brief The number of the last grid search that returned this object, used to return each object no more than once
+	uint32 _grid_search;
 }; // class MapObject
 
 
@@ -422,7 +436,7 @@ public:
 class ObjectLayer : public MapLayer {
 public:
 	ObjectLayer(uint32 id) :
-		MapLayer(), _object_layer_id(id) {}
+		MapLayer(), _object_layer_id(id), _max_image_height(0.0f) {}
 
 	//! \name Class Member Accessor Methods
 	//@{
@@ -436,9 +450,15 @@ public:
 	//! \brief Calls the Update() method for all objects on this layer
 	void Update();
 
-	/** \brief Calls the Draw() method for all objects on this layer
+	/** \brief Calls the Draw() method for all objects on this layer that are on the screen
 	*** \param context Only objects within this context will be drawn
-	*** \note SortObjects() should be called prior to this function so that objects are drawn in the correct draw order
+	***
+	*** Because the objects are sorted by the bottom edge of their images, the objects which may be on
+	*** screen form a single run of the sorted objects. The start of that run is found with a binary search,
+	*** so objects far above or below the screen are never examined.
+	***
+	*** \note SortObjects() must be called prior to this function, otherwise objects may be drawn in the
+	*** wrong order or not drawn at all
 	**/
 	void Draw(MAP_CONTEXT context) const;
 
@@ -456,9 +476,14 @@ public:
 	**/
 	void RemoveObject(MapObject* object);
 
-	//! \brief Sorts all objects so that they are in the correct draw order
-	void SortObjects()
-		{ std::sort(_objects.begin(), _objects.end(), MapObject_Sort_Compare()); }
+	/** \brief Sorts all objects so that they are in the correct draw order
+	***
+	*** Only a few objects move from one frame to the next, so the objects are almost always still in order
+	*** from the previous sort. An insertion sort is used, which finishes in a single pass over the layer in
+	*** that case and only moves those objects that have passed another object. The sort is stable, so
+	*** objects at the same height keep their relative draw order from one frame to the next.
+	**/
+	void SortObjects();
 
 private:
 	//! \brief Holds the unique id of this object layer. The first layer created for a map should use the value DEFAULT_LAYER_ID
@@ -466,9 +491,258 @@ private:
 
 	//! \brief Container holding all objects that exist on this layer
 	std::vector<MapObject*> _objects;
+
+	//! \brief The greatest image height of any object on this layer, found by the most recent call to SortObjects()
+	float _max_image_height;
 }; // class ObjectLayer : public MapLayer
 
 
+//! \brief The number of collision grid elements along each side of a cell in the object grid
+const uint16 OBJECT_GRID_CELL_SIZE = 8;
+
+//! \brief The number of contexts that the object grid keeps a separate set of cells for
+const uint32 OBJECT_GRID_NUM_CONTEXTS = 32;
+
+/** ****************************************************************************
+*** \brief A spatial hash of map objects used to limit collision tests to nearby objects
+***
+*** The map is divided into square cells of OBJECT_GRID_CELL_SIZE collision grid elements,
+*** and each object is filed in every cell that its collision rectangle overlaps. A separate
+*** set of cells is kept for each map context, so that objects inside of a building are never
+*** examined by sprites walking around outside of it. An object residing in several contexts at
+*** once is filed under each one of them. The cells for a context are not allocated until an
+*** object is filed in that context.
+***
+*** Searches return candidates only. Objects are filed by where they were when UpdateObject()
+*** was last called on them, so the caller must still test the collision rectangle of every
+*** object that a search returns.
+***
+*** \note The ObjectSupervisor owns the single instance of this class and is responsible for
+*** calling UpdateObject() whenever an object moves or changes context.
+*** ***************************************************************************/
+class ObjectGrid {
+public:
+	ObjectGrid();
+
+	/** \brief Sets the dimensions of the grid and empties every cell
+	*** \param num_grid_rows The number of rows in the map's collision grid
+	*** \param num_grid_cols The number of columns in the map's collision grid
+	**/
+	void Initialize(uint16 num_grid_rows, uint16 num_grid_cols);
+
+	/** \brief Files an object in the cells that it currently overlaps
+	*** \param object A pointer to the object to file, which may or may not already be in the grid
+	***
+	*** This is inexpensive to call when the object has not moved to a different cell or changed
+	*** its context, as the object's existing filing is compared against its current position and
+	*** nothing is changed if the two match.
+	**/
+	void UpdateObject(MapObject* object);
+
+	/** \brief Removes an object from every cell that it is filed in
+	*** \param object A pointer to the object to remove
+	**/
+	void RemoveObject(MapObject* object);
+
+	/** \brief Finds all objects filed in the cells that overlap an area of the map
+	*** \param area The area of the map to search, in collision grid coordinates
+	*** \param context The contexts to search. Objects filed under any of these contexts are returned.
+	*** \param results A reference to a vector to hold the objects found. It is cleared by this call.
+	*** \note Each object is returned at most once, even if it is filed in several of the cells searched.
+	**/
+	void FindObjects(const MapRectangle& area, uint32 context, std::vector<MapObject*>& results);
+
+private:
+	//! \brief The number of rows and columns of cells
+	uint16 _num_cell_rows, _num_cell_cols;
+
+	/** \brief The cells for each context, indexed by the context's bit position
+	*** The cells of a context are stored by row, so that the cell at row r and column c is found
+	*** at [r * _num_cell_cols + c]. The vector for a context is empty until an object is filed in it.
+	**/
+	std::vector<std::vector<MapObject*> > _cells[OBJECT_GRID_NUM_CONTEXTS];
+
+	//! \brief Incremented for every search so that objects already returned by it may be recognized
+	uint32 _search_count;
+
+	/** \brief Computes the range of cells that overlap an area of the map
+	*** \param area The area of the map, in collision grid coordinates
+	*** \note Areas which extend beyond the edges of the map are clamped to the cells along the edges
+	**/
+	void _ComputeCellRange(const MapRectangle& area, uint16& left, uint16& right, uint16& top, uint16& bottom) const;
+}; // class ObjectGrid
+
+
+//! \brief The number of collision grid columns packed into each word of a collision grid bit-plane
+const uint16 COLLISION_GRID_WORD_BITS = 32;
+
+/** ****************************************************************************
+*** \brief The collision grid of a map, stored as one bit-plane per context
+***
+*** The map data stores a bitmask of contexts for every collision grid element. That layout
+*** requires a separate load and test for each element that a collision rectangle covers. This
+*** class instead stores a separate plane of bits for every context, where each row of a plane
+*** is packed into COLLISION_GRID_WORD_BITS columns per word. Testing whether a rectangle
+*** overlaps any unwalkable element then takes a masked test of a few words for each row.
+***
+*** Planes are only stored for the contexts that have at least one unwalkable element, so a
+*** map using only a handful of contexts does not pay for the other ones.
+***
+*** \note Rows are packed into 32-bit words rather than 64-bit words, as the engine does not
+*** make use of 64-bit integer types.
+*** ***************************************************************************/
+class CollisionGrid {
+public:
+	CollisionGrid();
+
+	/** \brief Builds the bit-planes from a grid of context bitmasks
+	*** \param grid The bitmask of every grid element in row-major order, holding num_rows * num_cols elements
+	*** \param num_rows The number of rows in the grid
+	*** \param num_cols The number of columns in the grid
+	**/
+	void Initialize(const uint32* grid, uint16 num_rows, uint16 num_cols);
+
+	/** \brief Returns true if a grid element is unwalkable in any of a set of contexts
+	*** \param row The row of the element, which must be within the grid
+	*** \param col The column of the element, which must be within the grid
+	*** \param context The contexts to check
+	**/
+	bool IsElementBlocked(uint16 row, uint16 col, uint32 context) const;
+
+	/** \brief Returns true if any element in a rectangular area of the grid is unwalkable in any of a set of contexts
+	*** \param top The first row of the area
+	*** \param bottom The last row of the area, inclusive
+	*** \param left The first column of the area
+	*** \param right The last column of the area, inclusive
+	*** \param context The contexts to check
+	*** \note Any part of the area that extends past the bottom or right edge of the grid is ignored
+	**/
+	bool IsAreaBlocked(uint16 top, uint16 bottom, uint16 left, uint16 right, uint32 context) const;
+
+private:
+	//! \brief The number of rows and columns in the grid
+	uint16 _num_rows, _num_cols;
+
+	//! \brief The number of words that each row of a plane is packed into
+	uint16 _words_per_row;
+
+	//! \brief The contexts that have at least one unwalkable element, and therefore a plane
+	uint32 _blocked_contexts;
+
+	//! \brief The index of the plane for each context, by the context's bit position. Contexts without a plane hold -1.
+	int8 _plane_indices[OBJECT_GRID_NUM_CONTEXTS];
+
+	/** \brief The words of every plane
+	*** Word w of row r of plane p is found at [(p * _num_rows + r) * _words_per_row + w]. Bit b of a word is set
+	*** when the element at column (w * COLLISION_GRID_WORD_BITS + b) is unwalkable.
+	**/
+	std::vector<uint32> _planes;
+}; // class CollisionGrid
+
+
+/** ****************************************************************************
+*** \brief The state of one collision grid element during a path search
+***
+*** The ObjectSupervisor keeps one of these for every element of the collision grid and
+*** reuses them for every search. Rather than resetting all of them before each search,
+*** each node records the search that last touched it. A node whose search ID does not
+*** match the current search holds stale data and is treated as unvisited.
+*** ***************************************************************************/
+class PathSearchNode {
+public:
+	PathSearchNode() :
+		g_score(0), parent(-1), search_id(0), blocked(false), closed(false) {}
+
+	//! \brief The cost of the best known path from the source to this node
+	int32 g_score;
+
+	//! \brief The index of the node that precedes this one on the best known path, or -1 for the source node
+	int32 parent;
+
+	//! \brief The ID of the last search that visited this node
+	uint32 search_id;
+
+	//! \brief True if the sprite can not stand at this node
+	bool blocked;
+
+	//! \brief True once the best path to this node has been found
+	bool closed;
+}; // class PathSearchNode
+
+
+/** ****************************************************************************
+*** \brief An entry in the open set of a path search
+***
+*** Entries are kept in a binary heap. When a shorter path to a node is found, a new entry
+*** is pushed rather than the existing one being updated, and the old entry is recognized
+*** and discarded when it reaches the top of the heap.
+*** ***************************************************************************/
+class PathSearchEntry {
+public:
+	PathSearchEntry(int32 f, int32 h, uint32 i) :
+		f_score(f), h_score(h), index(i) {}
+
+	//! \brief The estimated total cost of a path through this node (f = g + h)
+	int32 f_score;
+
+	//! \brief The estimated cost from this node to the destination
+	int32 h_score;
+
+	//! \brief The index of the node in the collision grid
+	uint32 index;
+
+	/** \brief Orders entries so that the std heap functions keep the entry with the lowest f_score on top
+	*** Ties are broken by the lowest h_score and then by the lowest index so that a search is always repeatable.
+	**/
+	bool operator<(const PathSearchEntry& that) const {
+		if (f_score != that.f_score)
+			return f_score > that.f_score;
+		if (h_score != that.h_score)
+			return h_score > that.h_score;
+		return index > that.index;
+	}
+}; // class PathSearchEntry
+
+
+//! \brief The greatest cost from its target that a flow field extends to, which is 32 lateral steps
+const int32 FLOW_FIELD_MAX_COST = 320;
+
+/** ****************************************************************************
+*** \brief The directions from the area around a target back towards that target
+***
+*** A flow field is built by searching outward from the target across the collision grid,
+*** using the same movement costs and collision tests as ObjectSupervisor::FindPath(). Every
+*** node the search reaches records the adjacent node that it was reached from, which is the
+*** next step on the shortest path to the target. Any number of sprites can then find the way
+*** to the target by looking up the node they stand on.
+***
+*** The search stops at nodes that are more than FLOW_FIELD_MAX_COST away from the target, so
+*** the cost of building a field does not depend on the size of the map. Like PathSearchNode,
+*** nodes are not reset between builds and a node whose search ID does not match the field's
+*** build ID is treated as unreached.
+***
+*** \note The ObjectSupervisor keeps one field for each map context and rebuilds it only when
+*** the target moves onto a different collision grid element.
+*** ***************************************************************************/
+class FlowField {
+public:
+	FlowField() :
+		target_row(-1), target_col(-1), build_id(0) {}
+
+	//! \brief The collision grid element of the target when the field was last built, or -1 if it has never been built
+	int16 target_row, target_col;
+
+	//! \brief The ID of the most recent build of this field
+	uint32 build_id;
+
+	/** \brief The search state of every collision grid element, stored by row
+	*** The parent of a node is the adjacent node one step closer to the target. This vector
+	*** is empty until the field is first built.
+	**/
+	std::vector<PathSearchNode> nodes;
+}; // class FlowField
+
+
 
 /** ****************************************************************************
 *** \brief A helper class to MapMode responsible for management of all object and sprite data
@@ -529,14 +803,22 @@ public:
 	ObjectLayer* GetObjectLayer(uint32 layer_id)
 		{ if (layer_id >= _object_layers.size()) return NULL; else return &_object_layers[layer_id]; }
 
+	//! \brief Returns the number of rows in the collision grid
+	uint16 GetNumGridRows() const
+		{ return _num_grid_rows; }
+
+	//! \brief Returns the number of columns in the collision grid
+	uint16 GetNumGridCols() const
+		{ return _num_grid_cols; }
+
+	//! \brief Returns the collision grid, which is empty until the map is loaded
+	const CollisionGrid& GetCollisionGrid() const
+		{ return _collision_grid; }
+
 	/** \brief Loads the collision grid data and saved state of all map objects
-	*** \param map_file A reference to the open map script file
-	***
-	*** The file must be open prior to making this call and additionally must
-	*** be at the highest level scope (i.e., there are no actively open tables
-	*** in the script descriptor object).
+	*** \param map_data A reference to the loaded map data
 	**/
-	void Load(hoa_script::ReadScriptDescriptor& map_file);
+	void Load(const MapData& map_data);
 
 	//! \brief Updates the state of all map zones and objects across all layers
 	void Update();
@@ -586,6 +868,16 @@ public:
 	//! \brief Sorts the objects in each object layer
 	void SortObjectLayers();
 
+	/** \brief Refiles an object in the object grid after it has moved or changed context
+	*** \param object A pointer to the object whose position or context may have changed
+	***
+	*** Every object is refiled at the start and end of Update(), which catches changes made by events, zones,
+	*** and map scripts. Anything that moves an object during the update of the object layers, as sprites do,
+	*** should call this immediately afterward so that the objects updated after it see its new position.
+	**/
+	void UpdateObjectGrid(private_map::MapObject* object)
+		{ _object_grid.UpdateObject(object); }
+
 	/** \brief Finds the nearest map object within a certain distance of a sprite
 	*** \param sprite The sprite who is trying to find its nearest object
 	*** \param search_distance The maximum distance to search for an object from the sprite (default == 3.0f)
@@ -632,6 +924,8 @@ public:
 	*** \param row The collision grid row
 	*** \return A pointer to the object occupying the grid position or NULL if the position is unoccupied
 	***
+	*** An object occupies a grid element when its collision rectangle overlaps the element in any context.
+	***
 	*** \todo Take into account the object/sprite's collision property and also add a parameter for map context
 	**/
 	private_map::MapObject* IsPositionOccupied(int16 col, int16 row);
@@ -689,13 +983,31 @@ public:
 	*** \return True if a path to the destination was found successfully
 	***
 	*** This algorithm uses the A* algorithm to find a path from a source to a destination.
-	*** This function ignores the position of all other objects and only concerns itself with
-	*** which map grid elements are walkable.
+	*** This function ignores the position of all other sprites and only concerns itself with
+	*** which map grid elements are walkable and which are blocked by stationary objects.
+	*** The sprite itself is never moved while the path is being found.
 	***
 	*** \note If an error is detected or a path could not be found, the function will empty the path vector before returning
 	**/
 	bool FindPath(private_map::VirtualSprite* sprite, std::vector<private_map::PathNode>& path, const private_map::PathNode& dest);
 
+	/** \brief Determines which direction a sprite should move in to pursue another sprite
+	*** \param pursuer A pointer to the sprite doing the pursuing
+	*** \param target A pointer to the sprite being pursued, which is usually the player's sprite
+	*** \return The direction to move in, or zero if no direction could be determined
+	***
+	*** The direction is read from the flow field of the context that the two sprites share, which is
+	*** rebuilt first if the target has moved onto a different collision grid element. Sampling a field
+	*** that is already built costs the same no matter how many sprites are pursuing the target.
+	***
+	*** Like FindPath(), the field ignores all sprites and only avoids unwalkable grid elements and
+	*** stationary objects. Whether an element is walkable is decided using the target's collision
+	*** rectangle, so pursuers of a very different size may still collide along the way. Diagonal steps
+	*** are never taken past the corner of an obstruction. Zero is returned when the pursuer is on the
+	*** target's grid element, shares no context with the target, or stands where the field does not reach.
+	**/
+	uint16 FindPursuitDirection(const private_map::VirtualSprite* pursuer, const private_map::VirtualSprite* target);
+
 private:
 	/** \brief The number of rows and columns in the collision gride
 	*** The number of collision grid rows and columns is always equal to twice
@@ -706,11 +1018,10 @@ private:
 	//! \brief Holds the most recently generated object ID number
 	uint16 _last_id;
 
-	/** \brief A 2D vector indicating which grid element on the map sprites may be occupied by objects.
-	*** Each bit of each element in this grid corresponds to a context. So all together this entire grid
-	*** stores the collision information for all 32 possible map contexts.
+	/** \brief Indicates which grid elements on the map may not be occupied by objects in each context
+	*** This stores the collision information for all 32 possible map contexts.
 	**/
-	std::vector<std::vector<uint32> > _collision_grid;
+	CollisionGrid _collision_grid;
 
 	/** \brief A map containing pointers to all of the objects on a map.
 	*** The sprite's unique identifier integer is used as the map key.
@@ -732,8 +1043,65 @@ private:
 	**/
 	std::vector<ResidentZone*> _resident_zones;
 
+	//! \brief Files every object by location so that collision tests only need to examine nearby objects
+	ObjectGrid _object_grid;
+
+	//! \brief Holds the results of object grid searches, retained to avoid allocating a new vector for every search
+	std::vector<MapObject*> _grid_results;
+
+	//! \brief The path search state of every collision grid element, stored by row and reused by every call to FindPath()
+	std::vector<PathSearchNode> _path_nodes;
+
+	//! \brief The binary heap of open nodes used by FindPath(), retained so its memory is reused between calls
+	std::vector<PathSearchEntry> _path_open;
+
+	//! \brief The ID of the most recent path search
+	uint32 _path_search_id;
+
+	//! \brief The flow fields used by FindPursuitDirection(), indexed by the bit position of the context they were built for
+	FlowField _flow_fields[OBJECT_GRID_NUM_CONTEXTS];
+
 	// ---------- Methods
 
+	//! \brief Refiles every object in the object grid
+	void _UpdateObjectGrid();
+
+	/** \brief Determines if a sprite with a given collision rectangle would collide with the map or another object
+	*** \param sprite A pointer to the sprite to check
+	*** \param coll_rect The collision rectangle to check for the sprite, which need not be where the sprite currently is
+	*** \param collision_object If not NULL, set to point to the object collided with when an object collision is found
+	*** \param ignore_sprites If true, collisions with any type of sprite object will be disregarded
+	*** \return The type of collision detected, which may include NO_COLLISION if none was detected
+	***
+	*** This performs the same tests as DetectCollision() but sends no notification events and ignores the
+	*** collidable property of the sprite. It is shared by DetectCollision() and FindPath().
+	**/
+	COLLISION_TYPE _DetectCollision(const VirtualSprite* sprite, const MapRectangle& coll_rect, MapObject** collision_object, bool ignore_sprites);
+
+	/** \brief Determines if a sprite could stand at a collision grid element when finding a path
+	*** \param sprite A pointer to the sprite that the path is being found for
+	*** \param row The row of the collision grid element
+	*** \param col The column of the collision grid element
+	*** \return True if the sprite would collide with the map or a stationary object there
+	*** \note The sprite's current position offsets are used with the row and column, as FindPath() has always done
+	**/
+	bool _IsPathNodeBlocked(const VirtualSprite* sprite, int16 row, int16 col);
+
+	/** \brief Rebuilds a flow field so that it leads to a target's current collision grid element
+	*** \param field A reference to the field to rebuild
+	*** \param target A pointer to the sprite that the field should lead to
+	**/
+	void _BuildFlowField(FlowField& field, const VirtualSprite* target);
+
+	/** \brief Determines if a node of a flow field is blocked, testing the node if the current build has not yet done so
+	*** \param field A reference to the field being built
+	*** \param target A pointer to the sprite that the field is being built for
+	*** \param row The row of the collision grid element
+	*** \param col The column of the collision grid element
+	*** \return True if the node lies outside of the collision grid or the target could not stand there
+	**/
+	bool _IsFlowFieldNodeBlocked(FlowField& field, const VirtualSprite* target, int16 row, int16 col);
+
 	/** \brief Attempts to align a sprite's collision rectangle alongside whatever the sprite has collided against
 	*** \param sprite The sprite to examine for positional alignment
 	*** \param direction The direction in which the alignment should take place (only NORTH, SOUTH, EAST, and WEST are valid values)
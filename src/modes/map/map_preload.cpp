@@ -0,0 +1,207 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2015 by The Allacrost Project
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    map_preload.cpp
+*** \author  Tyler Olsen, roots@allacrost.org
+*** \brief   Source file for loading maps ahead of a transition
+*** ***************************************************************************/
+
+#include <SDL2/SDL.h>
+
+// Allacrost engines
+#include "script.h"
+#include "video.h"
+
+#include "common.h"
+
+// Local map mode headers
+#include "map_preload.h"
+#include "map_utils.h"
+
+using namespace std;
+using namespace hoa_utils;
+using namespace hoa_common;
+using namespace hoa_script;
+using namespace hoa_video;
+
+namespace hoa_map {
+
+namespace private_map {
+
+MapPreload::MapPreload(const string& script_filename) :
+	_script_filename(script_filename),
+	_state(PRELOAD_WAITING),
+	_data_loaded(false),
+	_thread(NULL),
+	_mutex(NULL),
+	_thread_finished(false),
+	_next_tileset(0)
+{}
+
+
+
+MapPreload::~MapPreload() {
+	_WaitForThread();
+
+	if (_mutex != NULL)
+		SDL_DestroyMutex(_mutex);
+
+	// Images that the map has already loaded were claimed from the decoder, so this only frees decodes that went unused
+	for (uint32 i = 0; i < _image_filenames.size(); i++) {
+		TextureManager->DiscardPredecodedImage(_image_filenames[i]);
+	}
+}
+
+
+
+void MapPreload::Update() {
+	switch (_state) {
+		case PRELOAD_WAITING:
+			_Start();
+			break;
+
+		case PRELOAD_READING_DATA: {
+			SDL_LockMutex(_mutex);
+			bool finished = _thread_finished;
+			SDL_UnlockMutex(_mutex);
+			if (finished == false)
+				break;
+
+			_WaitForThread();
+			if (_data_loaded == false) {
+				IF_PRINT_DEBUG(MAP_DEBUG) << "no compiled map data is available to preload for map: " << _script_filename << endl;
+				_state = PRELOAD_FAILED;
+			}
+			else {
+				_state = PRELOAD_QUEUEING_IMAGES;
+			}
+			break;
+		}
+
+		case PRELOAD_QUEUEING_IMAGES: {
+			// Only a single tileset definition file is read per update to keep the time spent in the Lua state short
+			if (_next_tileset >= _map_data.tileset_filenames.size()) {
+				IF_PRINT_DEBUG(MAP_DEBUG) << "finished preloading map: " << _script_filename << endl;
+				_state = PRELOAD_COMPLETE;
+				break;
+			}
+
+			const string& definition_filename = _map_data.tileset_filenames[_next_tileset];
+			_next_tileset++;
+
+			ReadScriptDescriptor definition_file;
+			if (definition_file.OpenFile(definition_filename) == false) {
+				IF_PRINT_WARNING(MAP_DEBUG) << "failed to open tileset definition file: " << definition_filename << endl;
+				break;
+			}
+			definition_file.OpenTable(DetermineLuaFileTablespaceName(definition_filename));
+			string image_filename = definition_file.ReadString("image");
+			definition_file.CloseFile();
+
+			if (TextureManager->PredecodeImage(image_filename, true) == true)
+				_image_filenames.push_back(image_filename);
+			break;
+		}
+
+		default:
+			break;
+	}
+} // void MapPreload::Update()
+
+
+
+const MapData* MapPreload::GetMapData() {
+	if (_state == PRELOAD_READING_DATA) {
+		_WaitForThread();
+		_state = (_data_loaded == true) ? PRELOAD_QUEUEING_IMAGES : PRELOAD_FAILED;
+	}
+
+	return (_data_loaded == true) ? &_map_data : NULL;
+}
+
+
+
+void MapPreload::_Start() {
+	// The map script must be opened to find the name of its data file
+	ReadScriptDescriptor map_script;
+	if (map_script.OpenFile(_script_filename) == false) {
+		IF_PRINT_WARNING(MAP_DEBUG) << "failed to open map script file: " << _script_filename << endl;
+		_state = PRELOAD_FAILED;
+		return;
+	}
+	map_script.OpenTable(DetermineLuaFileTablespaceName(_script_filename));
+	_data_filename = map_script.ReadString("data_file");
+	map_script.CloseFile();
+
+	// Determining the compiled filename may create the cache directory, so it is not done on the worker thread
+	_compiled_filename = _map_data.GetCompiledFilename(_data_filename);
+
+	_mutex = SDL_CreateMutex();
+	if (_mutex == NULL) {
+		IF_PRINT_WARNING(MAP_DEBUG) << "failed to create a mutex for the map preload: " << SDL_GetError() << endl;
+		_state = PRELOAD_FAILED;
+		return;
+	}
+
+	_thread_finished = false;
+	_state = PRELOAD_READING_DATA;
+	_thread = SDL_CreateThread(_WorkerThreadEntry, "MapPreload", this);
+	if (_thread == NULL) {
+		IF_PRINT_WARNING(MAP_DEBUG) << "failed to create the map preload thread: " << SDL_GetError() << endl;
+		_state = PRELOAD_FAILED;
+	}
+}
+
+
+
+void MapPreload::_WaitForThread() {
+	if (_thread == NULL)
+		return;
+
+	SDL_WaitThread(_thread, NULL);
+	_thread = NULL;
+}
+
+
+
+int MapPreload::_WorkerThreadEntry(void* data) {
+	static_cast<MapPreload*>(data)->_WorkerThread();
+	return 0;
+}
+
+
+
+void MapPreload::_WorkerThread() {
+	_data_loaded = _map_data.LoadCompiled(_data_filename, _compiled_filename);
+
+	// Mapping a file does not read it, so touch every page of the arrays to bring them into memory now rather
+	// than when the map is entered
+	if (_data_loaded == true) {
+		const uint32 page_size = 4096;
+		const uint8* collision = reinterpret_cast<const uint8*>(_map_data.collision_grid);
+		const uint8* tiles = reinterpret_cast<const uint8*>(_map_data.tiles);
+		uint32 collision_bytes = _map_data.collision_row_count * _map_data.collision_column_count * sizeof(uint32);
+		uint32 tile_bytes = _map_data.context_count * _map_data.tile_layer_count * _map_data.row_count * _map_data.column_count * sizeof(int16);
+
+		volatile uint8 sum = 0;
+		for (uint32 i = 0; i < collision_bytes; i += page_size)
+			sum += collision[i];
+		for (uint32 i = 0; i < tile_bytes; i += page_size)
+			sum += tiles[i];
+	}
+
+	SDL_LockMutex(_mutex);
+	_thread_finished = true;
+	SDL_UnlockMutex(_mutex);
+}
+
+} // namespace private_map
+
+} // namespace hoa_map
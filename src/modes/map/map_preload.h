@@ -0,0 +1,146 @@
+///////////////////////////////////////////////////////////////////////////////
+//            Copyright (C) 2004-2015 by The Allacrost Project
+//                         All Rights Reserved
+//
+// This code is licensed under the GNU GPL version 2. It is free software
+// and you may modify it and/or redistribute it under the terms of this license.
+// See http://www.gnu.org/copyleft/gpl.html for details.
+///////////////////////////////////////////////////////////////////////////////
+
+/** ****************************************************************************
+*** \file    map_preload.h
+*** \author  Tyler Olsen, roots@allacrost.org
+*** \brief   Header file for loading maps ahead of a transition
+***
+*** Constructing a MapMode loads everything the map needs while the screen is
+*** frozen. A map preload does the expensive parts of that work for a map that
+*** the player is likely to enter next while the current map continues to run.
+*** The compiled map data is read on a worker thread and the tileset images are
+*** decoded by the video engine's image decoder threads. When the map is finally
+*** entered, its constructor picks up the preload and only has to copy the data
+*** into place and upload the decoded images to texture memory.
+***
+*** Work that requires the Lua state, the audio engine, or the OpenGL context is
+*** still performed by the MapMode constructor on the main thread.
+*** ***************************************************************************/
+
+#ifndef __MAP_PRELOAD_HEADER__
+#define __MAP_PRELOAD_HEADER__
+
+#include <SDL2/SDL_thread.h>
+#include <SDL2/SDL_mutex.h>
+
+// Allacrost utilities
+#include "utils.h"
+#include "defs.h"
+
+// Local map mode headers
+#include "map_data.h"
+
+namespace hoa_map {
+
+namespace private_map {
+
+//! \brief The maximum number of maps that may be preloaded at once. Further requests discard the least recently requested preload.
+const uint32 MAX_MAP_PRELOADS = 4;
+
+//! \brief The stages that a map preload passes through
+enum MAP_PRELOAD_STATE {
+	PRELOAD_INVALID          = 0,
+	PRELOAD_WAITING          = 1, //!< The preload was requested but no work has been done for it yet
+	PRELOAD_READING_DATA     = 2, //!< The worker thread is reading the compiled map data
+	PRELOAD_QUEUEING_IMAGES  = 3, //!< Tileset images are being queued for decoding, one tileset per update
+	PRELOAD_COMPLETE         = 4, //!< All work was handed off, although images may still be decoding
+	PRELOAD_FAILED           = 5, //!< The preload could not be performed and the map will be loaded normally
+	PRELOAD_TOTAL            = 6
+};
+
+
+/** ****************************************************************************
+*** \brief Loads the data and tileset images of a single map in the background
+***
+*** A preload advances a small step each time that Update() is called, so that none
+*** of the main thread work it does causes a noticeable stall in the current map.
+*** The map data is only preloaded when a compiled data file exists for it. A map
+*** which has never been loaded before has its data read by its constructor as usual,
+*** which also compiles it for the next time.
+***
+*** \note All methods of this class must be called from the main thread.
+*** ***************************************************************************/
+class MapPreload {
+public:
+	/** \param script_filename The name of the script file of the map to preload
+	*** \note No work is started until the first call to Update()
+	**/
+	MapPreload(const std::string& script_filename);
+
+	//! \brief Waits for the worker thread and frees any decoded images that were never claimed
+	~MapPreload();
+
+	//! \brief Performs the next step of the preload
+	void Update();
+
+	/** \brief Retrieves the preloaded map data, waiting for the worker thread if it has not finished
+	*** \return A pointer to the map data, or NULL if the data could not be preloaded
+	*** \note The data remains valid for the lifetime of this object
+	**/
+	const MapData* GetMapData();
+
+	const std::string& GetScriptFilename() const
+		{ return _script_filename; }
+
+	MAP_PRELOAD_STATE GetState() const
+		{ return _state; }
+
+private:
+	//! \brief The name of the script file of the map being preloaded
+	std::string _script_filename;
+
+	//! \brief The name of the data file of the map, read from the map script when the preload starts
+	std::string _data_filename;
+
+	//! \brief The name of the compiled form of the data file
+	std::string _compiled_filename;
+
+	//! \brief The current stage of the preload
+	MAP_PRELOAD_STATE _state;
+
+	//! \brief The map data, which belongs to the worker thread while it is running
+	MapData _map_data;
+
+	//! \brief Set by the worker thread to indicate whether the map data was loaded
+	bool _data_loaded;
+
+	//! \brief The worker thread that reads the map data, or NULL if it is not running
+	SDL_Thread* _thread;
+
+	//! \brief Protects _thread_finished
+	SDL_mutex* _mutex;
+
+	//! \brief Set to true by the worker thread when it has finished
+	bool _thread_finished;
+
+	//! \brief The index of the next tileset whose image should be queued for decoding
+	uint32 _next_tileset;
+
+	//! \brief The names of the image files that were queued for decoding
+	std::vector<std::string> _image_filenames;
+
+	//! \brief Reads the data file name from the map script and starts the worker thread
+	void _Start();
+
+	//! \brief Waits for the worker thread to exit if it is running
+	void _WaitForThread();
+
+	//! \brief The entry point of the worker thread. The data argument is a pointer to the MapPreload.
+	static int _WorkerThreadEntry(void* data);
+
+	//! \brief Maps the compiled map data into memory and reads every page of it so that it is resident
+	void _WorkerThread();
+}; // class MapPreload
+
+} // namespace private_map
+
+} // namespace hoa_map
+
+#endif // __MAP_PRELOAD_HEADER__
@@ -121,6 +121,9 @@ void VirtualSprite::Update() {
 
 		_ResolveCollision(collision_type, collision_object);
 	}
+
+	// Refile the sprite right away so that the sprites updated after this one see where it has moved to
+	MapMode::CurrentInstance()->GetObjectSupervisor()->UpdateObjectGrid(this);
 }
 
 
@@ -1036,7 +1039,14 @@ void EnemySprite::Update() {
 					 && (!_zone->IsRoamingRestrained() ||
 					 _zone->IsInsideZone(MapMode::CurrentInstance()->GetPlayerSprite()->x_position, MapMode::CurrentInstance()->GetPlayerSprite()->y_position)))))
 				{
-					if (xdelta > -0.5 && xdelta < 0.5 && ydelta < 0)
+					// Follow the shared flow field towards the player so that walls are walked around rather than into
+					uint16 pursuit_direction = MapMode::CurrentInstance()->GetObjectSupervisor()->FindPursuitDirection(this,
+						MapMode::CurrentInstance()->GetPlayerSprite());
+
+					// Head straight for the player when the flow field has no direction, such as when the two are on the same grid element
+					if (pursuit_direction != 0)
+						SetDirection(pursuit_direction);
+					else if (xdelta > -0.5 && xdelta < 0.5 && ydelta < 0)
 						SetDirection(SOUTH);
 					else if (xdelta > -0.5 && xdelta < 0.5 && ydelta > 0)
 						SetDirection(NORTH);
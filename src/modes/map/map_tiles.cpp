@@ -21,6 +21,7 @@
 
 // Local map mode headers
 #include "map.h"
+#include "map_data.h"
 #include "map_tiles.h"
 
 using namespace std;
@@ -41,8 +42,14 @@ void TileLayer::Draw(MAP_CONTEXT context) const {
 
 TileSupervisor::TileSupervisor() :
 	_row_count(0),
-	_column_count(0)
-{}
+	_column_count(0),
+	_chunk_row_count(0),
+	_chunk_column_count(0)
+{
+	for (uint32 i = 0; i < 32; i++) {
+		_context_indices[i] = -1;
+	}
+}
 
 
 
@@ -53,6 +60,7 @@ TileSupervisor::~TileSupervisor() {
 		delete(_tile_images[i]);
 
 	_tile_grid.clear();
+	_tile_chunks.clear();
 	_tile_images.clear();
 	_animated_tile_images.clear();
 }
@@ -72,50 +80,20 @@ MAP_CONTEXT TileSupervisor::GetInheritedContext(MAP_CONTEXT context) {
 
 
 
-void TileSupervisor::Load(ReadScriptDescriptor& map_file, const MapMode* map_instance) {
-	// TODO: Add some more error checking in this function (such as checking for script errors after reading blocks of data from the map file)
-
-	// ---------- (1) Load the map properties and do some basic sanity checks
-	_row_count = map_file.ReadUInt("map_height");
-	_column_count = map_file.ReadUInt("map_length");
-	uint32 tileset_count = map_file.ReadUInt("number_tilesets");
-	uint32 tile_layer_count = map_file.ReadUInt("number_tile_layers");
-	uint32 map_context_count = map_file.ReadUInt("number_map_contexts");
-
-	if (map_file.GetTableSize("tileset_filenames") != tileset_count) {
-		PRINT_ERROR << "the number of tilesets declared does not match the size of the tileset_filenames table" << endl;
-		return;
-	}
-
-	if (map_file.GetTableSize("tile_layer_names") != tile_layer_count) {
-		PRINT_ERROR << "the number of tile layers declared does not match the size of the tile_layer_names table" << endl;
-		return;
-	}
-
-	if (map_file.GetTableSize("map_context_inheritance") != map_context_count) {
-		PRINT_ERROR << "the number of map contexts declared does not match the size of the map_context_inheritance table" << endl;
-		return;
-	}
-
-	// For collision_grid and map_tiles tables, we only check that the number of rows are correct and not columns in the interest of reducing load time
-	if (map_file.GetTableSize("collision_grid") != _row_count * 2) {
-		PRINT_ERROR << "the collision_grid table size is incorrect" << endl;
-		return;
-	}
-
-
-	if (map_file.GetTableSize("map_tiles") != _row_count) {
-		PRINT_ERROR << "the map_tiles table size was not equal to the number of tile rows specified by the map" << endl;
-		return;
-	}
+void TileSupervisor::Load(const MapData& map_data, const MapMode* map_instance) {
+	// ---------- (1) Load the map properties. The map data has already been checked for consistency when it was loaded.
+	_row_count = map_data.row_count;
+	_column_count = map_data.column_count;
+	uint32 tileset_count = map_data.tileset_count;
+	uint32 tile_layer_count = map_data.tile_layer_count;
+	uint32 map_context_count = map_data.context_count;
 
 	// ---------- (2) Construct the tile layer and map context containers
 	for (uint32 i = 0; i < tile_layer_count; ++i)
 		_tile_layers.push_back(TileLayer(i));
 
 	vector<MAP_CONTEXT> map_contexts;
-	vector<int32> context_inheritance;
-	map_file.ReadIntVector("map_context_inheritance", context_inheritance);
+	vector<int32> context_inheritance = map_data.context_inheritance;
 
 	// For each context, populate the map_context vector and the _inherited_contexts map
 	for (uint32 i = 0; i < map_context_count; ++i) {
@@ -134,15 +112,26 @@ void TileSupervisor::Load(ReadScriptDescriptor& map_file, const MapMode* map_ins
 
 	// ---------- (3) Load all of the tileset images that are used by this map
 	// Contains all of the definition filenames used for each tileset
-	vector<string> tileset_definition_filenames;
+	const vector<string>& tileset_definition_filenames = map_data.tileset_filenames;
 	// The image filename corresponding to each tileset definition
 	vector<string> image_filenames;
 	// Temporarily retains all tile images loaded for each tileset. Each inner vector contains 256 StillImage objects
 	vector<vector<StillImage> > tileset_images;
 
-	// First we have to load the definition file for each tileset and retrieve the corresponding image filename in it
+	// Prepare the container to hold the tile images of every tileset. The outer vector must not be resized after this
+	// point, as the image batch below holds pointers to the inner vectors.
+	tileset_images.resize(tileset_count, vector<StillImage>(TILES_PER_TILESET));
+	for (uint32 i = 0; i < tileset_count; i++) {
+		// The map mode coordinate system used corresponds to a tile size of (2.0, 2.0)
+		for (uint32 j = 0; j < TILES_PER_TILESET; j++) {
+			tileset_images[i][j].SetDimensions(2.0f, 2.0f);
+		}
+	}
+
+	// Load the definition file for each tileset and retrieve the corresponding image filename in it. Each tileset image
+	// begins decoding in the background as soon as its filename is known, while the remaining definition files are read.
+	ImageLoadBatch tileset_batch;
 	ReadScriptDescriptor definition_file;
-	map_file.ReadStringVector("tileset_filenames", tileset_definition_filenames);
 	for (uint32 i = 0; i < tileset_count; ++i) {
 		if (definition_file.OpenFile(tileset_definition_filenames[i]) == false) {
 			PRINT_ERROR << "failed to load tileset definition file: " << tileset_definition_filenames[i] << endl;
@@ -151,21 +140,14 @@ void TileSupervisor::Load(ReadScriptDescriptor& map_file, const MapMode* map_ins
 		definition_file.OpenTable(DetermineLuaFileTablespaceName(tileset_definition_filenames[i]));
 		image_filenames.push_back(definition_file.ReadString("image"));
 		definition_file.CloseFile();
-	}
-
-	// Prepare the container to hold the tile image files and load each tileset into them
-	for (uint32 i = 0; i < tileset_count; i++) {
-		tileset_images.push_back(vector<StillImage>(TILES_PER_TILESET));
-		// The map mode coordinate system used corresponds to a tile size of (2.0, 2.0)
-		for (uint32 j = 0; j < TILES_PER_TILESET; j++) {
-			tileset_images[i][j].SetDimensions(2.0f, 2.0f);
-		}
 
 		// Each tileset image is 512x512 pixels, yielding 16 * 16 (== 256) tiles of 32x32 pixels each
-		if (ImageDescriptor::LoadMultiImageFromElementGrid(tileset_images[i], image_filenames[i], 16, 16) == false) {
-			PRINT_ERROR << "failed to load tileset image: " << image_filenames[i] << endl;
-			exit(1);
-		}
+		tileset_batch.AddMultiImage(&tileset_images[i], image_filenames[i], 16, 16);
+	}
+
+	if (tileset_batch.Finish() == false) {
+		PRINT_ERROR << "failed to load one or more tileset images for map file: " << map_data.filename << endl;
+		exit(1);
 	}
 
 	// ---------- (4) Read in the map tile data for all layers and all contexts
@@ -173,51 +155,38 @@ void TileSupervisor::Load(ReadScriptDescriptor& map_file, const MapMode* map_ins
 	// within the tileset is also determined by the value, where the first 16 indeces in the tileset range are the tiles of the first row
 	// (left to right), and so on.
 
-	// First allocate all of the tile objects needed for each context before reading in the tile data
-	MapTile blank_tile(tile_layer_count); // Used to size each MapTile in the _tile_grid appropriately
+	// The map data holds the tiles of each context as a single block in the same layout as _tile_grid, so each context
+	// is copied over whole. The index of each context is recorded as well.
+	uint32 context_tile_count = tile_layer_count * _row_count * _column_count;
+	_tile_grid.resize(map_context_count);
 	for (uint32 i = 0; i < map_context_count; ++i) {
-		_tile_grid.insert(make_pair(map_contexts[i], vector<vector<MapTile> >(_row_count)));
-		for (uint32 r = 0; r < _row_count; r++) {
-			_tile_grid[map_contexts[i]][r].resize(_column_count, blank_tile);
-		}
+		_context_indices[i] = static_cast<int8>(i);
+		_tile_grid[i].assign(map_data.tiles + i * context_tile_count, map_data.tiles + (i + 1) * context_tile_count);
 	}
 
-	// Now read in all of the tile data and write it to the correct location in the _tile_grid
-	vector<int32> tile_data;
-	map_file.OpenTable("map_tiles");
-	for (uint32 y = 0; y < _row_count; ++y) {
-		map_file.OpenTable(y);
-		for (uint32 x = 0; x < _column_count; ++x) {
-			tile_data.clear();
-			map_file.ReadIntVector(x, tile_data);
-			for (uint32 c = 0; c < map_context_count; ++c) {
-				MAP_CONTEXT context = map_contexts[c];
-				for (uint32 l = 0, data_index = c * tile_layer_count; l < tile_layer_count; ++l, ++data_index) {
-					_tile_grid[context][y][x].tile_layers[l] = tile_data[data_index];
-				}
-			}
-		}
-		map_file.CloseTable();
-	}
-	map_file.CloseTable();
-
-	// ---------- (5) Determine which tiles in each tileset are referenced in this map
 	// Used to determine whether each tile is used by the map or not. An entry of UNREFERENCED_TILE indicates that particular tile is not used
 	vector<int16> tile_references;
 	// Set size to be equal to the total number of tiles and initialize all entries to unrefereced
 	tile_references.assign(tileset_count * TILES_PER_TILESET, UNREFERENCED_TILE);
 
-	for (map<MAP_CONTEXT, vector<vector<MapTile> > >::iterator i = _tile_grid.begin(); i != _tile_grid.end(); i++) {
-		for (uint32 r = 0; r < _row_count; r++) {
-			for (uint32 c = 0; c < _column_count; c++) {
-				for (uint32 l = 0; l < tile_layer_count; l++) {
-					if ((i->second)[r][c].tile_layers[l] >= 0)
-						tile_references[(i->second)[r][c].tile_layers[l]] = 0;
-				}
+	// Every tile that was copied is also marked as referenced here, which is step (5) below, so that the tile data need
+	// only be examined once. Tiles outside the range of the tilesets used by the map are discarded.
+	for (uint32 i = 0; i < _tile_grid.size(); i++) {
+		vector<int16>& tiles = _tile_grid[i];
+		for (uint32 j = 0; j < tiles.size(); j++) {
+			if (tiles[j] >= static_cast<int32>(tile_references.size())) {
+				IF_PRINT_WARNING(MAP_DEBUG) << "map data contained a tile outside of the range of its tilesets: " << tiles[j] << endl;
+				tiles[j] = UNREFERENCED_TILE;
+			}
+			else if (tiles[j] >= 0) {
+				tile_references[tiles[j]] = 0;
 			}
 		}
 	}
 
+	// ---------- (5) Determine which tiles in each tileset are referenced in this map
+	// This was done while the tile data was read in above
+
 	// ---------- (6) Translate the tileset tile indeces into indeces for the vector of tile images
 	// Here, we have to convert the original tile indeces defined in the map file into a new form. The original index
 	// indicates the tileset where the tile is used and its location in that tileset. We need to convert those indeces
@@ -234,14 +203,11 @@ void TileSupervisor::Load(ReadScriptDescriptor& map_file, const MapMode* map_ins
 	}
 
 	// Now, go back and re-assign all tile layer indeces with the translated indeces
-	for (map<MAP_CONTEXT, vector<vector<MapTile> > >::iterator i = _tile_grid.begin(); i != _tile_grid.end(); i++) {
-		for (uint32 r = 0; r < _row_count; r++) {
-			for (uint32 c = 0; c < _column_count; c++) {
-				for (uint32 l = 0; l < tile_layer_count; l++) {
-					if ((i->second)[r][c].tile_layers[l] >= 0)
-						(i->second)[r][c].tile_layers[l] = tile_references[(i->second)[r][c].tile_layers[l]];
-				}
-			}
+	for (uint32 i = 0; i < _tile_grid.size(); i++) {
+		vector<int16>& tiles = _tile_grid[i];
+		for (uint32 j = 0; j < tiles.size(); j++) {
+			if (tiles[j] >= 0)
+				tiles[j] = tile_references[tiles[j]];
 		}
 	}
 
@@ -298,12 +264,14 @@ void TileSupervisor::Load(ReadScriptDescriptor& map_file, const MapMode* map_ins
 				// Add the tile as a StillImage
 				if (tile_animations.find(reference) == tile_animations.end()) {
 					_tile_images.push_back(new StillImage(tileset_images[i][j]));
+					_animated_tile_flags.push_back(false);
 				}
 
 				// Add the tile as an AnimatedImage
 				else {
 					_tile_images.push_back(tile_animations[reference]);
 					_animated_tile_images.push_back(tile_animations[reference]);
+					_animated_tile_flags.push_back(true);
 					tile_animations.erase(reference);
 				}
 			}
@@ -316,7 +284,15 @@ void TileSupervisor::Load(ReadScriptDescriptor& map_file, const MapMode* map_ins
 
 	// Remove all tileset images. Any tiles which were not added to _tile_images will no longer exist in memory
 	tileset_images.clear();
-} // void TileSupervisor::Load(ReadScriptDescriptor& map_file, const MapMode* map_instance)
+
+	// ---------- (9) Allocate the tile chunks for every layer and context. Their drawing data is built when they are first drawn.
+	_chunk_row_count = (_row_count + TILE_CHUNK_LENGTH - 1) / TILE_CHUNK_LENGTH;
+	_chunk_column_count = (_column_count + TILE_CHUNK_LENGTH - 1) / TILE_CHUNK_LENGTH;
+	_tile_chunks.resize(map_context_count);
+	for (uint32 i = 0; i < map_context_count; ++i) {
+		_tile_chunks[i].resize(tile_layer_count * _chunk_row_count * _chunk_column_count);
+	}
+} // void TileSupervisor::Load(const MapData& map_data, const MapMode* map_instance)
 
 
 
@@ -337,29 +313,111 @@ void TileSupervisor::DrawTileLayer(uint16 layer_index, MAP_CONTEXT context) {
 		PRINT_ERROR << "invalid context argument: " << context << endl;
 		return;
 	}
+	int32 context_index = _GetContextIndex(context);
+	if (context_index < 0) {
+		PRINT_ERROR << "the map does not declare the context argument: " << context << endl;
+		return;
+	}
 
 	const MapFrame& frame = MapMode::CurrentInstance()->GetMapFrame();
-	MAP_CONTEXT inherited_context = GetInheritedContext(context);
+
+	// The range of tiles and chunks that are visible on the screen
+	uint16 first_row = static_cast<uint16>(frame.starting_row);
+	uint16 first_col = static_cast<uint16>(frame.starting_col);
+	uint16 last_row = first_row + frame.num_draw_rows - 1;
+	uint16 last_col = first_col + frame.num_draw_cols - 1;
+	if (last_row >= _row_count)
+		last_row = _row_count - 1;
+	if (last_col >= _column_count)
+		last_col = _column_count - 1;
+
+	uint16 first_chunk_row = first_row / TILE_CHUNK_LENGTH;
+	uint16 first_chunk_col = first_col / TILE_CHUNK_LENGTH;
+	uint16 last_chunk_row = last_row / TILE_CHUNK_LENGTH;
+	uint16 last_chunk_col = last_col / TILE_CHUNK_LENGTH;
+
+	// Tile images are drawn with center/bottom alignment, so the upper left corner of the tile at the starting row and
+	// column is one unit to the left and two units above the tile draw start position
+	float x_origin = frame.tile_x_start - 1.0f - (first_col * 2.0f);
+	float y_origin = frame.tile_y_start - 2.0f - (first_row * 2.0f);
 
 	VideoManager->SetDrawFlags(VIDEO_BLEND, 0);
-	VideoManager->Move(frame.tile_x_start, frame.tile_y_start);
-	for (uint32 r = static_cast<uint32>(frame.starting_row); r < static_cast<uint32>(frame.starting_row + frame.num_draw_rows); ++r)	{
-		for (uint32 c = static_cast<uint32>(frame.starting_col); c < static_cast<uint32>(frame.starting_col + frame.num_draw_cols); ++c)	{
-			// Draw a tile image if it exists at this location
-			if (_tile_grid[context][r][c].tile_layers[layer_index] >= 0) {
-				_tile_images[_tile_grid[context][r][c].tile_layers[layer_index]]->Draw();
-			}
-			else if (_tile_grid[context][r][c].tile_layers[layer_index] == INHERITED_TILE) {
-				if (_tile_grid[inherited_context][r][c].tile_layers[layer_index] >= 0) {
-					_tile_images[_tile_grid[inherited_context][r][c].tile_layers[layer_index]]->Draw();
-				}
+
+	// First draw the still tiles of each visible chunk, building the chunk if necessary
+	VideoManager->Move(x_origin, y_origin);
+	for (uint16 cr = first_chunk_row; cr <= last_chunk_row; ++cr) {
+		for (uint16 cc = first_chunk_col; cc <= last_chunk_col; ++cc) {
+			TileChunk& chunk = _GetTileChunk(context_index, layer_index, cr, cc);
+			if (chunk.needs_rebuild == true)
+				_BuildTileChunk(chunk, layer_index, context_index, cr, cc);
+			chunk.still_tiles.Draw();
+		}
+	}
+
+	// Then draw the visible animated tiles of each chunk. Tiles on the same layer do not overlap, so drawing these after
+	// the still tiles makes no visual difference.
+	for (uint16 cr = first_chunk_row; cr <= last_chunk_row; ++cr) {
+		for (uint16 cc = first_chunk_col; cc <= last_chunk_col; ++cc) {
+			const vector<AnimatedTile>& animated_tiles = _GetTileChunk(context_index, layer_index, cr, cc).animated_tiles;
+			for (uint32 i = 0; i < animated_tiles.size(); ++i) {
+				const AnimatedTile& tile = animated_tiles[i];
+				if (tile.row < first_row || tile.row > last_row || tile.col < first_col || tile.col > last_col)
+					continue;
+
+				VideoManager->Move(frame.tile_x_start + ((tile.col - first_col) * 2.0f), frame.tile_y_start + ((tile.row - first_row) * 2.0f));
+				_tile_images[tile.image_index]->Draw();
 			}
-			VideoManager->MoveRelative(2.0f, 0.0f);
 		}
-		VideoManager->MoveRelative(-static_cast<float>(frame.num_draw_cols * 2), 2.0f);
 	}
 }
 
+
+
+int32 TileSupervisor::_GetContextIndex(MAP_CONTEXT context) const {
+	uint32 bit = 0;
+	while (bit < 32 && (static_cast<uint32>(context) & (static_cast<uint32>(1) << bit)) == 0) {
+		bit++;
+	}
+	return (bit < 32) ? _context_indices[bit] : -1;
+}
+
+
+
+void TileSupervisor::_BuildTileChunk(TileChunk& chunk, uint16 layer_index, uint32 context_index, uint16 chunk_row, uint16 chunk_col) {
+	int32 inherited_index = _GetContextIndex(GetInheritedContext(static_cast<MAP_CONTEXT>(static_cast<uint32>(1) << context_index)));
+
+	chunk.still_tiles.Clear();
+	chunk.animated_tiles.clear();
+
+	uint16 end_row = (chunk_row + 1) * TILE_CHUNK_LENGTH;
+	uint16 end_col = (chunk_col + 1) * TILE_CHUNK_LENGTH;
+	if (end_row > _row_count)
+		end_row = _row_count;
+	if (end_col > _column_count)
+		end_col = _column_count;
+
+	for (uint16 r = chunk_row * TILE_CHUNK_LENGTH; r < end_row; ++r) {
+		for (uint16 c = chunk_col * TILE_CHUNK_LENGTH; c < end_col; ++c) {
+			int16 image_index = _GetTile(context_index, layer_index, r, c);
+			if (image_index == INHERITED_TILE && inherited_index >= 0) {
+				image_index = _GetTile(inherited_index, layer_index, r, c);
+			}
+
+			if (image_index < 0)
+				continue;
+
+			if (_animated_tile_flags[image_index] == true) {
+				chunk.animated_tiles.push_back(AnimatedTile(r, c, image_index));
+			}
+			else {
+				chunk.still_tiles.AddImage(*(static_cast<StillImage*>(_tile_images[image_index])), c * 2.0f, r * 2.0f);
+			}
+		}
+	}
+
+	chunk.needs_rebuild = false;
+} // void TileSupervisor::_BuildTileChunk(...)
+
 } // namespace private_map
 
 } // namespace hoa_map
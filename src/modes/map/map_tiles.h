@@ -23,6 +23,9 @@
 #include "defs.h"
 #include "utils.h"
 
+// Allacrost engines
+#include "video.h"
+
 // Local map mode headers
 #include "map_utils.h"
 
@@ -30,34 +33,49 @@ namespace hoa_map {
 
 namespace private_map {
 
+//! \brief The number of rows and columns of tiles that are grouped into each tile chunk
+const uint16 TILE_CHUNK_LENGTH = 16;
+
+//! \brief The location and image index of an animated tile within a tile chunk
+class AnimatedTile {
+public:
+	AnimatedTile(uint16 row_, uint16 col_, uint16 image_index_) :
+		row(row_), col(col_), image_index(image_index_) {}
+
+	//! \brief The row and column of the tile on the map
+	uint16 row, col;
+
+	//! \brief The index of the tile's image in the TileSupervisor's tile image container
+	uint16 image_index;
+}; // class AnimatedTile
+
+
 /** ****************************************************************************
-*** \brief Holds the indeces to the images used for a particular tile on the map
+*** \brief Prebuilt drawing data for a square section of a single tile layer in a single context
 ***
-*** The images that a tile uses are not stored within this class. This class
-*** only holds indices to the container class holding those images. This class
-*** also does not contain any information about the collision grid. That information
-*** is maintained in the map object manager.
+*** Drawing a tile layer one image at a time requires a draw cursor movement, several container
+*** lookups, and a separate quad submission for every tile on the screen. Instead, the still tiles
+*** of each TILE_CHUNK_LENGTH x TILE_CHUNK_LENGTH section of a layer are placed into a static sprite
+*** batch which is drawn with a single call per texture sheet. Animated tiles change their image every
+*** few frames, so they are kept out of the batch and drawn individually.
 ***
-*** \note The reason that tiles do not contain collision information is that
-*** each tile is 32x32 pixels, but collision is defined on a 16x16 granularity,
-*** meaning that there are four collision sections to each tile. Certain code
-*** such as pathfinding is more simple if all collision information is kept in
-*** in another form of container.
+*** Chunks are built the first time that they are visible and are only rebuilt when marked as
+*** needing it. Tiles that are inherited from another context are resolved when the chunk is built.
 *** ***************************************************************************/
-class MapTile {
+class TileChunk {
 public:
-	/** \name Tile Layer Indeces
-	*** \brief Indeces to the tile image container, where each element corresponds to a different tile layer
-	*** \note A negative value means that no image is registered to that tile layer
-	**/
-	std::vector<int16> tile_layers;
+	TileChunk() :
+		needs_rebuild(true) {}
 
-	MapTile()
-		{}
+	//! \brief Set to true when the tiles in this chunk have changed and the drawing data must be rebuilt
+	bool needs_rebuild;
 
-	MapTile(uint32 layer_count) :
-		tile_layers(layer_count, -1) { tile_layers.shrink_to_fit(); }
-}; // class MapTile
+	//! \brief The still tiles in this chunk, positioned in tile grid units (two units per tile)
+	hoa_video::StaticSpriteBatch still_tiles;
+
+	//! \brief All tiles in this chunk that use animated images
+	std::vector<AnimatedTile> animated_tiles;
+}; // class TileChunk
 
 
 /** ****************************************************************************
@@ -133,12 +151,11 @@ public:
 	MAP_CONTEXT GetInheritedContext(MAP_CONTEXT context);
 	//@}
 
-	/** \brief Handles all operations on loading tilesets and tile images from the map data file
-	*** \param map_file A reference to the Lua file containing the map data
+	/** \brief Handles all operations on loading tilesets and tile images from the map data
+	*** \param map_data A reference to the loaded map data
 	*** \param map_instance A pointer to the MapMode object which invoked this function
-	*** \note The map file should already be opened with no Lua tables open
 	**/
-	void Load(hoa_script::ReadScriptDescriptor& map_file, const MapMode* map_instance);
+	void Load(const MapData& map_data, const MapMode* map_instance);
 
 	//! \brief Updates all animated tile images
 	void Update();
@@ -165,18 +182,28 @@ private:
 	**/
 	uint16 _column_count;
 
+	//! \brief The number of rows and columns of tile chunks needed to cover the map
+	uint16 _chunk_row_count, _chunk_column_count;
+
 	//! \brief Holds a TileLayer object for each tile layer loaded from the map
 	std::vector<TileLayer> _tile_layers;
 
 	//! \brief A mapping of each context to the context that it inherits from. Set to MAP_CONTEXT_NONE for a context that does not inherit
 	std::map<MAP_CONTEXT, MAP_CONTEXT> _inherited_contexts;
 
-	/** \brief A map of 2D vectors that contains all of the map's tile objects.
-	*** Each key-value pair in the std::map represents a map context, thus the size of the std::map is equal to
-	*** number of contexts in the game map (up to 32). The 2D vector represents the rows and columns of tiles,
-	*** respectively, for the given map context.
+	/** \brief The image index of every tile of every layer, with one flat array for each map context
+	*** The outer vector is indexed by context index (see _context_indices). Each inner vector is laid out as
+	*** [layer][row][column], so that the tiles of one row of a layer are adjacent in memory. Use _GetTile() to
+	*** retrieve a particular tile. A negative value means that no image is registered to that tile.
+	*** \note Tiles do not contain collision information, because each tile is 32x32 pixels but collision is defined
+	*** on a 16x16 granularity. The collision grid is maintained by the ObjectSupervisor.
+	**/
+	std::vector<std::vector<int16> > _tile_grid;
+
+	/** \brief Translates the bit position of a map context into its index in _tile_grid and _tile_chunks
+	*** Contexts which the map does not declare hold -1.
 	**/
-	std::map<MAP_CONTEXT, std::vector<std::vector<MapTile> > > _tile_grid;
+	int8 _context_indices[32];
 
 	//! \brief Contains the image objects for all map tiles, both still and animated.
 	std::vector<hoa_video::ImageDescriptor*> _tile_images;
@@ -186,6 +213,44 @@ private:
 	*** _tile_images vector, which contains both still and animated images.
 	**/
 	std::vector<hoa_video::AnimatedImage*> _animated_tile_images;
+
+	/** \brief Prebuilt drawing data for every tile layer of every context
+	*** The outer vector is indexed by context index. The inner vector holds the chunks of every tile layer in order,
+	*** with the chunks of each layer stored in row-major order. Use _GetTileChunk() to retrieve a particular chunk.
+	**/
+	std::vector<std::vector<TileChunk> > _tile_chunks;
+
+	//! \brief Holds true for each element of _tile_images that is an AnimatedImage
+	std::vector<bool> _animated_tile_flags;
+
+	// ---------- Private methods
+
+	/** \brief Returns the index of a map context in _tile_grid and _tile_chunks
+	*** \param context The context to find the index of, which must have exactly one bit set
+	*** \return The index of the context, or -1 if the map does not declare that context
+	**/
+	int32 _GetContextIndex(MAP_CONTEXT context) const;
+
+	/** \brief Returns the image index of a tile of a layer and context at a given row and column
+	*** \note None of the arguments are checked for validity
+	**/
+	int16& _GetTile(uint32 context_index, uint32 layer_index, uint32 row, uint32 col)
+		{ return _tile_grid[context_index][(layer_index * _row_count + row) * _column_count + col]; }
+
+	/** \brief Returns the tile chunk of a layer and context at a given chunk row and column
+	*** \note None of the arguments are checked for validity
+	**/
+	TileChunk& _GetTileChunk(uint32 context_index, uint16 layer_index, uint16 chunk_row, uint16 chunk_col)
+		{ return _tile_chunks[context_index][(layer_index * _chunk_row_count + chunk_row) * _chunk_column_count + chunk_col]; }
+
+	/** \brief Rebuilds the drawing data for a tile chunk from the tile grid
+	*** \param chunk A reference to the chunk to rebuild
+	*** \param layer_index The index of the tile layer that the chunk belongs to
+	*** \param context_index The index of the context that the chunk belongs to
+	*** \param chunk_row The row of the chunk
+	*** \param chunk_col The column of the chunk
+	**/
+	void _BuildTileChunk(TileChunk& chunk, uint16 layer_index, uint32 context_index, uint16 chunk_row, uint16 chunk_col);
 }; // class TileSupervisor
 
 } // namespace private_map
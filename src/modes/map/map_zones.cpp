@@ -263,26 +263,44 @@ void ContextZone::AddSection(uint16 left_col, uint16 right_col, uint16 top_row,
 
 void ContextZone::Update() {
 	int16 index;
+	ObjectSupervisor* supervisor = MapMode::CurrentInstance()->GetObjectSupervisor();
+
+	for (uint32 s = 0; s < _sections.size(); ++s) {
+		// Only objects filed in the object grid near the section can have their position inside of it. An object's position
+		// lies within its collision rectangle, up to one grid element to the left of and above it.
+		MapRectangle area;
+		area.left = static_cast<float>(_sections[s].left_col);
+		area.right = static_cast<float>(_sections[s].right_col) + 1.0f;
+		area.top = static_cast<float>(_sections[s].top_row);
+		area.bottom = static_cast<float>(_sections[s].bottom_row) + 1.0f;
+		supervisor->_object_grid.FindObjects(area, _context_one | _context_two, _candidates);
+
+		for (uint32 i = 0; i < _candidates.size(); ++i) {
+			MapObject* object = _candidates[i];
+
+			// TODO: examine objects on the proper layer, not just the default layer
+			if (object->GetObjectLayerID() != DEFAULT_LAYER_ID) {
+				continue;
+			}
 
-	// Check every ground object and determine if its context should be changed by this zone
-	// TODO: get the object container from the proper layer, not just the default layer
-	vector<MapObject*>* objects = MapMode::CurrentInstance()->GetObjectSupervisor()->_object_layers[DEFAULT_LAYER_ID].GetObjects();
-	for (uint32 i = 0;	i < objects->size(); ++i) {
-		// If the object does not have a context equal to one of the two switching contexts, do not examine it further
-		if (objects->at(i)->GetContext() != _context_one && objects->at(i)->GetContext() != _context_two) {
-			continue;
-		}
+			// If the object does not have a context equal to one of the two switching contexts, do not examine it further
+			if (object->GetContext() != _context_one && object->GetContext() != _context_two) {
+				continue;
+			}
 
-		// If the object is inside the zone, set their context to that zone's context
-		// (This may result in no change from the object's current context depending on the zone section)
-		index = _IsInsideZone(objects->at(i));
-		if (index >= 0) {
-			MAP_CONTEXT section_context = _section_contexts[index] ? _context_one : _context_two;
-			if (objects->at(i)->GetContext() != section_context) {
-				objects->at(i)->SetContext(section_context);
-				// If the camera is pointing at the object that just had its context changed, start the context transition
-				if (MapMode::CurrentInstance()->GetCamera() == objects->at(i)) {
-					MapMode::CurrentInstance()->ContextTransitionBlackColor(objects->at(i)->GetContext(), 0);
+			// If the object is inside the zone, set their context to that zone's context
+			// (This may result in no change from the object's current context depending on the zone section)
+			index = _IsInsideZone(object);
+			if (index >= 0) {
+				MAP_CONTEXT section_context = _section_contexts[index] ? _context_one : _context_two;
+				if (object->GetContext() != section_context) {
+					object->SetContext(section_context);
+					// Refile the object under its new context so that the zones updated after this one will find it
+					supervisor->_object_grid.UpdateObject(object);
+					// If the camera is pointing at the object that just had its context changed, start the context transition
+					if (MapMode::CurrentInstance()->GetCamera() == object) {
+						MapMode::CurrentInstance()->ContextTransitionBlackColor(object->GetContext(), 0);
+					}
 				}
 			}
 		}
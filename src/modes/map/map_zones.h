@@ -473,6 +473,9 @@ private:
 	//! \brief Stores the context of each zone section. True indicates context one, false is context two
 	std::vector<bool> _section_contexts;
 
+	//! \brief Holds the objects found near a zone section, retained to avoid allocating a new vector for every update
+	std::vector<MapObject*> _candidates;
+
 	/** \brief Determines if a map object is inside the context zone
 	*** \param object A pointer to the map object
 	*** \return The index of the zone section where the object is located, or -1 if it is not in the zone
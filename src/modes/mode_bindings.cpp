@@ -233,6 +233,7 @@ void BindModeCode() {
 			.def_readwrite("run_stamina", &MapMode::_run_stamina)
 
 			.def("PlayMusic", &MapMode::PlayMusic)
+			.def("PreloadMap", &MapMode::PreloadMap)
 			.def("AddZone", &MapMode::AddZone, adopt(_2))
 			.def("SetCamera", (void(MapMode::*)(private_map::VirtualSprite*))&MapMode::SetCamera)
 			.def("SetCamera", (void(MapMode::*)(private_map::VirtualSprite*, uint32))&MapMode::SetCamera)
@@ -763,7 +764,17 @@ void BindModeCode() {
 	module(hoa_script::ScriptManager->GetGlobalState(), "hoa_test")
 	[
 		class_<TestMode, hoa_mode_manager::GameMode>("TestMode")
-			.def("SetImmediateTestID", &TestMode::SetImmediateTestID)
+			.def("SetImmediateTestID", &TestMode::SetImmediateTestID),
+
+		def("BenchmarkParticleUpdate", &BenchmarkParticleUpdate),
+		def("BenchmarkPathFinding", &BenchmarkPathFinding),
+		def("BenchmarkCollisionQueries", &BenchmarkCollisionQueries),
+		def("BenchmarkScriptCache", &BenchmarkScriptCache),
+		def("BenchmarkScriptCompilation", &BenchmarkScriptCompilation),
+		def("BenchmarkTableReads", &BenchmarkTableReads),
+		def("BenchmarkObjectCreation", &BenchmarkObjectCreation),
+		def("BenchmarkCharacterGrowth", &BenchmarkCharacterGrowth),
+		def("BenchmarkMapDataLoad", &BenchmarkMapDataLoad)
 	];
 
 	} // End using test mode namespaces
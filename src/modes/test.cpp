@@ -21,8 +21,13 @@
 #include "script.h"
 #include "video.h"
 
+#include "common.h"
 #include "global.h"
 #include "gui.h"
+#include "map.h"
+#include "map_data.h"
+#include "map_objects.h"
+#include "map_sprites.h"
 #include "pause.h"
 
 using namespace std;
@@ -34,8 +39,11 @@ using namespace hoa_mode_manager;
 using namespace hoa_script;
 using namespace hoa_video;
 
+using namespace hoa_common;
 using namespace hoa_global;
 using namespace hoa_gui;
+using namespace hoa_map;
+using namespace hoa_map::private_map;
 using namespace hoa_pause;
 using namespace hoa_test::private_test;
 
@@ -500,4 +508,569 @@ void TestMode::_SetDescriptionText() {
 	}
 }
 
+// -----------------------------------------------------------------------------
+// Benchmark functions
+// -----------------------------------------------------------------------------
+
+void BenchmarkParticleUpdate(const string& filename, uint32 num_effects, uint32 num_frames) {
+	// The same fixed frame time is used for every update so that each run simulates exactly the same effects
+	const uint32 FRAME_TIME = 16;
+	const uint32 WARMUP_FRAMES = 60;
+
+	if (num_effects == 0 || num_frames == 0) {
+		IF_PRINT_WARNING(TEST_DEBUG) << "the number of effects and frames must both be non-zero" << endl;
+		return;
+	}
+
+	// Time one thread, then every power of two up to the number of CPU cores, then the number of cores itself
+	vector<uint32> thread_counts;
+	uint32 cpu_count = static_cast<uint32>(max(SDL_GetCPUCount(), 1));
+	for (uint32 i = 1; i < cpu_count; i *= 2) {
+		thread_counts.push_back(i);
+	}
+	thread_counts.push_back(cpu_count);
+
+	uint32 original_threads = VideoManager->GetParticleUpdateThreads();
+	VideoManager->StopAllParticleEffects(true);
+	VideoManager->UpdateParticleEffects(0);
+
+	cout << "Particle update benchmark: " << num_effects << " copies of " << filename << ", " << num_frames << " frames" << endl;
+
+	for (uint32 i = 0; i < thread_counts.size(); ++i) {
+		VideoManager->SetParticleUpdateThreads(thread_counts[i]);
+
+		for (uint32 j = 0; j < num_effects; ++j) {
+			float x = 64.0f + static_cast<float>((j * 97) % 896);
+			float y = 64.0f + static_cast<float>((j * 61) % 640);
+			if (VideoManager->AddParticleEffect(filename, x, y) == VIDEO_INVALID_EFFECT) {
+				PRINT_ERROR << "failed to add particle effect: " << filename << endl;
+				VideoManager->SetParticleUpdateThreads(original_threads);
+				return;
+			}
+		}
+
+		for (uint32 j = 0; j < WARMUP_FRAMES; ++j) {
+			VideoManager->UpdateParticleEffects(FRAME_TIME);
+		}
+
+		uint32 start_time = SDL_GetTicks();
+		for (uint32 j = 0; j < num_frames; ++j) {
+			VideoManager->UpdateParticleEffects(FRAME_TIME);
+		}
+		uint32 elapsed_time = SDL_GetTicks() - start_time;
+
+		cout << "  " << VideoManager->GetParticleUpdateThreads() << " thread(s): "
+			<< static_cast<float>(elapsed_time) / static_cast<float>(num_frames) << " ms per frame, "
+			<< VideoManager->GetNumParticles() << " particles" << endl;
+
+		VideoManager->StopAllParticleEffects(true);
+		VideoManager->UpdateParticleEffects(0);
+	}
+
+	VideoManager->SetParticleUpdateThreads(original_threads);
+} // void BenchmarkParticleUpdate(const string& filename, uint32 num_effects, uint32 num_frames)
+
+
+
+void BenchmarkPathFinding(const string& filename, uint32 num_searches) {
+	if (num_searches == 0) {
+		IF_PRINT_WARNING(TEST_DEBUG) << "the number of searches must be non-zero" << endl;
+		return;
+	}
+
+	// The map is never pushed onto the game mode stack. It is only constructed so that its collision grid and objects are loaded.
+	MapMode* map = new MapMode(filename);
+	ObjectSupervisor* objects = map->GetObjectSupervisor();
+	int16 num_rows = static_cast<int16>(objects->GetNumGridRows());
+	int16 num_cols = static_cast<int16>(objects->GetNumGridCols());
+
+	// A sprite with the same collision rectangle as the playable characters, which is not added to the map
+	VirtualSprite sprite;
+	sprite.collidable = true;
+	sprite.context = MAP_CONTEXT_01;
+	sprite.SetCollHalfWidth(0.95f);
+	sprite.SetCollHeight(1.9f);
+
+	// Use the walkable grid elements closest to the top left and bottom right corners as the two ends of the path,
+	// searching along diagonals that move progressively further from each corner
+	PathNode source, dest;
+	for (int16 d = 0; d < num_rows + num_cols && (source.row < 0 || dest.row < 0); ++d) {
+		for (int16 r = 0; r <= d && r < num_rows; ++r) {
+			int16 c = d - r;
+			if (c >= num_cols)
+				continue;
+
+			if (source.row < 0) {
+				sprite.SetPosition(c, r);
+				if (objects->DetectCollision(&sprite, NULL, true) == NO_COLLISION)
+					source = PathNode(r, c);
+			}
+			if (dest.row < 0) {
+				sprite.SetPosition(num_cols - 1 - c, num_rows - 1 - r);
+				if (objects->DetectCollision(&sprite, NULL, true) == NO_COLLISION)
+					dest = PathNode(num_rows - 1 - r, num_cols - 1 - c);
+			}
+		}
+	}
+
+	if (source.row < 0 || dest.row < 0 || source == dest) {
+		PRINT_ERROR << "could not find two separate walkable grid elements on the map: " << filename << endl;
+		delete map;
+		return;
+	}
+
+	cout << "Path finding benchmark: " << filename << " (" << num_rows << "x" << num_cols << " collision grid), "
+		<< "from [" << source.row << ", " << source.col << "] to [" << dest.row << ", " << dest.col << "]" << endl;
+
+	// The first search is not timed. It reports whether a path exists and is used to check that every later search agrees with it.
+	vector<PathNode> first_path;
+	vector<PathNode> path;
+	sprite.SetPosition(source.col, source.row);
+	if (objects->FindPath(&sprite, first_path, dest) == false) {
+		cout << "  no path exists between the two grid elements" << endl;
+		delete map;
+		return;
+	}
+
+	uint32 start_time = SDL_GetTicks();
+	for (uint32 i = 0; i < num_searches; ++i) {
+		objects->FindPath(&sprite, path, dest);
+	}
+	uint32 elapsed_time = SDL_GetTicks() - start_time;
+
+	if (path != first_path) {
+		PRINT_ERROR << "repeated searches between the same grid elements returned different paths" << endl;
+	}
+
+	cout << "  " << num_searches << " searches: " << static_cast<float>(elapsed_time) / static_cast<float>(num_searches)
+		<< " ms per search, " << first_path.size() << " nodes in path, path cost " << first_path.back().g_score << endl;
+
+	delete map;
+} // void BenchmarkPathFinding(const string& filename, uint32 num_searches)
+
+
+
+void BenchmarkCollisionQueries(const string& filename, uint32 num_queries) {
+	if (num_queries == 0) {
+		IF_PRINT_WARNING(TEST_DEBUG) << "the number of queries must be non-zero" << endl;
+		return;
+	}
+
+	// The map is never pushed onto the game mode stack. It is only constructed so that its collision grid is loaded.
+	MapMode* map = new MapMode(filename);
+	const CollisionGrid& grid = map->GetObjectSupervisor()->GetCollisionGrid();
+	int32 num_rows = map->GetObjectSupervisor()->GetNumGridRows();
+	int32 num_cols = map->GetObjectSupervisor()->GetNumGridCols();
+	if (num_rows == 0 || num_cols == 0) {
+		PRINT_ERROR << "the map has an empty collision grid: " << filename << endl;
+		delete map;
+		return;
+	}
+
+	// Generate every rectangle before timing begins. Rectangles range from a single element up to several times the size of a sprite.
+	vector<uint16> rects(num_queries * 4);
+	for (uint32 i = 0; i < num_queries; ++i) {
+		int32 top = RandomBoundedInteger(0, num_rows - 1);
+		int32 bottom = top + RandomBoundedInteger(0, 7);
+		int32 left = RandomBoundedInteger(0, num_cols - 1);
+		int32 right = left + RandomBoundedInteger(0, 7);
+		rects[i * 4] = static_cast<uint16>(top);
+		rects[i * 4 + 1] = static_cast<uint16>((bottom < num_rows) ? bottom : num_rows - 1);
+		rects[i * 4 + 2] = static_cast<uint16>(left);
+		rects[i * 4 + 3] = static_cast<uint16>((right < num_cols) ? right : num_cols - 1);
+	}
+
+	cout << "Collision query benchmark: " << filename << " (" << num_rows << "x" << num_cols << " collision grid)" << endl;
+
+	// Time the area query against testing each element of the rectangle individually, which is how the grid was previously queried
+	uint32 area_blocked = 0;
+	uint32 start_time = SDL_GetTicks();
+	for (uint32 i = 0; i < num_queries; ++i) {
+		if (grid.IsAreaBlocked(rects[i * 4], rects[i * 4 + 1], rects[i * 4 + 2], rects[i * 4 + 3], MAP_CONTEXT_01) == true)
+			area_blocked++;
+	}
+	uint32 area_time = SDL_GetTicks() - start_time;
+
+	uint32 element_blocked = 0;
+	start_time = SDL_GetTicks();
+	for (uint32 i = 0; i < num_queries; ++i) {
+		bool blocked = false;
+		for (uint16 r = rects[i * 4]; r <= rects[i * 4 + 1] && blocked == false; ++r) {
+			for (uint16 c = rects[i * 4 + 2]; c <= rects[i * 4 + 3] && blocked == false; ++c) {
+				blocked = grid.IsElementBlocked(r, c, MAP_CONTEXT_01);
+			}
+		}
+		if (blocked == true)
+			element_blocked++;
+	}
+	uint32 element_time = SDL_GetTicks() - start_time;
+
+	if (area_blocked != element_blocked) {
+		PRINT_ERROR << "area queries found " << area_blocked << " blocked rectangles, but element queries found " << element_blocked << endl;
+	}
+
+	cout << "  " << num_queries << " queries, " << area_blocked << " blocked: " << area_time << " ms by area, "
+		<< element_time << " ms by element" << endl;
+
+	delete map;
+} // void BenchmarkCollisionQueries(const string& filename, uint32 num_queries)
+
+
+
+void BenchmarkScriptCache(const string& filename, uint32 num_opens) {
+	if (num_opens == 0) {
+		IF_PRINT_WARNING(TEST_DEBUG) << "the number of opens must be non-zero" << endl;
+		return;
+	}
+
+	// Files that the game keeps open, such as the definition scripts retained by GameGlobal, can not be opened again
+	if (ScriptManager->IsFileOpen(filename) == true) {
+		PRINT_ERROR << "the script file is already open and can not be benchmarked: " << filename << endl;
+		return;
+	}
+
+	ReadScriptDescriptor script;
+	uint32 cache_size = ScriptManager->GetScriptCacheSize();
+	cout << "Script cache benchmark: " << filename << endl;
+
+	// Time opening the file with the cache disabled, so that every open parses the file
+	ScriptManager->SetScriptCacheSize(0);
+	uint32 start_time = SDL_GetTicks();
+	for (uint32 i = 0; i < num_opens; ++i) {
+		if (script.OpenFile(filename) == false) {
+			PRINT_ERROR << "failed to open the script file: " << filename << endl;
+			ScriptManager->SetScriptCacheSize(cache_size);
+			return;
+		}
+		script.CloseFile();
+	}
+	uint32 uncached_time = SDL_GetTicks() - start_time;
+
+	// Time the same opens with the cache enabled. Only the first open is a miss.
+	ScriptManager->SetScriptCacheSize(cache_size);
+	ScriptManager->InvalidateCachedScript(script.GetLoadedFilename());
+	ScriptManager->ResetScriptCacheStatistics();
+	start_time = SDL_GetTicks();
+	for (uint32 i = 0; i < num_opens; ++i) {
+		script.OpenFile(filename);
+		script.CloseFile();
+	}
+	uint32 cached_time = SDL_GetTicks() - start_time;
+
+	cout << "  " << num_opens << " opens: " << static_cast<float>(uncached_time) / static_cast<float>(num_opens) << " ms per open uncached, "
+		<< static_cast<float>(cached_time) / static_cast<float>(num_opens) << " ms per open cached" << endl << "  ";
+	ScriptManager->PrintScriptCacheStatistics();
+} // void BenchmarkScriptCache(const string& filename, uint32 num_opens)
+
+
+
+void BenchmarkScriptCompilation(const string& filename, uint32 num_loads) {
+	if (num_loads == 0) {
+		IF_PRINT_WARNING(TEST_DEBUG) << "the number of loads must be non-zero" << endl;
+		return;
+	}
+
+	string compiled_filename = filename + ".hoa";
+	if (DoesFileExist(compiled_filename) == false) {
+		PRINT_ERROR << "no compiled file exists for the script (run 'make compile-lua' to create it): " << filename << endl;
+		return;
+	}
+
+	// The files are loaded directly rather than opened through a descriptor, which bypasses the script cache and
+	// the engine's preference for the compiled file, and excludes the time spent executing them
+	lua_State* state = ScriptManager->GetGlobalState();
+	uint32 load_times[2] = { 0, 0 };
+	const string* filenames[2] = { &filename, &compiled_filename };
+	for (uint32 f = 0; f < 2; ++f) {
+		uint32 start_time = SDL_GetTicks();
+		for (uint32 i = 0; i < num_loads; ++i) {
+			if (luaL_loadfile(state, filenames[f]->c_str()) != 0) {
+				PRINT_ERROR << "failed to load the script file: " << *filenames[f] << ", error message: " << lua_tostring(state, -1) << endl;
+				lua_pop(state, 1);
+				return;
+			}
+			lua_pop(state, 1);
+		}
+		load_times[f] = SDL_GetTicks() - start_time;
+	}
+
+	cout << "Script compilation benchmark: " << filename << endl << "  " << num_loads << " loads: "
+		<< static_cast<float>(load_times[0]) / static_cast<float>(num_loads) << " ms per load from source, "
+		<< static_cast<float>(load_times[1]) / static_cast<float>(num_loads) << " ms per load compiled" << endl;
+} // void BenchmarkScriptCompilation(const string& filename, uint32 num_loads)
+
+
+
+void BenchmarkTableReads(const string& filename, uint32 num_reads) {
+	if (num_reads == 0) {
+		IF_PRINT_WARNING(TEST_DEBUG) << "the number of reads must be non-zero" << endl;
+		return;
+	}
+
+	ReadScriptDescriptor data_file;
+	if (data_file.OpenFile(filename) == false) {
+		PRINT_ERROR << "failed to open the map data file: " << filename << endl;
+		return;
+	}
+	data_file.OpenTablespace();
+
+	uint32 row_count = data_file.ReadUInt("map_height");
+	uint32 column_count = data_file.ReadUInt("map_length");
+	uint32 tiles_per_entry = data_file.ReadUInt("number_tile_layers") * data_file.ReadUInt("number_map_contexts");
+	if (row_count == 0 || column_count == 0 || tiles_per_entry == 0) {
+		PRINT_ERROR << "the file does not contain valid map dimensions: " << filename << endl;
+		data_file.CloseFile();
+		return;
+	}
+
+	cout << "Table read benchmark: " << filename << " (" << row_count << "x" << column_count << " tiles, "
+		<< tiles_per_entry << " per entry)" << endl;
+
+	// Each method reads every entry of the map_tiles table num_reads times and sums the tiles, so that the
+	// results of the three methods may be checked against each other
+	vector<int32> tile_data;
+	vector<int32> tile_array(tiles_per_entry);
+	int32 sums[3] = { 0, 0, 0 };
+	uint32 read_times[3] = { 0, 0, 0 };
+	data_file.OpenTable("map_tiles");
+	for (uint32 method = 0; method < 3; ++method) {
+		uint32 start_time = SDL_GetTicks();
+		for (uint32 n = 0; n < num_reads; ++n) {
+			for (uint32 y = 0; y < row_count; ++y) {
+				data_file.OpenTable(y);
+				for (uint32 x = 0; x < column_count; ++x) {
+					if (method == 0) {
+						// The way that all numeric tables were read before the fast paths were added: a luabind cast of every element
+						data_file.OpenTable(x);
+						luabind::object entry(luabind::from_stack(data_file.GetLuaState(), -1));
+						for (luabind::iterator it(entry), end; it != end; ++it) {
+							try {
+								sums[method] += luabind::object_cast<int32>(*it);
+							}
+							catch (...) {}
+						}
+						data_file.CloseTable();
+					}
+					else if (method == 1) {
+						tile_data.clear();
+						data_file.ReadIntVector(x, tile_data);
+						for (uint32 i = 0; i < tile_data.size(); ++i)
+							sums[method] += tile_data[i];
+					}
+					else if (data_file.ReadIntArray(x, &tile_array[0], tiles_per_entry) == true) {
+						for (uint32 i = 0; i < tiles_per_entry; ++i)
+							sums[method] += tile_array[i];
+					}
+				}
+				data_file.CloseTable();
+			}
+		}
+		read_times[method] = SDL_GetTicks() - start_time;
+	}
+	data_file.CloseTable();
+
+	if (data_file.IsErrorDetected() == true) {
+		PRINT_ERROR << "errors occurred while reading the tile tables:" << endl << data_file.GetErrorMessages() << endl;
+	}
+	if (sums[0] != sums[1] || sums[0] != sums[2]) {
+		PRINT_ERROR << "the three read methods did not return the same tiles" << endl;
+	}
+	data_file.CloseFile();
+
+	cout << "  " << num_reads << " reads: " << static_cast<float>(read_times[0]) / static_cast<float>(num_reads) << " ms per read with luabind casts, "
+		<< static_cast<float>(read_times[1]) / static_cast<float>(num_reads) << " ms with ReadIntVector, "
+		<< static_cast<float>(read_times[2]) / static_cast<float>(num_reads) << " ms with ReadIntArray" << endl;
+} // void BenchmarkTableReads(const string& filename, uint32 num_reads)
+
+
+
+void BenchmarkObjectCreation(uint32 num_passes, uint32 expected_objects, uint32 expected_skills) {
+	if (num_passes == 0) {
+		IF_PRINT_WARNING(TEST_DEBUG) << "the number of passes must be non-zero" << endl;
+		return;
+	}
+
+	// Collect the ID of every definition from the persistent scripts, which have their definition tables open.
+	// ReadTableKeys() replaces the contents of the vector it is given, so the keys of each script are appended.
+	vector<uint32> object_ids;
+	vector<uint32> skill_ids;
+	vector<uint32> script_keys;
+	ReadScriptDescriptor* object_scripts[] = {
+		&GlobalManager->GetItemsScript(), &GlobalManager->GetWeaponsScript(), &GlobalManager->GetHeadArmorScript(),
+		&GlobalManager->GetTorsoArmorScript(), &GlobalManager->GetArmArmorScript(), &GlobalManager->GetLegArmorScript(),
+		&GlobalManager->GetKeyItemsScript()
+	};
+	ReadScriptDescriptor* skill_scripts[] = {
+		&GlobalManager->GetAttackSkillsScript(), &GlobalManager->GetDefendSkillsScript(), &GlobalManager->GetSupportSkillsScript()
+	};
+	for (uint32 i = 0; i < 7; ++i) {
+		object_scripts[i]->ReadTableKeys(script_keys);
+		object_ids.insert(object_ids.end(), script_keys.begin(), script_keys.end());
+	}
+	for (uint32 i = 0; i < 3; ++i) {
+		skill_scripts[i]->ReadTableKeys(script_keys);
+		skill_ids.insert(skill_ids.end(), script_keys.begin(), script_keys.end());
+	}
+
+	if (object_ids.empty() == true && skill_ids.empty() == true) {
+		PRINT_ERROR << "no object or skill definitions were found" << endl;
+		return;
+	}
+
+	cout << "Object creation benchmark: " << object_ids.size() << " objects, " << skill_ids.size() << " skills" << endl;
+	if (object_ids.size() != expected_objects || skill_ids.size() != expected_skills) {
+		PRINT_ERROR << "expected " << expected_objects << " object and " << expected_skills << " skill definitions, but found "
+			<< object_ids.size() << " objects and " << skill_ids.size() << " skills" << endl;
+	}
+
+	uint32 invalid_count = 0;
+	uint32 first_pass_time = 0;
+	uint32 pass_time = 0;
+	for (uint32 n = 0; n <= num_passes; ++n) {
+		uint32 start_time = SDL_GetTicks();
+		for (uint32 i = 0; i < object_ids.size(); ++i) {
+			GlobalObject* object = GlobalCreateNewObject(object_ids[i]);
+			if (object == NULL || object->IsValid() == false)
+				invalid_count++;
+			delete object;
+		}
+		for (uint32 i = 0; i < skill_ids.size(); ++i) {
+			GlobalSkill skill(skill_ids[i]);
+			if (skill.IsValid() == false)
+				invalid_count++;
+		}
+
+		if (n == 0)
+			first_pass_time = SDL_GetTicks() - start_time;
+		else
+			pass_time += SDL_GetTicks() - start_time;
+	}
+
+	if (invalid_count > 0) {
+		PRINT_ERROR << invalid_count << " objects or skills could not be created over all passes" << endl;
+	}
+
+	uint32 creations = num_passes * (object_ids.size() + skill_ids.size());
+	cout << "  first pass: " << first_pass_time << " ms" << endl;
+	cout << "  " << num_passes << " further passes: " << pass_time << " ms, "
+		<< static_cast<float>(pass_time) * 1000.0f / static_cast<float>(creations) << " microseconds per object or skill" << endl;
+} // void BenchmarkObjectCreation(uint32 num_passes, uint32 expected_objects, uint32 expected_skills)
+
+
+
+void BenchmarkCharacterGrowth(uint32 experience, uint32 num_trials) {
+	if (num_trials == 0) {
+		IF_PRINT_WARNING(TEST_DEBUG) << "the number of trials must be non-zero" << endl;
+		return;
+	}
+
+	vector<uint32> character_ids;
+	GlobalManager->GetCharactersScript().ReadTableKeys(character_ids);
+	if (character_ids.empty() == true) {
+		PRINT_ERROR << "no character definitions were found" << endl;
+		return;
+	}
+
+	cout << "Character growth benchmark: " << character_ids.size() << " characters, " << experience << " experience points each" << endl;
+
+	// Only the low 32 bits of the performance counter are kept. Their difference is correct for any interval that is
+	// shorter than 2^32 counts, which is far longer than the growth of a party takes.
+	float counts_per_microsecond = static_cast<float>(SDL_GetPerformanceFrequency()) / 1000000.0f;
+	uint32 levels_gained = 0;
+	uint32 growth_calls = 0;
+	float total_microseconds = 0.0f;
+	for (uint32 n = 0; n < num_trials; ++n) {
+		vector<GlobalCharacter*> characters;
+		for (uint32 i = 0; i < character_ids.size(); ++i) {
+			characters.push_back(new GlobalCharacter(character_ids[i]));
+		}
+
+		uint32 start_time = static_cast<uint32>(SDL_GetPerformanceCounter());
+		for (uint32 i = 0; i < characters.size(); ++i) {
+			uint32 start_level = characters[i]->GetExperienceLevel();
+			if (characters[i]->AddExperiencePoints(experience) == true) {
+				// AcknowledgeGrowth() returns true for as long as more growth remains to be acknowledged
+				do {
+					growth_calls++;
+				} while (characters[i]->AcknowledgeGrowth() == true);
+			}
+			levels_gained += characters[i]->GetExperienceLevel() - start_level;
+		}
+		uint32 elapsed_counts = static_cast<uint32>(SDL_GetPerformanceCounter()) - start_time;
+		total_microseconds += static_cast<float>(elapsed_counts) / counts_per_microsecond;
+
+		for (uint32 i = 0; i < characters.size(); ++i) {
+			delete characters[i];
+		}
+	}
+
+	cout << "  " << num_trials << " trials: " << levels_gained / num_trials << " levels gained per trial, "
+		<< total_microseconds / static_cast<float>(num_trials) << " microseconds per trial, "
+		<< total_microseconds / static_cast<float>(growth_calls) << " microseconds per call to AcknowledgeGrowth()" << endl;
+} // void BenchmarkCharacterGrowth(uint32 experience, uint32 num_trials)
+
+
+
+void BenchmarkMapDataLoad(const string& filename, uint32 num_loads) {
+	if (num_loads == 0) {
+		IF_PRINT_WARNING(TEST_DEBUG) << "the number of loads must be non-zero" << endl;
+		return;
+	}
+
+	// Read the map data from its script the same way that a map does when no usable compiled data exists
+	MapData script_data;
+	ReadScriptDescriptor data_file;
+	uint32 start_time = SDL_GetTicks();
+	for (uint32 i = 0; i < num_loads; ++i) {
+		if (data_file.OpenFile(filename) == false) {
+			PRINT_ERROR << "failed to open the map data file: " << filename << endl;
+			return;
+		}
+
+		data_file.OpenTable(DetermineLuaFileTablespaceName(filename));
+		bool data_loaded = script_data.LoadScript(data_file);
+		data_file.CloseAllTables();
+		data_file.CloseFile();
+		if (data_loaded == false) {
+			PRINT_ERROR << "failed to load the map data file: " << filename << endl;
+			return;
+		}
+	}
+	uint32 script_time = SDL_GetTicks() - start_time;
+
+	cout << "Map data load benchmark: " << filename << " (script read from " << data_file.GetLoadedFilename() << ")" << endl;
+
+	// Maps look up their compiled data by the name of the Lua data file, so the data must record that name even when the
+	// script was read from its compiled form. Otherwise the compiled data written here would never be used.
+	if (script_data.filename != filename) {
+		PRINT_ERROR << "the map data recorded the source filename " << script_data.filename << " instead of " << filename << endl;
+		return;
+	}
+
+	if (script_data.Compile() == false) {
+		PRINT_ERROR << "failed to write the compiled map data for: " << filename << endl;
+		return;
+	}
+
+	MapData compiled_data;
+	start_time = SDL_GetTicks();
+	for (uint32 i = 0; i < num_loads; ++i) {
+		if (compiled_data.LoadCompiled(filename) == false) {
+			PRINT_ERROR << "the compiled map data that was just written could not be loaded for: " << filename << endl;
+			return;
+		}
+	}
+	uint32 compiled_time = SDL_GetTicks() - start_time;
+
+	if (compiled_data.row_count != script_data.row_count || compiled_data.column_count != script_data.column_count
+		|| compiled_data.context_count != script_data.context_count)
+	{
+		PRINT_ERROR << "the compiled map data does not match the data read from the script: " << filename << endl;
+		return;
+	}
+
+	cout << "  " << num_loads << " loads: " << static_cast<float>(script_time) / static_cast<float>(num_loads) << " ms per load from script, "
+		<< static_cast<float>(compiled_time) / static_cast<float>(num_loads) << " ms per load compiled" << endl;
+} // void BenchmarkMapDataLoad(const string& filename, uint32 num_loads)
+
 } // namespace hoa_test
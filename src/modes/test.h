@@ -203,6 +203,100 @@ private:
 	void _SetDescriptionText();
 }; // class TestMode : public hoa_mode_manager::GameMode
 
+
+/** \name Benchmark Functions
+*** \brief Measure the performance of engine code and print the results to standard output
+***
+*** These functions are bound to Lua so that tests may run them. Each one runs its workload
+*** to completion before returning, so the screen does not update while a benchmark is running.
+**/
+//@{
+/** \brief Measures the time spent updating particle effects when using different numbers of threads
+*** \param filename The name of the particle effect definition file to use
+*** \param num_effects The number of copies of the effect to play at once
+*** \param num_frames The number of frames to time for each thread count
+***
+*** The copies of the effect are spread across the screen and updated for one second of game time before timing
+*** begins, so that their number of particles has time to build up. The effects are destroyed when the benchmark ends.
+**/
+void BenchmarkParticleUpdate(const std::string& filename, uint32 num_effects, uint32 num_frames);
+
+/** \brief Measures the time taken to find a long path across a map
+*** \param filename The name of the map script file to load
+*** \param num_searches The number of times to find the path
+***
+*** The path runs between the walkable collision grid elements closest to the top left and bottom right corners
+*** of the map, for a sprite the size of a playable character. The map is loaded but never becomes the active game
+*** mode, and it is destroyed when the benchmark ends.
+**/
+void BenchmarkPathFinding(const std::string& filename, uint32 num_searches);
+
+/** \brief Measures the time taken to test random rectangles of a map's collision grid for unwalkable elements
+*** \param filename The name of the map script file to load
+*** \param num_queries The number of rectangles to test
+***
+*** Each rectangle is tested both with a single area query and one element at a time, and the two results are
+*** checked against each other. The map is loaded but never becomes the active game mode, and it is destroyed
+*** when the benchmark ends.
+**/
+void BenchmarkCollisionQueries(const std::string& filename, uint32 num_queries);
+
+/** \brief Measures the time taken to open a script file repeatedly with and without the script cache
+*** \param filename The name of the script file to open
+*** \param num_opens The number of times to open the file in each case
+***
+*** The script cache statistics are reset before the cached opens are timed and are printed when the benchmark ends.
+**/
+void BenchmarkScriptCache(const std::string& filename, uint32 num_opens);
+
+/** \brief Measures the time taken to load a script file from its source compared to its compiled form
+*** \param filename The name of the source script file, including its extension
+*** \param num_loads The number of times to load each form of the file
+***
+*** The compiled form must have already been created by the compile-lua build target. Only the time spent
+*** loading the file is measured. Neither form of the file is executed.
+**/
+void BenchmarkScriptCompilation(const std::string& filename, uint32 num_loads);
+
+/** \brief Measures the time taken to read every tile table of a map data file
+*** \param filename The name of the map data file to read
+*** \param num_reads The number of times to read all of the tables with each method
+***
+*** The tables are read by casting each element through luabind, with ReadIntVector(), and with ReadIntArray(),
+*** and the tiles returned by each method are checked against each other.
+**/
+void BenchmarkTableReads(const std::string& filename, uint32 num_reads);
+
+/** \brief Measures the time taken to construct every object and skill that has a definition
+*** \param num_passes The number of times to construct all of the objects and skills after the first time
+*** \param expected_objects The number of object definitions in the definition scripts
+*** \param expected_skills The number of skill definitions in the definition scripts
+***
+*** The first pass is timed separately, because it also loads every definition that has not already been requested.
+*** An error is reported if the number of definitions found does not match the expected numbers.
+**/
+void BenchmarkObjectCreation(uint32 num_passes, uint32 expected_objects, uint32 expected_skills);
+
+/** \brief Measures the time taken to process the growth of every character after a large experience award
+*** \param experience The number of experience points to award each character
+*** \param num_trials The number of times to construct the characters and process their growth
+***
+*** Only the calls to AcknowledgeGrowth() are timed. The characters are constructed from their initial state for each
+*** trial and are never added to the party.
+**/
+void BenchmarkCharacterGrowth(uint32 experience, uint32 num_trials);
+
+/** \brief Measures the time taken to load map data from its script compared to its compiled form
+*** \param filename The name of the map data file, including its extension
+*** \param num_loads The number of times to load each form of the data
+***
+*** The data is compiled after it is read from the script, and the benchmark reports an error if the compiled data can
+*** not then be found under the name of the map data file. Running it after the compile-lua build target checks that
+*** map data read from a compiled script is still compiled under the name of its source file.
+**/
+void BenchmarkMapDataLoad(const std::string& filename, uint32 num_loads);
+//@}
+
 } // namespace hoa_test
 
 #endif // __TEST_HEADER__
\ No newline at end of file
@@ -13,7 +13,7 @@
 *** \brief   Source file for Allacrost utility code.
 *** ***************************************************************************/
 
-// Headers included for directory manipulation. Windows has its own way of
+// Headers included for directory manipulation and file mapping. Windows has its own way of
 // dealing with directories, hence the need for conditional includes
 #ifdef _WIN32
 	#include <direct.h>
@@ -22,8 +22,11 @@
 	#include <dirent.h>
 	#include <sys/types.h>
 	#include <pwd.h>
+	#include <fcntl.h>
+	#include <sys/mman.h>
 #endif
 
+#include <cstdio>
 #include <iconv.h>
 #include <sys/stat.h>
 
@@ -805,6 +808,77 @@ bool DeleteFile(const std::string &filename) {
 
 
 
+bool MapFileIntoMemory(const std::string& filename, uint8*& data, uint32& size) {
+	data = NULL;
+	size = 0;
+
+	if (filename.empty() == true)
+		return false;
+
+	#ifdef _WIN32
+		// Windows lacks mmap, so the file is simply read into memory
+		FILE* file = fopen(filename.c_str(), "rb");
+		if (file == NULL)
+			return false;
+
+		fseek(file, 0, SEEK_END);
+		long length = ftell(file);
+		fseek(file, 0, SEEK_SET);
+		if (length <= 0) {
+			fclose(file);
+			return false;
+		}
+
+		data = static_cast<uint8*>(malloc(length));
+		if (data == NULL || fread(data, length, 1, file) != 1) {
+			free(data);
+			data = NULL;
+			fclose(file);
+			return false;
+		}
+		fclose(file);
+		size = static_cast<uint32>(length);
+	#else
+		int descriptor = open(filename.c_str(), O_RDONLY);
+		if (descriptor < 0)
+			return false;
+
+		struct stat buf;
+		if (fstat(descriptor, &buf) != 0 || buf.st_size <= 0) {
+			close(descriptor);
+			return false;
+		}
+
+		void* mapping = mmap(NULL, buf.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+		// The mapping remains valid after the descriptor is closed
+		close(descriptor);
+		if (mapping == MAP_FAILED) {
+			if (UTILS_DEBUG) cerr << "UTILS WARNING: failed to map file into memory: " << filename << endl;
+			return false;
+		}
+
+		data = static_cast<uint8*>(mapping);
+		size = static_cast<uint32>(buf.st_size);
+	#endif
+
+	return true;
+}
+
+
+
+void UnmapFileFromMemory(uint8* data, uint32 size) {
+	if (data == NULL)
+		return;
+
+	#ifdef _WIN32
+		free(data);
+	#else
+		munmap(data, size);
+	#endif
+}
+
+
+
 
 const std::string GetUserDataPath(bool user_files) {
 	#if defined _WIN32
@@ -662,6 +662,23 @@ std::vector<std::string> ListDirectory(const std::string& dir_name, const std::s
 **/
 bool DeleteFile(const std::string& filename);
 
+/** \brief Maps the contents of a file into memory for reading
+*** \param filename The name of the file to map
+*** \param data Set to point at the contents of the file
+*** \param size Set to the size of the file, in bytes
+*** \return False if the file does not exist, is empty, or could not be mapped
+***
+*** The memory is read-only and must be released with UnmapFileFromMemory().
+*** \note Systems without mmap (Windows) read the entire file into memory instead.
+**/
+bool MapFileIntoMemory(const std::string& filename, uint8*& data, uint32& size);
+
+/** \brief Releases the memory of a file that was mapped by MapFileIntoMemory()
+*** \param data The contents of the file. Nothing is done if this is NULL.
+*** \param size The size of the file, in bytes
+**/
+void UnmapFileFromMemory(uint8* data, uint32 size);
+
 
 //! \name User directory and settings paths
 //@{